@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+# -*- coding: utf8 -*-
+#
+# Copyright © 2026 VLC authors and VideoLAN
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation; either version 2.1 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+
+"""Convert a trace file from the binary tracer (--tracer=binary) to the
+Chrome trace event format, as loaded by https://ui.perfetto.dev/ and
+chrome://tracing.
+
+Spans (vlc_tracer_TraceBegin() and vlc_tracer_TraceEnd()) become duration
+events on the timeline of their thread, other traces become instant events
+with their values as arguments.
+
+Usage: vlc-trace2json.py vlc-trace.bin [output.json]
+"""
+
+import json
+import struct
+import sys
+
+HEADER_SIZE = 256
+MAGIC = b'VLCTRACE'
+
+# enum vlc_tracer_value
+TRACER_INT, TRACER_TICK, TRACER_STRING = range(3)
+
+
+def read_header(data):
+    if len(data) < HEADER_SIZE or data[:8] != MAGIC:
+        raise ValueError('not a VLC binary trace file')
+
+    for endian in '<>':
+        fields = struct.unpack_from(endian + '7I', data, 8)
+        if fields[1] == 0x01020304:
+            break
+    else:
+        raise ValueError('unknown byte order')
+
+    version, _, record_size, entries, key_size, string_size, pid = fields
+    if version != 1:
+        raise ValueError('unsupported trace version %u' % version)
+    return endian, record_size, entries, key_size, string_size, pid
+
+
+def read_records(data):
+    endian, record_size, entries, key_size, string_size, pid = \
+        read_header(data)
+
+    record = struct.Struct(endian + 'qII')
+    entry_size = key_size + 1 + string_size
+    entry_size += -entry_size % 8
+    value_offset = key_size + 1
+    value_offset += -value_offset % 8
+
+    for offset in range(HEADER_SIZE, len(data) - record_size + 1,
+                        record_size):
+        ts, thread, count = record.unpack_from(data, offset)
+        if count == 0:
+            continue # zero padding at the end of an unterminated file
+
+        values = {}
+        base = offset + record.size
+        for i in range(min(count, entries)):
+            e = base + i * entry_size
+            key = data[e:e + key_size].split(b'\0', 1)[0].decode('utf-8',
+                                                                 'replace')
+            kind = data[e + key_size]
+            if kind == TRACER_STRING:
+                raw = data[e + value_offset:e + value_offset + string_size]
+                values[key] = raw.split(b'\0', 1)[0].decode('utf-8',
+                                                            'replace')
+            else:
+                value, = struct.unpack_from(endian + 'q', data,
+                                            e + value_offset)
+                # Ticks are in nanoseconds, as the timestamps
+                values[key] = value / 1000. if kind == TRACER_TICK else value
+        yield pid, thread, ts, values
+
+
+def convert(data):
+    events = []
+
+    for pid, thread, ts, values in read_records(data):
+        event = {
+            'pid': pid,
+            'tid': thread,
+            'ts': ts / 1000.,
+            'cat': values.get('type', 'trace'),
+        }
+
+        if 'begin' in values:
+            event['ph'] = 'B'
+            event['name'] = values.pop('begin')
+        elif 'end' in values:
+            event['ph'] = 'E'
+            event['name'] = values.pop('end')
+        elif 'dropped' in values:
+            # Records lost because the ring of the thread was full
+            event['ph'] = 'i'
+            event['s'] = 't'
+            event['name'] = 'dropped'
+        else:
+            event['ph'] = 'i'
+            event['s'] = 't'
+            event['name'] = values.get('event', event['cat'])
+        event['args'] = values
+        events.append(event)
+
+    # Threads drain their rings in no particular order
+    events.sort(key=lambda event: event['ts'])
+    return {'traceEvents': events, 'displayTimeUnit': 'ms'}
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 1
+
+    with open(argv[1], 'rb') as f:
+        data = f.read()
+
+    try:
+        trace = convert(data)
+    except ValueError as e:
+        sys.stderr.write('%s: %s\n' % (argv[1], e))
+        return 1
+
+    if len(argv) == 3:
+        with open(argv[2], 'w') as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
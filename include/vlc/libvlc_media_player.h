@@ -499,6 +499,196 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup );
 
+/**
+ * Opaque reference to a decoded video frame.
+ *
+ * \see libvlc_video_set_frame_callback()
+ * \version LibVLC 4.0.0 and later.
+ */
+typedef struct libvlc_video_frame_t libvlc_video_frame_t;
+
+/**
+ * Callback prototype to receive decoded video frames.
+ *
+ * The callback owns a reference to the frame, and must release it with
+ * libvlc_video_frame_release(), possibly later and from another thread.
+ *
+ * \warning The frames are allocated from the decoder picture pool, which is
+ * bounded: holding too many frames for too long stalls the decoding.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_video_set_frame_callback() [IN]
+ * \param frame the decoded frame [IN]
+ * \version LibVLC 4.0.0 and later.
+ */
+typedef void (*libvlc_video_frame_cb)(void *opaque,
+                                      libvlc_video_frame_t *frame);
+
+/**
+ * Set a callback to receive the decoded video frames without any copy.
+ *
+ * Unlike libvlc_video_set_callbacks(), the application does not provide the
+ * video memory: the pictures output by the decoder are handed over as they
+ * are, in their native chroma and dimensions. Sub-pictures are not blended
+ * and hardware decoding is disabled.
+ *
+ * The callback is invoked from the video output thread, at the time each
+ * frame is due for display. It is not invoked anymore once this function
+ * returns, so it must not call this function itself.
+ *
+ * \param mp the media player
+ * \param frame_cb callback to receive the frames, or NULL to disable it and
+ *                 restore the default video output
+ * \param opaque private pointer for the callback (as first parameter)
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame_cb,
+                                      void *opaque );
+
+/**
+ * Increment the reference count of a video frame.
+ *
+ * \param frame a video frame
+ * \return the same frame
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API libvlc_video_frame_t *
+libvlc_video_frame_retain( libvlc_video_frame_t *frame );
+
+/**
+ * Decrement the reference count of a video frame, and give the picture back
+ * to the decoder when it reaches 0.
+ *
+ * \param frame a video frame
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API void libvlc_video_frame_release( libvlc_video_frame_t *frame );
+
+/**
+ * Get the chroma of a video frame, as a 4-character string (e.g. "I420").
+ *
+ * The string is valid as long as the frame.
+ *
+ * \param frame a video frame
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API const char *
+libvlc_video_frame_get_chroma( const libvlc_video_frame_t *frame );
+
+/**
+ * Get the visible width of a video frame in pixels.
+ *
+ * \param frame a video frame
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API unsigned
+libvlc_video_frame_get_width( const libvlc_video_frame_t *frame );
+
+/**
+ * Get the visible height of a video frame in pixels.
+ *
+ * \param frame a video frame
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API unsigned
+libvlc_video_frame_get_height( const libvlc_video_frame_t *frame );
+
+/**
+ * Get the number of planes of a video frame.
+ *
+ * \param frame a video frame
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API unsigned
+libvlc_video_frame_get_plane_count( const libvlc_video_frame_t *frame );
+
+/**
+ * Get the pixels of a plane of a video frame.
+ *
+ * The pixels belong to the frame and must not be modified.
+ *
+ * \param frame a video frame
+ * \param plane the plane index, lower than
+ *              libvlc_video_frame_get_plane_count()
+ * \param pitch pointer to the number of bytes per line [OUT]
+ * \param lines pointer to the number of visible lines [OUT]
+ * \return a pointer to the first visible pixel of the plane
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API const unsigned char *
+libvlc_video_frame_get_plane( const libvlc_video_frame_t *frame,
+                              unsigned plane, size_t *pitch, unsigned *lines );
+
+/**
+ * Get the presentation timestamp of a video frame.
+ *
+ * \param frame a video frame
+ * \return the media time of the frame in microseconds, or -1 if unknown
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API int64_t
+libvlc_video_frame_get_pts( const libvlc_video_frame_t *frame );
+
+/**
+ * Opaque queue of decoded video frames, for applications that would rather
+ * pull the frames than receive them from a callback.
+ *
+ * \version LibVLC 4.0.0 and later.
+ */
+typedef struct libvlc_video_frame_queue_t libvlc_video_frame_queue_t;
+
+/**
+ * Create a queue of decoded video frames.
+ *
+ * This replaces any callback set with libvlc_video_set_frame_callback().
+ * When the queue is full, the oldest frame is dropped so that the playback
+ * is never blocked.
+ *
+ * \param mp the media player
+ * \param depth the maximum number of queued frames (at least 1)
+ * \return a frame queue, or NULL on error
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API libvlc_video_frame_queue_t *
+libvlc_video_frame_queue_new( libvlc_media_player_t *mp, unsigned depth );
+
+/**
+ * Dequeue the oldest decoded video frame.
+ *
+ * \param queue a frame queue
+ * \param timeout maximum time to wait in microseconds,
+ *                0 not to wait, or a negative value to wait indefinitely
+ * \return a frame to release with libvlc_video_frame_release(),
+ *         or NULL if none was available in time
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API libvlc_video_frame_t *
+libvlc_video_frame_queue_pop( libvlc_video_frame_queue_t *queue,
+                              int64_t timeout );
+
+/**
+ * Get the number of frames dropped because the queue was full.
+ *
+ * \param queue a frame queue
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API uint64_t
+libvlc_video_frame_queue_get_dropped( libvlc_video_frame_queue_t *queue );
+
+/**
+ * Destroy a queue of decoded video frames, and release the queued frames.
+ *
+ * No more frames are queued once this function returns, even if the media
+ * player is still playing.
+ *
+ * \param queue a frame queue
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API void
+libvlc_video_frame_queue_destroy( libvlc_video_frame_queue_t *queue );
+
 
 typedef struct libvlc_video_setup_device_cfg_t
 {
@@ -1121,6 +1311,205 @@ LIBVLC_API
 void libvlc_audio_set_format( libvlc_media_player_t *mp, const char *format,
                               unsigned rate, unsigned channels );
 
+/**
+ * Opaque reference to a buffer of decoded audio samples.
+ *
+ * \see libvlc_audio_set_tap_callback()
+ * \version LibVLC 4.0.0 and later.
+ */
+typedef struct libvlc_audio_buffer_t libvlc_audio_buffer_t;
+
+/**
+ * Callback prototype to receive decoded audio buffers.
+ *
+ * The callback owns a reference to the buffer, and must release it with
+ * libvlc_audio_buffer_release(), possibly later and from another thread.
+ *
+ * The decoding waits for the callback to return: a slow callback slows the
+ * decoding down, rather than losing samples.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_audio_set_tap_callback() [IN]
+ * \param buffer the decoded buffer, or NULL at the end of the audio stream [IN]
+ * \version LibVLC 4.0.0 and later.
+ */
+typedef void (*libvlc_audio_tap_cb)(void *opaque,
+                                    libvlc_audio_buffer_t *buffer);
+
+/**
+ * Set a callback to receive the decoded audio buffers, as fast as possible.
+ *
+ * Unlike libvlc_audio_set_callbacks(), the audio is not played: the media
+ * is decoded as fast as the callback consumes the buffers, regardless of
+ * the playback clock. Video and subtitles are not decoded.
+ *
+ * The supported formats are the same as libvlc_audio_set_format().
+ *
+ * The callback is not invoked anymore once this function returns: this
+ * function waits for a callback in progress, so the callback must not call
+ * this function itself, nor wait for the thread calling it. This function
+ * only applies to the media set afterwards with
+ * libvlc_media_player_set_media(). Disabling the callback restores the video
+ * and subtitles tracks selection to its state before the callback was set.
+ *
+ * \param mp the media player
+ * \param format a four-characters string identifying the sample format
+ * \param rate sample rate (expressed in Hz), or 0 to keep the native rate
+ * \param channels channels count, or 0 to keep the native count
+ * \param tap_cb callback to receive the buffers (or NULL to disable)
+ * \param opaque private pointer for the callback (as first parameter)
+ * \return 0 on success, -1 if the format is not supported
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API
+int libvlc_audio_set_tap_callback( libvlc_media_player_t *mp,
+                                   const char *format, unsigned rate,
+                                   unsigned channels,
+                                   libvlc_audio_tap_cb tap_cb, void *opaque );
+
+/**
+ * Increment the reference count of an audio buffer.
+ *
+ * \param buffer an audio buffer
+ * \return the same buffer
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API libvlc_audio_buffer_t *
+libvlc_audio_buffer_retain( libvlc_audio_buffer_t *buffer );
+
+/**
+ * Decrement the reference count of an audio buffer, and free it when it
+ * reaches 0.
+ *
+ * \param buffer an audio buffer
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API void libvlc_audio_buffer_release( libvlc_audio_buffer_t *buffer );
+
+/**
+ * Get the interleaved samples of an audio buffer.
+ *
+ * The samples belong to the buffer and must not be modified.
+ *
+ * \param buffer an audio buffer
+ * \param size pointer to the size of the samples in bytes [OUT]
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API const void *
+libvlc_audio_buffer_get_data( const libvlc_audio_buffer_t *buffer,
+                              size_t *size );
+
+/**
+ * Get the number of samples (per channel) of an audio buffer.
+ *
+ * \param buffer an audio buffer
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API unsigned
+libvlc_audio_buffer_get_samples( const libvlc_audio_buffer_t *buffer );
+
+/**
+ * Get the sample format of an audio buffer, as a four-characters string.
+ *
+ * The string is valid as long as the buffer.
+ *
+ * \param buffer an audio buffer
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API const char *
+libvlc_audio_buffer_get_format( const libvlc_audio_buffer_t *buffer );
+
+/**
+ * Get the sample rate of an audio buffer (expressed in Hz).
+ *
+ * \param buffer an audio buffer
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API unsigned
+libvlc_audio_buffer_get_rate( const libvlc_audio_buffer_t *buffer );
+
+/**
+ * Get the channels count of an audio buffer.
+ *
+ * \param buffer an audio buffer
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API unsigned
+libvlc_audio_buffer_get_channels( const libvlc_audio_buffer_t *buffer );
+
+/**
+ * Get the presentation timestamp of an audio buffer.
+ *
+ * \param buffer an audio buffer
+ * \return the media time of the first sample in microseconds,
+ *         or -1 if unknown
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API int64_t
+libvlc_audio_buffer_get_pts( const libvlc_audio_buffer_t *buffer );
+
+/**
+ * Opaque queue of decoded audio buffers, for applications that would rather
+ * pull the buffers than receive them from a callback.
+ *
+ * \version LibVLC 4.0.0 and later.
+ */
+typedef struct libvlc_audio_tap_queue_t libvlc_audio_tap_queue_t;
+
+/**
+ * Create a queue of decoded audio buffers.
+ *
+ * This replaces any callback set with libvlc_audio_set_tap_callback(), with
+ * the same parameters. When the queue is full, the decoding waits for the
+ * application to pop buffers.
+ *
+ * \param mp the media player
+ * \param format a four-characters string identifying the sample format
+ * \param rate sample rate (expressed in Hz), or 0 to keep the native rate
+ * \param channels channels count, or 0 to keep the native count
+ * \param depth the maximum number of queued buffers (at least 1)
+ * \return an audio buffer queue, or NULL on error
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API libvlc_audio_tap_queue_t *
+libvlc_audio_tap_queue_new( libvlc_media_player_t *mp, const char *format,
+                            unsigned rate, unsigned channels, unsigned depth );
+
+/**
+ * Dequeue the oldest decoded audio buffer.
+ *
+ * \param queue an audio buffer queue
+ * \param timeout maximum time to wait in microseconds,
+ *                0 not to wait, or a negative value to wait indefinitely
+ * \return a buffer to release with libvlc_audio_buffer_release(), or NULL
+ *         if none was available in time or if the end of the audio stream
+ *         was reached
+ * \see libvlc_audio_tap_queue_ended()
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API libvlc_audio_buffer_t *
+libvlc_audio_tap_queue_pop( libvlc_audio_tap_queue_t *queue, int64_t timeout );
+
+/**
+ * Check whether the end of the audio stream was reached, and all the
+ * buffers were popped from the queue.
+ *
+ * \param queue an audio buffer queue
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API bool libvlc_audio_tap_queue_ended( libvlc_audio_tap_queue_t *queue );
+
+/**
+ * Destroy a queue of decoded audio buffers, and release the queued buffers.
+ *
+ * The decoding is unblocked, and no more buffers are queued once this
+ * function returns, even if the media player is still playing.
+ *
+ * \param queue an audio buffer queue
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API void libvlc_audio_tap_queue_destroy( libvlc_audio_tap_queue_t *queue );
+
 /** \bug This might go away ... to be replaced by a broader system */
 
 /**
@@ -86,11 +86,17 @@
 #define block_Release vlc_frame_Release
 #define block_CopyProperties vlc_frame_CopyProperties
 #define block_Duplicate vlc_frame_Duplicate
+#define block_Share vlc_frame_Share
+#define block_Clone vlc_frame_Clone
+#define block_IsShared vlc_frame_IsShared
+#define block_Unshare vlc_frame_Unshare
 #define block_heap_Alloc vlc_frame_heap_Alloc
 #define block_mmap_Alloc vlc_frame_mmap_Alloc
 #define block_shm_Alloc vlc_frame_shm_Alloc
 #define block_File vlc_frame_File
 #define block_FilePath vlc_frame_FilePath
+#define block_FileRange vlc_frame_FileRange
+#define block_GetFileRange vlc_frame_GetFileRange
 #define block_Cleanup vlc_frame_Cleanup
 #define block_cleanup_push vlc_frame_cleanup_push
 #define block_ChainAppend vlc_frame_ChainAppend
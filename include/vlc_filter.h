@@ -54,6 +54,7 @@ struct filter_audio_callbacks
         void (*on_changed)(filter_t *,
                            const struct vlc_audio_loudness *loudness);
     } meter_loudness;
+    block_t *(*buffer_new)(filter_t *, size_t);
 };
 
 struct filter_subpicture_callbacks
@@ -324,6 +325,31 @@ static inline block_t *filter_DrainAudio( filter_t *p_filter )
         return NULL;
 }
 
+/**
+ * This function will return a new block usable by an audio filter as an
+ * output buffer. You have to release it using block_Release or by returning
+ * it to the caller as a ops->filter_audio return value.
+ *
+ * The owner may recycle buffers from a per-pipeline arena, so that the
+ * steady state of an audio pipeline does not hit the heap at all.
+ * Provided for convenience.
+ *
+ * \param p_filter filter_t object
+ * \param size size of the buffer in bytes
+ * \return new block on success or NULL on failure
+ */
+static inline block_t *filter_NewAudioBuffer( filter_t *p_filter, size_t size )
+{
+    block_t *block = NULL;
+    if ( p_filter->owner.audio != NULL && p_filter->owner.audio->buffer_new != NULL )
+        block = p_filter->owner.audio->buffer_new( p_filter, size );
+    if ( block == NULL )
+        block = block_Alloc( size );
+    if ( block == NULL )
+        msg_Warn( p_filter, "can't get output buffer" );
+    return block;
+}
+
 static inline void filter_SendAudioLoudness(filter_t *filter,
     const struct vlc_audio_loudness *loudness)
 {
@@ -270,6 +270,50 @@ static inline vlc_frame_t *vlc_frame_Duplicate( const vlc_frame_t *frame )
     return p_dup;
 }
 
+/**
+ * Shares the payload of a frame.
+ *
+ * Turns a frame into a reference to its payload, which can then be handed to
+ * several consumers with vlc_frame_Clone() instead of being copied.
+ * The payload is released with the last reference.
+ *
+ * The references cannot be written to in place: use vlc_frame_Unshare()
+ * first. vlc_frame_Realloc() copies the payload as needed.
+ *
+ * @param frame frame to share (it is consumed)
+ * @return a reference to the payload, or @c frame itself if it could not be
+ * shared (the clones are then copies).
+ */
+VLC_API vlc_frame_t *vlc_frame_Share(vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Clones a frame.
+ *
+ * Creates another reference to the payload of a shared frame, with the same
+ * properties. Other frames are duplicated.
+ *
+ * @return the clone on success, NULL on error.
+ */
+VLC_API vlc_frame_t *vlc_frame_Clone(const vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Checks whether the payload of a frame is referenced by other frames, or
+ * by a file.
+ *
+ * @retval true if the payload must not be written to in place
+ */
+VLC_API bool vlc_frame_IsShared(const vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Makes the payload of a frame writable.
+ *
+ * Copies the payload if it is referenced by other frames.
+ *
+ * @return the writable frame on success, NULL on error.
+ * @note On error, the frame is discarded.
+ */
+VLC_API vlc_frame_t *vlc_frame_Unshare(vlc_frame_t *frame) VLC_USED;
+
 /**
  * Wraps heap in a frame.
  *
@@ -345,6 +389,35 @@ VLC_API vlc_frame_t *vlc_frame_File(int fd, bool write) VLC_USED VLC_MALLOC;
  */
 VLC_API vlc_frame_t *vlc_frame_FilePath(const char *, bool write) VLC_USED VLC_MALLOC;
 
+/**
+ * Maps a file range in memory.
+ *
+ * Creates a frame of the bytes of a file range, which remembers where it
+ * comes from: outputs to files can then copy the range from the file
+ * without reading it in memory (see vlc_frame_GetFileRange()).
+ * If the range cannot be mapped, it is read normally.
+ *
+ * The payload is shared with the file (see vlc_frame_IsShared()), and may be
+ * read-only: it must be unshared with vlc_frame_Unshare() before writing.
+ *
+ * @param fd file descriptor to map from (it is duplicated)
+ * @param offset byte offset of the range
+ * @param length byte length of the range, which must be within the file
+ * @return the frame, or NULL upon error (see errno).
+ */
+VLC_API vlc_frame_t *vlc_frame_FileRange(int fd, uint64_t offset,
+                                         size_t length) VLC_USED VLC_MALLOC;
+
+/**
+ * Gets the file range of a frame.
+ *
+ * @param offset storage for the file offset of the payload [OUT]
+ * @return the file descriptor of the frame created with
+ * vlc_frame_FileRange(), or of the frame it references, or -1 if the payload
+ * is not backed by a file.
+ */
+VLC_API int vlc_frame_GetFileRange(const vlc_frame_t *frame, uint64_t *offset);
+
 static inline void vlc_frame_Cleanup (void *frame)
 {
     vlc_frame_Release ((vlc_frame_t *)frame);
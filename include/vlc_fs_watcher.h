@@ -0,0 +1,97 @@
+/*****************************************************************************
+ * vlc_fs_watcher.h: file system watcher API
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_FS_WATCHER_H
+#define VLC_FS_WATCHER_H 1
+
+/**
+ * \defgroup fs_watcher File system watcher
+ * \ingroup os
+ *
+ * Notifications of changes in a local directory.
+ *
+ * A watcher reports the entries added to, removed from or modified in one
+ * directory (not recursively), from a thread of its own, so that the users
+ * can keep a view of the directory current without listing it again.
+ * @{
+ */
+
+typedef struct vlc_fs_watcher vlc_fs_watcher_t;
+
+/**
+ * Watcher callbacks.
+ *
+ * The callbacks are called from the watcher thread, in the order of the
+ * changes. The name is the name of the entry within the watched directory.
+ */
+struct vlc_fs_watcher_callbacks
+{
+    /** An entry was created in or moved into the directory */
+    void (*on_added)(vlc_fs_watcher_t *, const char *name, void *data);
+    /** An entry was deleted from or moved out of the directory */
+    void (*on_removed)(vlc_fs_watcher_t *, const char *name, void *data);
+    /** An entry was written to or had its attributes changed */
+    void (*on_modified)(vlc_fs_watcher_t *, const char *name, void *data);
+    /**
+     * Some changes were lost (e.g. the event queue overflowed): the directory
+     * must be listed again.
+     */
+    void (*on_overflow)(vlc_fs_watcher_t *, void *data);
+};
+
+struct vlc_fs_watcher
+{
+    struct vlc_object_t obj;
+    module_t *module;
+
+    const char *path; /**< watched directory */
+    const struct vlc_fs_watcher_callbacks *cbs;
+    void *cbs_data;
+
+    void *sys; /**< private data of the watcher module */
+};
+
+/**
+ * Starts watching a directory.
+ *
+ * \param parent parent object
+ * \param path local directory path
+ * \param cbs callbacks (must remain valid until deletion)
+ * \param data opaque pointer passed to the callbacks
+ * \return the watcher, or NULL if the directory cannot be watched
+ */
+VLC_API vlc_fs_watcher_t *vlc_fs_watcher_New(vlc_object_t *parent,
+                                             const char *path,
+                                             const struct vlc_fs_watcher_callbacks *cbs,
+                                             void *data) VLC_USED;
+#define vlc_fs_watcher_New(o, p, c, d) \
+        vlc_fs_watcher_New(VLC_OBJECT(o), p, c, d)
+
+/**
+ * Stops watching a directory.
+ *
+ * No callbacks are called once this function returns. It must not be called
+ * from a callback.
+ */
+VLC_API void vlc_fs_watcher_Delete(vlc_fs_watcher_t *);
+
+/** @} */
+
+#endif
@@ -507,6 +507,9 @@ VLC_API int libvlc_MetadataRequest( libvlc_int_t *, input_item_t *,
                                     const input_preparser_callbacks_t *cbs,
                                     void *cbs_userdata,
                                     int, void * );
+VLC_API size_t libvlc_MetadataWarmup( libvlc_int_t *,
+                                      input_item_t *const *items,
+                                      size_t count );
 VLC_API int libvlc_ArtRequest(libvlc_int_t *, input_item_t *,
                               input_item_meta_request_option_t,
                               const input_fetcher_callbacks_t *cbs,
@@ -544,6 +547,53 @@ struct input_stats_t
     int64_t i_lost_abuffers;
 };
 
+/******************
+ * ES latency
+ ******************/
+
+/**
+ * Pipeline stages where an elementary stream frame is timestamped
+ *
+ * A frame is identified by its PTS from the demuxer output to its display.
+ * Stages that a given stream does not go through (packetizer for already
+ * packetized streams, filters and prerendering for audio) are skipped.
+ */
+enum vlc_latency_stage
+{
+    VLC_LATENCY_DEMUX,       /**< sent by the demuxer */
+    VLC_LATENCY_PACKETIZED,  /**< output by the packetizer */
+    VLC_LATENCY_DECODING,    /**< input to the decoder */
+    VLC_LATENCY_DECODED,     /**< output by the decoder */
+    VLC_LATENCY_FILTERED,    /**< output by the output filters */
+    VLC_LATENCY_PRERENDERED, /**< rendered into the display picture */
+    VLC_LATENCY_DISPLAYED,   /**< displayed, or queued to the audio output */
+};
+#define VLC_LATENCY_STAGE_COUNT (VLC_LATENCY_DISPLAYED + 1)
+
+/** Number of histogram buckets, bucket i counts delays below 2^(i+1) µs */
+#define VLC_LATENCY_BUCKETS 24
+
+struct vlc_latency_stage_stats
+{
+    uint64_t count;    /**< frames that reached the stage */
+    vlc_tick_t total;  /**< sum of the delays since the previous stage */
+    vlc_tick_t max;    /**< longest delay since the previous stage */
+    unsigned queued;   /**< frames currently waiting for the next stage */
+    uint64_t histogram[VLC_LATENCY_BUCKETS];
+};
+
+/**
+ * Per elementary stream latency statistics
+ *
+ * The delay of each stage is measured from the previous stage that the same
+ * frame went through, so that the delays of a frame add up to its overall
+ * demux to display latency.
+ */
+struct vlc_es_latency
+{
+    struct vlc_latency_stage_stats stages[VLC_LATENCY_STAGE_COUNT];
+};
+
 /**
  * Access pf_readdir helper struct
  * \see vlc_readdir_helper_init()
@@ -207,6 +207,33 @@ vlc_media_tree_Preparse(vlc_media_tree_t *tree, libvlc_int_t *libvlc,
 VLC_API void
 vlc_media_tree_PreparseCancel(libvlc_int_t *libvlc, void* id);
 
+/**
+ * Keep the children of a local directory media up to date.
+ *
+ * The entries created in, deleted from or modified in the directory are
+ * reflected in the media tree as they happen (through the on_children_added()
+ * and on_children_removed() callbacks), instead of preparsing the directory
+ * again. If some changes are lost, the directory is preparsed again.
+ *
+ * \param tree   the media tree, unlocked
+ * \param libvlc the libvlc instance
+ * \param media  the media of a local directory in the tree
+ * \retval VLC_SUCCESS on success
+ * \retval VLC_ENOTSUP if the media cannot be watched
+ */
+VLC_API int
+vlc_media_tree_Watch(vlc_media_tree_t *tree, libvlc_int_t *libvlc,
+                     input_item_t *media);
+
+/**
+ * Stop keeping the children of a media up to date.
+ *
+ * \param tree  the media tree, unlocked
+ * \param media a media passed to vlc_media_tree_Watch()
+ */
+VLC_API void
+vlc_media_tree_Unwatch(vlc_media_tree_t *tree, input_item_t *media);
+
 /**
  * Media source.
  *
@@ -1463,6 +1463,23 @@ vlc_player_GetSubtitleTrackAt(vlc_player_t *player, size_t index)
 VLC_API const struct vlc_player_track *
 vlc_player_GetTrack(vlc_player_t *player, vlc_es_id_t *es_id);
 
+/**
+ * Get the pipeline latency statistics of an ES identifier
+ *
+ * The statistics are only collected if the "latency-stats" option is set.
+ * They accumulate from the creation of the track, and the number of frames
+ * still waiting at each stage is a snapshot.
+ *
+ * @param player locked player instance
+ * @param es_id an ES ID (retrieved from vlc_player_cbs.on_track_list_changed or
+ * vlc_player_GetTrackAt())
+ * @param stats pointer to the statistics to fill
+ * @return VLC_SUCCESS or VLC_EGENERIC if the statistics are not collected
+ */
+VLC_API int
+vlc_player_GetTrackLatency(vlc_player_t *player, vlc_es_id_t *es_id,
+                           struct vlc_es_latency *stats);
+
 /**
  * Get and the video output used by a ES identifier
  *
@@ -2145,6 +2162,17 @@ vlc_player_SetRenderer(vlc_player_t *player, vlc_renderer_item_t *renderer);
 VLC_API vlc_renderer_item_t *
 vlc_player_GetRenderer(vlc_player_t *player);
 
+/**
+ * Set the stream output chain
+ *
+ * Valid for the next media: the current one, if any, keeps its stream output.
+ *
+ * @param player locked player instance
+ * @param chain a stream output chain, or NULL (to disable it)
+ */
+VLC_API void
+vlc_player_SetStreamOutput(vlc_player_t *player, const char *chain);
+
 /** @} vlc_player__renderer */
 
 /**
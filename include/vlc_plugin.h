@@ -48,6 +48,7 @@ enum vlc_module_properties
     VLC_MODULE_DESCRIPTION,
     VLC_MODULE_HELP,
     VLC_MODULE_TEXTDOMAIN,
+    VLC_MODULE_SIGNATURE,
     /* Insert new VLC_MODULE_* here */
 
     /* DO NOT EVER REMOVE, INSERT OR REPLACE ANY ITEM! It would break the ABI!
@@ -355,6 +356,16 @@ VLC_METADATA_EXPORTS
                        (void (*)(vlc_object_t *))( deactivate ))) \
         goto error;
 
+/* Declares that the module only accepts data bearing the given magic bytes
+ * at the given offset, as a string of hexadecimal digits where "??" matches
+ * any byte. With several signatures, any one of them must match. This lets
+ * the core skip the module without probing it, unless it is forced. */
+#define add_signature( offset, magic ) \
+    if (vlc_module_set (VLC_MODULE_SIGNATURE, \
+                        VLC_CHECKED_TYPE(unsigned, offset), \
+                        VLC_CHECKED_TYPE(const char *, magic))) \
+        goto error;
+
 #define cannot_unload_broken_library( ) \
     if (vlc_module_set (VLC_MODULE_NO_UNLOAD)) \
         goto error;
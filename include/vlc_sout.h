@@ -70,6 +70,10 @@ enum access_out_query_e
 {
     ACCESS_OUT_CONTROLS_PACE, /* arg1=bool *, can fail (assume true) */
     ACCESS_OUT_CAN_SEEK, /* arg1=bool *, can fail (assume false) */
+    ACCESS_OUT_CAN_INSERT, /* arg1=uint64_t *, granularity in bytes,
+                              can fail (assume no insertion) */
+    ACCESS_OUT_INSERT, /* arg1=uint64_t offset, arg2=uint64_t length, both
+                          multiple of the granularity, can fail */
 };
 
 VLC_API sout_access_out_t * sout_AccessOutNew( vlc_object_t *, const char *psz_access, const char *psz_name ) VLC_USED;
@@ -170,6 +174,10 @@ enum sout_stream_query_e {
     SOUT_STREAM_WANTS_SUBSTREAMS,  /* arg1=bool *, res=can fail (assume false) */
     SOUT_STREAM_ID_SPU_HIGHLIGHT,  /* arg1=void *, arg2=const vlc_spu_highlight_t *, res=can fail */
     SOUT_STREAM_IS_SYNCHRONOUS, /* arg1=bool *, can fail (assume false) */
+    /* The ES arg1 takes the decoded data of the same ES arg3 in the stream
+     * arg2, instead of decoding the blocks itself: on success, the caller
+     * stops sending blocks to arg1 and serializes the calls to both streams. */
+    SOUT_STREAM_ID_SHARE_DECODER, /* arg1=void *, arg2=sout_stream_t *, arg3=void *, res=can fail */
 };
 
 struct sout_stream_operations {
@@ -195,6 +195,31 @@ static inline void vlc_tracer_TraceEvent(struct vlc_tracer *tracer, const char *
                      VLC_TRACE("event", event), VLC_TRACE_END);
 }
 
+/**
+ * Begin a span
+ *
+ * A span covers the time spent by the calling thread between this call and
+ * the matching vlc_tracer_TraceEnd() call. Spans of a thread may nest.
+ */
+static inline void vlc_tracer_TraceBegin(struct vlc_tracer *tracer,
+                                         const char *type, const char *id,
+                                         const char *name)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("begin", name), VLC_TRACE_END);
+}
+
+/**
+ * End a span started with vlc_tracer_TraceBegin()
+ */
+static inline void vlc_tracer_TraceEnd(struct vlc_tracer *tracer,
+                                       const char *type, const char *id,
+                                       const char *name)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type), VLC_TRACE("id", id),
+                     VLC_TRACE("end", name), VLC_TRACE_END);
+}
+
 static inline void vlc_tracer_TracePCR( struct vlc_tracer *tracer, const char *type,
                                     const char *id, vlc_tick_t pcr)
 {
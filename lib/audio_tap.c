@@ -0,0 +1,395 @@
+/*****************************************************************************
+ * audio_tap.c: libvlc decoded audio buffers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_renderer_discoverer.h>
+#include <vlc/libvlc_picture.h>
+#include <vlc/libvlc_media.h>
+#include <vlc/libvlc_media_player.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_block.h>
+#include <vlc_es.h>
+#include <vlc_fourcc.h>
+#include <vlc_interrupt.h>
+
+#include "libvlc_internal.h"
+#include "media_player_internal.h"
+
+/* Same sample formats as libvlc_audio_set_format() */
+static const struct
+{
+    char name[5];
+    vlc_fourcc_t fourcc;
+} formats[] = {
+    { "S16N", VLC_CODEC_S16N },
+    { "S32N", VLC_CODEC_S32N },
+    { "FL32", VLC_CODEC_FL32 },
+};
+
+struct libvlc_audio_buffer_t
+{
+    vlc_atomic_rc_t rc;
+    block_t *block;
+    unsigned rate;
+    unsigned channels;
+    const char *format;
+};
+
+static void libvlc_audio_tap_queue_Push(void *, libvlc_audio_buffer_t *);
+static void libvlc_audio_tap_queue_Close(void *);
+
+/* Called by the smem stream output, from the input thread */
+static void libvlc_audio_tap_Deliver(void *opaque, block_t *block,
+                                     const es_format_t *fmt)
+{
+    libvlc_media_player_t *mp = opaque;
+    libvlc_audio_buffer_t *buffer = NULL;
+
+    if (block != NULL)
+    {
+        buffer = malloc(sizeof (*buffer));
+        if (unlikely(buffer == NULL))
+        {
+            block_Release(block);
+            return;
+        }
+
+        vlc_atomic_rc_init(&buffer->rc);
+        buffer->block = block;
+        buffer->rate = fmt->audio.i_rate;
+        buffer->channels = fmt->audio.i_channels;
+        buffer->format = NULL;
+        for (size_t i = 0; i < ARRAY_SIZE(formats); i++)
+            if (formats[i].fourcc == fmt->i_codec)
+                buffer->format = formats[i].name;
+        assert(buffer->format != NULL);
+    }
+
+    /* The callback may block, e.g. on a full queue: it is invoked without the
+     * lock, and libvlc_audio_set_tap_callback() waits for it to return. */
+    vlc_mutex_lock(&mp->audio_tap.lock);
+    libvlc_audio_tap_cb cb = mp->audio_tap.cb;
+    void *cb_opaque = mp->audio_tap.opaque;
+    if (cb != NULL)
+        mp->audio_tap.busy++;
+    vlc_mutex_unlock(&mp->audio_tap.lock);
+
+    if (cb != NULL)
+    {
+        cb(cb_opaque, buffer);
+        buffer = NULL;
+
+        vlc_mutex_lock(&mp->audio_tap.lock);
+        if (--mp->audio_tap.busy == 0)
+            vlc_cond_broadcast(&mp->audio_tap.wait);
+        vlc_mutex_unlock(&mp->audio_tap.lock);
+    }
+
+    if (buffer != NULL)
+        libvlc_audio_buffer_release(buffer);
+}
+
+int libvlc_audio_set_tap_callback( libvlc_media_player_t *mp,
+                                   const char *format, unsigned rate,
+                                   unsigned channels,
+                                   libvlc_audio_tap_cb tap_cb, void *opaque )
+{
+    char *sout = NULL;
+
+    if (tap_cb != NULL)
+    {
+        const vlc_fourcc_t *codec = NULL;
+        for (size_t i = 0; i < ARRAY_SIZE(formats); i++)
+            if (strcmp(formats[i].name, format) == 0)
+                codec = &formats[i].fourcc;
+        if (codec == NULL)
+        {
+            libvlc_printerr("Unsupported audio format \"%s\"", format);
+            return -1;
+        }
+
+        /* The raw audio "encoder" converts to the requested format, and the
+         * stream output is not synchronised to the clock. */
+        if (asprintf(&sout, "#transcode{acodec=%4.4s,samplerate=%u,"
+                     "channels=%u}:smem{audio-tap-callback=%"PRIdPTR","
+                     "audio-data=%"PRIdPTR",no-time-sync}",
+                     (const char *)codec, rate, channels,
+                     (intptr_t)libvlc_audio_tap_Deliver, (intptr_t)mp) == -1)
+        {
+            libvlc_printerr("Not enough memory");
+            return -1;
+        }
+    }
+
+    vlc_mutex_lock(&mp->audio_tap.lock);
+    /* A replaced queue does not receive buffers anymore: unblock it */
+    if (mp->audio_tap.cb == libvlc_audio_tap_queue_Push
+     && mp->audio_tap.opaque != opaque)
+        libvlc_audio_tap_queue_Close(mp->audio_tap.opaque);
+    mp->audio_tap.cb = tap_cb;
+    mp->audio_tap.opaque = opaque;
+    while (mp->audio_tap.busy > 0)
+        vlc_cond_wait(&mp->audio_tap.wait, &mp->audio_tap.lock);
+    vlc_mutex_unlock(&mp->audio_tap.lock);
+
+    vlc_player_t *player = mp->player;
+    vlc_player_Lock(player);
+    vlc_player_SetStreamOutput(player, sout);
+    if (sout != NULL && !mp->audio_tap.active)
+    {
+        mp->audio_tap.video_enabled =
+            vlc_player_IsTrackCategoryEnabled(player, VIDEO_ES);
+        mp->audio_tap.spu_enabled =
+            vlc_player_IsTrackCategoryEnabled(player, SPU_ES);
+        vlc_player_SetTrackCategoryEnabled(player, VIDEO_ES, false);
+        vlc_player_SetTrackCategoryEnabled(player, SPU_ES, false);
+        mp->audio_tap.active = true;
+    }
+    else if (sout == NULL && mp->audio_tap.active)
+    {
+        vlc_player_SetTrackCategoryEnabled(player, VIDEO_ES,
+                                           mp->audio_tap.video_enabled);
+        vlc_player_SetTrackCategoryEnabled(player, SPU_ES,
+                                           mp->audio_tap.spu_enabled);
+        mp->audio_tap.active = false;
+    }
+    vlc_player_Unlock(player);
+    free(sout);
+    return 0;
+}
+
+libvlc_audio_buffer_t *
+libvlc_audio_buffer_retain( libvlc_audio_buffer_t *buffer )
+{
+    vlc_atomic_rc_inc(&buffer->rc);
+    return buffer;
+}
+
+void libvlc_audio_buffer_release( libvlc_audio_buffer_t *buffer )
+{
+    if (!vlc_atomic_rc_dec(&buffer->rc))
+        return;
+
+    block_Release(buffer->block);
+    free(buffer);
+}
+
+const void *libvlc_audio_buffer_get_data( const libvlc_audio_buffer_t *buffer,
+                                          size_t *size )
+{
+    *size = buffer->block->i_buffer;
+    return buffer->block->p_buffer;
+}
+
+unsigned libvlc_audio_buffer_get_samples( const libvlc_audio_buffer_t *buffer )
+{
+    return buffer->block->i_nb_samples;
+}
+
+const char *libvlc_audio_buffer_get_format( const libvlc_audio_buffer_t *buffer )
+{
+    return buffer->format;
+}
+
+unsigned libvlc_audio_buffer_get_rate( const libvlc_audio_buffer_t *buffer )
+{
+    return buffer->rate;
+}
+
+unsigned libvlc_audio_buffer_get_channels( const libvlc_audio_buffer_t *buffer )
+{
+    return buffer->channels;
+}
+
+int64_t libvlc_audio_buffer_get_pts( const libvlc_audio_buffer_t *buffer )
+{
+    if (buffer->block->i_pts == VLC_TICK_INVALID)
+        return -1;
+    return US_FROM_VLC_TICK(buffer->block->i_pts - VLC_TICK_0);
+}
+
+struct libvlc_audio_tap_queue_t
+{
+    libvlc_media_player_t *mp;
+    vlc_mutex_t lock;
+    vlc_cond_t wait_pop;
+    vlc_cond_t wait_push;
+    bool closed;
+    bool ended;
+    unsigned depth;
+    unsigned first;
+    unsigned count;
+    libvlc_audio_buffer_t *buffers[];
+};
+
+static void libvlc_audio_tap_queue_Interrupt(void *opaque)
+{
+    libvlc_audio_tap_queue_t *queue = opaque;
+
+    vlc_mutex_lock(&queue->lock);
+    vlc_cond_broadcast(&queue->wait_push);
+    vlc_mutex_unlock(&queue->lock);
+}
+
+/* Unblocks the decoding, and drops the next buffers */
+static void libvlc_audio_tap_queue_Close(void *opaque)
+{
+    libvlc_audio_tap_queue_t *queue = opaque;
+
+    vlc_mutex_lock(&queue->lock);
+    queue->closed = true;
+    vlc_cond_broadcast(&queue->wait_push);
+    vlc_mutex_unlock(&queue->lock);
+}
+
+static void libvlc_audio_tap_queue_Push(void *opaque,
+                                        libvlc_audio_buffer_t *buffer)
+{
+    libvlc_audio_tap_queue_t *queue = opaque;
+
+    /* Wait for room, unless the input is stopping */
+    vlc_interrupt_register(libvlc_audio_tap_queue_Interrupt, queue);
+    vlc_mutex_lock(&queue->lock);
+    if (buffer != NULL)
+        while (queue->count == queue->depth && !queue->closed && !vlc_killed())
+            vlc_cond_wait(&queue->wait_push, &queue->lock);
+
+    if (queue->count == queue->depth || queue->closed)
+        ;
+    else if (buffer != NULL)
+    {
+        queue->buffers[(queue->first + queue->count) % queue->depth] = buffer;
+        queue->count++;
+        queue->ended = false;
+        buffer = NULL;
+    }
+    else
+        queue->ended = true;
+    vlc_cond_signal(&queue->wait_pop);
+    vlc_mutex_unlock(&queue->lock);
+    vlc_interrupt_unregister();
+
+    if (buffer != NULL)
+        libvlc_audio_buffer_release(buffer);
+}
+
+libvlc_audio_tap_queue_t *
+libvlc_audio_tap_queue_new( libvlc_media_player_t *mp, const char *format,
+                            unsigned rate, unsigned channels, unsigned depth )
+{
+    if (depth == 0)
+        return NULL;
+
+    libvlc_audio_tap_queue_t *queue =
+        malloc(sizeof (*queue) + depth * sizeof (queue->buffers[0]));
+    if (unlikely(queue == NULL))
+    {
+        libvlc_printerr("Not enough memory");
+        return NULL;
+    }
+
+    queue->mp = mp;
+    vlc_mutex_init(&queue->lock);
+    vlc_cond_init(&queue->wait_pop);
+    vlc_cond_init(&queue->wait_push);
+    queue->closed = false;
+    queue->ended = false;
+    queue->depth = depth;
+    queue->first = 0;
+    queue->count = 0;
+
+    if (libvlc_audio_set_tap_callback(mp, format, rate, channels,
+                                      libvlc_audio_tap_queue_Push, queue))
+    {
+        free(queue);
+        return NULL;
+    }
+    libvlc_media_player_retain(mp);
+    return queue;
+}
+
+libvlc_audio_buffer_t *
+libvlc_audio_tap_queue_pop( libvlc_audio_tap_queue_t *queue, int64_t timeout )
+{
+    libvlc_audio_buffer_t *buffer = NULL;
+    vlc_tick_t deadline = timeout >= 0
+                        ? vlc_tick_now() + VLC_TICK_FROM_US(timeout)
+                        : VLC_TICK_INVALID;
+
+    vlc_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->ended)
+    {
+        if (deadline == VLC_TICK_INVALID)
+            vlc_cond_wait(&queue->wait_pop, &queue->lock);
+        else if (timeout == 0
+              || vlc_cond_timedwait(&queue->wait_pop, &queue->lock, deadline))
+            break;
+    }
+
+    if (queue->count > 0)
+    {
+        buffer = queue->buffers[queue->first];
+        queue->first = (queue->first + 1) % queue->depth;
+        queue->count--;
+        vlc_cond_signal(&queue->wait_push);
+    }
+    vlc_mutex_unlock(&queue->lock);
+    return buffer;
+}
+
+bool libvlc_audio_tap_queue_ended( libvlc_audio_tap_queue_t *queue )
+{
+    vlc_mutex_lock(&queue->lock);
+    bool ended = queue->ended && queue->count == 0;
+    vlc_mutex_unlock(&queue->lock);
+    return ended;
+}
+
+void libvlc_audio_tap_queue_destroy( libvlc_audio_tap_queue_t *queue )
+{
+    libvlc_media_player_t *mp = queue->mp;
+
+    /* Unblock the decoding first, then wait for it to leave the queue */
+    libvlc_audio_tap_queue_Close(queue);
+
+    vlc_mutex_lock(&mp->audio_tap.lock);
+    if (mp->audio_tap.opaque == queue)
+    {
+        mp->audio_tap.cb = NULL;
+        mp->audio_tap.opaque = NULL;
+    }
+    while (mp->audio_tap.busy > 0)
+        vlc_cond_wait(&mp->audio_tap.wait, &mp->audio_tap.lock);
+    vlc_mutex_unlock(&mp->audio_tap.lock);
+    libvlc_media_player_release(mp);
+
+    for (unsigned i = 0; i < queue->count; i++)
+        libvlc_audio_buffer_release(
+            queue->buffers[(queue->first + i) % queue->depth]);
+    free(queue);
+}
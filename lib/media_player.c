@@ -609,6 +609,8 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "vmem-width", VLC_VAR_INTEGER);
     var_Create (mp, "vmem-height", VLC_VAR_INTEGER);
     var_Create (mp, "vmem-pitch", VLC_VAR_INTEGER);
+    var_Create (mp, "vmem-frame", VLC_VAR_ADDRESS);
+    var_Create (mp, "vmem-frame-data", VLC_VAR_ADDRESS);
 
     var_Create (mp, "vout-cb-type", VLC_VAR_INTEGER );
     var_Create( mp, "vout-cb-opaque", VLC_VAR_ADDRESS );
@@ -719,6 +721,15 @@ libvlc_media_player_new( libvlc_instance_t *instance )
 
     mp->p_md = NULL;
     mp->p_libvlc_instance = instance;
+    vlc_mutex_init(&mp->video_frame.lock);
+    mp->video_frame.cb = NULL;
+    mp->video_frame.opaque = NULL;
+    vlc_mutex_init(&mp->audio_tap.lock);
+    vlc_cond_init(&mp->audio_tap.wait);
+    mp->audio_tap.cb = NULL;
+    mp->audio_tap.opaque = NULL;
+    mp->audio_tap.busy = 0;
+    mp->audio_tap.active = false;
     /* use a reentrant lock to allow calling libvlc functions from callbacks */
     mp->player = vlc_player_New(VLC_OBJECT(mp), VLC_PLAYER_LOCK_REENTRANT,
                                 NULL, NULL);
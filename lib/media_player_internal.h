@@ -49,6 +49,29 @@ struct libvlc_media_player_t
     struct libvlc_instance_t * p_libvlc_instance; /* Parent instance */
     libvlc_media_t * p_md; /* current media descriptor */
     libvlc_event_manager_t event_manager;
+
+    /* Zero-copy video frames, cf. libvlc_video_set_frame_callback() */
+    struct
+    {
+        vlc_mutex_t lock;
+        libvlc_video_frame_cb cb;
+        void *opaque;
+    } video_frame;
+
+    /* Decoded audio buffers, cf. libvlc_audio_set_tap_callback() */
+    struct
+    {
+        vlc_mutex_t lock;
+        vlc_cond_t wait;
+        libvlc_audio_tap_cb cb;
+        void *opaque;
+        unsigned busy; /* callbacks in progress */
+
+        /* Protected by the player lock */
+        bool active;
+        bool video_enabled; /* categories state before the tap */
+        bool spu_enabled;
+    } audio_tap;
 };
 
 libvlc_track_description_t * libvlc_get_track_description(
@@ -0,0 +1,298 @@
+/*****************************************************************************
+ * video_frame.c: libvlc zero-copy video frames
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_renderer_discoverer.h>
+#include <vlc/libvlc_picture.h>
+#include <vlc/libvlc_media.h>
+#include <vlc/libvlc_media_player.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_picture.h>
+
+#include "libvlc_internal.h"
+#include "media_player_internal.h"
+
+struct libvlc_video_frame_t
+{
+    vlc_atomic_rc_t rc;
+    picture_t *pic;
+    const vlc_chroma_description_t *dsc;
+    char chroma[5];
+};
+
+/* Called by the vmem display plugin, with a picture reference */
+static void libvlc_video_frame_Deliver(void *opaque, picture_t *pic)
+{
+    libvlc_media_player_t *mp = opaque;
+    libvlc_video_frame_t *frame = malloc(sizeof (*frame));
+
+    if (unlikely(frame == NULL))
+    {
+        picture_Release(pic);
+        return;
+    }
+
+    vlc_atomic_rc_init(&frame->rc);
+    frame->pic = pic;
+    frame->dsc = vlc_fourcc_GetChromaDescription(pic->format.i_chroma);
+    assert(frame->dsc != NULL && frame->dsc->plane_count > 0);
+    memcpy(frame->chroma, &pic->format.i_chroma, 4);
+    frame->chroma[4] = '\0';
+
+    /* The lock guarantees that the callback is not running anymore once
+     * libvlc_video_set_frame_callback() returned. */
+    vlc_mutex_lock(&mp->video_frame.lock);
+    if (mp->video_frame.cb != NULL)
+    {
+        mp->video_frame.cb(mp->video_frame.opaque, frame);
+        frame = NULL;
+    }
+    vlc_mutex_unlock(&mp->video_frame.lock);
+
+    if (frame != NULL)
+        libvlc_video_frame_release(frame);
+}
+
+/* Unsets the vmem variables, and restores the default outputs */
+static void libvlc_video_frame_Unset(libvlc_media_player_t *mp)
+{
+    var_SetAddress( mp, "vmem-frame", NULL );
+    var_SetAddress( mp, "vmem-frame-data", NULL );
+
+    /* Unless the application copies the pictures to its own buffers */
+    if( var_GetAddress( mp, "vmem-lock" ) == NULL )
+    {
+        var_SetString( mp, "dec-dev", "" );
+        var_SetString( mp, "vout", "any" );
+        var_SetString( mp, "window", "any" );
+    }
+}
+
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame_cb,
+                                      void *opaque )
+{
+    vlc_mutex_lock(&mp->video_frame.lock);
+    mp->video_frame.cb = frame_cb;
+    mp->video_frame.opaque = opaque;
+    vlc_mutex_unlock(&mp->video_frame.lock);
+
+    if (frame_cb != NULL)
+    {
+        var_SetAddress( mp, "vmem-frame", libvlc_video_frame_Deliver );
+        var_SetAddress( mp, "vmem-frame-data", mp );
+        var_SetString( mp, "dec-dev", "none" );
+        var_SetString( mp, "vout", "vmem" );
+        var_SetString( mp, "window", "dummy" );
+    }
+    else
+        libvlc_video_frame_Unset(mp);
+}
+
+libvlc_video_frame_t *libvlc_video_frame_retain( libvlc_video_frame_t *frame )
+{
+    vlc_atomic_rc_inc(&frame->rc);
+    return frame;
+}
+
+void libvlc_video_frame_release( libvlc_video_frame_t *frame )
+{
+    if (!vlc_atomic_rc_dec(&frame->rc))
+        return;
+
+    picture_Release(frame->pic);
+    free(frame);
+}
+
+const char *libvlc_video_frame_get_chroma( const libvlc_video_frame_t *frame )
+{
+    return frame->chroma;
+}
+
+unsigned libvlc_video_frame_get_width( const libvlc_video_frame_t *frame )
+{
+    return frame->pic->format.i_visible_width;
+}
+
+unsigned libvlc_video_frame_get_height( const libvlc_video_frame_t *frame )
+{
+    return frame->pic->format.i_visible_height;
+}
+
+unsigned libvlc_video_frame_get_plane_count( const libvlc_video_frame_t *frame )
+{
+    return frame->pic->i_planes;
+}
+
+const unsigned char *
+libvlc_video_frame_get_plane( const libvlc_video_frame_t *frame,
+                              unsigned plane, size_t *pitch, unsigned *lines )
+{
+    const picture_t *pic = frame->pic;
+    const video_format_t *fmt = &pic->format;
+
+    assert(plane < (unsigned) pic->i_planes);
+
+    const plane_t *p = &pic->p[plane];
+    const vlc_rational_t *w = &frame->dsc->p[plane].w;
+    const vlc_rational_t *h = &frame->dsc->p[plane].h;
+    size_t x = fmt->i_x_offset * w->num / w->den;
+    size_t y = fmt->i_y_offset * h->num / h->den;
+
+    *pitch = p->i_pitch;
+    *lines = p->i_visible_lines;
+    return p->p_pixels + y * p->i_pitch + x * p->i_pixel_pitch;
+}
+
+int64_t libvlc_video_frame_get_pts( const libvlc_video_frame_t *frame )
+{
+    if (frame->pic->date == VLC_TICK_INVALID)
+        return -1;
+    return US_FROM_VLC_TICK(frame->pic->date - VLC_TICK_0);
+}
+
+struct libvlc_video_frame_queue_t
+{
+    libvlc_media_player_t *mp;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    uint64_t dropped;
+    unsigned depth;
+    unsigned first;
+    unsigned count;
+    libvlc_video_frame_t *frames[];
+};
+
+static void libvlc_video_frame_queue_Push(void *opaque,
+                                          libvlc_video_frame_t *frame)
+{
+    libvlc_video_frame_queue_t *queue = opaque;
+    libvlc_video_frame_t *dropped = NULL;
+
+    vlc_mutex_lock(&queue->lock);
+    if (queue->count == queue->depth)
+    {
+        /* Drop the oldest frame rather than blocking the video output */
+        dropped = queue->frames[queue->first];
+        queue->first = (queue->first + 1) % queue->depth;
+        queue->count--;
+        queue->dropped++;
+    }
+    queue->frames[(queue->first + queue->count) % queue->depth] = frame;
+    queue->count++;
+    vlc_cond_signal(&queue->wait);
+    vlc_mutex_unlock(&queue->lock);
+
+    if (dropped != NULL)
+        libvlc_video_frame_release(dropped);
+}
+
+libvlc_video_frame_queue_t *
+libvlc_video_frame_queue_new( libvlc_media_player_t *mp, unsigned depth )
+{
+    if (depth == 0)
+        return NULL;
+
+    libvlc_video_frame_queue_t *queue =
+        malloc(sizeof (*queue) + depth * sizeof (queue->frames[0]));
+    if (unlikely(queue == NULL))
+    {
+        libvlc_printerr("Not enough memory");
+        return NULL;
+    }
+
+    queue->mp = mp;
+    vlc_mutex_init(&queue->lock);
+    vlc_cond_init(&queue->wait);
+    queue->dropped = 0;
+    queue->depth = depth;
+    queue->first = 0;
+    queue->count = 0;
+
+    libvlc_media_player_retain(mp);
+    libvlc_video_set_frame_callback(mp, libvlc_video_frame_queue_Push, queue);
+    return queue;
+}
+
+libvlc_video_frame_t *
+libvlc_video_frame_queue_pop( libvlc_video_frame_queue_t *queue,
+                              int64_t timeout )
+{
+    libvlc_video_frame_t *frame = NULL;
+    vlc_tick_t deadline = timeout >= 0
+                        ? vlc_tick_now() + VLC_TICK_FROM_US(timeout)
+                        : VLC_TICK_INVALID;
+
+    vlc_mutex_lock(&queue->lock);
+    while (queue->count == 0)
+    {
+        if (deadline == VLC_TICK_INVALID)
+            vlc_cond_wait(&queue->wait, &queue->lock);
+        else if (timeout == 0
+              || vlc_cond_timedwait(&queue->wait, &queue->lock, deadline))
+            break;
+    }
+
+    if (queue->count > 0)
+    {
+        frame = queue->frames[queue->first];
+        queue->first = (queue->first + 1) % queue->depth;
+        queue->count--;
+    }
+    vlc_mutex_unlock(&queue->lock);
+    return frame;
+}
+
+uint64_t
+libvlc_video_frame_queue_get_dropped( libvlc_video_frame_queue_t *queue )
+{
+    vlc_mutex_lock(&queue->lock);
+    uint64_t dropped = queue->dropped;
+    vlc_mutex_unlock(&queue->lock);
+    return dropped;
+}
+
+void libvlc_video_frame_queue_destroy( libvlc_video_frame_queue_t *queue )
+{
+    libvlc_media_player_t *mp = queue->mp;
+
+    vlc_mutex_lock(&mp->video_frame.lock);
+    if (mp->video_frame.opaque == queue)
+    {
+        mp->video_frame.cb = NULL;
+        mp->video_frame.opaque = NULL;
+        libvlc_video_frame_Unset(mp);
+    }
+    vlc_mutex_unlock(&mp->video_frame.lock);
+    libvlc_media_player_release(mp);
+
+    for (unsigned i = 0; i < queue->count; i++)
+        libvlc_video_frame_release(
+            queue->frames[(queue->first + i) % queue->depth]);
+    free(queue);
+}
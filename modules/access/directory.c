@@ -30,12 +30,14 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
 #include <limits.h>
 #include <sys/stat.h>
 
 #include <vlc_common.h>
 #include "fs.h"
 #include <vlc_access.h>
+#include <vlc_executor.h>
 #include <vlc_input_item.h>
 
 #include <vlc_fs.h>
@@ -46,8 +48,47 @@ typedef struct
     char *base_uri;
     bool need_separator;
     DIR *dir;
+    vlc_executor_t *executor; /**< to stat entries in parallel, shared */
 } access_sys_t;
 
+/* Number of entries read and stat'ed at once */
+#define DIR_BATCH_SIZE 256
+/* Minimum number of entries to stat in parallel: below that, handing them
+ * over to other threads costs more than it saves */
+#define DIR_STAT_PARALLEL_MIN 32
+
+/* The executor is shared by all the directory accesses, rather than one
+ * set of threads per listed directory */
+static vlc_mutex_t executor_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *executor;
+static unsigned executor_refs;
+
+static vlc_executor_t *DirExecutorHold(int threads)
+{
+    vlc_executor_t *ex;
+
+    vlc_mutex_lock(&executor_lock);
+    if (executor == NULL)
+        executor = vlc_executor_New(threads);
+    ex = executor;
+    if (ex != NULL)
+        executor_refs++;
+    vlc_mutex_unlock(&executor_lock);
+    return ex;
+}
+
+static void DirExecutorRelease(void)
+{
+    vlc_mutex_lock(&executor_lock);
+    assert(executor_refs > 0);
+    if (--executor_refs == 0)
+    {
+        vlc_executor_Delete(executor);
+        executor = NULL;
+    }
+    vlc_mutex_unlock(&executor_lock);
+}
+
 static int DirRead (stream_t *access, input_item_node_t *node);
 
 static int DirControl( stream_t *p_access, int i_query, va_list args )
@@ -91,6 +132,7 @@ int DirInit (stream_t *access, DIR *dir)
 #endif
             last_char != '/';
     sys->dir = dir;
+    sys->executor = NULL;
 
     access->p_sys = sys;
     access->pf_readdir = DirRead;
@@ -127,97 +169,287 @@ void DirClose(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
+    if (sys->executor != NULL)
+        DirExecutorRelease();
     free(sys->base_uri);
     closedir(sys->dir);
 }
 
-static int DirRead (stream_t *access, input_item_node_t *node)
+struct dir_entry
 {
-    access_sys_t *sys = access->p_sys;
-    const char *entry;
-    int ret = VLC_SUCCESS;
+    char *name;
+    mode_t type; /**< file type from the directory entry, or 0 if unknown */
+    bool valid; /**< st is valid */
+    struct stat st;
+};
 
-    bool special_files = var_InheritBool(access, "list-special-files");
+struct dir_stat_job
+{
+    stream_t *access;
+    struct dir_entry *entries;
+    size_t count;
+    vlc_sem_t *done;
+    struct vlc_runnable runnable;
+};
 
-    struct vlc_readdir_helper rdh;
-    vlc_readdir_helper_init(&rdh, access, node);
+/**
+ * Reads the next batch of directory entries.
+ *
+ * The entry type is taken from the directory entry where available, so that
+ * special files are dropped or listed without calling stat(). Other entries,
+ * including directories, are still stat'ed, for their type (symbolic links),
+ * modification time and size.
+ */
+static size_t DirReadBatch(stream_t *access, struct dir_entry *entries,
+                           bool special_files, bool hidden_files)
+{
+    access_sys_t *sys = access->p_sys;
+    size_t count = 0;
 
-    while (ret == VLC_SUCCESS && (entry = vlc_readdir(sys->dir)) != NULL)
+    while (count < DIR_BATCH_SIZE)
     {
-        struct stat st;
-        int type;
+        const char *name;
+        mode_t type = 0;
 
-#ifdef HAVE_FSTATAT
-        if (fstatat(dirfd(sys->dir), entry, &st, 0))
-            continue;
-#else
-        char *path;
+#if defined(HAVE_FSTATAT) && defined(DT_UNKNOWN)
+        const struct dirent *ent = readdir(sys->dir);
+        if (ent == NULL)
+            break;
+        name = ent->d_name;
 
-        if (asprintf(&path, "%s"DIR_SEP"%s", access->psz_filepath, entry) == -1
-         || (type = vlc_stat(path, &st), free(path), type))
-            continue;
-#endif
-        switch (st.st_mode & S_IFMT)
+        switch (ent->d_type)
         {
 #ifdef S_IFBLK
-            case S_IFBLK:
-                if (!special_files)
-                    continue;
-                type = ITEM_TYPE_DISC;
+            case DT_BLK:
+                type = S_IFBLK;
                 break;
 #endif
-            case S_IFCHR:
-                if (!special_files)
-                    continue;
-                type = ITEM_TYPE_CARD;
+            case DT_CHR:
+                type = S_IFCHR;
                 break;
-            case S_IFIFO:
-                if (!special_files)
-                    continue;
-                type = ITEM_TYPE_STREAM;
+            case DT_FIFO:
+                type = S_IFIFO;
                 break;
-            case S_IFREG:
-                type = ITEM_TYPE_FILE;
-                break;
-            case S_IFDIR:
-                type = ITEM_TYPE_DIRECTORY;
-                break;
-            /* S_IFLNK cannot occur while following symbolic links */
-            /* S_IFSOCK cannot be opened with open()/openat() */
-            default:
-                continue; /* ignore */
+            case DT_SOCK:
+                continue;
         }
+        if (type != 0 && !special_files)
+            continue;
+#else
+        VLC_UNUSED(special_files);
+        name = vlc_readdir(sys->dir);
+        if (name == NULL)
+            break;
+#endif
+        /* Ignored by the readdir helper anyway */
+        if (!hidden_files && name[0] == '.')
+            continue;
 
-        /* Create an input item for the current entry */
-        char *encoded = vlc_uri_encode(entry);
-        if (unlikely(encoded == NULL))
-        {
-            ret = VLC_ENOMEM;
+        entries[count].name = strdup(name);
+        if (unlikely(entries[count].name == NULL))
             break;
-        }
+        entries[count].type = type;
+        entries[count].valid = false;
+        count++;
+    }
+    return count;
+}
 
-        char *uri;
-        if (unlikely(asprintf(&uri, "%s%s%s", sys->base_uri,
-                              sys->need_separator ? "/" : "",
-                              encoded) == -1))
-            uri = NULL;
-        free(encoded);
-        if (unlikely(uri == NULL))
-        {
-            ret = VLC_ENOMEM;
+static void DirStatEntries(stream_t *access, struct dir_entry *entries,
+                           size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        struct dir_entry *entry = &entries[i];
+
+        if (entry->type != 0)
+            continue;
+#ifdef HAVE_FSTATAT
+        access_sys_t *sys = access->p_sys;
+
+        entry->valid = !fstatat(dirfd(sys->dir), entry->name, &entry->st, 0);
+#else
+        char *path;
+
+        if (asprintf(&path, "%s"DIR_SEP"%s", access->psz_filepath,
+                     entry->name) == -1)
+            continue;
+        entry->valid = !vlc_stat(path, &entry->st);
+        free(path);
+#endif
+    }
+}
+
+static void DirStatRun(void *userdata)
+{
+    struct dir_stat_job *job = userdata;
+
+    DirStatEntries(job->access, job->entries, job->count);
+    vlc_sem_post(job->done);
+}
+
+/**
+ * Stats a batch of entries, spreading the calls over the executor threads.
+ *
+ * On network file systems, each stat() is a round-trip to the server, so
+ * issuing them in parallel hides most of the latency.
+ */
+static void DirStatBatch(stream_t *access, struct dir_entry *entries,
+                         size_t count)
+{
+    access_sys_t *sys = access->p_sys;
+    int threads = var_InheritInteger(access, "directory-stat-threads");
+    size_t unknown = 0;
+
+    for (size_t i = 0; i < count; i++)
+        if (entries[i].type == 0)
+            unknown++;
+
+    if (threads > 1 && unknown >= DIR_STAT_PARALLEL_MIN
+     && sys->executor == NULL)
+        sys->executor = DirExecutorHold(threads);
+    if (threads <= 1 || unknown < DIR_STAT_PARALLEL_MIN
+     || sys->executor == NULL)
+    {
+        DirStatEntries(access, entries, count);
+        return;
+    }
+
+    if (threads > DIR_STAT_THREADS_MAX)
+        threads = DIR_STAT_THREADS_MAX;
+    if ((size_t)threads > count)
+        threads = count;
+
+    struct dir_stat_job jobs[DIR_STAT_THREADS_MAX];
+    size_t per_job = (count + threads - 1) / threads;
+    size_t offset = 0;
+    unsigned submitted = 0;
+    vlc_sem_t done;
+
+    vlc_sem_init(&done, 0);
+
+    for (int i = 0; i < threads && offset < count; i++)
+    {
+        struct dir_stat_job *job = &jobs[i];
+
+        job->access = access;
+        job->entries = entries + offset;
+        job->count = count - offset < per_job ? count - offset : per_job;
+        job->done = &done;
+        job->runnable.run = DirStatRun;
+        job->runnable.userdata = job;
+        offset += job->count;
+        vlc_executor_Submit(sys->executor, &job->runnable);
+        submitted++;
+    }
+
+    while (submitted-- > 0)
+        vlc_sem_wait(&done);
+}
+
+static int DirAddEntry(stream_t *access, struct vlc_readdir_helper *rdh,
+                       struct dir_entry *entry, bool special_files)
+{
+    access_sys_t *sys = access->p_sys;
+    mode_t mode;
+    int type;
+
+    if (entry->valid)
+        mode = entry->st.st_mode;
+    else if (entry->type != 0)
+        mode = entry->type;
+    else
+        return VLC_SUCCESS;
+
+    switch (mode & S_IFMT)
+    {
+#ifdef S_IFBLK
+        case S_IFBLK:
+            if (!special_files)
+                return VLC_SUCCESS;
+            type = ITEM_TYPE_DISC;
             break;
-        }
-        input_item_t *p_item;
-        ret = vlc_readdir_helper_additem(&rdh, uri, NULL, entry, type,
+#endif
+        case S_IFCHR:
+            if (!special_files)
+                return VLC_SUCCESS;
+            type = ITEM_TYPE_CARD;
+            break;
+        case S_IFIFO:
+            if (!special_files)
+                return VLC_SUCCESS;
+            type = ITEM_TYPE_STREAM;
+            break;
+        case S_IFREG:
+            type = ITEM_TYPE_FILE;
+            break;
+        case S_IFDIR:
+            type = ITEM_TYPE_DIRECTORY;
+            break;
+        /* S_IFLNK cannot occur while following symbolic links */
+        /* S_IFSOCK cannot be opened with open()/openat() */
+        default:
+            return VLC_SUCCESS; /* ignore */
+    }
+
+    /* Create an input item for the current entry */
+    char *encoded = vlc_uri_encode(entry->name);
+    if (unlikely(encoded == NULL))
+        return VLC_ENOMEM;
+
+    char *uri;
+    if (unlikely(asprintf(&uri, "%s%s%s", sys->base_uri,
+                          sys->need_separator ? "/" : "",
+                          encoded) == -1))
+        uri = NULL;
+    free(encoded);
+    if (unlikely(uri == NULL))
+        return VLC_ENOMEM;
+
+    input_item_t *p_item;
+    int ret = vlc_readdir_helper_additem(rdh, uri, NULL, entry->name, type,
                                          ITEM_NET_UNKNOWN, &p_item);
 
-        if (ret == VLC_SUCCESS && p_item && st.st_mtime >= 0 && st.st_size >= 0)
+    if (ret == VLC_SUCCESS && p_item && entry->valid
+     && entry->st.st_mtime >= 0 && entry->st.st_size >= 0)
+    {
+        input_item_AddStat( p_item, "mtime", entry->st.st_mtime );
+        input_item_AddStat( p_item, "size", entry->st.st_size );
+    }
+    free(uri);
+    return ret;
+}
+
+static int DirRead (stream_t *access, input_item_node_t *node)
+{
+    int ret = VLC_SUCCESS;
+
+    bool special_files = var_InheritBool(access, "list-special-files");
+
+    struct vlc_readdir_helper rdh;
+    vlc_readdir_helper_init(&rdh, access, node);
+
+    struct dir_entry *entries = malloc(DIR_BATCH_SIZE * sizeof (*entries));
+    if (unlikely(entries == NULL))
+        ret = VLC_ENOMEM;
+
+    while (ret == VLC_SUCCESS)
+    {
+        size_t count = DirReadBatch(access, entries, special_files,
+                                    rdh.b_show_hiddenfiles);
+        if (count == 0)
+            break;
+
+        DirStatBatch(access, entries, count);
+
+        for (size_t i = 0; i < count; i++)
         {
-            input_item_AddStat( p_item, "mtime", st.st_mtime );
-            input_item_AddStat( p_item, "size", st.st_size );
+            if (ret == VLC_SUCCESS)
+                ret = DirAddEntry(access, &rdh, &entries[i], special_files);
+            free(entries[i].name);
         }
-        free(uri);
     }
+    free(entries);
 
     vlc_readdir_helper_finish(&rdh, ret == VLC_SUCCESS);
 
@@ -50,5 +50,9 @@ vlc_module_begin ()
 
     add_bool("list-special-files", false, N_("List special files"),
              N_("Include devices and pipes when listing directories"))
+    add_integer_with_range("directory-stat-threads", 8, 1, DIR_STAT_THREADS_MAX,
+             N_("Directory listing threads"),
+             N_("Maximum number of threads used to retrieve the properties "
+                "of the files when listing directories"))
     add_obsolete_string("directory-sort") /* since 3.0.0 */
 vlc_module_end ()
@@ -20,6 +20,9 @@
 
 #include <dirent.h>
 
+/* Maximum number of threads to stat directory entries */
+#define DIR_STAT_THREADS_MAX 64
+
 int FileOpen (vlc_object_t *);
 void FileClose (vlc_object_t *);
 
@@ -95,6 +95,41 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+/**
+ * Receives a packet from a socket.
+ *
+ * @return a packet, or NULL on error (errno is then set)
+ */
+static block_t *rtp_recv (demux_t *demux, struct vlc_dtls *sock)
+{
+    block_t *block = block_Alloc(DEFAULT_MRU);
+    if (unlikely(block == NULL))
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    bool truncated;
+    ssize_t len = vlc_dtls_Recv(sock, block->p_buffer, block->i_buffer,
+                                &truncated);
+    if (len < 0)
+    {
+        int errval = errno;
+
+        block_Release (block);
+        errno = errval;
+        return NULL;
+    }
+
+    if (truncated) {
+        msg_Err(demux, "packet truncated (MRU was %zu)", block->i_buffer);
+        block->i_flags |= BLOCK_FLAG_CORRUPTED;
+    }
+    else
+        block->i_buffer = len;
+    return block;
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -103,18 +138,28 @@ void *rtp_dgram_thread (void *opaque)
     demux_t *demux = opaque;
     demux_sys_t *sys = demux->p_sys;
     vlc_tick_t deadline = VLC_TICK_INVALID;
-    struct vlc_dtls *rtp_sock = sys->rtp_sock;
+    struct vlc_dtls *socks[1 + ARRAY_SIZE(sys->fec_sock)];
+    unsigned nfds = 0;
 
     vlc_thread_set_name("vlc-rtp");
 
+    /* The RTP socket comes first, then the FEC sockets if any */
+    socks[nfds++] = sys->rtp_sock;
+    for (size_t i = 0; i < ARRAY_SIZE(sys->fec_sock); i++)
+        if (sys->fec_sock[i] != NULL)
+            socks[nfds++] = sys->fec_sock[i];
+
     for (;;)
     {
-        struct pollfd ufd[1];
+        struct pollfd ufd[ARRAY_SIZE(socks)];
 
-        ufd[0].events = POLLIN;
-        ufd[0].fd = vlc_dtls_GetPollFD(rtp_sock, &ufd[0].events);
+        for (unsigned i = 0; i < nfds; i++)
+        {
+            ufd[i].events = POLLIN;
+            ufd[i].fd = vlc_dtls_GetPollFD(socks[i], &ufd[i].events);
+        }
 
-        int n = poll (ufd, 1, rtp_timeout (deadline));
+        int n = poll (ufd, nfds, rtp_timeout (deadline));
         if (n == -1)
             continue;
 
@@ -124,34 +169,31 @@ void *rtp_dgram_thread (void *opaque)
 
         if (ufd[0].revents)
         {
-            block_t *block = block_Alloc(DEFAULT_MRU);
-            if (unlikely(block == NULL))
-                break; /* we are totallly screwed */
-
-            bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
-                                       block->i_buffer, &truncated);
-            if (len >= 0) {
-                if (truncated) {
-                    msg_Err(demux, "packet truncated (MRU was %zu)",
-                            block->i_buffer);
-                    block->i_flags |= BLOCK_FLAG_CORRUPTED;
-                }
-                else
-                    block->i_buffer = len;
+            block_t *block = rtp_recv (demux, socks[0]);
 
+            if (block != NULL)
                 rtp_process (demux, block);
-            }
             else
             {
                 if (errno == EPIPE)
                     break; /* connection terminated */
                 msg_Warn (demux, "RTP network error: %s",
                           vlc_strerror_c(errno));
-                block_Release (block);
             }
+        }
+
+        for (unsigned i = 1; i < nfds; i++)
+        {
+            if (!ufd[i].revents)
+                continue;
 
-            n--;
+            block_t *block = rtp_recv (demux, socks[i]);
+
+            if (block != NULL)
+                rtp_queue_fec (sys->session, block);
+            else
+                msg_Warn (demux, "FEC network error: %s",
+                          vlc_strerror_c(errno));
         }
 
     dequeue:
@@ -0,0 +1,477 @@
+/**
+ * @file jitter.c
+ * @brief RTP jitter buffer and forward error correction
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#include "jitter.h"
+
+/* Released packets kept for FEC recovery. SMPTE 2022-1 matrices span at most
+ * 100 packets (L x D), the column FEC packets come after the whole matrix. */
+#define RTP_HISTORY 256
+/* FEC packets kept for recovery (a matrix has at most 20 columns and 20 rows,
+ * and the FEC packets of two successive matrices may overlap). */
+#define RTP_FEC_MAX 64
+
+#define RTP_FEC_HEADER 16
+
+/** SMPTE 2022-1 FEC packet */
+struct rtp_fec
+{
+    block_t *block; /* FEC packet including the RTP header */
+    size_t header; /* offset of the FEC header within the packet */
+    uint16_t base; /* sequence number of the first protected packet */
+    uint8_t offset; /* sequence number step between protected packets */
+    uint8_t count; /* number of protected packets */
+};
+
+struct rtp_jitter
+{
+    block_t *blocks; /* queued packets, in sequence order */
+    block_t *last; /* last queued packet */
+    block_t *history[RTP_HISTORY]; /* released packets */
+    struct rtp_fec fec[RTP_FEC_MAX];
+    unsigned fec_next;
+    struct rtp_jitter_stats stats;
+    uint32_t ssrc;
+    uint32_t rate; /* RTP clock rate of the last queued packet, or 0 */
+    uint16_t seq; /* sequence of the next released packet */
+    bool hold;
+    bool discontinuity;
+};
+
+static inline uint16_t rtp_seq(const block_t *block)
+{
+    assert(block->i_buffer >= 12);
+    return GetWBE(block->p_buffer + 2);
+}
+
+static inline uint32_t rtp_timestamp(const block_t *block)
+{
+    assert(block->i_buffer >= 12);
+    return GetDWBE(block->p_buffer + 4);
+}
+
+rtp_jitter_t *rtp_jitter_create(uint32_t ssrc, uint16_t seq, bool hold)
+{
+    rtp_jitter_t *jb = calloc(1, sizeof (*jb));
+    if (unlikely(jb == NULL))
+        return NULL;
+
+    jb->ssrc = ssrc;
+    jb->seq = seq;
+    jb->hold = hold;
+    return jb;
+}
+
+static void rtp_jitter_flush(rtp_jitter_t *jb)
+{
+    block_ChainRelease(jb->blocks);
+    jb->blocks = jb->last = NULL;
+
+    for (size_t i = 0; i < ARRAY_SIZE(jb->history); i++)
+        if (jb->history[i] != NULL)
+        {
+            block_Release(jb->history[i]);
+            jb->history[i] = NULL;
+        }
+
+    for (size_t i = 0; i < ARRAY_SIZE(jb->fec); i++)
+        if (jb->fec[i].block != NULL)
+        {
+            block_Release(jb->fec[i].block);
+            jb->fec[i].block = NULL;
+        }
+}
+
+void rtp_jitter_destroy(rtp_jitter_t *jb)
+{
+    rtp_jitter_flush(jb);
+    free(jb);
+}
+
+void rtp_jitter_reset(rtp_jitter_t *jb, uint16_t seq)
+{
+    rtp_jitter_flush(jb);
+    jb->seq = seq;
+    jb->discontinuity = true;
+}
+
+/**
+ * Inserts a packet in sequence order.
+ *
+ * @return 0 if appended, 1 if inserted before another packet,
+ * -1 if a duplicate (the packet is not queued)
+ */
+static int rtp_jitter_insert(rtp_jitter_t *jb, block_t *block)
+{
+    const uint16_t seq = rtp_seq(block);
+
+    /* In most cases, the packet comes last */
+    if (jb->last == NULL || (int16_t)(seq - rtp_seq(jb->last)) > 0)
+    {
+        block->p_next = NULL;
+        if (jb->last != NULL)
+            jb->last->p_next = block;
+        else
+            jb->blocks = block;
+        jb->last = block;
+        return 0;
+    }
+
+    block_t **pp = &jb->blocks;
+    for (block_t *prev = *pp; prev != NULL; prev = *pp)
+    {
+        int16_t delta = seq - rtp_seq(prev);
+        if (delta < 0)
+            break;
+        if (delta == 0)
+            return -1;
+        pp = &prev->p_next;
+    }
+    assert(*pp != NULL);
+    block->p_next = *pp;
+    *pp = block;
+    return 1;
+}
+
+/**
+ * Finds a queued or released packet by sequence number.
+ */
+static const block_t *rtp_jitter_find(const rtp_jitter_t *jb, uint16_t seq)
+{
+    if ((int16_t)(seq - jb->seq) < 0)
+    {
+        const block_t *block = jb->history[seq % RTP_HISTORY];
+        return (block != NULL && rtp_seq(block) == seq) ? block : NULL;
+    }
+
+    for (const block_t *block = jb->blocks; block != NULL;
+         block = block->p_next)
+    {
+        int16_t delta = rtp_seq(block) - seq;
+        if (delta >= 0)
+            return (delta == 0) ? block : NULL;
+    }
+    return NULL;
+}
+
+bool rtp_jitter_put(rtp_jitter_t *jb, block_t *block, uint32_t rate)
+{
+    const uint16_t seq = rtp_seq(block);
+
+    if (rate != 0)
+        jb->rate = rate;
+
+    if ((int16_t)(seq - jb->seq) < 0)
+    {   /* Too late, already released or given up */
+        if (rtp_jitter_find(jb, seq) != NULL)
+            jb->stats.duplicates++;
+        else
+            jb->stats.late++;
+        goto drop;
+    }
+
+    switch (rtp_jitter_insert(jb, block))
+    {
+        case 1:
+            jb->stats.reordered++;
+            break;
+        case -1:
+            jb->stats.duplicates++;
+            goto drop;
+    }
+    jb->stats.received++;
+    return true;
+
+drop:
+    block_Release(block);
+    return false;
+}
+
+void rtp_jitter_put_fec(rtp_jitter_t *jb, block_t *block)
+{
+    if (block->i_buffer < 12 || (block->p_buffer[0] >> 6) != 2)
+        goto drop;
+
+    /* CSRC count */
+    size_t header = 12u + (block->p_buffer[0] & 0x0F) * 4;
+    if (block->i_buffer < header + RTP_FEC_HEADER)
+        goto drop;
+
+    const uint8_t *fec = block->p_buffer + header;
+    uint16_t base = GetWBE(fec);
+    uint8_t offset = fec[13];
+    uint8_t count = fec[14];
+
+    if (!(fec[4] & 0x80) /* RFC 2733 bit mask: not supported */
+     || (fec[12] & 0xBF) /* N bit, FEC type and index (only XOR) */
+     || offset == 0 || count == 0
+     || offset * (count - 1) >= RTP_HISTORY)
+        goto drop;
+
+    struct rtp_fec *f = &jb->fec[jb->fec_next];
+
+    jb->fec_next = (jb->fec_next + 1) % RTP_FEC_MAX;
+    if (f->block != NULL)
+        block_Release(f->block);
+    f->block = block;
+    f->header = header;
+    f->base = base;
+    f->offset = offset;
+    f->count = count;
+    jb->stats.fec++;
+    return;
+
+drop:
+    block_Release(block);
+}
+
+#if defined (__has_attribute)
+# if __has_attribute(__vector_size__)
+#  define HAS_ATTRIBUTE_VECTORSIZE
+# endif
+#endif
+
+/**
+ * XORs a buffer into another one, 16 bytes at a time if the compiler
+ * supports vector types.
+ */
+static void rtp_fec_xor(uint8_t *restrict dst, const uint8_t *restrict src,
+                        size_t length)
+{
+#ifdef HAS_ATTRIBUTE_VECTORSIZE
+    typedef unsigned char v16qu __attribute__((__vector_size__(16)));
+
+    while (length >= sizeof (v16qu))
+    {
+        v16qu a, b;
+
+        memcpy(&a, dst, sizeof (a));
+        memcpy(&b, src, sizeof (b));
+        a ^= b;
+        memcpy(dst, &a, sizeof (a));
+        dst += sizeof (a);
+        src += sizeof (b);
+        length -= sizeof (a);
+    }
+#endif
+    for (size_t i = 0; i < length; i++)
+        dst[i] ^= src[i];
+}
+
+/**
+ * Recovers a packet from a FEC packet and the other packets it protects.
+ */
+static block_t *rtp_fec_recover(const rtp_jitter_t *jb,
+                                const struct rtp_fec *f, uint16_t seq)
+{
+    const block_t *pkts[UINT8_MAX];
+    const block_t *fec = f->block;
+    const uint8_t *header = fec->p_buffer + f->header;
+    const size_t size = fec->i_buffer - f->header - RTP_FEC_HEADER;
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < f->count; i++)
+    {
+        uint16_t s = f->base + i * f->offset;
+        if (s == seq)
+            continue;
+
+        const block_t *pkt = rtp_jitter_find(jb, s);
+        if (pkt == NULL || pkt->i_buffer - 12 > size)
+            return NULL; /* more than one packet missing */
+        pkts[n++] = pkt;
+    }
+
+    /* The P, X and CC fields are recovered from the FEC packet RTP header,
+     * the M bit, payload type, timestamp and length from the FEC header. */
+    uint8_t flags = fec->p_buffer[0] & 0x3F;
+    uint8_t mpt = (fec->p_buffer[1] & 0x80) | (header[4] & 0x7F);
+    uint16_t length = GetWBE(header + 2);
+    uint32_t timestamp = GetDWBE(header + 8);
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        const uint8_t *p = pkts[i]->p_buffer;
+
+        flags ^= p[0] & 0x3F;
+        mpt ^= p[1];
+        length ^= pkts[i]->i_buffer - 12;
+        timestamp ^= GetDWBE(p + 4);
+    }
+
+    if (length > size)
+        return NULL; /* corrupt FEC packet */
+
+    block_t *block = block_Alloc(12 + size);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    uint8_t *buf = block->p_buffer;
+
+    memcpy(buf + 12, header + RTP_FEC_HEADER, size);
+    for (unsigned i = 0; i < n; i++)
+        rtp_fec_xor(buf + 12, pkts[i]->p_buffer + 12, pkts[i]->i_buffer - 12);
+
+    buf[0] = 0x80 | flags;
+    buf[1] = mpt;
+    SetWBE(buf + 2, seq);
+    SetDWBE(buf + 4, timestamp);
+    SetDWBE(buf + 8, jb->ssrc);
+    block->i_buffer = 12 + length;
+    return block;
+}
+
+/**
+ * Tries to recover missing packets before the first queued packet.
+ *
+ * Recovering a packet can make another one recoverable, for instance a row
+ * FEC packet can recover a packet, completing the column of another one.
+ *
+ * @return true if at least one packet was recovered
+ */
+static bool rtp_jitter_repair(rtp_jitter_t *jb, uint16_t missing)
+{
+    bool repaired = false, progress;
+
+    if (jb->stats.fec == 0)
+        return false;
+    if (missing > RTP_HISTORY)
+        missing = RTP_HISTORY;
+
+    do
+    {
+        progress = false;
+
+        for (uint16_t i = 0; i < missing; i++)
+        {
+            const uint16_t seq = jb->seq + i;
+
+            if (rtp_jitter_find(jb, seq) != NULL)
+                continue;
+
+            for (size_t j = 0; j < ARRAY_SIZE(jb->fec); j++)
+            {
+                const struct rtp_fec *f = &jb->fec[j];
+                uint16_t delta = seq - f->base;
+
+                if (f->block == NULL || (delta % f->offset) != 0
+                 || (delta / f->offset) >= f->count)
+                    continue;
+
+                block_t *block = rtp_fec_recover(jb, f, seq);
+                if (block == NULL)
+                    continue;
+
+                /* Due at the local time of its own RTP timestamp, counted
+                 * back from the next queued packet */
+                const block_t *ref = jb->blocks;
+                int32_t ahead = rtp_timestamp(ref) - rtp_timestamp(block);
+
+                block->i_pts = ref->i_pts;
+                if (jb->rate != 0 && ahead > 0)
+                    block->i_pts -= vlc_tick_from_samples(ahead, jb->rate);
+                rtp_jitter_insert(jb, block);
+                jb->stats.recovered++;
+                progress = repaired = true;
+                break;
+            }
+        }
+    }
+    while (progress);
+
+    return repaired;
+}
+
+block_t *rtp_jitter_get(rtp_jitter_t *jb, vlc_tick_t now,
+                        vlc_tick_t *restrict deadlinep)
+{
+    block_t *block;
+
+    while ((block = jb->blocks) != NULL)
+    {
+        /* Late packets are rejected, so this is the number of missing
+         * packets before the first queued one. */
+        uint16_t missing = rtp_seq(block) - jb->seq;
+
+        if (missing > 0)
+        {
+            if (rtp_jitter_repair(jb, missing))
+                continue;
+            if (now < block->i_pts)
+                break; /* wait for the missing packets */
+
+            jb->stats.lost += missing;
+            jb->discontinuity = true;
+            jb->seq = rtp_seq(block);
+        }
+        else if (jb->hold && now < block->i_pts)
+            break;
+
+        jb->blocks = block->p_next;
+        if (jb->blocks == NULL)
+            jb->last = NULL;
+        block->p_next = NULL;
+        jb->seq++;
+
+        if (jb->discontinuity)
+        {
+            block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+            jb->discontinuity = false;
+        }
+
+        if (jb->stats.fec > 0)
+        {   /* Keep a copy for recovery of later packets. This is not a
+             * shared reference, as the depacketizers and the decoders
+             * write to the released packets in place. */
+            block_t **slot = &jb->history[rtp_seq(block) % RTP_HISTORY];
+
+            if (*slot != NULL)
+                block_Release(*slot);
+            *slot = block_Duplicate(block);
+        }
+        return block;
+    }
+
+    if (block != NULL)
+        *deadlinep = block->i_pts;
+    return NULL;
+}
+
+bool rtp_jitter_empty(const rtp_jitter_t *jb)
+{
+    return jb->blocks == NULL;
+}
+
+const struct rtp_jitter_stats *rtp_jitter_stats(const rtp_jitter_t *jb)
+{
+    return &jb->stats;
+}
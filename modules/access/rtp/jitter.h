@@ -0,0 +1,130 @@
+/**
+ * @file jitter.h
+ * @brief RTP jitter buffer and forward error correction
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ ****************************************************************************/
+
+#ifndef VLC_RTP_JITTER_H
+#define VLC_RTP_JITTER_H
+
+/**
+ * \defgroup rtp_jitter RTP jitter buffer
+ * \ingroup rtp
+ *
+ * The jitter buffer re-orders the packets of one RTP source in sequence
+ * order, and releases them when they are due. Packets that are still missing
+ * by then are recovered from SMPTE 2022-1 (column and row) forward error
+ * correction packets, if possible, or declared lost.
+ *
+ * The buffer does not depend on a VLC object, so that any RTP based input
+ * can reuse it.
+ *
+ * @{
+ */
+
+typedef struct rtp_jitter rtp_jitter_t;
+
+/**
+ * Jitter buffer statistics.
+ */
+struct rtp_jitter_stats
+{
+    uint64_t received; /**< Media packets received */
+    uint64_t reordered; /**< Media packets received out of order */
+    uint64_t duplicates; /**< Duplicate media packets */
+    uint64_t late; /**< Media packets received after their release */
+    uint64_t lost; /**< Media packets neither received nor recovered */
+    uint64_t recovered; /**< Media packets recovered from FEC packets */
+    uint64_t fec; /**< FEC packets received */
+};
+
+/**
+ * Creates a jitter buffer.
+ *
+ * If hold is false, the packets are released as soon as they are next in
+ * sequence order, and only the missing packets are waited for. Otherwise,
+ * all packets are held until their deadline.
+ *
+ * @param ssrc RTP source identifier (for recovered packets)
+ * @param seq sequence number of the first expected packet
+ * @param hold whether to hold the packets until their deadline
+ * @return a jitter buffer or NULL on memory error
+ */
+rtp_jitter_t *rtp_jitter_create(uint32_t ssrc, uint16_t seq, bool hold);
+
+/**
+ * Destroys a jitter buffer and the packets it holds.
+ */
+void rtp_jitter_destroy(rtp_jitter_t *jb);
+
+/**
+ * Flushes a jitter buffer after a sequence discontinuity.
+ *
+ * @param seq sequence number of the next expected packet
+ */
+void rtp_jitter_reset(rtp_jitter_t *jb, uint16_t seq);
+
+/**
+ * Queues a media packet.
+ *
+ * The packet must include the RTP header, and its i_pts must be set to the
+ * local time at which it is due for release.
+ *
+ * @param rate RTP clock rate of the packet payload type, or 0 if unknown
+ * (to date the recovered packets)
+ * @return false if the packet was a duplicate or came too late (in which
+ * case it was released), true otherwise
+ */
+bool rtp_jitter_put(rtp_jitter_t *jb, block_t *block, uint32_t rate);
+
+/**
+ * Queues a forward error correction packet.
+ *
+ * The packet must include the RTP header and the SMPTE 2022-1 FEC header.
+ * Invalid or unsupported packets are released.
+ */
+void rtp_jitter_put_fec(rtp_jitter_t *jb, block_t *block);
+
+/**
+ * Dequeues the next packet in sequence order, if it is due.
+ *
+ * A packet following missing packets is flagged with
+ * BLOCK_FLAG_DISCONTINUITY.
+ *
+ * @param now current local time
+ * @param deadlinep where to store the time to try again [OUT]
+ * (unchanged if the buffer is empty or if a packet is returned)
+ * @return a packet, or NULL if none is due
+ */
+block_t *rtp_jitter_get(rtp_jitter_t *jb, vlc_tick_t now,
+                        vlc_tick_t *restrict deadlinep);
+
+/**
+ * Checks if a jitter buffer holds no packets.
+ */
+bool rtp_jitter_empty(const rtp_jitter_t *jb);
+
+/**
+ * Returns the statistics of a jitter buffer.
+ */
+const struct rtp_jitter_stats *rtp_jitter_stats(const rtp_jitter_t *jb);
+
+/** @} */
+
+#endif
@@ -277,6 +277,9 @@ static void Close (vlc_object_t *obj)
         srtp_destroy (p_sys->srtp);
 #endif
     rtp_session_destroy (demux, p_sys->session);
+    for (size_t i = 0; i < ARRAY_SIZE(p_sys->fec_sock); i++)
+        if (p_sys->fec_sock[i] != NULL)
+            vlc_dtls_Close(p_sys->fec_sock[i]);
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
@@ -311,6 +314,7 @@ static int OpenSDP(vlc_object_t *obj)
 
     sys->rtp_sock = NULL;
     sys->rtcp_sock = NULL;
+    sys->fec_sock[0] = sys->fec_sock[1] = NULL;
     sys->session = NULL;
 #ifdef HAVE_SRTP
     sys->srtp = NULL;
@@ -421,6 +425,7 @@ static int OpenSDP(vlc_object_t *obj)
     sys->timeout = vlc_tick_from_sec(var_InheritInteger(obj, "rtp-timeout"));
     sys->max_dropout  = var_InheritInteger(obj, "rtp-max-dropout");
     sys->max_misorder = -var_InheritInteger(obj, "rtp-max-misorder");
+    sys->latency = VLC_TICK_FROM_MS(var_InheritInteger(obj, "rtp-latency"));
 
     demux->pf_demux = NULL;
     demux->pf_control = Control;
@@ -510,9 +515,10 @@ static int OpenURL(vlc_object_t *obj)
         dport = 5004; /* avt-profile-1 port */
 
     int rtcp_dport = var_CreateGetInteger (obj, "rtcp-port");
+    bool fec = var_CreateGetBool (obj, "rtp-fec");
 
     /* Try to connect */
-    int fd = -1, rtcp_fd = -1;
+    int fd = -1, rtcp_fd = -1, fec_fd[2] = { -1, -1 };
     bool co = false;
 
     switch (tp)
@@ -524,6 +530,17 @@ static int OpenURL(vlc_object_t *obj)
                 break;
             if (rtcp_dport > 0) /* XXX: source port is unknown */
                 rtcp_fd = net_OpenDgram (obj, dhost, rtcp_dport, shost, 0, tp);
+            if (fec)
+            {   /* SMPTE 2022-1 column and row FEC ports */
+                for (size_t i = 0; i < ARRAY_SIZE(fec_fd); i++)
+                {
+                    fec_fd[i] = net_OpenDgram (obj, dhost, dport + 2 * (i + 1),
+                                               shost, 0, tp);
+                    if (fec_fd[i] == -1)
+                        msg_Warn (obj, "cannot open FEC port %d",
+                                  dport + 2 * (int)(i + 1));
+                }
+            }
             break;
 
          case IPPROTO_DCCP:
@@ -552,6 +569,9 @@ static int OpenURL(vlc_object_t *obj)
     if (p_sys->rtp_sock == NULL) {
         if (rtcp_fd != -1)
             net_Close(rtcp_fd);
+        for (size_t i = 0; i < ARRAY_SIZE(fec_fd); i++)
+            if (fec_fd[i] != -1)
+                net_Close(fec_fd[i]);
         return VLC_EGENERIC;
     }
     net_SetCSCov (fd, -1, 12);
@@ -563,6 +583,15 @@ static int OpenURL(vlc_object_t *obj)
     } else
         p_sys->rtcp_sock = NULL;
 
+    for (size_t i = 0; i < ARRAY_SIZE(fec_fd); i++) {
+        p_sys->fec_sock[i] = NULL;
+        if (fec_fd[i] == -1)
+            continue;
+        p_sys->fec_sock[i] = vlc_datagram_CreateFD(fec_fd[i]);
+        if (p_sys->fec_sock[i] == NULL)
+            net_Close (fec_fd[i]);
+    }
+
     /* Initializes demux */
     p_sys->chained_demux = NULL;
 #ifdef HAVE_SRTP
@@ -572,6 +601,7 @@ static int OpenURL(vlc_object_t *obj)
     p_sys->timeout      = vlc_tick_from_sec( var_CreateGetInteger (obj, "rtp-timeout") );
     p_sys->max_dropout  = var_CreateGetInteger (obj, "rtp-max-dropout");
     p_sys->max_misorder = -var_CreateGetInteger (obj, "rtp-max-misorder");
+    p_sys->latency      = VLC_TICK_FROM_MS( var_CreateGetInteger (obj, "rtp-latency") );
 
     demux->pf_demux   = NULL;
     demux->pf_control = Control;
@@ -621,6 +651,9 @@ error:
 #endif
     if (p_sys->session != NULL)
         rtp_session_destroy(demux, p_sys->session);
+    for (size_t i = 0; i < ARRAY_SIZE(p_sys->fec_sock); i++)
+        if (p_sys->fec_sock[i] != NULL)
+            vlc_dtls_Close(p_sys->fec_sock[i]);
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
@@ -661,6 +694,18 @@ error:
     "RTP packets will be discarded if they are too far behind (i.e. in the " \
     "past) by this many packets from the last received packet." )
 
+#define RTP_LATENCY_TEXT N_("RTP jitter buffer latency (ms)")
+#define RTP_LATENCY_LONGTEXT N_( \
+    "RTP packets will be released this long after the time of their RTP " \
+    "timestamp. If zero, packets are released as soon as they are in " \
+    "sequence, and missing packets are waited for depending on the " \
+    "estimated network jitter.")
+
+#define RTP_FEC_TEXT N_("RTP forward error correction")
+#define RTP_FEC_LONGTEXT N_( \
+    "Lost RTP packets will be recovered with SMPTE 2022-1 column and row " \
+    "FEC packets received on the RTP port plus 2 and plus 4 respectively.")
+
 /*
  * Module descriptor
  */
@@ -698,6 +743,11 @@ vlc_module_begin()
     add_integer("rtp-max-misorder", 100, RTP_MAX_MISORDER_TEXT,
                 RTP_MAX_MISORDER_LONGTEXT)
         change_integer_range (0, 32767)
+    add_integer("rtp-latency", 0, RTP_LATENCY_TEXT,
+                RTP_LATENCY_LONGTEXT)
+        change_integer_range (0, 10000)
+    add_bool("rtp-fec", false, RTP_FEC_TEXT, RTP_FEC_LONGTEXT)
+        change_safe()
     add_obsolete_string("rtp-dynamic-pt") /* since 4.0.0 */
 
     /*add_shortcut ("sctp")*/
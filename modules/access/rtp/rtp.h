@@ -362,6 +362,7 @@ static inline uint8_t rtp_ptype (const block_t *block)
 rtp_session_t *rtp_session_create (demux_t *);
 void rtp_session_destroy (demux_t *, rtp_session_t *);
 void rtp_queue (demux_t *, rtp_session_t *, block_t *);
+void rtp_queue_fec (rtp_session_t *, block_t *);
 bool rtp_dequeue (demux_t *, const rtp_session_t *, vlc_tick_t *);
 int rtp_add_type(rtp_session_t *ses, rtp_pt_t *pt);
 int vlc_rtp_add_media_types(vlc_object_t *obj, rtp_session_t *ses,
@@ -383,9 +384,11 @@ typedef struct
 #endif
     struct vlc_dtls *rtp_sock;
     struct vlc_dtls *rtcp_sock;
+    struct vlc_dtls *fec_sock[2]; /**< Column and row FEC sockets */
     vlc_thread_t  thread;
 
     vlc_tick_t    timeout;
+    vlc_tick_t    latency; /**< Jitter buffer latency (0 = adaptive) */
     uint16_t      max_dropout; /**< Max packet forward misordering */
     uint16_t      max_misorder; /**< Max packet backward misordering */
     uint8_t       max_src; /**< Max simultaneous RTP sources */
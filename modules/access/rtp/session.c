@@ -32,6 +32,7 @@
 #include <vlc_demux.h>
 
 #include "rtp.h"
+#include "jitter.h"
 
 typedef struct rtp_source_t rtp_source_t;
 
@@ -48,7 +49,8 @@ static rtp_source_t *
 rtp_source_create (demux_t *, const rtp_session_t *, uint32_t, uint16_t);
 static void rtp_source_destroy(demux_t *, rtp_source_t *);
 
-static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
+static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *,
+                        block_t *);
 
 /**
  * Creates a new RTP session.
@@ -117,11 +119,14 @@ struct rtp_source_t
     uint32_t ref_rtp; /* sender RTP timestamp reference */
     vlc_tick_t  ref_ntp; /* sender NTP timestamp reference */
 
+    uint32_t due_rtp; /* RTP timestamp of the last due time */
+    vlc_tick_t  due_local; /* last due time (without latency) */
+
     uint16_t bad_seq; /* tentatively next expected sequence for resync */
     uint16_t max_seq; /* next expected sequence */
 
-    uint16_t last_seq; /* sequence of the next dequeued packet */
-    block_t *blocks; /* re-ordered blocks queue */
+    uint64_t lost; /* lost packets count, as last reported */
+    rtp_jitter_t *jb; /* re-ordering jitter buffer */
     struct {
         struct vlc_rtp_pt *instance; /* Per-source current payload format */
         void *opaque; /* Per-source payload format private data */
@@ -135,19 +140,27 @@ static rtp_source_t *
 rtp_source_create (demux_t *demux, const rtp_session_t *session,
                    uint32_t ssrc, uint16_t init_seq)
 {
+    const demux_sys_t *sys = demux->p_sys;
     rtp_source_t *source;
 
     source = malloc (sizeof (*source) + (sizeof (void *) * session->ptc));
     if (source == NULL)
         return NULL;
 
+    source->jb = rtp_jitter_create (ssrc, init_seq, sys->latency > 0);
+    if (source->jb == NULL)
+    {
+        free (source);
+        return NULL;
+    }
+
     source->ssrc = ssrc;
     source->jitter = 0;
     source->ref_rtp = 0;
     source->ref_ntp = UINT64_C (1) << 51;
+    source->due_local = VLC_TICK_INVALID;
     source->max_seq = source->bad_seq = init_seq;
-    source->last_seq = init_seq - 1;
-    source->blocks = NULL;
+    source->lost = 0;
     source->pt.instance = NULL;
     msg_Dbg (demux, "added RTP source (%08x)", ssrc);
     return source;
@@ -159,10 +172,17 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
  */
 static void rtp_source_destroy(demux_t *demux, rtp_source_t *source)
 {
+    const struct rtp_jitter_stats *stats = rtp_jitter_stats (source->jb);
+
     msg_Dbg (demux, "removing RTP source (%08x)", source->ssrc);
+    msg_Dbg (demux, "%"PRIu64" packets received, %"PRIu64" reordered, "
+             "%"PRIu64" duplicate, %"PRIu64" late, %"PRIu64" lost, "
+             "%"PRIu64" recovered with %"PRIu64" FEC packets",
+             stats->received, stats->reordered, stats->duplicates,
+             stats->late, stats->lost, stats->recovered, stats->fec);
     if (source->pt.instance != NULL)
         vlc_rtp_pt_end(source->pt.instance, source->pt.opaque);
-    block_ChainRelease (source->blocks);
+    rtp_jitter_destroy (source->jb);
     free (source);
 }
 
@@ -193,6 +213,75 @@ static struct vlc_rtp_pt *rtp_find_ptype(const rtp_session_t *session,
     return NULL;
 }
 
+/**
+ * Computes when a received packet is due for release from the jitter buffer.
+ */
+static vlc_tick_t rtp_due (const demux_sys_t *sys, rtp_source_t *src,
+                           const rtp_pt_t *pt, uint32_t timestamp,
+                           vlc_tick_t now)
+{
+    if (sys->latency == 0)
+    {
+        /* Because of IP packet delay variation (IPDV), we need to guesstimate
+         * how long to wait for a missing packet in the RTP sequence
+         * (see RFC3393 for background on IPDV).
+         *
+         * This situation occurs if a packet got lost, or if the network has
+         * re-ordered packets. Unfortunately, the MSL is 2 minutes, orders of
+         * magnitude too long for multimedia. We need a trade-off.
+         * If we underestimated IPDV, we may have to discard valid but late
+         * packets. If we overestimate it, we will either cause too much
+         * delay, or worse, underflow our downstream buffers, as we wait for
+         * definitely a lost packets.
+         *
+         * The rest of the "de-jitter buffer" work is done by the internal
+         * LibVLC E/S-out clock synchronization. Here, we need to bother about
+         * re-ordering packets, as decoders can't cope with mis-ordered data.
+         *
+         * Wait for 3 times the inter-arrival delay variance (about 99.7%
+         * match for random gaussian jitter).
+         */
+        vlc_tick_t delay = 0;
+        if (pt != NULL)
+            delay = vlc_tick_from_samples(3 * src->jitter, pt->frequency);
+        /* else no jitter estimate with no frequency :( */
+
+        /* Make sure we wait at least for 25 msec */
+        if (delay < VLC_TICK_FROM_MS(25))
+            delay = VLC_TICK_FROM_MS(25);
+
+        /* Additionally, we implicitly wait for the packetization time
+         * multiplied by the number of missing packets, as the deadline
+         * applies from the first non-missing packet. We have no better
+         * estimated time of arrival, as we do not know the RTP timestamp
+         * of not yet received packets. */
+        return now + delay;
+    }
+
+    if (pt == NULL)
+        return now + sys->latency;
+
+    /* Timestamp-driven release: a packet is due a constant latency after
+     * the local time of its RTP timestamp. That time is estimated from the
+     * packets that arrived the earliest, and follows the sender clock drift
+     * slowly. */
+    vlc_tick_t due = now;
+
+    if (src->due_local != VLC_TICK_INVALID)
+    {
+        int32_t delta = timestamp - src->due_rtp;
+
+        due = src->due_local + vlc_tick_from_samples(delta, pt->frequency);
+        if (due > now)
+            due = now;
+        else
+            due += (now - due) / 256;
+    }
+    src->due_rtp = timestamp;
+    src->due_local = due;
+    return due + sys->latency;
+}
+
 /**
  * Receives an RTP packet and queues it. Not a cancellation point.
  *
@@ -211,16 +300,6 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     if ((block->p_buffer[0] >> 6 ) != 2) /* RTP version number */
         goto drop;
 
-    /* Remove padding if present */
-    if (block->p_buffer[0] & 0x20)
-    {
-        uint8_t padding = block->p_buffer[block->i_buffer - 1];
-        if ((padding == 0) || (block->i_buffer < (12u + padding)))
-            goto drop; /* illegal value */
-
-        block->i_buffer -= padding;
-    }
-
     vlc_tick_t     now = vlc_tick_now ();
     rtp_source_t  *src  = NULL;
     const uint16_t seq  = rtp_seq (block);
@@ -245,6 +324,8 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
         }
     }
 
+    const rtp_pt_t *pt = rtp_find_ptype(session, block);
+
     if (src == NULL)
     {
         /* New source */
@@ -269,8 +350,6 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     }
     else
     {
-        const rtp_pt_t *pt = rtp_find_ptype(session, block);
-
         if (pt != NULL)
         {
             /* Recompute jitter estimate.
@@ -285,8 +364,9 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
         }
     }
     src->last_rx = now;
-    block->i_pts = now; /* store reception time until dequeued */
     src->last_ts = rtp_timestamp (block);
+    /* store release deadline until dequeued */
+    block->i_pts = rtp_due (p_sys, src, pt, src->last_ts, now);
 
     /* Check sequence number */
     /* NOTE: the sequence number is per-source,
@@ -304,10 +384,8 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
         if (seq == src->bad_seq)
         {
             src->max_seq = src->bad_seq = seq + 1;
-            src->last_seq = seq - 0x7fffe; /* hack for rtp_decode() */
             msg_Warn (demux, "sequence resynchronized");
-            block_ChainRelease (src->blocks);
-            src->blocks = NULL;
+            rtp_jitter_reset (src->jb, seq);
         }
         else
         {
@@ -321,37 +399,55 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
 
     /* Queues the block in sequence order,
      * hence there is a single queue for all payload types. */
-    block_t **pp = &src->blocks;
-    for (block_t *prev = *pp; prev != NULL; prev = *pp)
-    {
-        delta_seq.u = seq - rtp_seq (prev);
-        if (delta_seq.s < 0)
-            break;
-        if (delta_seq.s == 0)
-        {
-            msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
-            goto drop; /* duplicate */
-        }
-        pp = &prev->p_next;
-    }
-    block->p_next = *pp;
-    *pp = block;
-
-    /*rtp_decode (demux, session, src);*/
+    if (!rtp_jitter_put (src->jb, block, (pt != NULL) ? pt->frequency : 0))
+        msg_Dbg (demux, "duplicate or late packet (sequence: %"PRIu16")",
+                 seq);
     return;
 
 drop:
     block_Release (block);
 }
 
+/**
+ * Receives a forward error correction packet and queues it.
+ * Not a cancellation point.
+ *
+ * @param session RTP session receiving the packet
+ * @param block FEC packet including the RTP header
+ */
+void
+rtp_queue_fec (rtp_session_t *session, block_t *block)
+{
+    rtp_source_t *src = NULL;
+
+    if (block->i_buffer >= 12)
+    {
+        const uint32_t ssrc = GetDWBE (block->p_buffer + 8);
+
+        for (unsigned i = 0; i < session->srcc; i++)
+            if (session->srcv[i]->ssrc == ssrc)
+                src = session->srcv[i];
+
+        /* SMPTE 2022-1 FEC streams normally have a null SSRC */
+        if (src == NULL && session->srcc == 1)
+            src = session->srcv[0];
+    }
+
+    if (src != NULL)
+        rtp_jitter_put_fec (src->jb, block);
+    else
+        block_Release (block);
+}
+
 
-static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
+static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *,
+                        block_t *);
 
 /**
  * Dequeues RTP packets and pass them to decoder. Not cancellation-safe(?).
  * A packet is decoded if it is the next in sequence order, or if we have
  * given up waiting on the missing packets (time out) from the last one
- * already decoded.
+ * already decoded. Missing packets are recovered with FEC if possible.
  *
  * @param demux VLC demux object
  * @param session RTP session receiving the packet
@@ -370,62 +466,17 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
     for (unsigned i = 0, max = session->srcc; i < max; i++)
     {
         rtp_source_t *src = session->srcv[i];
+        vlc_tick_t deadline;
         block_t *block;
 
-        /* Because of IP packet delay variation (IPDV), we need to guesstimate
-         * how long to wait for a missing packet in the RTP sequence
-         * (see RFC3393 for background on IPDV).
-         *
-         * This situation occurs if a packet got lost, or if the network has
-         * re-ordered packets. Unfortunately, the MSL is 2 minutes, orders of
-         * magnitude too long for multimedia. We need a trade-off.
-         * If we underestimated IPDV, we may have to discard valid but late
-         * packets. If we overestimate it, we will either cause too much
-         * delay, or worse, underflow our downstream buffers, as we wait for
-         * definitely a lost packets.
-         *
-         * The rest of the "de-jitter buffer" work is done by the internal
-         * LibVLC E/S-out clock synchronization. Here, we need to bother about
-         * re-ordering packets, as decoders can't cope with mis-ordered data.
-         */
-        while (((block = src->blocks)) != NULL)
-        {
-            if ((int16_t)(rtp_seq (block) - (src->last_seq + 1)) <= 0)
-            {   /* Next (or earlier) block ready, no need to wait */
-                rtp_decode (demux, session, src);
-                continue;
-            }
-
-            /* Wait for 3 times the inter-arrival delay variance (about 99.7%
-             * match for random gaussian jitter).
-             */
-            vlc_tick_t deadline;
-            const rtp_pt_t *pt = rtp_find_ptype(session, block);
-            if (pt)
-                deadline = vlc_tick_from_samples(3 * src->jitter, pt->frequency);
-            else
-                deadline = 0; /* no jitter estimate with no frequency :( */
-
-            /* Make sure we wait at least for 25 msec */
-            if (deadline < VLC_TICK_FROM_MS(25))
-                deadline = VLC_TICK_FROM_MS(25);
-
-            /* Additionally, we implicitly wait for the packetization time
-             * multiplied by the number of missing packets. block is the first
-             * non-missing packet (lowest sequence number). We have no better
-             * estimated time of arrival, as we do not know the RTP timestamp
-             * of not yet received packets. */
-            deadline += block->i_pts;
-            if (now >= deadline)
-            {
-                rtp_decode (demux, session, src);
-                continue;
-            }
-            if (*deadlinep > deadline)
-                *deadlinep = deadline;
-            pending = true; /* packet pending in buffer */
-            break;
-        }
+        while ((block = rtp_jitter_get (src->jb, now, &deadline)) != NULL)
+            rtp_decode (demux, session, src, block);
+
+        if (rtp_jitter_empty (src->jb))
+            continue;
+        if (*deadlinep > deadline)
+            *deadlinep = deadline;
+        pending = true; /* packet pending in buffer */
     }
     return pending;
 }
@@ -434,28 +485,28 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
  * Decodes one RTP packet.
  */
 static void
-rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src)
+rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src,
+            block_t *block)
 {
-    block_t *block = src->blocks;
+    /* Discontinuity detection */
+    if (block->i_flags & BLOCK_FLAG_DISCONTINUITY)
+    {
+        uint64_t lost = rtp_jitter_stats (src->jb)->lost;
 
-    assert (block);
-    src->blocks = block->p_next;
-    block->p_next = NULL;
+        if (lost != src->lost)
+            msg_Warn (demux, "%"PRIu64" packet(s) lost", lost - src->lost);
+        src->lost = lost;
+    }
 
-    /* Discontinuity detection */
-    uint16_t delta_seq = rtp_seq (block) - (src->last_seq + 1);
-    if (delta_seq != 0)
+    /* Remove padding if present */
+    if (block->p_buffer[0] & 0x20)
     {
-        if (delta_seq >= 0x8000)
-        {   /* Trash too late packets (and PIM Assert duplicates) */
-            msg_Dbg (demux, "ignoring late packet (sequence: %"PRIu16")",
-                      rtp_seq (block));
-            goto drop;
-        }
-        msg_Warn (demux, "%"PRIu16" packet(s) lost", delta_seq);
-        block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
+        uint8_t padding = block->p_buffer[block->i_buffer - 1];
+        if ((padding == 0) || (block->i_buffer < (12u + padding)))
+            goto drop; /* illegal value */
+
+        block->i_buffer -= padding;
     }
-    src->last_seq = rtp_seq (block);
 
     /* Match the payload type */
     struct vlc_rtp_pt *pt = rtp_find_ptype(session, block);
@@ -0,0 +1,334 @@
+/**
+ * @file jitter.c
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include "../jitter.h"
+
+const char vlc_module_name[] = "jitter_test";
+
+#define SSRC 0x12345678
+#define SEQ0 65500 /* wraps around */
+#define L 5 /* FEC matrix columns */
+#define D 4 /* FEC matrix rows */
+#define MATRICES 10
+#define COUNT (L * D * MATRICES)
+#define DELAY VLC_TICK_FROM_MS(50)
+#define RATE 90000 /* 90 samples, 1 ms, per packet */
+
+static block_t *media[COUNT];
+
+/* Captured media packets: MPEG-TS over RTP, with a few short packets */
+static void capture(void)
+{
+    for (unsigned i = 0; i < COUNT; i++)
+    {
+        size_t size = 12 + ((i % 7) ? 7 * 188 : 3 * 188 + (i % 5));
+        block_t *block = block_Alloc(size);
+        assert(block != NULL);
+
+        uint8_t *p = block->p_buffer;
+        p[0] = 0x80;
+        p[1] = 33 | (((i % 9) == 0) ? 0x80 : 0);
+        SetWBE(p + 2, SEQ0 + i);
+        SetDWBE(p + 4, 90 * i);
+        SetDWBE(p + 8, SSRC);
+        for (size_t j = 12; j < size; j++)
+            p[j] = i * 31 + j * 7;
+        media[i] = block;
+    }
+}
+
+/* Generates a SMPTE 2022-1 FEC packet for count packets from first */
+static block_t *protect(unsigned first, unsigned offset, unsigned count,
+                        uint16_t seq)
+{
+    size_t size = 0;
+
+    for (unsigned i = 0; i < count; i++)
+        size = __MAX(size, media[first + i * offset]->i_buffer - 12);
+
+    block_t *block = block_Alloc(12 + 16 + size);
+    assert(block != NULL);
+
+    uint8_t *p = block->p_buffer;
+    memset(p, 0, block->i_buffer);
+    p[0] = 0x80;
+    p[1] = 96;
+    SetWBE(p + 2, seq);
+    SetWBE(p + 12, SEQ0 + first);
+    p[16] = 0x80; /* E */
+    p[24] = offset == 1 ? 0x40 : 0x00; /* D */
+    p[25] = offset;
+    p[26] = count;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        const block_t *pkt = media[first + i * offset];
+        uint16_t length = GetWBE(p + 14) ^ (pkt->i_buffer - 12);
+
+        p[0] ^= pkt->p_buffer[0] & 0x3F;
+        p[1] ^= pkt->p_buffer[1] & 0x80;
+        p[16] ^= pkt->p_buffer[1] & 0x7F;
+        SetWBE(p + 14, length);
+        SetDWBE(p + 20, GetDWBE(p + 20) ^ GetDWBE(pkt->p_buffer + 4));
+        for (size_t j = 12; j < pkt->i_buffer; j++)
+            p[28 + j - 12] ^= pkt->p_buffer[j];
+    }
+    return block;
+}
+
+/* Lost packets: single losses, a loss recoverable only once another one is,
+ * and 2x2 squares that cannot be recovered */
+static bool is_lost(unsigned i)
+{
+    static const unsigned lost[] = {
+        3,                  /* matrix 0: single */
+        20 + 6, 20 + 8,     /* matrix 1: same row, distinct columns */
+        40 + 2, 40 + 3, 40 + 7, /* matrix 2: row then column */
+        60 + 0, 60 + 1, 60 + 5, 60 + 6, /* matrix 3: square */
+        100 + 19,           /* matrix 5: last packet */
+        140 + 10, 140 + 11, 140 + 12, 140 + 13, 140 + 14, /* matrix 7: row */
+    };
+
+    for (size_t j = 0; j < ARRAY_SIZE(lost); j++)
+        if (lost[j] == i)
+            return true;
+    return false;
+}
+#define UNRECOVERABLE 4
+
+static unsigned next; /* next expected packet index */
+static vlc_tick_t now;
+
+static void drain(rtp_jitter_t *jb)
+{
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+    block_t *block;
+
+    while ((block = rtp_jitter_get(jb, now, &deadline)) != NULL)
+    {
+        uint16_t seq = GetWBE(block->p_buffer + 2);
+        unsigned i = (uint16_t)(seq - SEQ0);
+
+        assert(i >= next && i < COUNT);
+        assert(((block->i_flags & BLOCK_FLAG_DISCONTINUITY) != 0)
+               == (i != next));
+        next = i + 1;
+
+        /* Received or recovered packets are identical */
+        assert(block->i_buffer == media[i]->i_buffer);
+        assert(!memcmp(block->p_buffer, media[i]->p_buffer, block->i_buffer));
+
+        /* Depacketizers write in place, e.g. H.264 FU-A headers: this must
+         * not affect the recovery of later packets */
+        memset(block->p_buffer, 0xFF, block->i_buffer);
+        block_Release(block);
+    }
+
+    if (!rtp_jitter_empty(jb))
+        assert(deadline > now);
+}
+
+static void put(rtp_jitter_t *jb, unsigned i, bool expected)
+{
+    block_t *block = block_Duplicate(media[i]);
+    assert(block != NULL);
+    block->i_pts = now + DELAY;
+    assert(rtp_jitter_put(jb, block, RATE) == expected);
+}
+
+static void test_replay(void)
+{
+    rtp_jitter_t *jb = rtp_jitter_create(SSRC, SEQ0, false);
+    assert(jb != NULL);
+
+    uint16_t fec_seq = 1000;
+    now = VLC_TICK_0;
+    next = 0;
+
+    for (unsigned m = 0; m < MATRICES; m++)
+    {
+        const unsigned base = m * L * D;
+
+        for (unsigned i = base; i < base + L * D; i++)
+        {
+            now += VLC_TICK_FROM_MS(1);
+
+            /* Swap two packets every 10 packets. This stays within a row,
+             * otherwise the delayed packet could be recovered before it
+             * comes (and would then be a duplicate). */
+            unsigned j = i;
+            if ((i % 10) == 1)
+                j = i + 1;
+            else if ((i % 10) == 2)
+                j = i - 1;
+
+            if (!is_lost(j))
+                put(jb, j, true);
+
+            /* The row FEC packet follows its row */
+            if ((i - base) % L == L - 1)
+            {
+                block_t *fec = protect(i - (L - 1), 1, L, fec_seq++);
+                if (m != 9) /* lose the row FEC packets of the last matrix */
+                    rtp_jitter_put_fec(jb, fec);
+                else
+                    block_Release(fec);
+            }
+            drain(jb);
+        }
+
+        /* The column FEC packets follow the matrix */
+        for (unsigned c = 0; c < L; c++)
+            rtp_jitter_put_fec(jb, protect(base + c, L, D, fec_seq++));
+        drain(jb);
+
+        if (m == 4)
+        {   /* Duplicate */
+            put(jb, base + 10, false);
+        }
+    }
+
+    /* Flush the buffer */
+    now += DELAY;
+    drain(jb);
+    assert(rtp_jitter_empty(jb));
+    assert(next == COUNT);
+
+    /* Too late, given up */
+    put(jb, 60, false);
+
+    const struct rtp_jitter_stats *stats = rtp_jitter_stats(jb);
+    unsigned lost = 0;
+
+    for (unsigned i = 0; i < COUNT; i++)
+        if (is_lost(i))
+            lost++;
+
+    assert(stats->received == COUNT - lost);
+    assert(stats->lost == UNRECOVERABLE);
+    assert(stats->recovered == lost - UNRECOVERABLE);
+    assert(stats->reordered > 0);
+    assert(stats->duplicates == 1);
+    assert(stats->late == 1);
+    assert(stats->fec == MATRICES * L + (MATRICES - 1) * D);
+
+    rtp_jitter_destroy(jb);
+}
+
+static void test_hold(void)
+{
+    rtp_jitter_t *jb = rtp_jitter_create(SSRC, SEQ0, true);
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+    assert(jb != NULL);
+
+    now = VLC_TICK_0;
+    put(jb, 1, true);
+    put(jb, 0, true);
+
+    /* The packets are held until they are due */
+    assert(rtp_jitter_get(jb, now, &deadline) == NULL);
+    assert(deadline == now + DELAY);
+
+    now += DELAY;
+    for (unsigned i = 0; i < 2; i++)
+    {
+        block_t *block = rtp_jitter_get(jb, now, &deadline);
+        assert(block != NULL);
+        assert(GetWBE(block->p_buffer + 2) == (uint16_t)(SEQ0 + i));
+        block_Release(block);
+    }
+    assert(rtp_jitter_empty(jb));
+
+    /* Missing packet given up after the deadline */
+    put(jb, 3, true);
+    assert(rtp_jitter_get(jb, now, &deadline) == NULL);
+    now += DELAY;
+
+    block_t *block = rtp_jitter_get(jb, now, &deadline);
+    assert(block != NULL);
+    assert(block->i_flags & BLOCK_FLAG_DISCONTINUITY);
+    block_Release(block);
+    assert(rtp_jitter_stats(jb)->lost == 1);
+
+    /* Reset */
+    put(jb, 5, true);
+    rtp_jitter_reset(jb, SEQ0 + 10);
+    assert(rtp_jitter_empty(jb));
+    put(jb, 10, true);
+    block = rtp_jitter_get(jb, now + DELAY, &deadline);
+    assert(block != NULL);
+    assert(block->i_flags & BLOCK_FLAG_DISCONTINUITY);
+    block_Release(block);
+
+    rtp_jitter_destroy(jb);
+}
+
+static void test_recovered_deadline(void)
+{
+    rtp_jitter_t *jb = rtp_jitter_create(SSRC, SEQ0, true);
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+    assert(jb != NULL);
+
+    /* The packets after the lost one arrive in a burst */
+    now = VLC_TICK_0;
+    for (unsigned i = 0; i < L; i++)
+        if (i != 1)
+            put(jb, i, true);
+    rtp_jitter_put_fec(jb, protect(0, 1, L, 1000));
+
+    now += DELAY;
+    block_t *block = rtp_jitter_get(jb, now, &deadline);
+    assert(block != NULL);
+    block_Release(block);
+
+    /* The recovered packet is due from its own timestamp, 1 ms before the
+     * next packet, not with it */
+    block = rtp_jitter_get(jb, now, &deadline);
+    assert(block != NULL);
+    assert(GetWBE(block->p_buffer + 2) == (uint16_t)(SEQ0 + 1));
+    assert(block->i_pts == now - VLC_TICK_FROM_MS(1));
+    block_Release(block);
+    assert(rtp_jitter_stats(jb)->recovered == 1);
+
+    rtp_jitter_destroy(jb);
+}
+
+int main(void)
+{
+    capture();
+    test_replay();
+    test_hold();
+    test_recovered_deadline();
+
+    for (unsigned i = 0; i < COUNT; i++)
+        block_Release(media[i]);
+    return 0;
+}
@@ -71,6 +71,45 @@ static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
     return val;
 }
 
+/**
+ * Copies a block backed by a file range, from the file rather than from its
+ * mapping: the file may have shrunk since the block was created, and reading
+ * the mapping past the end of the file would raise SIGBUS.
+ *
+ * @return the written byte count, 0 if the block is not backed by a file
+ * (it must then be written normally), or -1 on error (see errno).
+ */
+static ssize_t CopyRange(int fd, const block_t *block)
+{
+    uint64_t offset;
+    int src = block_GetFileRange(block, &offset);
+    if (src == -1)
+        return 0;
+
+#ifdef HAVE_COPY_FILE_RANGE
+    off_t off = offset;
+    ssize_t val = copy_file_range(src, &off, fd, NULL, block->i_buffer, 0);
+    if (val > 0 || (val == -1 && errno == EINTR))
+        return val;
+    if (val == 0)
+    {   /* The range is not within the file anymore */
+        errno = EIO;
+        return -1;
+    }
+    /* Not supported by the file systems: copy through a buffer */
+#endif
+    uint8_t buf[32768];
+    ssize_t len = pread(src, buf, __MIN(block->i_buffer, sizeof (buf)),
+                        offset);
+    if (len <= 0)
+    {
+        if (len == 0)
+            errno = EIO;
+        return -1;
+    }
+    return write(fd, buf, len);
+}
+
 /*****************************************************************************
  * Write: standard write on a file descriptor.
  *****************************************************************************/
@@ -81,7 +120,9 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
     while( p_buffer )
     {
-        ssize_t val = write(fd, p_buffer->p_buffer, p_buffer->i_buffer);
+        ssize_t val = CopyRange(fd, p_buffer);
+        if (val == 0)
+            val = write(fd, p_buffer->p_buffer, p_buffer->i_buffer);
         if (val <= 0)
         {
             if (errno == EINTR)
@@ -210,6 +251,37 @@ static int Control( sout_access_out_t *p_access, int i_query, va_list args )
             break;
         }
 
+#ifdef FALLOC_FL_INSERT_RANGE
+        case ACCESS_OUT_CAN_INSERT:
+        {
+            int *fdp = p_access->p_sys, fd = *fdp;
+            struct stat st;
+
+            /* Only regular files support ranges insertion, and only on some
+             * file systems, which is only known when inserting */
+            if (p_access->pf_seek == NULL || fstat(fd, &st)
+             || !S_ISREG(st.st_mode) || st.st_blksize <= 0)
+                return VLC_EGENERIC;
+            *va_arg( args, uint64_t * ) = st.st_blksize;
+            break;
+        }
+
+        case ACCESS_OUT_INSERT:
+        {
+            int *fdp = p_access->p_sys, fd = *fdp;
+            uint64_t offset = va_arg( args, uint64_t );
+            uint64_t length = va_arg( args, uint64_t );
+
+            if (fallocate(fd, FALLOC_FL_INSERT_RANGE, offset, length))
+            {
+                msg_Dbg( p_access, "cannot insert range: %s",
+                         vlc_strerror_c(errno) );
+                return VLC_EGENERIC;
+            }
+            break;
+        }
+#endif
+
         default:
             return VLC_EGENERIC;
     }
@@ -56,6 +56,8 @@
 #define STR_ENDLIST "#EXT-X-ENDLIST\n"
 
 #define MAX_RENAME_RETRIES        10
+/* Queued data above which the muxer waits for the writer thread */
+#define MAX_QUEUED_BYTES          (8 << 20)
 
 /*****************************************************************************
  * Module descriptor
@@ -105,6 +107,22 @@ static void Close( vlc_object_t * );
 #define INTITIAL_SEG_TEXT N_("Number of first segment")
 #define INITIAL_SEG_LONGTEXT N_("The number of the first segment generated")
 
+#define CMAF_TEXT N_("CMAF segments")
+#define CMAF_LONGTEXT N_("Write fragmented MP4 segments, starting on the "\
+                         "fragments of the mp4stream muxer. Its header is "\
+                         "written once to the initialization segment.")
+
+#define INITSEG_TEXT N_("Initialization segment")
+#define INITSEG_LONGTEXT N_("Path to the initialization segment of the CMAF "\
+                            "segments. By default, the segment path with "\
+                            "\"init\" as segment number.")
+
+#define PARTLEN_TEXT N_("Partial segment length (ms)")
+#define PARTLEN_LONGTEXT N_("Publish partial segments of this length in the "\
+                            "index while the segments are written, for "\
+                            "low-latency HLS. The HTTP server has to support "\
+                            "the blocking playlist reloads. 0 disables them.")
+
 vlc_module_begin ()
     set_description( N_("HTTP Live streaming output") )
     set_shortname( N_("LiveHTTP" ))
@@ -134,6 +152,13 @@ vlc_module_begin ()
                  KEYFILE_TEXT, KEYFILE_LONGTEXT)
     add_loadfile(SOUT_CFG_PREFIX "key-loadfile", NULL,
                  KEYLOADFILE_TEXT, KEYLOADFILE_LONGTEXT)
+    add_bool( SOUT_CFG_PREFIX "cmaf", false,
+              CMAF_TEXT, CMAF_LONGTEXT )
+    add_string( SOUT_CFG_PREFIX "init-segment", NULL,
+                INITSEG_TEXT, INITSEG_LONGTEXT )
+    add_integer( SOUT_CFG_PREFIX "part-length", 0,
+                 PARTLEN_TEXT, PARTLEN_LONGTEXT )
+        change_integer_range( 0, 10000 )
     set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -155,21 +180,36 @@ static const char *const ppsz_sout_options[] = {
     "key-loadfile",
     "generate-iv",
     "initial-segment-number",
+    "cmaf",
+    "init-segment",
+    "part-length",
     NULL
 };
 
 static ssize_t Write( sout_access_out_t *, block_t * );
+static ssize_t WriteBlocks( sout_access_out_t *, block_t * );
 static int Control( sout_access_out_t *, int, va_list );
 
+typedef struct output_part
+{
+    vlc_tick_t length;
+    uint64_t i_offset;
+    uint64_t i_size;
+    bool b_independent;
+} output_part_t;
+
 typedef struct output_segment
 {
     char *psz_filename;
     char *psz_uri;
     char *psz_key_uri;
-    char *psz_duration;
+    char *psz_duration; /* NULL while the segment is written */
     vlc_tick_t segment_length;
     uint32_t i_segment_number;
     uint8_t aes_ivs[16];
+    uint64_t i_size;
+    output_part_t *p_parts;
+    size_t i_parts;
 } output_segment_t;
 
 typedef struct
@@ -201,13 +241,36 @@ typedef struct
     uint8_t stuffing_bytes[16];
     ssize_t stuffing_size;
     vlc_array_t segments_t;
+
+    /* CMAF */
+    bool b_cmaf;
+    bool b_init_written;
+    char *psz_initPath;
+    char *psz_initUrl;
+    int i_split_flags;
+
+    /* Low-latency partial segments */
+    vlc_tick_t part_max_length;
+    vlc_tick_t part_target;
+    bool b_part_independent;
+
+    /* The segments, the encryption and the index are written by a
+     * background thread, not to block the muxer on slow storage */
+    vlc_thread_t thread;
+    block_fifo_t *fifo;
+    vlc_cond_t drained; /* the queue went below its size limit */
+    bool b_closing;
+    bool b_write_error; /* the writer thread failed, latched */
 } sout_access_out_sys_t;
 
 static int LoadCryptFile( sout_access_out_t *p_access);
 static int CryptSetup( sout_access_out_t *p_access, char *keyfile );
 static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
 static ssize_t writeSegment( sout_access_out_t *p_access );
+static ssize_t writePart( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
 static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
+static char *formatInitPath( const char *psz_path );
+static void *WriterThread( void *data );
 /*****************************************************************************
  * Open: open the file
  *****************************************************************************/
@@ -295,10 +358,67 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_segment = p_sys->i_initial_segment-1;
     p_sys->psz_cursegPath = NULL;
 
+    p_sys->b_cmaf = var_GetBool( p_access, SOUT_CFG_PREFIX "cmaf" );
+    if( p_sys->b_cmaf )
+    {
+        /* Fragmented MP4 segments can only start on the fragments */
+        p_sys->i_split_flags = BLOCK_FLAG_TYPE_I;
+        p_sys->b_splitanywhere = false;
+
+        p_sys->psz_initPath = var_GetNonEmptyString( p_access,
+                                          SOUT_CFG_PREFIX "init-segment" );
+        if( !p_sys->psz_initPath )
+            p_sys->psz_initPath = formatInitPath( p_access->psz_path );
+        if( p_sys->psz_initPath )
+            p_sys->psz_initUrl = p_sys->psz_indexUrl ?
+                formatInitPath( p_sys->psz_indexUrl ) :
+                strdup( p_sys->psz_initPath );
+        if( unlikely( !p_sys->psz_initUrl ) )
+            goto error;
+    }
+    else
+        p_sys->i_split_flags = BLOCK_FLAG_HEADER;
+
+    p_sys->part_max_length = VLC_TICK_FROM_MS(
+            var_GetInteger( p_access, SOUT_CFG_PREFIX "part-length" ) );
+    if( p_sys->part_max_length > 0 && ( p_sys->key_uri || p_sys->psz_keyfile ) )
+    {
+        msg_Warn( p_access, "partial segments cannot be encrypted" );
+        p_sys->part_max_length = 0;
+    }
+    p_sys->part_target = p_sys->part_max_length;
+
+    p_sys->fifo = block_FifoNew();
+    if( unlikely( !p_sys->fifo ) )
+        goto error;
+    vlc_cond_init( &p_sys->drained );
+    p_sys->b_closing = false;
+    p_sys->b_write_error = false;
+
+    if( vlc_clone( &p_sys->thread, WriterThread, p_access ) )
+    {
+        block_FifoRelease( p_sys->fifo );
+        goto error;
+    }
+
     p_access->pf_write = Write;
     p_access->pf_control = Control;
 
     return VLC_SUCCESS;
+
+error:
+    if( p_sys->key_uri )
+    {
+        gcry_cipher_close( p_sys->aes_ctx );
+        free( p_sys->key_uri );
+    }
+    free( p_sys->psz_initUrl );
+    free( p_sys->psz_initPath );
+    free( p_sys->psz_keyfile );
+    free( p_sys->psz_indexUrl );
+    free( p_sys->psz_indexPath );
+    free( p_sys );
+    return VLC_ENOMEM;
 }
 
 /************************************************************************
@@ -498,8 +618,35 @@ static char *formatSegmentPath( char *psz_path, uint32_t i_seg )
     return psz_result;
 }
 
+/*****************************************************************************
+ * formatInitPath: create the initialization segment path name
+ *****************************************************************************/
+static char *formatInitPath( const char *psz_path )
+{
+    char *psz_result = vlc_strftime( psz_path );
+    if ( !psz_result )
+        return NULL;
+
+    char *psz_firstNumSign = psz_result + strcspn( psz_result, SEG_NUMBER_PLACEHOLDER );
+    char *psz_newResult;
+    int ret;
+
+    if ( *psz_firstNumSign )
+    {
+        int i_cnt = strspn( psz_firstNumSign, SEG_NUMBER_PLACEHOLDER );
+
+        *psz_firstNumSign = '\0';
+        ret = asprintf( &psz_newResult, "%sinit%s", psz_result, psz_firstNumSign + i_cnt );
+    }
+    else
+        ret = asprintf( &psz_newResult, "%s.init", psz_result );
+    free( psz_result );
+    return ret < 0 ? NULL : psz_newResult;
+}
+
 static void destroySegment( output_segment_t *segment )
 {
+    free( segment->p_parts );
     free( segment->psz_filename );
     free( segment->psz_duration );
     free( segment->psz_uri );
@@ -587,8 +734,9 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             return -1;
         }
 
-        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:3\n#EXT-X-ALLOW-CACHE:%s"
+        if ( fprintf( fp, "#EXTM3U\n#EXT-X-TARGETDURATION:%.0f\n#EXT-X-VERSION:%d\n#EXT-X-ALLOW-CACHE:%s"
                           "%s\n#EXT-X-MEDIA-SEQUENCE:%"PRIu32"\n%s", ceil(secf_from_vlc_tick( p_sys->segment_max_length )) ,
+                          p_sys->b_cmaf || p_sys->part_max_length ? 7 : 3,
                           p_sys->b_caching ? "YES" : "NO",
                           p_sys->i_numsegs > 0 ? "" : b_isend ? "\n#EXT-X-PLAYLIST-TYPE:VOD" : "\n#EXT-X-PLAYLIST-TYPE:EVENT",
                           i_firstseg, ((p_sys->i_initial_segment > 1) && (p_sys->i_initial_segment == i_firstseg)) ? "#EXT-X-DISCONTINUITY\n" : ""
@@ -598,6 +746,19 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
             fclose( fp );
             return -1;
         }
+
+        if( ( p_sys->part_max_length &&
+              fprintf( fp, "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=%.3f\n"
+                           "#EXT-X-PART-INF:PART-TARGET=%.3f\n",
+                       3 * secf_from_vlc_tick( p_sys->part_target ),
+                       secf_from_vlc_tick( p_sys->part_target ) ) < 0 ) ||
+            ( p_sys->b_init_written &&
+              fprintf( fp, "#EXT-X-MAP:URI=\"%s\"\n", p_sys->psz_initUrl ) < 0 ) )
+        {
+            free( psz_idxTmp );
+            fclose( fp );
+            return -1;
+        }
         char *psz_current_uri=NULL;
 
 
@@ -640,7 +801,33 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
                 }
             }
 
-            val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
+            /* The partial segments of the last segments */
+            if( p_sys->part_max_length && p_sys->i_segment - i < 3 )
+            {
+                for( size_t j = 0; j < segment->i_parts; j++ )
+                {
+                    const output_part_t *part = &segment->p_parts[j];
+                    if( fprintf( fp, "#EXT-X-PART:DURATION=%.5f,URI=\"%s\","
+                                     "BYTERANGE=\"%"PRIu64"@%"PRIu64"\"%s\n",
+                                 secf_from_vlc_tick( part->length ),
+                                 segment->psz_uri, part->i_size, part->i_offset,
+                                 part->b_independent ? ",INDEPENDENT=YES" : "" ) < 0 )
+                    {
+                        free( psz_current_uri );
+                        free( psz_idxTmp );
+                        fclose( fp );
+                        return -1;
+                    }
+                }
+            }
+
+            if( segment->psz_duration == NULL )
+                /* Segment being written, the next part is appended to it */
+                val = fprintf( fp, "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"%s\","
+                                   "BYTERANGE-START=%"PRIu64"\n",
+                               segment->psz_uri, segment->i_size );
+            else
+                val = fprintf( fp, "#EXTINF:%s,\n%s\n", segment->psz_duration, segment->psz_uri);
             if ( val < 0 )
             {
                 free( psz_current_uri );
@@ -676,6 +863,10 @@ static int updateIndexAndDel( sout_access_out_t *p_access, sout_access_out_sys_t
         free( psz_idxTmp );
     }
 
+    /* Only delete when a segment is complete */
+    if( p_sys->i_handle >= 0 )
+        return 0;
+
     // Then take care of deletion
     // Try to follow pantos draft 11 section 6.2.2
     while( p_sys->b_delsegs && p_sys->i_numsegs &&
@@ -756,6 +947,14 @@ static void Close( vlc_object_t * p_this )
     sout_access_out_t *p_access = (sout_access_out_t*)p_this;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
 
+    /* Let the writer thread write the queued blocks */
+    vlc_fifo_Lock( p_sys->fifo );
+    p_sys->b_closing = true;
+    vlc_fifo_Signal( p_sys->fifo );
+    vlc_fifo_Unlock( p_sys->fifo );
+    vlc_join( p_sys->thread, NULL );
+    block_FifoRelease( p_sys->fifo );
+
     if( p_sys->ongoing_segment )
         block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
     p_sys->ongoing_segment = NULL;
@@ -770,17 +969,23 @@ static void Close( vlc_object_t * p_this )
         block_t *p_next = output_block->p_next;
         output_block->p_next = NULL;
 
-        Write( p_access, output_block );
+        WriteBlocks( p_access, output_block );
         output_block = p_next;
     }
-    if( p_sys->ongoing_segment )
+    ssize_t writevalue;
+    if( p_sys->part_max_length && p_sys->ongoing_segment )
+        /* The tail is a partial segment too, so that the index lists it */
+        writevalue = writePart( p_access, p_sys );
+    else
     {
-        block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
-        p_sys->ongoing_segment = NULL;
-        p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
+        if( p_sys->ongoing_segment )
+        {
+            block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
+            p_sys->ongoing_segment = NULL;
+            p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
+        }
+        writevalue = writeSegment( p_access );
     }
-
-    ssize_t writevalue = writeSegment( p_access );
     msg_Dbg( p_access, "Writing.. %zd", writevalue );
     if( unlikely( writevalue < 0 ) )
     {
@@ -811,6 +1016,8 @@ static void Close( vlc_object_t * p_this )
         destroySegment( segment );
     }
 
+    free( p_sys->psz_initUrl );
+    free( p_sys->psz_initPath );
     free( p_sys->psz_indexUrl );
     free( p_sys->psz_indexPath );
     free( p_sys );
@@ -894,6 +1101,7 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
     p_sys->i_handle = fd;
     p_sys->i_segment = i_newseg;
     p_sys->b_segment_has_data = false;
+    p_sys->current_segment_length = 0;
     return fd;
 }
 /*****************************************************************************
@@ -945,11 +1153,21 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
 
     ssize_t i_write=0;
     bool encrypted = false;
-    p_sys->current_segment_length = current_length;
+    p_sys->current_segment_length += current_length;
     while( output )
     {
         if( p_sys->key_uri && !encrypted )
         {
+            /* The payload is encrypted in place: it must not be shared with
+             * another output (see the duplicate stream output) */
+            block_t *p_next = output->p_next;
+            output = block_Unshare( output );
+            if( unlikely(!output ) )
+            {
+                block_ChainRelease( p_next );
+                return VLC_ENOMEM;
+            }
+
             if( p_sys->stuffing_size )
             {
                 output = block_Realloc( output, p_sys->stuffing_size, output->i_buffer );
@@ -1006,18 +1224,177 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
 }
 
 /*****************************************************************************
- * Write: standard write on a file descriptor.
+ * writeInitSegment: replace the CMAF initialization segment
  *****************************************************************************/
-static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+static int writeInitSegment( sout_access_out_t *p_access, block_t *p_header )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    char *psz_tmp;
+    int ret = -1;
+
+    if ( asprintf( &psz_tmp, "%s.tmp", p_sys->psz_initPath ) < 0 )
+    {
+        block_Release( p_header );
+        return -1;
+    }
+
+    int fd = vlc_open( psz_tmp, O_WRONLY | O_CREAT | O_LARGEFILE | O_TRUNC, 0666 );
+    if ( fd == -1 )
+    {
+        msg_Err( p_access, "cannot open `%s' (%s)", psz_tmp,
+                 vlc_strerror_c(errno) );
+        goto out;
+    }
+
+    while( p_header->i_buffer > 0 )
+    {
+        ssize_t val = vlc_write( fd, p_header->p_buffer, p_header->i_buffer );
+        if ( val == -1 )
+        {
+            if ( errno == EINTR )
+                continue;
+            break;
+        }
+        p_header->p_buffer += val;
+        p_header->i_buffer -= val;
+    }
+    vlc_close( fd );
+
+    /* The players never see a partial initialization segment */
+    if ( p_header->i_buffer > 0 || vlc_rename( psz_tmp, p_sys->psz_initPath ) < 0 )
+    {
+        msg_Err( p_access, "cannot write initialization segment `%s'",
+                 p_sys->psz_initPath );
+        vlc_unlink( psz_tmp );
+    }
+    else
+    {
+        p_sys->b_init_written = true;
+        ret = 0;
+    }
+out:
+    free( psz_tmp );
+    block_Release( p_header );
+    return ret;
+}
+
+/*****************************************************************************
+ * writePart: write the ongoing blocks as a partial segment
+ *****************************************************************************/
+static ssize_t writePart( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys )
+{
+    output_segment_t *segment = vlc_array_item_at_index( &p_sys->segments_t, vlc_array_count( &p_sys->segments_t ) - 1 );
+    output_part_t *parts = realloc( segment->p_parts,
+                                    ( segment->i_parts + 1 ) * sizeof( *parts ) );
+    if( unlikely( !parts ) )
+        return -1;
+    segment->p_parts = parts;
+
+    output_part_t *part = &parts[segment->i_parts];
+    block_ChainProperties( p_sys->ongoing_segment, NULL, NULL, &part->length );
+    part->i_offset = segment->i_size;
+    part->b_independent = p_sys->b_part_independent;
+
+    block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
+    p_sys->ongoing_segment = NULL;
+    p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
+
+    ssize_t i_write = writeSegment( p_access );
+    if( i_write < 0 )
+        return i_write;
+
+    part->i_size = i_write;
+    segment->i_size += i_write;
+    segment->i_parts++;
+
+    /* The fragments of the muxer can be longer than the asked parts */
+    if( part->length > p_sys->part_target )
+        p_sys->part_target = part->length;
+    return i_write;
+}
+
+/*****************************************************************************
+ * writePartBlock: low-latency write, publishing the segments by parts
+ *****************************************************************************/
+static ssize_t writePartBlock( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    ssize_t i_write = 0;
+    bool b_split = p_sys->b_splitanywhere || ( p_buffer->i_flags & p_sys->i_split_flags );
+
+    /* The fragmented MP4 parts are whole fragments */
+    if( p_sys->ongoing_segment && ( b_split || !p_sys->b_cmaf ) )
+    {
+        vlc_tick_t ongoing_length = 0;
+        block_ChainProperties( p_sys->ongoing_segment, NULL, NULL, &ongoing_length );
+
+        bool b_end = b_split &&
+            p_buffer->i_length + p_sys->current_segment_length + ongoing_length >= p_sys->segment_max_length;
+        if( b_end || p_buffer->i_length + ongoing_length > p_sys->part_max_length )
+        {
+            i_write = writePart( p_access, p_sys );
+            if( unlikely( i_write < 0 ) )
+            {
+                block_Release( p_buffer );
+                return -1;
+            }
+            if( b_end )
+                closeCurrentSegment( p_access, p_sys, false );
+            else
+                updateIndexAndDel( p_access, p_sys, false );
+        }
+    }
+
+    if ( p_sys->i_handle < 0 && openNextFile( p_access, p_sys ) < 0 )
+    {
+        block_Release( p_buffer );
+        return -1;
+    }
+
+    if( !p_sys->ongoing_segment )
+        p_sys->b_part_independent = b_split;
+    block_ChainLastAppend( &p_sys->ongoing_segment_end, p_buffer );
+    return i_write;
+}
+
+/*****************************************************************************
+ * WriteBlocks: segment the blocks, and write them on a file descriptor.
+ *****************************************************************************/
+static ssize_t WriteBlocks( sout_access_out_t *p_access, block_t *p_buffer )
 {
     size_t i_write = 0;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
     while( p_buffer )
     {
+        if( p_sys->b_cmaf && ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) )
+        {
+            block_t *p_temp = p_buffer->p_next;
+            p_buffer->p_next = NULL;
+            writeInitSegment( p_access, p_buffer );
+            p_buffer = p_temp;
+            continue;
+        }
+
+        if( p_sys->part_max_length )
+        {
+            block_t *p_temp = p_buffer->p_next;
+            p_buffer->p_next = NULL;
+            ssize_t ret = writePartBlock( p_access, p_buffer );
+            if( ret < 0 )
+            {
+                msg_Err( p_access, "Error in write loop");
+                block_ChainRelease( p_temp );
+                return ret;
+            }
+            i_write += ret;
+            p_buffer = p_temp;
+            continue;
+        }
+
         /* Check if current block is already past segment-length
             and we want to write gathered blocks into segment
             and update playlist */
-        if( p_sys->ongoing_segment && ( p_sys->b_splitanywhere  || ( p_buffer->i_flags & BLOCK_FLAG_HEADER ) ) )
+        if( p_sys->ongoing_segment && ( p_sys->b_splitanywhere  || ( p_buffer->i_flags & p_sys->i_split_flags ) ) )
         {
             msg_Dbg( p_access, "Moving ongoing segment to full segments-queue" );
             block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
@@ -1042,3 +1419,70 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
     return i_write;
 }
+
+/*****************************************************************************
+ * WriterThread: write the segments and the index in the background
+ *****************************************************************************/
+static void *WriterThread( void *data )
+{
+    sout_access_out_t *p_access = data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    vlc_thread_set_name( "vlc-livehttp" );
+
+    vlc_fifo_Lock( p_sys->fifo );
+    for( ;; )
+    {
+        while( vlc_fifo_IsEmpty( p_sys->fifo ) && !p_sys->b_closing )
+            vlc_fifo_Wait( p_sys->fifo );
+
+        block_t *p_buffer = vlc_fifo_DequeueAllUnlocked( p_sys->fifo );
+        if( p_buffer == NULL )
+            break; /* closing */
+        vlc_cond_signal( &p_sys->drained );
+        bool b_error = p_sys->b_write_error;
+        vlc_fifo_Unlock( p_sys->fifo );
+
+        if( b_error )
+            block_ChainRelease( p_buffer );
+        else if( WriteBlocks( p_access, p_buffer ) < 0 )
+            b_error = true;
+
+        vlc_fifo_Lock( p_sys->fifo );
+        if( b_error && !p_sys->b_write_error )
+        {
+            /* Fail the next Write(), rather than the muxer waiting forever */
+            p_sys->b_write_error = true;
+            vlc_cond_signal( &p_sys->drained );
+        }
+    }
+    vlc_fifo_Unlock( p_sys->fifo );
+    return NULL;
+}
+
+/*****************************************************************************
+ * Write: queue the blocks for the writer thread
+ *****************************************************************************/
+static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    size_t i_size;
+
+    block_ChainProperties( p_buffer, NULL, &i_size, NULL );
+
+    /* Bound the queue, so that the muxer slows down to the storage */
+    vlc_fifo_Lock( p_sys->fifo );
+    while( vlc_fifo_GetBytes( p_sys->fifo ) >= MAX_QUEUED_BYTES
+        && !p_sys->b_write_error )
+        vlc_fifo_WaitCond( p_sys->fifo, &p_sys->drained );
+
+    if( p_sys->b_write_error )
+    {
+        vlc_fifo_Unlock( p_sys->fifo );
+        block_ChainRelease( p_buffer );
+        return -1;
+    }
+    vlc_fifo_QueueUnlocked( p_sys->fifo, p_buffer );
+    vlc_fifo_Unlock( p_sys->fifo );
+    return i_size;
+}
@@ -49,6 +49,24 @@ typedef struct
     int channel_map[AOUT_CHAN_MAX];
 } filter_sys_t;
 
+static block_t *UpmixNew( filter_t *p_filter, block_t *p_in_buf,
+                          unsigned i_output_nb )
+{
+    block_t *p_out_buf = filter_NewAudioBuffer( p_filter,
+                    p_in_buf->i_nb_samples * i_output_nb * sizeof(float) );
+    if( unlikely(p_out_buf == NULL) )
+    {
+        block_Release( p_in_buf );
+        return NULL;
+    }
+
+    p_out_buf->i_nb_samples = p_in_buf->i_nb_samples;
+    p_out_buf->i_dts        = p_in_buf->i_dts;
+    p_out_buf->i_pts        = p_in_buf->i_pts;
+    p_out_buf->i_length     = p_in_buf->i_length;
+    return p_out_buf;
+}
+
 /**
  * Trivially upmixes
  */
@@ -59,18 +77,9 @@ static block_t *Upmix( filter_t *p_filter, block_t *p_in_buf )
 
     assert( i_input_nb < i_output_nb );
 
-    block_t *p_out_buf = block_Alloc(
-                              p_in_buf->i_buffer * i_output_nb / i_input_nb );
+    block_t *p_out_buf = UpmixNew( p_filter, p_in_buf, i_output_nb );
     if( unlikely(p_out_buf == NULL) )
-    {
-        block_Release( p_in_buf );
         return NULL;
-    }
-
-    p_out_buf->i_nb_samples = p_in_buf->i_nb_samples;
-    p_out_buf->i_dts        = p_in_buf->i_dts;
-    p_out_buf->i_pts        = p_in_buf->i_pts;
-    p_out_buf->i_length     = p_in_buf->i_length;
 
     filter_sys_t *p_sys = p_filter->p_sys;
 
@@ -91,6 +100,41 @@ static block_t *Upmix( filter_t *p_filter, block_t *p_in_buf )
     return p_out_buf;
 }
 
+/**
+ * Trivially upmixes signed 16-bits samples, converting them to float on the
+ * fly. This fuses the pre-mix format conversion into the mixing pass.
+ */
+static block_t *UpmixS16( filter_t *p_filter, block_t *p_in_buf )
+{
+    unsigned i_input_nb = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    unsigned i_output_nb = aout_FormatNbChannels( &p_filter->fmt_out.audio );
+
+    assert( i_input_nb < i_output_nb );
+
+    block_t *p_out_buf = UpmixNew( p_filter, p_in_buf, i_output_nb );
+    if( unlikely(p_out_buf == NULL) )
+        return NULL;
+
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const int16_t *p_src = (int16_t *)p_in_buf->p_buffer;
+    const int *channel_map = p_sys->channel_map;
+
+    for( size_t i = 0; i < p_in_buf->i_nb_samples; i++ )
+    {
+        for( unsigned j = 0; j < i_output_nb; j++ )
+            p_dest[j] = channel_map[j] == -1 ? 0.f
+                      : p_src[channel_map[j]] * (1.f / 32768.f);
+
+        p_src += i_input_nb;
+        p_dest += i_output_nb;
+    }
+
+    block_Release( p_in_buf );
+    return p_out_buf;
+}
+
 /**
  * Trivially downmixes (i.e. drop extra channels)
  */
@@ -136,7 +180,7 @@ static block_t *Extract( filter_t *p_filter, block_t *p_in_buf )
                       * p_filter->fmt_out.audio.i_bitspersample
                       * i_out_channels / 8;
 
-    block_t *p_out_buf = block_Alloc( i_out_size );
+    block_t *p_out_buf = filter_NewAudioBuffer( p_filter, i_out_size );
     if( unlikely(p_out_buf == NULL) )
     {
         block_Release( p_in_buf );
@@ -181,12 +225,17 @@ static int Create( vlc_object_t *p_this )
     static const struct vlc_filter_operations upmix_filter_ops =
         { .filter_audio = Upmix };
 
+    static const struct vlc_filter_operations upmix_s16_filter_ops =
+        { .filter_audio = UpmixS16 };
+
     static const struct vlc_filter_operations downmix_filter_ops =
         { .filter_audio = Downmix };
 
     if( infmt->i_physical_channels == 0 )
     {
         assert( infmt->i_channels > 0 );
+        if( infmt->i_format != outfmt->i_format )
+            return VLC_EGENERIC;
         if( outfmt->i_physical_channels == 0 )
             return VLC_EGENERIC;
         if( aout_FormatNbChannels( outfmt ) == infmt->i_channels )
@@ -204,9 +253,16 @@ static int Create( vlc_object_t *p_this )
         }
     }
 
-    if( infmt->i_format != outfmt->i_format
-     || infmt->i_rate != outfmt->i_rate
-     || infmt->i_format != VLC_CODEC_FL32 )
+    if( outfmt->i_format != VLC_CODEC_FL32
+     || infmt->i_rate != outfmt->i_rate )
+        return VLC_EGENERIC;
+
+    /* Signed 16-bits input can be converted while upmixing. Downmixing is
+     * left to better mixers, and requires float input. */
+    const bool b_s16 = infmt->i_format == VLC_CODEC_S16N;
+    if( infmt->i_format != VLC_CODEC_FL32
+     && ( !b_s16 || infmt->i_chan_mode != outfmt->i_chan_mode
+       || aout_FormatNbChannels( outfmt ) <= aout_FormatNbChannels( infmt ) ) )
         return VLC_EGENERIC;
 
     /* trivial is the lowest priority converter: if chan_mode are different
@@ -314,7 +370,9 @@ static int Create( vlc_object_t *p_this )
     p_filter->p_sys = p_sys;
     memcpy( p_sys->channel_map, channel_map, sizeof(channel_map) );
 
-    if( aout_FormatNbChannels( outfmt ) > aout_FormatNbChannels( infmt ) )
+    if( b_s16 )
+        p_filter->ops = &upmix_s16_filter_ops;
+    else if( aout_FormatNbChannels( outfmt ) > aout_FormatNbChannels( infmt ) )
         p_filter->ops = &upmix_filter_ops;
     else
         p_filter->ops = &downmix_filter_ops;
@@ -0,0 +1,654 @@
+/*****************************************************************************
+ * polyphase.c : built-in polyphase FIR resampler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Kaiser-windowed sinc interpolation from a table of polyphase sub-filters.
+ * Coefficients for an arbitrary fractional position are linearly interpolated
+ * between the two nearest phases, so that any ratio is supported and ratio
+ * changes (clock drift compensation) only update the phase increment.
+ *
+ * Input samples are kept de-interleaved, so that each output sample is a
+ * contiguous dot product, computed with SIMD where available.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_block.h>
+#include <vlc_cpu.h>
+
+#if defined (__SSE__)
+# include <xmmintrin.h>
+#endif
+#if defined (CAN_COMPILE_AVX)
+# include <immintrin.h>
+#endif
+#if defined (__ARM_NEON)
+# include <arm_neon.h>
+#endif
+
+#define QUALITY_TEXT N_("Resampling quality")
+#define QUALITY_LONGTEXT N_("Resampling quality, from fastest to best. " \
+    "Higher quality uses longer filters.")
+
+static const int quality_values[] = { 0, 1, 2 };
+static const char *const quality_texts[] = {
+    N_("Low"), N_("Medium"), N_("High"),
+};
+
+static int Open(vlc_object_t *);
+static int OpenResampler(vlc_object_t *);
+
+vlc_module_begin()
+    set_shortname(N_("Polyphase"))
+    set_description(N_("Polyphase FIR audio resampler"))
+    set_subcategory(SUBCAT_AUDIO_RESAMPLER)
+    add_integer("polyphase-resampler-quality", 1,
+                QUALITY_TEXT, QUALITY_LONGTEXT)
+        change_integer_list(quality_values, quality_texts)
+    set_capability("audio converter", 30)
+    set_callback(Open)
+
+    add_submodule()
+    set_capability("audio resampler", 30)
+    set_callback(OpenResampler)
+    add_shortcut("polyphase")
+vlc_module_end()
+
+static const struct
+{
+    unsigned taps; /**< Filter length at unity ratio, multiple of 8 */
+    unsigned phases; /**< Number of tabulated sub-filters */
+    float rolloff; /**< Pass-band edge, relative to the Nyquist frequency */
+    float beta; /**< Kaiser window parameter */
+} qualities[] = {
+    { 16,  64, 0.80f,  5.0f },
+    { 32, 128, 0.90f,  7.5f },
+    { 64, 256, 0.94f, 10.0f },
+};
+
+#define FRAC_BITS 32
+#define FRAC_ONE  (UINT64_C(1) << FRAC_BITS)
+
+typedef float (*dot_t)(const float *, const float *, unsigned);
+
+typedef struct
+{
+    unsigned quality;
+    unsigned channels;
+
+    /* Filter bank */
+    float *table; /**< (phases + 1) rows of taps coefficients */
+    float *coeffs; /**< Interpolated coefficients for one output sample */
+    unsigned taps;
+    unsigned phases;
+    float cutoff;
+    dot_t dot;
+
+    /* De-interleaved input history, one buffer per channel */
+    float *history[AOUT_CHAN_MAX];
+    size_t capacity; /**< Frames allocated per channel */
+    size_t avail; /**< Frames available per channel */
+
+    uint64_t pos; /**< Position of the next output frame (32.32) */
+    unsigned in_rate; /**< Rate the increment was computed for */
+    uint64_t step; /**< Position increment per output frame (32.32) */
+
+    vlc_tick_t next_pts; /**< Expected date of the next output frame */
+} filter_sys_t;
+
+/*****************************************************************************
+ * Dot products
+ *****************************************************************************/
+#if !defined (__SSE__) && !defined (__ARM_NEON)
+static float DotC(const float *restrict a, const float *restrict b,
+                  unsigned n)
+{
+    float s0 = 0.f, s1 = 0.f, s2 = 0.f, s3 = 0.f;
+
+    assert((n % 4) == 0);
+    for (unsigned i = 0; i < n; i += 4)
+    {
+        s0 += a[i + 0] * b[i + 0];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+#endif
+
+#if defined (__SSE__)
+static float DotSSE(const float *a, const float *b, unsigned n)
+{
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+
+    assert((n % 8) == 0);
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                       _mm_loadu_ps(b + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                       _mm_loadu_ps(b + i + 4)));
+    }
+    s0 = _mm_add_ps(s0, s1);
+    s0 = _mm_add_ps(s0, _mm_movehl_ps(s0, s0));
+    s0 = _mm_add_ss(s0, _mm_shuffle_ps(s0, s0, 1));
+    return _mm_cvtss_f32(s0);
+}
+#endif
+
+#if defined (CAN_COMPILE_AVX)
+VLC_AVX
+static float DotAVX(const float *a, const float *b, unsigned n)
+{
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    unsigned i = 0;
+
+    assert((n % 8) == 0);
+    for (; i + 16 <= n; i += 16)
+    {
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                             _mm256_loadu_ps(b + i)));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8),
+                                             _mm256_loadu_ps(b + i + 8)));
+    }
+    if (i < n)
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                             _mm256_loadu_ps(b + i)));
+    s0 = _mm256_add_ps(s0, s1);
+
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(s0),
+                          _mm256_extractf128_ps(s0, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+#if defined (__ARM_NEON)
+static float DotNEON(const float *a, const float *b, unsigned n)
+{
+    float32x4_t s0 = vdupq_n_f32(0.f), s1 = vdupq_n_f32(0.f);
+
+    assert((n % 8) == 0);
+    for (unsigned i = 0; i < n; i += 8)
+    {
+        s0 = vmlaq_f32(s0, vld1q_f32(a + i), vld1q_f32(b + i));
+        s1 = vmlaq_f32(s1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    s0 = vaddq_f32(s0, s1);
+
+    float32x2_t s = vadd_f32(vget_low_f32(s0), vget_high_f32(s0));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+#endif
+
+static dot_t GetDot(void)
+{
+#if defined (CAN_COMPILE_AVX)
+    if (vlc_CPU_AVX())
+        return DotAVX;
+#endif
+#if defined (__SSE__)
+    return DotSSE;
+#elif defined (__ARM_NEON)
+    return DotNEON;
+#else
+    return DotC;
+#endif
+}
+
+/*****************************************************************************
+ * Filter bank
+ *****************************************************************************/
+/* Zeroth order modified Bessel function of the first kind */
+static double BesselI0(double x)
+{
+    double sum = 1., term = 1., half = x / 2.;
+
+    for (unsigned k = 1; k < 64 && term > sum * 1e-12; k++)
+    {
+        term *= (half / k) * (half / k);
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * Computes the filter bank for a given cut-off frequency.
+ * Down-sampling lowers the cut-off and stretches the filter accordingly, so
+ * that the quality relative to the output rate is preserved.
+ */
+static int BuildTable(filter_t *filter, float cutoff)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned phases = qualities[sys->quality].phases;
+    const double beta = qualities[sys->quality].beta;
+
+    unsigned taps = ceilf(qualities[sys->quality].taps / cutoff);
+    taps = (taps + 7) & ~7u;
+
+    float *table = vlc_alloc((phases + 1) * taps, sizeof (*table));
+    float *coeffs = vlc_alloc(taps, sizeof (*coeffs));
+    if (unlikely(table == NULL || coeffs == NULL))
+    {
+        free(table);
+        free(coeffs);
+        return VLC_ENOMEM;
+    }
+
+    const double half = taps / 2.;
+    const double norm = BesselI0(beta);
+
+    for (unsigned p = 0; p <= phases; p++)
+    {
+        float *row = table + p * taps;
+        const double frac = p / (double)phases;
+        double sum = 0.;
+
+        for (unsigned k = 0; k < taps; k++)
+        {
+            /* Distance from the interpolated position to the k-th tap */
+            double d = k - (half - 1.) - frac;
+            double x = cutoff * d * M_PI;
+            double h = (x != 0.) ? sin(x) / x : 1.;
+            double w = d / half;
+
+            w = (w > -1. && w < 1.) ? BesselI0(beta * sqrt(1. - w * w)) / norm
+                                    : 0.;
+            row[k] = h * w;
+            sum += row[k];
+        }
+        /* Unity gain at DC for every phase */
+        for (unsigned k = 0; k < taps; k++)
+            row[k] /= sum;
+    }
+
+    /* The filter bank and its length are only replaced once the history
+     * fits the new length, so that they always match */
+    if (taps != sys->taps)
+    {
+        /* Keep the position aligned with the new filter length: the history
+         * must hold at least taps/2 - 1 frames before the next output. */
+        const size_t lead = taps / 2 - 1;
+        const size_t n = sys->pos >> FRAC_BITS;
+
+        if (n < lead)
+        {
+            const size_t pad = lead - n;
+
+            if (sys->avail + pad > sys->capacity)
+            {
+                for (unsigned c = 0; c < sys->channels; c++)
+                {
+                    float *h = realloc(sys->history[c], (sys->avail + pad)
+                                                        * sizeof (float));
+                    if (unlikely(h == NULL))
+                    {
+                        free(table);
+                        free(coeffs);
+                        return VLC_ENOMEM;
+                    }
+                    sys->history[c] = h;
+                }
+                sys->capacity = sys->avail + pad;
+            }
+            for (unsigned c = 0; c < sys->channels; c++)
+            {
+                memmove(sys->history[c] + pad, sys->history[c],
+                        sys->avail * sizeof (float));
+                memset(sys->history[c], 0, pad * sizeof (float));
+            }
+            sys->avail += pad;
+            sys->pos += (uint64_t)pad << FRAC_BITS;
+        }
+    }
+
+    free(sys->table);
+    free(sys->coeffs);
+    sys->table = table;
+    sys->coeffs = coeffs;
+    sys->taps = taps;
+    sys->cutoff = cutoff;
+    sys->phases = phases;
+
+    msg_Dbg(filter, "filter bank: %u phases of %u taps, cut-off %.3f",
+            phases, taps, cutoff);
+    return VLC_SUCCESS;
+}
+
+/**
+ * Updates the phase increment from the current input rate.
+ * This is called for every block, as the owner adjusts the input rate to
+ * compensate for clock drift and to change the playback rate.
+ */
+static int UpdateRatio(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const unsigned in_rate = filter->fmt_in.audio.i_rate;
+    const unsigned out_rate = filter->fmt_out.audio.i_rate;
+
+    if (likely(in_rate == sys->in_rate))
+        return VLC_SUCCESS;
+
+    sys->in_rate = in_rate;
+    sys->step = ((uint64_t)in_rate << FRAC_BITS) / out_rate;
+
+    /* Only rebuild the filter bank if the anti-aliasing cut-off moved
+     * significantly. Small drift corrections reuse the existing table. */
+    float cutoff = qualities[sys->quality].rolloff;
+    if (in_rate > out_rate)
+        cutoff *= out_rate / (float)in_rate;
+
+    if (sys->table != NULL && fabsf(cutoff - sys->cutoff) < .02f * cutoff)
+        return VLC_SUCCESS;
+
+    int ret = BuildTable(filter, cutoff);
+    if (unlikely(ret != VLC_SUCCESS))
+        sys->in_rate = 0; /* try again with the next block */
+    return ret;
+}
+
+static void Reset(filter_sys_t *sys)
+{
+    const size_t lead = sys->taps / 2 - 1;
+
+    for (unsigned c = 0; c < sys->channels; c++)
+        memset(sys->history[c], 0, lead * sizeof (float));
+    sys->avail = lead;
+    sys->pos = (uint64_t)lead << FRAC_BITS;
+    sys->next_pts = VLC_TICK_INVALID;
+}
+
+/*****************************************************************************
+ * Processing
+ *****************************************************************************/
+static int Append(filter_sys_t *sys, const float *in, size_t frames)
+{
+    if (sys->avail + frames > sys->capacity)
+    {
+        size_t capacity = sys->avail + frames + sys->taps;
+
+        for (unsigned c = 0; c < sys->channels; c++)
+        {
+            float *h = realloc(sys->history[c], capacity * sizeof (float));
+            if (unlikely(h == NULL))
+                return VLC_ENOMEM;
+            sys->history[c] = h;
+        }
+        sys->capacity = capacity;
+    }
+
+    const unsigned channels = sys->channels;
+    for (unsigned c = 0; c < channels; c++)
+    {
+        float *restrict dst = sys->history[c] + sys->avail;
+        const float *restrict src = in + c;
+
+        for (size_t i = 0; i < frames; i++)
+            dst[i] = src[i * channels];
+    }
+    sys->avail += frames;
+    return VLC_SUCCESS;
+}
+
+static size_t Convolve(filter_sys_t *sys, float *restrict out, size_t max)
+{
+    const unsigned channels = sys->channels;
+    const unsigned taps = sys->taps;
+    const unsigned phases = sys->phases;
+    const size_t lead = taps / 2 - 1;
+    size_t count = 0;
+
+    if (sys->step == FRAC_ONE && (uint32_t)sys->pos == 0)
+    {   /* Unity ratio at an integer position: plain copy */
+        for (; count < max; count++)
+        {
+            const size_t n = sys->pos >> FRAC_BITS;
+
+            if (n + taps / 2 >= sys->avail)
+                break;
+            for (unsigned c = 0; c < channels; c++)
+                *(out++) = sys->history[c][n];
+            sys->pos += FRAC_ONE;
+        }
+        return count;
+    }
+
+    for (; count < max; count++)
+    {
+        const size_t n = sys->pos >> FRAC_BITS;
+
+        if (n + taps / 2 >= sys->avail)
+            break;
+
+        /* Interpolate the coefficients between the two nearest phases */
+        const uint64_t scaled = (uint64_t)(uint32_t)sys->pos * phases;
+        const unsigned phase = scaled >> FRAC_BITS;
+        const float a = (uint32_t)scaled * (1.f / FRAC_ONE);
+        const float *restrict r0 = sys->table + phase * taps;
+        const float *restrict r1 = r0 + taps;
+        float *restrict coeffs = sys->coeffs;
+
+        for (unsigned k = 0; k < taps; k++)
+            coeffs[k] = r0[k] + a * (r1[k] - r0[k]);
+
+        for (unsigned c = 0; c < channels; c++)
+            *(out++) = sys->dot(sys->history[c] + n - lead, coeffs, taps);
+        sys->pos += sys->step;
+    }
+    return count;
+}
+
+/** Drops input frames that are no longer needed */
+static void Consume(filter_sys_t *sys)
+{
+    const size_t lead = sys->taps / 2 - 1;
+    const size_t n = sys->pos >> FRAC_BITS;
+
+    if (n <= lead)
+        return;
+
+    size_t drop = n - lead;
+    if (drop > sys->avail)
+        drop = sys->avail;
+
+    for (unsigned c = 0; c < sys->channels; c++)
+        memmove(sys->history[c], sys->history[c] + drop,
+                (sys->avail - drop) * sizeof (float));
+    sys->avail -= drop;
+    sys->pos -= (uint64_t)drop << FRAC_BITS;
+}
+
+static block_t *Process(filter_t *filter, const float *in, size_t frames,
+                        vlc_tick_t pts)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const size_t framesize = filter->fmt_out.audio.i_bytes_per_frame;
+    const size_t start = sys->avail;
+
+    if (Append(sys, in, frames))
+        return NULL;
+
+    /* Upper bound of the number of output frames */
+    const size_t usable = sys->avail > sys->taps / 2 ?
+                          sys->avail - sys->taps / 2 : 0;
+    const uint64_t end = (uint64_t)usable << FRAC_BITS;
+    size_t max = end > sys->pos ? (end - sys->pos) / sys->step + 1 : 0;
+    if (max == 0)
+        return NULL;
+
+    block_t *out = filter_NewAudioBuffer(filter, max * framesize);
+    if (unlikely(out == NULL))
+        return NULL;
+
+    /* Date the first output frame from its position relative to the first
+     * frame of the input block. */
+    if (pts != VLC_TICK_INVALID)
+    {
+        double delay = (double)(int64_t)(((uint64_t)start << FRAC_BITS)
+                                         - sys->pos) / FRAC_ONE;
+        out->i_pts = pts - vlc_tick_from_sec(delay / sys->in_rate);
+    }
+    else
+        out->i_pts = sys->next_pts;
+
+    size_t count = Convolve(sys, (float *)out->p_buffer, max);
+    Consume(sys);
+
+    out->i_nb_samples = count;
+    out->i_buffer = count * framesize;
+    out->i_length = vlc_tick_from_samples(count, filter->fmt_out.audio.i_rate);
+    out->i_dts = out->i_pts;
+    if (out->i_pts != VLC_TICK_INVALID)
+        sys->next_pts = out->i_pts + out->i_length;
+    return out;
+}
+
+static block_t *Resample(filter_t *filter, block_t *in)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    if (in->i_flags & BLOCK_FLAG_DISCONTINUITY)
+        Reset(sys);
+
+    block_t *out = NULL;
+    if (UpdateRatio(filter) == VLC_SUCCESS)
+    {
+        out = Process(filter, (const float *)in->p_buffer, in->i_nb_samples,
+                      in->i_pts);
+        if (out != NULL)
+            out->i_flags = in->i_flags;
+    }
+    block_Release(in);
+    return out;
+}
+
+static block_t *Drain(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+    const size_t pad = sys->taps / 2;
+
+    if (sys->avail <= sys->taps / 2 - 1)
+        return NULL;
+
+    /* Flush the tail of the input through the filter with silence */
+    float *zero = calloc(pad * sys->channels, sizeof (float));
+    if (unlikely(zero == NULL))
+        return NULL;
+
+    block_t *out = Process(filter, zero, pad, VLC_TICK_INVALID);
+    free(zero);
+    Reset(sys);
+    return out;
+}
+
+static void Flush(filter_t *filter)
+{
+    Reset(filter->p_sys);
+}
+
+static void Close(filter_t *filter)
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    for (unsigned c = 0; c < sys->channels; c++)
+        free(sys->history[c]);
+    free(sys->table);
+    free(sys->coeffs);
+    free(sys);
+}
+
+static int OpenResampler(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Cannot convert format */
+    if (filter->fmt_in.audio.i_format != VLC_CODEC_FL32
+     || filter->fmt_out.audio.i_format != VLC_CODEC_FL32
+    /* Cannot remix */
+     || filter->fmt_in.audio.i_channels != filter->fmt_out.audio.i_channels
+     || filter->fmt_in.audio.i_physical_channels == 0
+     || filter->fmt_in.audio.i_channels > AOUT_CHAN_MAX)
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    unsigned quality = var_InheritInteger(obj, "polyphase-resampler-quality");
+    if (quality >= ARRAY_SIZE(qualities))
+        quality = 1;
+
+    sys->quality = quality;
+    sys->channels = filter->fmt_in.audio.i_channels;
+    sys->table = NULL;
+    sys->coeffs = NULL;
+    sys->taps = 2;
+    sys->dot = GetDot();
+    sys->capacity = 0;
+    sys->avail = 0;
+    sys->pos = 0;
+    sys->in_rate = 0;
+    for (unsigned c = 0; c < AOUT_CHAN_MAX; c++)
+        sys->history[c] = NULL;
+    filter->p_sys = sys;
+
+    if (UpdateRatio(filter))
+    {
+        Close(filter);
+        return VLC_ENOMEM;
+    }
+    Reset(sys);
+
+    static const struct vlc_filter_operations filter_ops = {
+        .filter_audio = Resample,
+        .drain_audio = Drain,
+        .flush = Flush,
+        .close = Close,
+    };
+    filter->ops = &filter_ops;
+
+    msg_Dbg(filter, "%u Hz -> %u Hz, %u channel(s), %s quality",
+            filter->fmt_in.audio.i_rate, filter->fmt_out.audio.i_rate,
+            sys->channels, quality_texts[quality]);
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+
+    /* Will change rate */
+    if (filter->fmt_in.audio.i_rate == filter->fmt_out.audio.i_rate)
+        return VLC_EGENERIC;
+    return OpenResampler(obj);
+}
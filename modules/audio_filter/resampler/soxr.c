@@ -251,7 +251,7 @@ SoXR_Resample( filter_t *p_filter, soxr_t soxr, block_t *p_in, size_t i_olen )
     }
     else
     {
-        p_out = block_Alloc( i_olen * i_oframesize );
+        p_out = filter_NewAudioBuffer( p_filter, i_olen * i_oframesize );
         if( p_out == NULL )
             goto error;
     }
@@ -543,6 +543,14 @@ int InitVideoEnc( vlc_object_t *p_this )
 
         if( p_sys->i_key_int > 0 )
             p_context->gop_size = p_sys->i_key_int;
+        if( p_enc->i_iframes > 0 )
+        {
+            /* Fixed closed GOP requested by the owner, without scene change
+             * detection (required along the closed GOP flag) */
+            p_context->gop_size = p_context->keyint_min = p_enc->i_iframes;
+            p_context->flags |= AV_CODEC_FLAG_CLOSED_GOP;
+            add_av_option_int( p_enc, &options, "sc_threshold", 1000000000 );
+        }
         p_context->max_b_frames =
             VLC_CLIP( p_sys->i_b_frames, 0, FF_MAX_B_FRAMES );
         if( !p_context->max_b_frames  &&
@@ -1327,6 +1327,16 @@ static int  Open ( vlc_object_t *p_this )
     /* We don't want repeated headers, we repeat p_extra ourself if needed */
     p_sys->param.b_repeat_headers = 0;
 
+    /* Fixed closed GOP requested by the owner, e.g. to align the key frames
+     * of several renditions of the same pictures */
+    if( p_enc->i_iframes > 0 )
+    {
+        p_sys->param.i_keyint_max = p_enc->i_iframes;
+        p_sys->param.i_keyint_min = p_enc->i_iframes;
+        p_sys->param.i_scenecut_threshold = 0;
+        p_sys->param.b_open_gop = 0;
+    }
+
     char *psz_opts = var_InheritString( p_enc, SOUT_CFG_PREFIX "options" );
     if (psz_opts && *psz_opts) {
         config_chain_t *cfg = NULL;
@@ -49,6 +49,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("AIFF demuxer" ) )
     set_capability( "demux", 10 )
+    add_signature( 0, "464F524D????????41494646" )
     set_callback( Open )
     add_shortcut( "aiff" )
     add_file_extension("aiff")
@@ -59,6 +59,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("ASF/WMV demuxer") )
     set_capability( "demux", 200 )
+    add_signature( 0, "3026B2758E66CF11A6D900AA0062CE6C" )
     set_callbacks( Open, Close )
     add_shortcut( "asf", "wmv" )
     add_file_extension("asf")
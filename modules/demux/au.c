@@ -47,6 +47,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("AU demuxer") )
     set_capability( "demux", 10 )
+    add_signature( 0, "2E736E64" )
     set_callback( Open )
     add_shortcut( "au" )
     add_file_extension("au")
@@ -50,6 +50,7 @@ vlc_module_begin ()
 set_subcategory( SUBCAT_INPUT_DEMUX )
 set_description( N_( "CAF demuxer" ))
 set_capability( "demux", 140 )
+add_signature( 0, "63616666" )
 set_callbacks( Open, Close )
 add_shortcut( "caf" )
 vlc_module_end ()
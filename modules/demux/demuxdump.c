@@ -24,9 +24,15 @@
 # include "config.h"
 #endif
 
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_demux.h>
+#include <vlc_fs.h>
 #include <vlc_sout.h>
 
 #define ACCESS_TEXT N_("Dump module")
@@ -55,10 +61,50 @@ vlc_module_begin ()
 vlc_module_end ()
 
 #define DUMP_BLOCKSIZE  16384
+#define DUMP_RANGESIZE  (1 << 20)
+
+typedef struct
+{
+    sout_access_out_t *out;
+    int fd; /**< input file, if the stream reads it as is, or -1 */
+    uint64_t size;
+} demux_sys_t;
 
 static int Demux( demux_t * );
 static int Control( demux_t *, int,va_list );
 
+/**
+ * Opens the input file, to dump ranges of it without reading them.
+ *
+ * This is only possible if the stream reads the file as is, without stream
+ * filters changing its content.
+ */
+static int OpenInput( demux_t *p_demux, uint64_t *size )
+{
+    if( p_demux->psz_filepath == NULL
+     || vlc_stream_GetSize( p_demux->s, size ) || *size == 0 )
+        return -1;
+
+    int fd = vlc_open( p_demux->psz_filepath, O_RDONLY );
+    if( fd == -1 )
+        return -1;
+
+    struct stat st;
+    uint64_t offset = vlc_stream_Tell( p_demux->s );
+    const uint8_t *peek;
+    uint8_t buf[4096];
+    ssize_t len = vlc_stream_Peek( p_demux->s, &peek, sizeof (buf) );
+
+    if( fstat( fd, &st ) || !S_ISREG(st.st_mode)
+     || (uint64_t)st.st_size != *size || len <= 0
+     || pread( fd, buf, len, offset ) != len || memcmp( buf, peek, len ) )
+    {
+        vlc_close( fd );
+        return -1;
+    }
+    return fd;
+}
+
 /**
  * Initializes the raw dump pseudo-demuxer.
  */
@@ -89,16 +135,28 @@ static int Open( vlc_object_t * p_this )
         return VLC_EGENERIC;
     }
 
-    sout_access_out_t *out = sout_AccessOutNew( p_demux, access, path );
+    demux_sys_t *p_sys = vlc_obj_malloc( p_this, sizeof (*p_sys) );
+    if( unlikely(p_sys == NULL) )
+    {
+        free( path );
+        free( access );
+        return VLC_ENOMEM;
+    }
+
+    p_sys->out = sout_AccessOutNew( p_demux, access, path );
     free( path );
     free( access );
-    if( out == NULL )
+    if( p_sys->out == NULL )
     {
         msg_Err( p_demux, "cannot create output" );
         return VLC_EGENERIC;
     }
 
-    p_demux->p_sys = (void *)out;
+    p_sys->fd = OpenInput( p_demux, &p_sys->size );
+    if( p_sys->fd != -1 )
+        msg_Dbg( p_demux, "dumping file ranges" );
+
+    p_demux->p_sys = p_sys;
     p_demux->pf_demux = Demux;
     p_demux->pf_control = Control;
     return VLC_SUCCESS;
@@ -110,9 +168,11 @@ static int Open( vlc_object_t * p_this )
 static void Close( vlc_object_t *p_this )
 {
     demux_t *p_demux = (demux_t*)p_this;
-    sout_access_out_t *out = (void *)p_demux->p_sys;
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-    sout_AccessOutDelete( out );
+    sout_AccessOutDelete( p_sys->out );
+    if( p_sys->fd != -1 )
+        vlc_close( p_sys->fd );
 }
 
 /**
@@ -120,22 +180,42 @@ static void Close( vlc_object_t *p_this )
  */
 static int Demux( demux_t *p_demux )
 {
-    sout_access_out_t *out = (void *)p_demux->p_sys;
+    demux_sys_t *p_sys = p_demux->p_sys;
+    block_t *block = NULL;
+    uint64_t offset = vlc_stream_Tell( p_demux->s );
 
-    block_t *block = block_Alloc( DUMP_BLOCKSIZE );
-    if( unlikely(block == NULL) )
-        return -1;
+    /* The output copies the file range, if it can, instead of writing it */
+    if( p_sys->fd != -1 && offset < p_sys->size )
+    {
+        size_t length = __MIN(p_sys->size - offset, DUMP_RANGESIZE);
+
+        block = block_FileRange( p_sys->fd, offset, length );
+        if( block != NULL
+         && vlc_stream_Seek( p_demux->s, offset + length ) )
+        {
+            block_Release( block );
+            block = NULL;
+        }
+    }
 
-    int rd = vlc_stream_Read( p_demux->s, block->p_buffer, DUMP_BLOCKSIZE );
-    if ( rd <= 0 )
+    if( block == NULL )
     {
-        block_Release( block );
-        return rd;
+        block = block_Alloc( DUMP_BLOCKSIZE );
+        if( unlikely(block == NULL) )
+            return -1;
+
+        int rd = vlc_stream_Read( p_demux->s, block->p_buffer, DUMP_BLOCKSIZE );
+        if ( rd <= 0 )
+        {
+            block_Release( block );
+            return rd;
+        }
+        block->i_buffer = rd;
     }
-    block->i_buffer = rd;
 
-    size_t wr = sout_AccessOutWrite( out, block );
-    if( wr != (size_t)rd )
+    size_t len = block->i_buffer;
+    size_t wr = sout_AccessOutWrite( p_sys->out, block );
+    if( wr != len )
     {
         msg_Err( p_demux, "cannot write data" );
         return -1;
@@ -54,6 +54,7 @@ vlc_module_begin ()
     set_shortname( "Matroska" )
     set_description( N_("Matroska stream demuxer" ) )
     set_capability( "demux", 50 )
+    add_signature( 0, "1A45DFA3" )
     set_callbacks( Open, Close )
     set_subcategory( SUBCAT_INPUT_DEMUX )
 
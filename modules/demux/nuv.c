@@ -49,6 +49,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("Nuv demuxer") )
     set_capability( "demux", 145 )
+    add_signature( 0, "4D7974685456566964656F" )
+    add_signature( 0, "4E757070656C566964656F" )
     set_callbacks( Open, Close )
     add_shortcut( "nuv" )
 vlc_module_end ()
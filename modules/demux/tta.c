@@ -45,6 +45,7 @@ vlc_module_begin ()
     set_description( N_("TTA demuxer") )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 145 )
+    add_signature( 0, "54544131" )
 
     set_callbacks( Open, Close )
     add_shortcut( "tta" )
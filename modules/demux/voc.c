@@ -43,6 +43,7 @@ vlc_module_begin ()
     set_description( N_("VOC demuxer") )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 10 )
+    add_signature( 0, "437265617469766520566F6963652046696C651A" )
     set_callback( Open )
     add_file_extension("voc")
 vlc_module_end ()
@@ -720,5 +720,7 @@ vlc_module_begin ()
     set_description( N_("WAV demuxer") )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 142 )
+    add_signature( 0, "52494646????????57415645" )
+    add_signature( 0, "52463634????????57415645" )
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -42,6 +42,9 @@ vlc_module_begin ()
     set_description( N_("XA demuxer") )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 10 )
+    add_signature( 0, "58414900" )
+    add_signature( 0, "58414A00" )
+    add_signature( 0, "58410000" )
     set_callback( Open )
 vlc_module_end ()
 
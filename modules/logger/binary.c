@@ -0,0 +1,449 @@
+/*****************************************************************************
+ * binary.c: binary ring buffer tracer plugin
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Traces are emitted from real-time threads (audio and video outputs), so
+ * the tracing itself must not block nor take any lock. Each thread writes
+ * fixed-size records into its own single-producer single-consumer ring, and
+ * a background thread drains all the rings into a memory-mapped file.
+ *
+ * When a ring is full, the records are dropped and counted rather than
+ * waiting. Strings are truncated to fit in the records.
+ *
+ * extras/analyser/vlc-trace2json.py converts the file to the Chrome trace
+ * event format, which the Perfetto and Chrome trace viewers can load.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_list.h>
+#include <vlc_tracer.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define TRACE_FILENAME "vlc-trace.bin"
+
+#define TRACE_MAGIC "VLCTRACE"
+#define TRACE_VERSION 1
+
+#define TRACE_ENTRIES 6
+#define TRACE_KEY_SIZE 15
+#define TRACE_STRING_SIZE 24
+
+/* Records per thread ring (64 KiB) */
+#define RING_SIZE 256
+/* Size of the file mappings, a multiple of the record size */
+#define CHUNK_SIZE (4 << 20)
+#define DRAIN_PERIOD VLC_TICK_FROM_MS(20)
+
+/* File header, followed by the records */
+struct trace_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;    /**< 0x01020304 in the host byte order */
+    uint32_t record_size;
+    uint32_t entries;       /**< Entries per record */
+    uint32_t key_size;
+    uint32_t string_size;
+    uint32_t pid;
+    uint8_t reserved[220];
+};
+
+struct trace_entry
+{
+    char key[TRACE_KEY_SIZE];   /**< Not nul-terminated if it fills it */
+    uint8_t type;               /**< enum vlc_tracer_value */
+    union
+    {
+        int64_t integer;        /**< Integer, or tick in nanoseconds */
+        char string[TRACE_STRING_SIZE];
+    } value;
+};
+
+struct trace_record
+{
+    int64_t ts;                 /**< Timestamp in nanoseconds */
+    uint32_t thread;
+    uint32_t count;             /**< Number of used entries */
+    struct trace_entry entries[TRACE_ENTRIES];
+};
+
+static_assert(sizeof (struct trace_header) == 256, "Wrong header size");
+static_assert(sizeof (struct trace_record) == 256, "Wrong record size");
+static_assert(CHUNK_SIZE % sizeof (struct trace_record) == 0,
+              "Records must not cross mappings");
+
+struct trace_ring
+{
+    struct vlc_list node;
+    uint32_t thread;
+    atomic_bool orphan;         /**< The thread has exited */
+    atomic_size_t head;         /**< Written by the thread */
+    atomic_size_t tail;         /**< Written by the drain thread */
+    atomic_uint_least64_t dropped;
+    uint64_t reported;          /**< Drops already written to the file */
+    struct trace_record records[RING_SIZE];
+};
+
+typedef struct
+{
+    vlc_object_t *obj;
+    vlc_threadvar_t ring_key;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    struct vlc_list rings;
+    bool stop;
+
+    /* Owned by the drain thread */
+    int fd;
+    uint8_t *map;
+    size_t map_used;
+    off_t map_offset;
+} vlc_tracer_sys_t;
+
+static void RingOrphan(void *data)
+{
+    struct trace_ring *ring = data;
+
+    atomic_store_explicit(&ring->orphan, true, memory_order_release);
+}
+
+static struct trace_ring *RingGet(vlc_tracer_sys_t *sys)
+{
+    struct trace_ring *ring = vlc_threadvar_get(sys->ring_key);
+    if (likely(ring != NULL))
+        return ring;
+
+    /* First trace from this thread */
+    ring = malloc(sizeof (*ring));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    ring->thread = vlc_thread_id();
+    atomic_init(&ring->orphan, false);
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->dropped, 0);
+    ring->reported = 0;
+
+    if (vlc_threadvar_set(sys->ring_key, ring))
+    {
+        free(ring);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&sys->lock);
+    vlc_list_append(&ring->node, &sys->rings);
+    vlc_mutex_unlock(&sys->lock);
+    return ring;
+}
+
+static void CopyString(char *dst, size_t size, const char *src)
+{
+    size_t len = strnlen(src, size);
+
+    memcpy(dst, src, len);
+    if (len < size)
+        memset(dst + len, 0, size - len);
+}
+
+static void TraceBinary(void *opaque, vlc_tick_t ts, va_list entries)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    struct trace_ring *ring = RingGet(sys);
+    if (unlikely(ring == NULL))
+        return;
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= RING_SIZE)
+    {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    struct trace_record *rec = &ring->records[head % RING_SIZE];
+    unsigned count = 0;
+
+    rec->ts = NS_FROM_VLC_TICK(ts);
+    rec->thread = ring->thread;
+
+    for (struct vlc_tracer_entry entry = va_arg(entries, struct vlc_tracer_entry);
+         entry.key != NULL;
+         entry = va_arg(entries, struct vlc_tracer_entry))
+    {
+        if (count == TRACE_ENTRIES)
+            continue;
+
+        struct trace_entry *e = &rec->entries[count++];
+
+        CopyString(e->key, sizeof (e->key), entry.key);
+        e->type = entry.type;
+        switch (entry.type)
+        {
+            case VLC_TRACER_INT:
+                e->value.integer = entry.value.integer;
+                break;
+            case VLC_TRACER_TICK:
+                e->value.integer = NS_FROM_VLC_TICK(entry.value.tick);
+                break;
+            case VLC_TRACER_STRING:
+                CopyString(e->value.string, sizeof (e->value.string),
+                           entry.value.string != NULL ? entry.value.string
+                                                      : "");
+                break;
+            default:
+                vlc_assert_unreachable();
+        }
+    }
+    rec->count = count;
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/* Returns the space for the next record in the file */
+static struct trace_record *FileReserve(vlc_tracer_sys_t *sys)
+{
+    if (sys->map != NULL && sys->map_used == CHUNK_SIZE)
+    {
+        munmap(sys->map, CHUNK_SIZE);
+        sys->map = NULL;
+        sys->map_offset += CHUNK_SIZE;
+        sys->map_used = 0;
+    }
+
+    if (sys->map == NULL)
+    {
+        if (ftruncate(sys->fd, sys->map_offset + CHUNK_SIZE))
+            return NULL;
+
+        void *map = mmap(NULL, CHUNK_SIZE, PROT_READ|PROT_WRITE, MAP_SHARED,
+                         sys->fd, sys->map_offset);
+        if (map == MAP_FAILED)
+            return NULL;
+        sys->map = map;
+    }
+
+    struct trace_record *rec = (void *)(sys->map + sys->map_used);
+    sys->map_used += sizeof (*rec);
+    return rec;
+}
+
+static void DrainRing(vlc_tracer_sys_t *sys, struct trace_ring *ring)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    for (; tail != head; tail++)
+    {
+        struct trace_record *rec = FileReserve(sys);
+        if (unlikely(rec == NULL))
+            break;
+        memcpy(rec, &ring->records[tail % RING_SIZE], sizeof (*rec));
+    }
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+    uint64_t dropped = atomic_load_explicit(&ring->dropped,
+                                            memory_order_relaxed);
+    if (dropped != ring->reported)
+    {
+        struct trace_record *rec = FileReserve(sys);
+        if (unlikely(rec == NULL))
+            return;
+
+        memset(rec, 0, sizeof (*rec));
+        rec->ts = NS_FROM_VLC_TICK(vlc_tick_now());
+        rec->thread = ring->thread;
+        rec->count = 2;
+        CopyString(rec->entries[0].key, TRACE_KEY_SIZE, "type");
+        rec->entries[0].type = VLC_TRACER_STRING;
+        CopyString(rec->entries[0].value.string, TRACE_STRING_SIZE, "TRACER");
+        CopyString(rec->entries[1].key, TRACE_KEY_SIZE, "dropped");
+        rec->entries[1].type = VLC_TRACER_INT;
+        rec->entries[1].value.integer = dropped - ring->reported;
+        ring->reported = dropped;
+    }
+}
+
+static void Drain(vlc_tracer_sys_t *sys)
+{
+    struct trace_ring *ring;
+
+    /* The rings are only added by the traced threads, and only removed here,
+     * once their thread has exited and they are empty. */
+    vlc_list_foreach(ring, &sys->rings, node)
+    {
+        bool orphan = atomic_load_explicit(&ring->orphan,
+                                           memory_order_acquire);
+
+        vlc_mutex_unlock(&sys->lock);
+        DrainRing(sys, ring);
+        vlc_mutex_lock(&sys->lock);
+
+        if (orphan)
+        {
+            vlc_list_remove(&ring->node);
+            free(ring);
+        }
+    }
+}
+
+static void *Thread(void *data)
+{
+    vlc_tracer_sys_t *sys = data;
+
+    vlc_thread_set_name("vlc-tracer");
+
+    vlc_mutex_lock(&sys->lock);
+    while (!sys->stop)
+    {
+        vlc_cond_timedwait(&sys->wait, &sys->lock,
+                           vlc_tick_now() + DRAIN_PERIOD);
+        Drain(sys);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+
+    vlc_mutex_lock(&sys->lock);
+    sys->stop = true;
+    vlc_cond_signal(&sys->wait);
+    vlc_mutex_unlock(&sys->lock);
+    vlc_join(sys->thread, NULL);
+
+    vlc_threadvar_delete(&sys->ring_key);
+
+    /* Flush the remaining records */
+    struct trace_ring *ring;
+    vlc_mutex_lock(&sys->lock);
+    vlc_list_foreach(ring, &sys->rings, node)
+        atomic_store_explicit(&ring->orphan, true, memory_order_relaxed);
+    Drain(sys);
+    vlc_mutex_unlock(&sys->lock);
+    assert(vlc_list_is_empty(&sys->rings));
+
+    if (sys->map != NULL)
+        munmap(sys->map, CHUNK_SIZE);
+    /* Drop the unused end of the last mapping */
+    if (ftruncate(sys->fd, sys->map_offset + sys->map_used))
+        msg_Warn(sys->obj, "cannot truncate the trace file: %s",
+                 vlc_strerror_c(errno));
+    vlc_close(sys->fd);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations binary_ops =
+{
+    TraceBinary,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                               void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    char *path = var_InheritString(obj, "binary-tracer-file");
+    const char *filename = path != NULL ? path : TRACE_FILENAME;
+
+    msg_Dbg(obj, "opening trace file `%s'", filename);
+    sys->fd = vlc_open(filename, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (sys->fd == -1)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", filename,
+                vlc_strerror_c(errno));
+        free(path);
+        free(sys);
+        return NULL;
+    }
+    free(path);
+
+    sys->obj = obj;
+    sys->map = NULL;
+    sys->map_offset = 0;
+    sys->map_used = 0;
+
+    struct trace_header *hdr = (void *)FileReserve(sys);
+    if (hdr == NULL || vlc_threadvar_create(&sys->ring_key, RingOrphan))
+        goto error;
+
+    memset(hdr, 0, sizeof (*hdr));
+    memcpy(hdr->magic, TRACE_MAGIC, sizeof (hdr->magic));
+    hdr->version = TRACE_VERSION;
+    hdr->byte_order = 0x01020304;
+    hdr->record_size = sizeof (struct trace_record);
+    hdr->entries = TRACE_ENTRIES;
+    hdr->key_size = TRACE_KEY_SIZE;
+    hdr->string_size = TRACE_STRING_SIZE;
+    hdr->pid = getpid();
+
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait);
+    vlc_list_init(&sys->rings);
+    sys->stop = false;
+
+    if (vlc_clone(&sys->thread, Thread, sys))
+    {
+        vlc_threadvar_delete(&sys->ring_key);
+        goto error;
+    }
+
+    *sysp = sys;
+    return &binary_ops;
+
+error:
+    msg_Err(obj, "cannot map the trace file: %s", vlc_strerror_c(errno));
+    if (sys->map != NULL)
+        munmap(sys->map, CHUNK_SIZE);
+    vlc_close(sys->fd);
+    free(sys);
+    return NULL;
+}
+
+#define FILE_TEXT N_("Trace filename")
+#define FILE_LONGTEXT N_("Specify the binary trace filename.")
+
+vlc_module_begin()
+    set_shortname(N_("Binary tracer"))
+    set_description(N_("Binary ring buffer tracer"))
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("binary-tracer-file", NULL, FILE_TEXT, FILE_LONGTEXT)
+vlc_module_end()
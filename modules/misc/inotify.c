@@ -0,0 +1,173 @@
+/*****************************************************************************
+ * inotify.c: Linux file system watcher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_fs_watcher.h>
+#include <vlc_interrupt.h>
+
+#define WATCH_MASK (IN_CREATE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM \
+                  | IN_CLOSE_WRITE | IN_ATTRIB | IN_ONLYDIR)
+
+typedef struct
+{
+    int fd;
+    vlc_interrupt_t *interrupt;
+    vlc_thread_t thread;
+} watcher_sys_t;
+
+static void Dispatch(vlc_fs_watcher_t *watcher,
+                     const struct inotify_event *ev)
+{
+    const struct vlc_fs_watcher_callbacks *cbs = watcher->cbs;
+
+    if (ev->mask & IN_Q_OVERFLOW)
+    {
+        if (cbs->on_overflow != NULL)
+            cbs->on_overflow(watcher, watcher->cbs_data);
+        return;
+    }
+    if (ev->len == 0)
+        return; /* event on the directory itself */
+
+    if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+    {
+        if (cbs->on_added != NULL)
+            cbs->on_added(watcher, ev->name, watcher->cbs_data);
+    }
+    else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+    {
+        if (cbs->on_removed != NULL)
+            cbs->on_removed(watcher, ev->name, watcher->cbs_data);
+    }
+    else if (ev->mask & (IN_CLOSE_WRITE | IN_ATTRIB))
+    {
+        if (cbs->on_modified != NULL)
+            cbs->on_modified(watcher, ev->name, watcher->cbs_data);
+    }
+}
+
+static void *Thread(void *data)
+{
+    vlc_fs_watcher_t *watcher = data;
+    watcher_sys_t *sys = watcher->sys;
+    /* Large enough for several events, aligned for struct inotify_event */
+    char buf[16 * (sizeof (struct inotify_event) + NAME_MAX + 1)]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    vlc_thread_set_name("vlc-inotify");
+    vlc_interrupt_set(sys->interrupt);
+
+    for (;;)
+    {
+        struct pollfd ufd = { .fd = sys->fd, .events = POLLIN };
+
+        if (vlc_poll_i11e(&ufd, 1, -1) < 0)
+        {
+            if (errno == EINTR && !vlc_killed())
+                continue;
+            break;
+        }
+
+        ssize_t len = read(sys->fd, buf, sizeof (buf));
+        if (len < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            break;
+        }
+
+        for (char *p = buf; p < buf + len;)
+        {
+            const struct inotify_event *ev = (const void *)p;
+
+            Dispatch(watcher, ev);
+            p += sizeof (*ev) + ev->len;
+        }
+    }
+    return NULL;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    vlc_fs_watcher_t *watcher = (vlc_fs_watcher_t *)obj;
+    watcher_sys_t *sys = malloc(sizeof (*sys));
+
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (sys->fd == -1)
+        goto error;
+
+    if (inotify_add_watch(sys->fd, watcher->path, WATCH_MASK) == -1)
+    {
+        msg_Dbg(obj, "cannot watch %s: %s", watcher->path,
+                vlc_strerror_c(errno));
+        goto error;
+    }
+
+    sys->interrupt = vlc_interrupt_create();
+    if (unlikely(sys->interrupt == NULL))
+        goto error;
+
+    watcher->sys = sys;
+    if (vlc_clone(&sys->thread, Thread, watcher))
+    {
+        vlc_interrupt_destroy(sys->interrupt);
+        goto error;
+    }
+    return VLC_SUCCESS;
+
+error:
+    if (sys->fd != -1)
+        vlc_close(sys->fd);
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    vlc_fs_watcher_t *watcher = (vlc_fs_watcher_t *)obj;
+    watcher_sys_t *sys = watcher->sys;
+
+    vlc_interrupt_kill(sys->interrupt);
+    vlc_join(sys->thread, NULL);
+    vlc_interrupt_destroy(sys->interrupt);
+    vlc_close(sys->fd);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_shortname("inotify")
+    set_description(N_("Linux file system watcher"))
+    set_capability("fs watcher", 10)
+    set_callbacks(Open, Close)
+vlc_module_end()
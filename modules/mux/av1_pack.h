@@ -49,6 +49,10 @@ static inline block_t *AV1_Pack_Sample(block_t *p_block)
             case AV1_OBU_TILE_LIST:
             {
                 size_t i_offset = p_obu - p_block->p_buffer;
+                p_block = block_Unshare(p_block);
+                if(!p_block)
+                    return NULL;
+                p_obu = &p_block->p_buffer[i_offset];
                 if(i_offset < p_block->i_buffer - i_offset - i_obu)
                 {
                     memmove(&p_block->p_buffer[i_obu], p_block->p_buffer, i_offset);
@@ -77,6 +81,9 @@ static inline block_t *AV1_Pack_Sample(block_t *p_block)
         (void) AV1_OBUSize(p_obu, p_block->i_buffer - i_offset, &i_len);
         if(i_len)
         {
+            p_block = block_Unshare(p_block);
+            if(!p_block)
+                return NULL;
             memmove(&p_block->p_buffer[i_offset + i_header],
                     &p_block->p_buffer[i_offset + i_header + i_len],
                     p_block->i_buffer - i_offset - i_header - i_len);
@@ -53,6 +53,11 @@
     "Create \"Fast Start\" files. " \
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
+#define RESERVE_TEXT N_("Space reserved for the \"Fast Start\" index")
+#define RESERVE_LONGTEXT N_(\
+    "Space reserved at the start of \"Fast Start\" files for the index " \
+    "(in KiB). If the index fits, the media data does not need to be " \
+    "moved when the file is finalized.")
 
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
@@ -67,6 +72,8 @@ vlc_module_begin ()
 
     add_bool(SOUT_CFG_PREFIX "faststart", false,
               FASTSTART_TEXT, FASTSTART_LONGTEXT)
+    add_integer_with_range(SOUT_CFG_PREFIX "faststart-reserve", 0, 0, 65536,
+                           RESERVE_TEXT, RESERVE_LONGTEXT)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -85,7 +92,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "faststart-reserve", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -155,10 +162,12 @@ typedef struct
     mp4mux_handle_t *muxh;
     bool b_3gp;
     bool b_fast_start;
+    uint32_t i_moov_reserve;
 
     /* global */
     bool     b_header_sent;
 
+    uint64_t i_free_pos; /* where the fast start moov goes */
     uint64_t i_mdat_pos;
     uint64_t i_pos;
     vlc_tick_t  i_read_duration;
@@ -220,6 +229,8 @@ static void box_send(sout_mux_t *p_mux,  bo_t *box);
 static block_t *ConvertSUBT(block_t *);
 static bool CreateCurrentEdit(mp4_stream_t *, vlc_tick_t, bool);
 static int MuxStream(sout_mux_t *p_mux, sout_input_t *p_input, mp4_stream_t *p_stream);
+static int MuxFragBlock(sout_mux_t *, mp4_stream_t *, block_t *);
+static block_t * BlockDequeue(sout_input_t *, mp4_stream_t *);
 
 static int WriteSlowStartHeader(sout_mux_t *p_mux)
 {
@@ -234,10 +245,26 @@ static int WriteSlowStartHeader(sout_mux_t *p_mux)
             return VLC_ENOMEM;
 
         p_sys->i_pos += bo_size(box);
-        p_sys->i_mdat_pos = p_sys->i_pos;
         box_send(p_mux, box);
     }
 
+    p_sys->i_free_pos = p_sys->i_pos;
+    if (p_sys->b_fast_start && p_sys->i_moov_reserve > 0)
+    {
+        /* Reserve room for the moov, so that the media data does not need to
+         * be moved if it fits */
+        block_t *p_free = block_Alloc(p_sys->i_moov_reserve);
+        if(!p_free)
+            return VLC_ENOMEM;
+
+        memset(p_free->p_buffer, 0, p_free->i_buffer);
+        SetDWBE(p_free->p_buffer, p_free->i_buffer);
+        memcpy(p_free->p_buffer + 4, "free", 4);
+        p_sys->i_pos += p_free->i_buffer;
+        sout_AccessOutWrite(p_mux->p_access, p_free);
+    }
+    p_sys->i_mdat_pos = p_sys->i_pos;
+
     /* Now add mdat header */
     box = box_new("mdat");
     if(!box)
@@ -282,8 +309,12 @@ static int Open(vlc_object_t *p_this)
     p_sys->i_pos        = 0;
     p_sys->i_nb_streams = 0;
     p_sys->pp_streams   = NULL;
+    p_sys->i_free_pos   = 0;
     p_sys->i_mdat_pos   = 0;
     p_sys->b_header_sent = false;
+    p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
+    p_sys->i_moov_reserve =
+        var_GetInteger(p_this, SOUT_CFG_PREFIX "faststart-reserve") * 1024;
 
     p_sys->i_read_duration   = 0;
     p_sys->i_written_duration= 0;
@@ -309,6 +340,147 @@ static int Open(vlc_object_t *p_this)
     return VLC_SUCCESS;
 }
 
+/* Returns by how much the media data must be moved, so that the moov fits
+ * between the ftyp and the mdat, followed by a free box for the slack */
+static uint64_t FastStartShift(uint64_t i_room, uint64_t i_moov,
+                               uint64_t i_align)
+{
+    uint64_t i_shift = (i_room < i_moov) ? i_moov - i_room : 0;
+
+    for (;;)
+    {
+        i_shift = (i_shift + i_align - 1) / i_align * i_align;
+
+        uint64_t i_slack = i_room + i_shift - i_moov;
+        if (i_slack == 0 || i_slack >= 8)
+            return i_shift;
+        i_shift += 8 - i_slack;
+    }
+}
+
+#define FASTSTART_CHUNK (1 << 20)
+
+static int FastStartCopy(sout_mux_t *p_mux, uint64_t i_shift)
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    uint64_t i_size = p_sys->i_pos - p_sys->i_mdat_pos;
+
+    /* Move MDAT data towards the end, from its end, in large chunks as each
+     * chunk costs two seeks */
+    while (i_size > 0)
+    {
+        size_t i_chunk = __MIN(FASTSTART_CHUNK, i_size);
+        block_t *p_buf = block_Alloc(i_chunk);
+        if (unlikely(p_buf == NULL))
+            return VLC_ENOMEM;
+
+        sout_AccessOutSeek(p_mux->p_access,
+                           p_sys->i_mdat_pos + i_size - i_chunk);
+        ssize_t i_read = sout_AccessOutRead(p_mux->p_access, p_buf);
+        if (i_read < 0 || (size_t) i_read < i_chunk) {
+            block_Release(p_buf);
+            return VLC_EGENERIC;
+        }
+        sout_AccessOutSeek(p_mux->p_access,
+                           p_sys->i_mdat_pos + i_size + i_shift - i_chunk);
+        sout_AccessOutWrite(p_mux->p_access, p_buf);
+        i_size -= i_chunk;
+    }
+    return VLC_SUCCESS;
+}
+
+/* Writes the moov in front of the mdat, moving the media data if it does not
+ * fit in the reserved space */
+static int FastStart(sout_mux_t *p_mux, bo_t **pp_moov, bool b_64bitext)
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    uint64_t i_room = p_sys->i_mdat_pos - p_sys->i_free_pos;
+    uint64_t i_align;
+
+    /* Inserting a range only remaps extents on supporting file systems */
+    bool b_insert = sout_AccessOutControl(p_mux->p_access,
+                                          ACCESS_OUT_CAN_INSERT,
+                                          &i_align) == VLC_SUCCESS;
+    if (!b_insert)
+        i_align = 1;
+
+    uint64_t i_shift = FastStartShift(i_room, bo_size(*pp_moov), i_align);
+
+    /* moving samples will need new moov with 64bit atoms ? */
+    if (!b_64bitext && i_shift > 0 && p_sys->i_pos + i_shift > UINT32_MAX)
+    {
+        mp4mux_Set64BitExt(p_sys->muxh);
+        bo_t *moov64 = mp4mux_GetMoov(p_sys->muxh, VLC_OBJECT(p_mux), 0);
+        if (!moov64)
+            return VLC_ENOMEM;
+        bo_free(*pp_moov);
+        *pp_moov = moov64;
+        i_shift = FastStartShift(i_room, bo_size(moov64), i_align);
+    }
+    /* We now know our final MOOV size */
+
+    bo_t *moov = *pp_moov;
+    if (i_shift > 0)
+    {
+        /* Fix-up samples to chunks table in MOOV header to they point to
+         * next MDAT location */
+        mp4mux_ShiftSamples(p_sys->muxh, i_shift);
+        bo_t *shifted = mp4mux_GetMoov(p_sys->muxh, VLC_OBJECT(p_mux), 0);
+        if (!shifted)
+        {
+            mp4mux_ShiftSamples(p_sys->muxh, -(int64_t)i_shift);
+            return VLC_ENOMEM;
+        }
+        assert(bo_size(shifted) == bo_size(moov));
+
+        msg_Dbg(p_mux, "Moving data by %"PRIu64, i_shift);
+        if (b_insert && sout_AccessOutControl(p_mux->p_access,
+                                              ACCESS_OUT_INSERT, UINT64_C(0),
+                                              i_shift) == VLC_SUCCESS)
+        {
+            /* The ftyp was moved along */
+            if (!mp4mux_Is(p_sys->muxh, QUICKTIME))
+            {
+                bo_t *ftyp = mp4mux_GetFtyp(p_sys->muxh);
+                if (ftyp)
+                {
+                    sout_AccessOutSeek(p_mux->p_access, 0);
+                    box_send(p_mux, ftyp);
+                }
+            }
+        }
+        else if (FastStartCopy(p_mux, i_shift) != VLC_SUCCESS)
+        {
+            msg_Warn(p_mux, "read() not supported by access output, "
+                     "won't create a fast start file");
+            mp4mux_ShiftSamples(p_sys->muxh, -(int64_t)i_shift);
+            bo_free(shifted);
+            return VLC_EGENERIC;
+        }
+
+        bo_free(moov);
+        *pp_moov = moov = shifted;
+    }
+
+    uint64_t i_slack = i_room + i_shift - bo_size(moov);
+
+    sout_AccessOutSeek(p_mux->p_access, p_sys->i_free_pos);
+    box_send(p_mux, moov);
+    *pp_moov = NULL;
+
+    if (i_slack > 0)
+    {
+        bo_t bo;
+        if (bo_init(&bo, 8))
+        {
+            bo_add_32be  (&bo, i_slack);
+            bo_add_fourcc(&bo, "free");
+            sout_AccessOutWrite(p_mux->p_access, bo.b);
+        }
+    }
+    return VLC_SUCCESS;
+}
+
 /*****************************************************************************
  * Close:
  *****************************************************************************/
@@ -343,79 +515,15 @@ static void Close(vlc_object_t *p_this)
     if(b_64bitext)
         mp4mux_Set64BitExt(p_sys->muxh);
 
-    uint64_t i_moov_pos = p_sys->i_pos;
     bo_t *moov = mp4mux_GetMoov(p_sys->muxh, VLC_OBJECT(p_mux), 0);
 
     /* Check we need to create "fast start" files */
-    p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
-    while (p_sys->b_fast_start && moov && moov->b)
-    {
-        /* Move data to the end of the file so we can fit the moov header
-         * at the start */
-        uint64_t i_mdatsize = p_sys->i_pos - p_sys->i_mdat_pos;
-
-        /* moving samples will need new moov with 64bit atoms ? */
-        if(!b_64bitext && p_sys->i_pos + bo_size(moov) > UINT32_MAX)
-        {
-            mp4mux_Set64BitExt(p_sys->muxh);
-            b_64bitext = true;
-            /* generate a new moov */
-            bo_t *moov64 = mp4mux_GetMoov(p_sys->muxh, VLC_OBJECT(p_mux), 0);
-            if(moov64)
-            {
-                bo_free(moov);
-                moov = moov64;
-            }
-        }
-        /* We now know our final MOOV size */
-
-        /* Fix-up samples to chunks table in MOOV header to they point to next MDAT location */
-        mp4mux_ShiftSamples(p_sys->muxh, bo_size(moov));
-        msg_Dbg(p_this,"Moving data by %"PRIu64, (uint64_t)bo_size(moov));
-        bo_t *shifted = mp4mux_GetMoov(p_sys->muxh, VLC_OBJECT(p_mux), 0);
-        if(!shifted)
-        {
-            /* fail */
-            p_sys->b_fast_start = false;
-            continue;
-        }
-        assert(bo_size(shifted) == bo_size(moov));
-        bo_free(moov);
-        moov = shifted;
-
-        /* Make space, move MDAT data by moov size towards the end */
-        while (i_mdatsize > 0)
-        {
-            size_t i_chunk = __MIN(32768, i_mdatsize);
-            block_t *p_buf = block_Alloc(i_chunk);
-            sout_AccessOutSeek(p_mux->p_access,
-                                p_sys->i_mdat_pos + i_mdatsize - i_chunk);
-            ssize_t i_read = sout_AccessOutRead(p_mux->p_access, p_buf);
-            if (i_read < 0 || (size_t) i_read < i_chunk) {
-                msg_Warn(p_this, "read() not supported by access output, "
-                          "won't create a fast start file");
-                p_sys->b_fast_start = false;
-                block_Release(p_buf);
-                break;
-            }
-            sout_AccessOutSeek(p_mux->p_access, p_sys->i_mdat_pos + i_mdatsize +
-                               bo_size(moov) - i_chunk);
-            sout_AccessOutWrite(p_mux->p_access, p_buf);
-            i_mdatsize -= i_chunk;
-        }
-
-        if (!p_sys->b_fast_start) /* failed above */
-            continue;
-
-        /* Update pos pointers */
-        i_moov_pos = p_sys->i_mdat_pos;
-        p_sys->i_mdat_pos += bo_size(moov);
-
-        p_sys->b_fast_start = false;
-    }
+    if (p_sys->b_fast_start && moov && moov->b
+     && FastStart(p_mux, &moov, b_64bitext) == VLC_SUCCESS)
+        goto cleanup;
 
     /* Write MOOV header */
-    sout_AccessOutSeek(p_mux->p_access, i_moov_pos);
+    sout_AccessOutSeek(p_mux->p_access, p_sys->i_pos);
     if (moov != NULL)
         box_send(p_mux, moov);
 
@@ -543,6 +651,17 @@ static void DelStream(sout_mux_t *p_mux, sout_input_t *p_input)
         if(CreateCurrentEdit(p_stream, p_sys->i_start_dts, false))
             mp4mux_track_DebugEdits(VLC_OBJECT(p_mux), p_stream->tinfo);
     }
+    else
+    {
+        /* The last fragments would miss the still queued blocks */
+        while(block_FifoCount(p_input->p_fifo) > 0)
+        {
+            block_t *p_block = BlockDequeue(p_input, p_stream);
+            if(p_block != NULL &&
+               MuxFragBlock(p_mux, p_stream, p_block) != VLC_SUCCESS)
+                break;
+        }
+    }
 
     msg_Dbg(p_mux, "removing input");
 }
@@ -1429,20 +1548,11 @@ static void CloseFrag(vlc_object_t *p_this)
     free(p_sys);
 }
 
-static int MuxFrag(sout_mux_t *p_mux)
+static int MuxFragBlock(sout_mux_t *p_mux, mp4_stream_t *p_stream,
+                        block_t *p_currentblock)
 {
     sout_mux_sys_t *p_sys = (sout_mux_sys_t*) p_mux->p_sys;
 
-    int i_stream = sout_MuxGetStream(p_mux, 1, NULL);
-    if (i_stream < 0)
-        return VLC_SUCCESS;
-
-    sout_input_t *p_input  = p_mux->pp_inputs[i_stream];
-    mp4_stream_t *p_stream = (mp4_stream_t*) p_input->p_sys;
-    block_t *p_currentblock = BlockDequeue(p_input, p_stream);
-    if( !p_currentblock )
-        return VLC_SUCCESS;
-
     /* Set time ranges */
     if( p_stream->i_first_dts == VLC_TICK_INVALID )
     {
@@ -1531,3 +1641,18 @@ static int MuxFrag(sout_mux_t *p_mux)
 
     return VLC_SUCCESS;
 }
+
+static int MuxFrag(sout_mux_t *p_mux)
+{
+    int i_stream = sout_MuxGetStream(p_mux, 1, NULL);
+    if (i_stream < 0)
+        return VLC_SUCCESS;
+
+    sout_input_t *p_input  = p_mux->pp_inputs[i_stream];
+    mp4_stream_t *p_stream = (mp4_stream_t*) p_input->p_sys;
+    block_t *p_currentblock = BlockDequeue(p_input, p_stream);
+    if( !p_currentblock )
+        return VLC_SUCCESS;
+
+    return MuxFragBlock(p_mux, p_stream, p_currentblock);
+}
@@ -31,6 +31,7 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
 #include <limits.h>
 
 #include <vlc_common.h>
@@ -181,6 +182,12 @@ static const char *const ts_standards_list_text[] =
     "The encryption routines subtract the TS-header from the value before " \
     "encrypting." )
 
+#define AGGREGATE_TEXT N_("TS packets per output block")
+#define AGGREGATE_LONGTEXT N_("Number of TS packets gathered in each block " \
+    "passed to the access output. Zero selects one network datagram for " \
+    "streaming outputs, and 64 KiB for files. Streaming outputs are " \
+    "limited to one datagram, within the MTU.")
+
 #define SOUT_CFG_PREFIX "sout-ts-"
 #define MAX_PMT 64       /* Maximum number of programs. FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
 #define MAX_PMT_PID 64       /* Maximum pids in each pmt.  FIXME: I just chose an arbitrary number. Where is the maximum in the spec? */
@@ -231,6 +238,9 @@ vlc_module_begin ()
     add_string( SOUT_CFG_PREFIX "csa-use", "1",  CU_TEXT,   CU_LONGTEXT)
     add_integer(SOUT_CFG_PREFIX "csa-pkt", 188,  CPKT_TEXT, CPKT_LONGTEXT)
 
+    add_integer_with_range(SOUT_CFG_PREFIX "aggregate", 0, 0, 1024,
+                           AGGREGATE_TEXT, AGGREGATE_LONGTEXT)
+
     set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -243,7 +253,7 @@ static const char *const ppsz_sout_options[] = {
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "use-key-frames",
     "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
-    "muxpmt", "program-pmt", "alignment",
+    "muxpmt", "program-pmt", "alignment", "aggregate",
     NULL
 };
 
@@ -317,6 +327,100 @@ static inline void BufferChainClean( sout_buffer_chain_t *c )
     BufferChainInit( c );
 }
 
+/* TS packet of the muxing period being built */
+typedef struct
+{
+    uint8_t    *p_buffer; /* 188 bytes, within an aggregated block */
+    vlc_tick_t  i_dts;
+    vlc_tick_t  i_length;
+    uint32_t    i_flags;
+} ts_packet_t;
+
+/* TS packets of a muxing period. They are written in place into blocks of
+ * several packets, which are sent to the access output once dated. */
+typedef struct
+{
+    ts_packet_t *p_packets;
+    int          i_depth;
+    int          i_alloc;
+
+    block_t     *p_first;
+    block_t    **pp_last;
+    block_t     *p_current; /* block being filled */
+    unsigned     i_block_packets;
+} ts_batch_t;
+
+static void TSBatchInit( ts_batch_t *b )
+{
+    b->i_depth = 0;
+    b->p_first = NULL;
+    b->pp_last = &b->p_first;
+    b->p_current = NULL;
+}
+
+/* Appends a packet, or returns NULL on memory error */
+static ts_packet_t *TSBatchAdd( ts_batch_t *b )
+{
+    if( b->i_depth == b->i_alloc )
+    {
+        int i_alloc = b->i_alloc ? 2 * b->i_alloc : 256;
+        ts_packet_t *p_packets = realloc( b->p_packets,
+                                          i_alloc * sizeof(*p_packets) );
+        if( unlikely(p_packets == NULL) )
+            return NULL;
+        b->p_packets = p_packets;
+        b->i_alloc = i_alloc;
+    }
+
+    block_t *p_block = b->p_current;
+    if( p_block == NULL || p_block->i_buffer >= b->i_block_packets * 188 )
+    {
+        p_block = block_Alloc( b->i_block_packets * 188 );
+        if( unlikely(p_block == NULL) )
+            return NULL;
+        p_block->i_buffer = 0;
+        block_ChainLastAppend( &b->pp_last, p_block );
+        b->p_current = p_block;
+    }
+
+    ts_packet_t *p_pkt = &b->p_packets[b->i_depth++];
+    p_pkt->p_buffer = &p_block->p_buffer[p_block->i_buffer];
+    p_pkt->i_dts = 0;
+    p_pkt->i_length = 0;
+    p_pkt->i_flags = 0;
+    p_block->i_buffer += 188;
+    return p_pkt;
+}
+
+/* Makes the next packet start a new block, as access outputs only look at
+ * the flags of the blocks */
+static void TSBatchCut( ts_batch_t *b )
+{
+    b->p_current = NULL;
+}
+
+/* Copies table packets (PEStoTSCallback) */
+static void TSBatchAppendBlock( void *opaque, block_t *p_ts )
+{
+    ts_batch_t *b = opaque;
+
+    while( p_ts )
+    {
+        block_t *p_next = p_ts->p_next;
+        ts_packet_t *p_pkt = TSBatchAdd( b );
+
+        assert( p_ts->i_buffer == 188 );
+        if( likely(p_pkt != NULL) )
+        {
+            memcpy( p_pkt->p_buffer, p_ts->p_buffer, 188 );
+            p_pkt->i_dts = p_ts->i_dts;
+            p_pkt->i_flags = p_ts->i_flags;
+        }
+        block_Release( p_ts );
+        p_ts = p_next;
+    }
+}
+
 typedef struct
 {
     sout_buffer_chain_t chain_pes;
@@ -372,6 +476,8 @@ typedef struct
 
     vlc_tick_t      i_pcr;  /* last PCR emitted */
 
+    ts_batch_t      batch;
+
     csa_t           *csa;
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
@@ -464,15 +570,20 @@ static int Mux      ( sout_mux_t * );
 
 static block_t *FixPES( sout_mux_t *p_mux, block_fifo_t *p_fifo );
 static block_t *Add_ADTS( block_t *, const es_format_t * );
-static void TSSchedule  ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSSchedule  ( sout_mux_t *p_mux, ts_batch_t *p_batch, int i_first,
+                          int i_packet_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
-static void TSDate      ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSDate      ( sout_mux_t *p_mux, ts_batch_t *p_batch, int i_first,
+                          int i_packet_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
-static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
-static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
+static void TSBatchSend ( sout_mux_t *p_mux, ts_batch_t *p_batch );
+static void GetPAT( sout_mux_t *p_mux, ts_batch_t *p_batch );
+static void GetPMT( sout_mux_t *p_mux, ts_batch_t *p_batch );
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static bool TSStartsKeyFrame( const sout_input_sys_t *p_stream );
+static void TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr,
+                   ts_packet_t *p_ts );
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts );
 
 static csa_t *csaSetup( vlc_object_t *p_this )
 {
@@ -715,6 +826,39 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    /* Gather the TS packets into datagrams (UDP/RTP) or into large blocks
+     * (files) rather than sending them one by one */
+    unsigned i_aggregate = var_GetInteger( p_mux, SOUT_CFG_PREFIX "aggregate" );
+    bool b_seekable;
+    if( sout_AccessOutControl( p_mux->p_access, ACCESS_OUT_CAN_SEEK,
+                               &b_seekable ) != VLC_SUCCESS )
+        b_seekable = false;
+
+    if( b_seekable )
+    {
+        if( i_aggregate == 0 )
+            i_aggregate = 65536 / 188;
+    }
+    else
+    {
+        /* A block must fit in a datagram, and the RTP output would split
+         * the TS packets otherwise: leave room for the RTP header */
+        int64_t i_mtu = var_InheritInteger( p_mux, "mtu" ) - 12;
+        unsigned i_max = i_mtu >= 188 ? i_mtu / 188 : 1;
+
+        if( i_aggregate == 0 )
+            i_aggregate = i_max;
+        else if( i_aggregate > i_max )
+        {
+            msg_Warn( p_mux, "%u TS packets do not fit in the MTU, using %u",
+                      i_aggregate, i_max );
+            i_aggregate = i_max;
+        }
+    }
+    msg_Dbg( p_mux, "%u TS packets per block", i_aggregate );
+    p_sys->batch.i_block_packets = i_aggregate;
+    TSBatchInit( &p_sys->batch );
+
     p_mux->p_sys        = p_sys;
 
     p_sys->csa = csaSetup(p_this);
@@ -752,6 +896,7 @@ static void Close( vlc_object_t * p_this )
         free( p_sys->sdt.desc[i].psz_provider );
     }
 
+    free( p_sys->batch.p_packets );
     free( p_sys );
 }
 
@@ -991,16 +1136,10 @@ static void DelStream( sout_mux_t *p_mux, sout_input_t *p_input )
     p_sys->i_pmt_version_number %= 32;
 }
 
-static void SetHeader( sout_buffer_chain_t *c,
-                        int depth )
+static void SetHeader( ts_batch_t *p_batch, int i_packet )
 {
-    block_t *p_ts = BufferChainPeek( c );
-    while( depth > 0 )
-    {
-        p_ts = p_ts->p_next;
-        depth--;
-    }
-    p_ts->i_flags |= BLOCK_FLAG_HEADER;
+    if( i_packet < p_batch->i_depth )
+        p_batch->p_packets[i_packet].i_flags |= BLOCK_FLAG_HEADER;
 }
 
 static block_t *Pack_Opus(block_t *p_data)
@@ -1111,6 +1250,10 @@ static block_t *Encap_J2K( block_t *p_data, const es_format_t *p_fmt )
     {
         p_data->p_buffer += (i_offset - 38);
         p_data->i_buffer -= (i_offset - 38);
+        /* The header is written over the skipped boxes */
+        p_data = block_Unshare( p_data );
+        if( unlikely(!p_data) )
+            return NULL;
     }
 
     const int profile = j2k_get_profile( p_fmt->video.i_visible_width,
@@ -1151,7 +1294,6 @@ static bool MuxStreams(sout_mux_t *p_mux )
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
     sout_input_sys_t *p_pcr_stream = (sout_input_sys_t*)p_sys->p_pcr_input->p_sys;
 
-    sout_buffer_chain_t chain_ts;
     vlc_tick_t i_shaping_delay = p_pcr_stream->state.b_key_frame
         ? p_pcr_stream->state.i_pes_length
         : p_sys->i_shaping_delay;
@@ -1440,13 +1582,14 @@ static bool MuxStreams(sout_mux_t *p_mux )
     i_packet_count += (8 * i_pcr_length / p_sys->i_pcr_delay + 175) / 176;
 
     /* 3: mux PES into TS */
-    BufferChainInit( &chain_ts );
+    ts_batch_t *p_batch = &p_sys->batch;
+    TSBatchInit( p_batch );
     /* append PAT/PMT  -> FIXME with big pcr delay it won't have enough pat/pmt */
     bool pat_was_previous = true; //This is to prevent unnecessary double PAT/PMT insertions
-    GetPAT( p_mux, &chain_ts );
-    GetPMT( p_mux, &chain_ts );
+    GetPAT( p_mux, p_batch );
+    GetPMT( p_mux, p_batch );
     int i_packet_pos = 0;
-    i_packet_count += chain_ts.i_depth;
+    i_packet_count += p_batch->i_depth;
     /* msg_Dbg( p_mux, "estimated pck=%d", i_packet_count ); */
 
     const vlc_tick_t i_pcr_dts = p_pcr_stream->state.i_pes_dts;
@@ -1490,42 +1633,45 @@ static bool MuxStreams(sout_mux_t *p_mux )
             p_sys->i_pcr = i_pcr_dts + packet_length;
         }
 
-        /* Build the TS packet */
-        block_t *p_ts = TSNew( p_mux, p_stream, b_pcr );
-        if( p_sys->csa != NULL &&
-             (p_input->p_fmt->i_cat != AUDIO_ES || p_sys->b_crypt_audio) &&
-             (p_input->p_fmt->i_cat != VIDEO_ES || p_sys->b_crypt_video) )
-        {
-            p_ts->i_flags |= BLOCK_FLAG_SCRAMBLED;
-        }
-        i_packet_pos++;
-
         /* Write PAT/PMT before every keyframe if use-key-frames is enabled,
          * this helps to do segmenting with livehttp-output so it can cut segment
          * and start new one with pat,pmt,keyframe*/
-        if( ( p_sys->b_use_key_frames ) &&
-            ( p_input->p_fmt->i_cat == VIDEO_ES ) &&
-            ( p_ts->i_flags & BLOCK_FLAG_TYPE_I ) )
+        bool b_key_frame = p_input->p_fmt->i_cat == VIDEO_ES &&
+                           TSStartsKeyFrame( p_stream );
+        if( b_key_frame && !pat_was_previous )
+            TSBatchCut( p_batch ); /* key frames start a block */
+        if( p_sys->b_use_key_frames && b_key_frame )
         {
             if( likely( !pat_was_previous ) )
             {
-                int startcount = chain_ts.i_depth;
-                GetPAT( p_mux, &chain_ts );
-                GetPMT( p_mux, &chain_ts );
-                SetHeader( &chain_ts, startcount );
-                i_packet_count += (chain_ts.i_depth - startcount );
+                int startcount = p_batch->i_depth;
+                GetPAT( p_mux, p_batch );
+                GetPMT( p_mux, p_batch );
+                SetHeader( p_batch, startcount );
+                i_packet_count += (p_batch->i_depth - startcount );
             } else {
-                SetHeader( &chain_ts, 0); //We just inserted pat/pmt,so just flag it instead of adding new one
+                SetHeader( p_batch, 0); //We just inserted pat/pmt,so just flag it instead of adding new one
             }
         }
         pat_was_previous = false;
 
-        /* */
-        BufferChainAppend( &chain_ts, p_ts );
+        /* Build the TS packet */
+        ts_packet_t *p_ts = TSBatchAdd( p_batch );
+        if( unlikely(p_ts == NULL) )
+            break; /* the remaining data is muxed in the next period */
+        TSNew( p_mux, p_stream, b_pcr, p_ts );
+        if( p_sys->csa != NULL &&
+             (p_input->p_fmt->i_cat != AUDIO_ES || p_sys->b_crypt_audio) &&
+             (p_input->p_fmt->i_cat != VIDEO_ES || p_sys->b_crypt_video) )
+        {
+            p_ts->i_flags |= BLOCK_FLAG_SCRAMBLED;
+        }
+        i_packet_pos++;
     }
 
     /* 4: date and send */
-    TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    TSSchedule( p_mux, p_batch, 0, p_batch->i_depth, i_pcr_length, i_pcr_dts );
+    TSBatchSend( p_mux, p_batch );
     return false;
 }
 
@@ -1660,14 +1806,12 @@ static block_t *Add_ADTS( block_t *p_data, const es_format_t *p_fmt )
     return p_new_block;
 }
 
-static void TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSSchedule( sout_mux_t *p_mux, ts_batch_t *p_batch, int i_first,
+                        int i_packet_count,
                         vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    sout_buffer_chain_t new_chain;
-    int i_packet_count = p_chain_ts->i_depth;
-
-    BufferChainInit( &new_chain );
+    const ts_packet_t *p_ts = &p_batch->p_packets[i_first];
 
     if ( unlikely(i_pcr_length <= 0) )
     {
@@ -1676,48 +1820,48 @@ static void TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
 
     for (int i = 0; i < i_packet_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
         vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
+        int i_depth = i + 1; /* packets dated at the current rate */
 
-        BufferChainAppend( &new_chain, p_ts );
-
-        if (!p_ts->i_dts || p_ts->i_dts + p_sys->i_dts_delay * 2/3 >= i_new_dts)
+        if (!p_ts[i].i_dts ||
+            p_ts[i].i_dts + p_sys->i_dts_delay * 2/3 >= i_new_dts)
             continue;
 
-        vlc_tick_t i_max_diff = i_new_dts - p_ts->i_dts;
-        vlc_tick_t i_cut_dts = p_ts->i_dts;
+        vlc_tick_t i_max_diff = i_new_dts - p_ts[i].i_dts;
+        vlc_tick_t i_cut_dts = p_ts[i].i_dts;
 
-        while( (p_ts = BufferChainPeek( p_chain_ts )) )
+        while( i_depth < i_packet_count )
         {
             i_new_dts = i_pcr_dts + i_pcr_length * i++ / i_packet_count;
-            if( p_ts->i_dts >= i_pcr_dts &&
-                i_new_dts - p_ts->i_dts >= i_max_diff )
+            if( p_ts[i_depth].i_dts >= i_pcr_dts &&
+                i_new_dts - p_ts[i_depth].i_dts >= i_max_diff )
                break;
-            p_ts = BufferChainGet( p_chain_ts );
-            BufferChainAppend( &new_chain, p_ts );
-            i_max_diff = i_new_dts - p_ts->i_dts;
-            i_cut_dts = p_ts->i_dts;
+            i_max_diff = i_new_dts - p_ts[i_depth].i_dts;
+            i_cut_dts = p_ts[i_depth].i_dts;
+            i_depth++;
         }
         msg_Dbg( p_mux, "adjusting rate at %"PRId64"/%"PRId64" (%d/%d)",
-                 i_cut_dts - i_pcr_dts, i_pcr_length, new_chain.i_depth,
-                 p_chain_ts->i_depth );
-        if ( new_chain.i_depth )
-            TSDate( p_mux, &new_chain, i_cut_dts - i_pcr_dts, i_pcr_dts );
-        if ( p_chain_ts->i_depth )
-            TSSchedule( p_mux, p_chain_ts, i_pcr_dts + i_pcr_length - i_cut_dts,
-                        i_cut_dts );
+                 i_cut_dts - i_pcr_dts, i_pcr_length, i_depth,
+                 i_packet_count - i_depth );
+        TSDate( p_mux, p_batch, i_first, i_depth, i_cut_dts - i_pcr_dts,
+                i_pcr_dts );
+        if ( i_packet_count > i_depth )
+            TSSchedule( p_mux, p_batch, i_first + i_depth,
+                        i_packet_count - i_depth,
+                        i_pcr_dts + i_pcr_length - i_cut_dts, i_cut_dts );
         return;
     }
 
-    if ( new_chain.i_depth )
-        TSDate( p_mux, &new_chain, i_pcr_length, i_pcr_dts );
+    if ( i_packet_count )
+        TSDate( p_mux, p_batch, i_first, i_packet_count, i_pcr_length,
+                i_pcr_dts );
 }
 
-static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static void TSDate( sout_mux_t *p_mux, ts_batch_t *p_batch, int i_first,
+                    int i_packet_count,
                     vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    int i_packet_count = p_chain_ts->i_depth;
 
     if ( unlikely(i_pcr_length / 1000 <= 0) )
     {
@@ -1727,20 +1871,19 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     }
 
     /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
-    block_t *p_list = NULL;
-    block_t **pp_last = &p_list;
     for (int i = 0; i < i_packet_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
+        ts_packet_t *p_ts = &p_batch->p_packets[i_first + i];
         vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
 
         p_ts->i_dts    = i_new_dts;
         p_ts->i_length = i_pcr_length / i_packet_count;
 
+        /* The packets are stamped and scrambled in place */
         if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
         {
             /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
-            TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            TSSetPCR( p_ts->p_buffer, p_ts->i_dts - p_sys->first_dts );
         }
         if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
         {
@@ -1751,15 +1894,49 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
 
         /* latency */
         p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+    }
+}
 
-        block_ChainLastAppend( &pp_last, p_ts );
+/* Sends the dated packets, each block with the timing and the flags of its
+ * packets */
+static void TSBatchSend( sout_mux_t *p_mux, ts_batch_t *p_batch )
+{
+    const ts_packet_t *p_ts = p_batch->p_packets;
+
+    for( block_t *p_block = p_batch->p_first; p_block != NULL;
+         p_block = p_block->p_next )
+    {
+        size_t i_count = p_block->i_buffer / 188;
+
+        p_block->i_dts = p_ts[0].i_dts;
+        p_block->i_length = 0;
+        for( size_t i = 0; i < i_count; i++ )
+        {
+            p_block->i_length += p_ts[i].i_length;
+            p_block->i_flags |= p_ts[i].i_flags &
+                                (BLOCK_FLAG_HEADER | BLOCK_FLAG_TYPE_I);
+        }
+        p_ts += i_count;
     }
-    if ( p_list != NULL )
-        sout_AccessOutWrite( p_mux->p_access, p_list );
+    assert( p_ts == &p_batch->p_packets[p_batch->i_depth] );
+
+    if( p_batch->p_first != NULL )
+        sout_AccessOutWrite( p_mux->p_access, p_batch->p_first );
+    TSBatchInit( p_batch );
+}
+
+/* Returns whether the next TS packet of the stream starts a key frame */
+static bool TSStartsKeyFrame( const sout_input_sys_t *p_stream )
+{
+    const block_t *p_pes = p_stream->state.chain_pes.p_first;
+
+    return p_stream->state.i_pes_used <= 0
+        && !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME)
+        && (p_pes->i_flags & BLOCK_FLAG_TYPE_I);
 }
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
-                       bool b_pcr )
+static void TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
+                   bool b_pcr, ts_packet_t *p_ts )
 {
     VLC_UNUSED(p_mux);
     block_t *p_pes = p_stream->state.chain_pes.p_first;
@@ -1781,12 +1958,8 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         b_adaptation_field = true;
     }
 
-    block_t *p_ts = block_Alloc( 188 );
-
-    if (b_new_pes && !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME) && p_pes->i_flags & BLOCK_FLAG_TYPE_I)
-    {
+    if( TSStartsKeyFrame( p_stream ) )
         p_ts->i_flags |= BLOCK_FLAG_TYPE_I;
-    }
 
     p_ts->i_dts = p_pes->i_dts;
 
@@ -1857,35 +2030,33 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         }
         p_stream->state.i_pes_used = 0;
     }
-
-    return p_ts;
 }
 
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts )
 {
     int64_t i_pcr = TO_SCALE_NZ(i_dts);
 
-    p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
-    p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
-    p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
-    p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
-    p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    p_ts[6]  = ( i_pcr >> 25 )&0xff;
+    p_ts[7]  = ( i_pcr >> 17 )&0xff;
+    p_ts[8]  = ( i_pcr >> 9  )&0xff;
+    p_ts[9]  = ( i_pcr >> 1  )&0xff;
+    p_ts[10] = ( i_pcr << 7  )&0x80;
+    p_ts[10] |= 0x7e;
+    p_ts[11] = 0; /* we don't set PCR extension */
 }
 
-void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+void GetPAT( sout_mux_t *p_mux, ts_batch_t *p_batch )
 {
     sout_mux_sys_t       *p_sys = p_mux->p_sys;
 
     BuildPAT( p_sys->p_dvbpsi,
-              c, (PEStoTSCallback)BufferChainAppend,
+              p_batch, TSBatchAppendBlock,
               p_sys->i_tsid, p_sys->i_pat_version_number,
               &p_sys->pat,
               p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number );
 }
 
-static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+static void GetPMT( sout_mux_t *p_mux, ts_batch_t *p_batch )
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
     pes_mapped_stream_t mapped[p_mux->i_nb_inputs];
@@ -1907,7 +2078,7 @@ static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
     }
 
     BuildPMT( p_sys->p_dvbpsi, VLC_OBJECT(p_mux), p_sys->standard,
-              c, (PEStoTSCallback)BufferChainAppend,
+              p_batch, TSBatchAppendBlock,
               p_sys->i_tsid, p_sys->i_pmt_version_number,
               ((sout_input_sys_t *)p_sys->p_pcr_input->p_sys)->ts.i_pid,
               &p_sys->sdt,
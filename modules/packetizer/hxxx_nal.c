@@ -120,7 +120,8 @@ block_t *hxxx_AnnexB_to_xVC( block_t *p_block, uint8_t i_nal_length_size )
     uint8_t *p_dest = NULL;
     const size_t i_dest = p_block->i_buffer + p_list[i_nalcount - 1].move;
 
-    if( p_list[i_nalcount - 1].move != 0 || i_nal_length_size != 4 )  /* We'll need to grow or shrink */
+    if( p_list[i_nalcount - 1].move != 0 || i_nal_length_size != 4 /* We'll need to grow or shrink */
+     || block_IsShared( p_block ) ) /* or can't write in place */
     {
         block_t *p_newblock = block_Alloc( i_dest );
         if( unlikely(!p_newblock) )
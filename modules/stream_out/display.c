@@ -120,7 +120,8 @@ static int Send( sout_stream_t *p_stream, void *id, block_t *p_buffer )
 
         p_buffer->p_next = NULL;
 
-        if( id != NULL && p_buffer->i_buffer > 0 )
+        if( id != NULL && p_buffer->i_buffer > 0
+         && (p_buffer = block_Unshare( p_buffer )) != NULL )
         {
             if( p_buffer->i_dts == VLC_TICK_INVALID )
                 p_buffer->i_dts = 0;
@@ -72,6 +72,7 @@ typedef struct
 {
     int                 i_nb_ids;
     void                **pp_ids;
+    bool                *pb_shared; /* decoded by another output */
 } sout_stream_id_sys_t;
 
 static bool ESSelected( struct vlc_logger *, const es_format_t *fmt,
@@ -202,6 +203,38 @@ static void Close( vlc_object_t * p_this )
     free( p_sys );
 }
 
+/*****************************************************************************
+ * ShareDecoders: decode the ES once for the outputs transcoding it
+ *****************************************************************************/
+static void ShareDecoders( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    for( int i_stream = 1; i_stream < id->i_nb_ids; i_stream++ )
+    {
+        if( !id->pp_ids[i_stream] )
+            continue;
+
+        for( int i_leader = 0; i_leader < i_stream; i_leader++ )
+        {
+            if( !id->pp_ids[i_leader] || id->pb_shared[i_leader] )
+                continue;
+
+            if( sout_StreamControl( p_sys->pp_streams[i_stream],
+                                    SOUT_STREAM_ID_SHARE_DECODER,
+                                    id->pp_ids[i_stream],
+                                    p_sys->pp_streams[i_leader],
+                                    id->pp_ids[i_leader] ) == VLC_SUCCESS )
+            {
+                msg_Dbg( p_stream, "    - output %d decoded by output %d",
+                         i_stream, i_leader );
+                id->pb_shared[i_stream] = true;
+                break;
+            }
+        }
+    }
+}
+
 /*****************************************************************************
  * Add:
  *****************************************************************************/
@@ -216,6 +249,12 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         return NULL;
 
     TAB_INIT( id->i_nb_ids, id->pp_ids );
+    id->pb_shared = calloc( p_sys->i_nb_streams, sizeof( *id->pb_shared ) );
+    if( !id->pb_shared )
+    {
+        free( id );
+        return NULL;
+    }
 
     msg_Dbg( p_stream, "duplicated a new stream codec=%4.4s (es=%d group=%d)",
              (char*)&p_fmt->i_codec, p_fmt->i_id, p_fmt->i_group );
@@ -256,6 +295,7 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         return NULL;
     }
 
+    ShareDecoders( p_stream, id );
     return id;
 }
 
@@ -278,6 +318,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
     }
 
     free( id->pp_ids );
+    free( id->pb_shared );
     free( id );
 }
 
@@ -290,6 +331,11 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
     sout_stream_t     *p_dup_stream;
     int               i_stream;
+    int               i_outputs = 0;
+
+    for( i_stream = 0; i_stream < p_sys->i_nb_streams; i_stream++ )
+        if( id->pp_ids[i_stream] && !id->pb_shared[i_stream] )
+            i_outputs++;
 
     /* Loop through the linked list of buffers */
     while( p_buffer )
@@ -298,20 +344,26 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 
         p_buffer->p_next = NULL;
 
+        /* The outputs reference the same payload, and only copy it if they
+         * need to modify it */
+        if( i_outputs > 1 )
+            p_buffer = block_Share( p_buffer );
+
         for( i_stream = 0; i_stream < p_sys->i_nb_streams - 1; i_stream++ )
         {
             p_dup_stream = p_sys->pp_streams[i_stream];
 
-            if( id->pp_ids[i_stream] )
+            if( id->pp_ids[i_stream] && !id->pb_shared[i_stream] )
             {
-                block_t *p_dup = block_Duplicate( p_buffer );
+                block_t *p_dup = block_Clone( p_buffer );
 
                 if( p_dup )
                     sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_dup );
             }
         }
 
-        if( i_stream < p_sys->i_nb_streams && id->pp_ids[i_stream] )
+        if( i_stream < p_sys->i_nb_streams && id->pp_ids[i_stream]
+         && !id->pb_shared[i_stream] )
         {
             p_dup_stream = p_sys->pp_streams[i_stream];
             sout_StreamIdSend( p_dup_stream, id->pp_ids[i_stream], p_buffer );
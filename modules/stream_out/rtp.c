@@ -1328,17 +1328,18 @@ static void* ThreadSend( void *data )
 {
     vlc_thread_set_name("vlc-rt-send");
 
-#ifdef _WIN32
-# define ENOBUFS      WSAENOBUFS
-# define EAGAIN       WSAEWOULDBLOCK
-# define EWOULDBLOCK  WSAEWOULDBLOCK
-#endif
     sout_stream_id_sys_t *id = data;
     vlc_tick_t i_caching = id->i_caching;
-    block_t *out;
+    block_t *out = NULL; /* first packet of the next batch */
 
-    while ((out = vlc_queue_DequeueKillable(&id->queue, &id->dead)) != NULL)
+    for( ;; )
     {
+        if( out == NULL )
+        {
+            out = vlc_queue_DequeueKillable(&id->queue, &id->dead);
+            if( out == NULL )
+                break;
+        }
 #ifdef HAVE_SRTP
         if( id->srtp )
         {   /* FIXME: this is awfully inefficient */
@@ -1352,6 +1353,7 @@ static void* ThreadSend( void *data )
                 msg_Dbg( id->p_stream, "SRTP sending error: %s",
                          vlc_strerror_c(val) );
                 block_Release( out );
+                out = NULL;
                 continue;
             }
             out->i_buffer = len;
@@ -1359,7 +1361,32 @@ static void* ThreadSend( void *data )
 #endif
         vlc_tick_wait (out->i_dts + i_caching);
 
-        ssize_t len = out->i_buffer;
+        /* The packets which are also due are sent at once. Others are paced
+         * by their timestamps. */
+        block_t *pktv[RTP_BATCH];
+        struct iovec iov[RTP_BATCH];
+        unsigned pktc = 0;
+        vlc_tick_t now = vlc_tick_now();
+
+        do
+        {
+            pktv[pktc] = out;
+            iov[pktc].iov_base = out->p_buffer;
+            iov[pktc].iov_len = out->i_buffer;
+            pktc++;
+            out = NULL;
+
+#ifdef HAVE_SRTP
+            if( id->srtp )
+                break;
+#endif
+            vlc_queue_Lock(&id->queue);
+            if( !vlc_queue_IsEmpty(&id->queue) )
+                out = vlc_queue_DequeueUnlocked(&id->queue);
+            vlc_queue_Unlock(&id->queue);
+        }
+        while( out != NULL && out->i_dts + i_caching <= now
+            && pktc < RTP_BATCH );
 
         vlc_mutex_lock( &id->lock_sink );
         unsigned deadc = 0; /* How many dead sockets? */
@@ -1370,26 +1397,17 @@ static void* ThreadSend( void *data )
 #ifdef HAVE_SRTP
             if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+                for( unsigned j = 0; j < pktc; j++ )
+                    SendRTCP( id->sinkv[i].rtcp, pktv[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
+            if( rtp_send_packets( id->sinkv[i].rtp_fd, iov, pktc ) )
+                deadv[deadc++] = id->sinkv[i].rtp_fd;
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
+        id->i_seq_sent_next = ntohs(((uint16_t *) pktv[pktc - 1]->p_buffer)[1]) + 1;
         vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
+
+        for( unsigned i = 0; i < pktc; i++ )
+            block_Release( pktv[i] );
 
         for( unsigned i = 0; i < deadc; i++ )
         {
@@ -50,6 +50,19 @@ uint16_t rtp_get_seq( sout_stream_id_sys_t *id );
 vlc_tick_t rtp_get_ts( const sout_stream_t *p_stream, const sout_stream_id_sys_t *id,
                        vlc_tick_t *p_npt );
 
+/* Maximum number of due packets sent together to each sink */
+#define RTP_BATCH 32
+
+/**
+ * Sends packets to a sink, with as few system calls as possible.
+ *
+ * Packets that cannot be sent for lack of resources are dropped.
+ *
+ * @param count number of packets (at most RTP_BATCH)
+ * @return 0, or -1 if the connection is broken.
+ */
+int rtp_send_packets( int fd, const struct iovec *iov, unsigned count );
+
 /* RTP packetization */
 void rtp_packetize_common (sout_stream_id_sys_t *id, block_t *out,
                            bool b_m_bit, vlc_tick_t i_pts);
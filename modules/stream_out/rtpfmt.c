@@ -1361,7 +1361,9 @@ static int rtp_packetize_h264( sout_stream_id_sys_t *id, block_t *in )
     {
         /* TODO add STAP-A to remove a lot of overhead with small slice/sei/... */
         rtp_packetize_h264_nal( id, p_nal, i_nal,
-                (in->i_pts != VLC_TICK_INVALID ? in->i_pts : in->i_dts), in->i_dts,
+                (in->i_pts != VLC_TICK_INVALID ? in->i_pts : in->i_dts),
+                /* pace the NAL units over the frame duration */
+                in->i_dts + in->i_length * (p_nal - in->p_buffer) / in->i_buffer,
                 it.p_head + 3 >= it.p_tail, in->i_length * i_nal / in->i_buffer );
     }
 
@@ -1442,7 +1444,9 @@ static int rtp_packetize_h265( sout_stream_id_sys_t *id, block_t *in )
     while( hxxx_annexb_iterate_next( &it, &p_nal, &i_nal ) )
     {
         rtp_packetize_h265_nal( id, p_nal, i_nal,
-                (in->i_pts != VLC_TICK_INVALID ? in->i_pts : in->i_dts), in->i_dts,
+                (in->i_pts != VLC_TICK_INVALID ? in->i_pts : in->i_dts),
+                /* pace the NAL units over the frame duration */
+                in->i_dts + in->i_length * (p_nal - in->p_buffer) / in->i_buffer,
                 it.p_head + 3 >= it.p_tail, in->i_length * i_nal / in->i_buffer );
     }
 
@@ -0,0 +1,81 @@
+/*****************************************************************************
+ * rtpsend.c: RTP stream output packets sending
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#include <vlc_network.h>
+#include <vlc_sout.h>
+#include "rtp.h"
+
+#include <errno.h>
+#include <assert.h>
+
+#ifdef _WIN32
+# define ENOBUFS      WSAENOBUFS
+# define EAGAIN       WSAEWOULDBLOCK
+# define EWOULDBLOCK  WSAEWOULDBLOCK
+#endif
+
+int rtp_send_packets( int fd, const struct iovec *iov, unsigned count )
+{
+    assert( count <= RTP_BATCH );
+
+    for( unsigned i = 0; i < count; i++ )
+    {
+#ifdef HAVE_SENDMMSG
+        struct mmsghdr msgv[RTP_BATCH];
+        unsigned n = count - i;
+
+        for( unsigned j = 0; j < n; j++ )
+            msgv[j].msg_hdr = (struct msghdr){
+                .msg_iov = (struct iovec *)&iov[i + j],
+                .msg_iovlen = 1,
+            };
+
+        int val = sendmmsg( fd, msgv, n, 0 );
+        if( val > 0 )
+        {
+            i += val - 1;
+            continue;
+        }
+#else
+        if( send( fd, iov[i].iov_base, iov[i].iov_len, 0 ) != -1 )
+            continue;
+#endif
+        /* The packet that could not be sent is skipped */
+        if( net_errno != EAGAIN && net_errno != EWOULDBLOCK
+         && net_errno != ENOBUFS && net_errno != ENOMEM )
+        {
+            int type;
+            getsockopt( fd, SOL_SOCKET, SO_TYPE,
+                        &type, &(socklen_t){ sizeof(type) });
+            if( type != SOCK_DGRAM )
+                return -1; /* Broken connection */
+            /* ICMP soft error: ignore and retry */
+            send( fd, iov[i].iov_base, iov[i].iov_len, 0 );
+        }
+    }
+    return 0;
+}
@@ -360,6 +360,9 @@ void AbstractDecodedStream::decoderThread()
 int AbstractDecodedStream::Send(block_t *p_block)
 {
     assert(p_decoder);
+    /* The decoder may modify its input in place */
+    if(p_block && !(p_block = block_Unshare(p_block)))
+        return VLC_ENOMEM;
     vlc_mutex_lock(&inputLock);
     inputQueue.push(p_block);
     if(p_block)
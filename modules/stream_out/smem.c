@@ -36,6 +36,10 @@
  *
  * the video-data and audio-data pointers will be passed to lock/unlock function
  *
+ * Alternatively, the audio tap callback receives the audio blocks themselves,
+ * without any copy, and becomes their owner. It receives a NULL block when the
+ * audio stream ends.
+ *
  ******************************************************************************/
 
 /*****************************************************************************
@@ -79,6 +83,11 @@
 #define T_AUDIO_DATA N_( "Audio callback data" )
 #define LT_AUDIO_DATA N_( "Data for the audio callback function." )
 
+#define T_AUDIO_TAP_CALLBACK N_( "Audio tap callback" )
+#define LT_AUDIO_TAP_CALLBACK N_( "Address of the audio tap callback function. " \
+                                  "This function will receive the audio buffers, " \
+                                  "instead of the prerender and postrender callbacks." )
+
 #define T_TIME_SYNC N_( "Time Synchronized output" )
 #define LT_TIME_SYNC N_( "Time Synchronisation option for output. " \
                         "If true, stream will render as usual, else " \
@@ -105,6 +114,8 @@ vlc_module_begin ()
         change_volatile()
     add_string( SOUT_PREFIX_AUDIO "postrender-callback", "0", T_AUDIO_POSTRENDER_CALLBACK, LT_AUDIO_POSTRENDER_CALLBACK )
         change_volatile()
+    add_string( SOUT_PREFIX_AUDIO "tap-callback", "0", T_AUDIO_TAP_CALLBACK, LT_AUDIO_TAP_CALLBACK )
+        change_volatile()
     add_string( SOUT_PREFIX_VIDEO "data", "0", T_VIDEO_DATA, LT_VIDEO_DATA )
         change_volatile()
     add_string( SOUT_PREFIX_AUDIO "data", "0", T_AUDIO_DATA, LT_VIDEO_DATA )
@@ -120,7 +131,8 @@ vlc_module_end ()
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
     "video-prerender-callback", "audio-prerender-callback",
-    "video-postrender-callback", "audio-postrender-callback", "video-data", "audio-data", "time-sync", NULL
+    "video-postrender-callback", "audio-postrender-callback", "audio-tap-callback",
+    "video-data", "audio-data", "time-sync", NULL
 };
 
 static void *Add( sout_stream_t *, const es_format_t * );
@@ -146,6 +158,7 @@ typedef struct
     void ( *pf_audio_prerender_callback ) ( void* p_audio_data, uint8_t** pp_pcm_buffer, size_t size );
     void ( *pf_video_postrender_callback ) ( void* p_video_data, uint8_t* p_pixel_buffer, int width, int height, int pixel_pitch, size_t size, vlc_tick_t pts );
     void ( *pf_audio_postrender_callback ) ( void* p_audio_data, uint8_t* p_pcm_buffer, unsigned int channels, unsigned int rate, unsigned int nb_samples, unsigned int bits_per_sample, size_t size, vlc_tick_t pts );
+    void ( *pf_audio_tap_callback ) ( void* p_audio_data, block_t* p_block, const es_format_t* p_fmt );
     bool time_sync;
 } sout_stream_sys_t;
 
@@ -252,6 +265,10 @@ static int Open( vlc_object_t *p_this )
     if (p_sys->pf_audio_postrender_callback == NULL)
         p_sys->pf_audio_postrender_callback = AudioPostrenderDefaultCallback;
 
+    psz_tmp = var_GetString( p_stream, SOUT_PREFIX_AUDIO "tap-callback" );
+    p_sys->pf_audio_tap_callback = (void (*) (void*, block_t*, const es_format_t*))(intptr_t)atoll( psz_tmp );
+    free( psz_tmp );
+
     /* Setting stream out module callbacks */
     p_stream->ops = &ops;
     return VLC_SUCCESS;
@@ -353,8 +370,13 @@ static void *AddAudio( sout_stream_t *p_stream, const es_format_t *p_fmt )
 
 static void Del( sout_stream_t *p_stream, void *_id )
 {
-    VLC_UNUSED( p_stream );
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+
+    /* Signal the end of the audio stream */
+    if ( id->format.i_cat == AUDIO_ES && p_sys->pf_audio_tap_callback != NULL )
+        p_sys->pf_audio_tap_callback( id->p_data, NULL, &id->format );
+
     es_format_Clean( &id->format );
     free( id );
 }
@@ -412,6 +434,22 @@ static int SendAudio( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
         return VLC_EGENERIC;
     }
 
+    if ( p_sys->pf_audio_tap_callback != NULL )
+    {
+        /* Hand the blocks over as they are */
+        while ( p_buffer != NULL )
+        {
+            block_t *p_next = p_buffer->p_next;
+            p_buffer->p_next = NULL;
+            /* The callback owns, and may modify, the block */
+            p_buffer = block_Unshare( p_buffer );
+            if ( p_buffer != NULL )
+                p_sys->pf_audio_tap_callback( id->p_data, p_buffer, &id->format );
+            p_buffer = p_next;
+        }
+        return VLC_SUCCESS;
+    }
+
     i_samples = i_size / ( ( id->format.audio.i_bitspersample / 8 ) * id->format.audio.i_channels );
     /* Calling the prerender callback to get user buffer */
     p_sys->pf_audio_prerender_callback( id->p_data, &p_pcm_buffer, i_size );
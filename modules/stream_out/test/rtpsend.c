@@ -0,0 +1,188 @@
+/**
+ * @file rtpsend.c
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA.
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <signal.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_network.h>
+#include <vlc_sout.h>
+#include "../rtp.h"
+
+const char vlc_module_name[] = "rtpsend_test";
+
+#define SIZE 1000
+
+static uint8_t payload[RTP_BATCH][SIZE];
+static struct iovec iov[RTP_BATCH];
+
+static void setup(void)
+{
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+    {
+        memset(payload[i], i, SIZE);
+        iov[i].iov_base = payload[i];
+        iov[i].iov_len = SIZE;
+    }
+}
+
+static void set_nonblock(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    assert(flags != -1);
+    assert(fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0);
+}
+
+/* Receives the pending packets, checks that they are the first ones of the
+ * batch, in order, and returns their number */
+static unsigned drain(int fd)
+{
+    uint8_t buf[SIZE + 1];
+    unsigned count = 0;
+    ssize_t len;
+
+    while ((len = recv(fd, buf, sizeof (buf), MSG_DONTWAIT)) != -1)
+    {
+        assert(len == SIZE);
+        assert(buf[0] == count && buf[SIZE - 1] == count);
+        count++;
+    }
+    assert(errno == EAGAIN || errno == EWOULDBLOCK);
+    return count;
+}
+
+/* Creates a pair of connected UDP sockets on the loopback interface */
+static void udp_pair(int fds[2])
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addrlen = sizeof (addr);
+
+    for (int i = 0; i < 2; i++)
+    {
+        fds[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        assert(fds[i] != -1);
+        assert(bind(fds[i], (struct sockaddr *)&addr, sizeof (addr)) == 0);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        assert(getsockname(fds[!i], (struct sockaddr *)&addr,
+                           &addrlen) == 0);
+        assert(connect(fds[i], (struct sockaddr *)&addr, addrlen) == 0);
+    }
+}
+
+/* All the packets are sent, in order */
+static void test_complete(void)
+{
+    int fds[2];
+
+    udp_pair(fds);
+    assert(setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF,
+                      &(int){ 1 << 20 }, sizeof (int)) == 0);
+
+    assert(rtp_send_packets(fds[0], iov, RTP_BATCH) == 0);
+    assert(drain(fds[1]) == RTP_BATCH);
+
+    /* Smaller batch */
+    assert(rtp_send_packets(fds[0], iov, 3) == 0);
+    assert(drain(fds[1]) == 3);
+
+    close(fds[1]);
+    close(fds[0]);
+}
+
+/* The sending buffer fills up during the batch: the packets that fit are
+ * sent in order, the others are dropped */
+static void test_partial(void)
+{
+    int fds[2];
+
+    assert(socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) == 0);
+    set_nonblock(fds[0]);
+    assert(setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF,
+                      &(int){ 4 * SIZE }, sizeof (int)) == 0);
+
+    assert(rtp_send_packets(fds[0], iov, RTP_BATCH) == 0);
+
+    unsigned count = drain(fds[1]);
+    assert(count > 0 && count < RTP_BATCH);
+
+    /* Once the buffer is available again, sending resumes */
+    assert(rtp_send_packets(fds[0], iov, 1) == 0);
+    assert(drain(fds[1]) == 1);
+
+    close(fds[1]);
+    close(fds[0]);
+}
+
+/* The receiver went away: a datagram socket is still usable */
+static void test_refused(void)
+{
+    int fds[2];
+
+    udp_pair(fds);
+    close(fds[1]);
+
+    for (int i = 0; i < 4; i++)
+        assert(rtp_send_packets(fds[0], iov, RTP_BATCH) == 0);
+
+    close(fds[0]);
+}
+
+/* A broken stream connection is reported */
+static void test_broken(void)
+{
+    int fds[2];
+
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    close(fds[1]);
+
+    assert(rtp_send_packets(fds[0], iov, RTP_BATCH) == -1);
+
+    close(fds[0]);
+}
+
+int main(void)
+{
+    /* A broken stream connection must not kill the process */
+    signal(SIGPIPE, SIG_IGN);
+    setup();
+
+    test_complete();
+    test_partial();
+    test_refused();
+    test_broken();
+    return 0;
+}
@@ -38,6 +38,15 @@
 
 #include "transcode.h"
 
+static void audio_update_decoder_out( sout_stream_id_sys_t *id,
+                                      const es_format_t *p_fmt )
+{
+    vlc_mutex_lock(&id->fifo.lock);
+    es_format_Clean( &id->decoder_out );
+    es_format_Copy( &id->decoder_out, p_fmt );
+    vlc_mutex_unlock(&id->fifo.lock);
+}
+
 static int audio_update_format( decoder_t *p_dec )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
@@ -49,10 +58,11 @@ static int audio_update_format( decoder_t *p_dec )
     if( !AOUT_FMT_LINEAR(&p_dec->fmt_out.audio) )
         return VLC_EGENERIC;
 
-    vlc_mutex_lock(&id->fifo.lock);
-    es_format_Clean( &id->decoder_out );
-    es_format_Copy( &id->decoder_out, &p_dec->fmt_out );
-    vlc_mutex_unlock(&id->fifo.lock);
+    audio_update_decoder_out( id, &p_dec->fmt_out );
+
+    sout_stream_id_sys_t *follower;
+    vlc_list_foreach( follower, &id->followers, follower_node )
+        audio_update_decoder_out( follower, &p_dec->fmt_out );
 
     return VLC_SUCCESS;
 }
@@ -75,17 +85,31 @@ static int transcode_audio_filters_init( sout_stream_t *p_stream,
     return ( *pp_chain != NULL ) ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
-static void decoder_queue_audio( decoder_t *p_dec, block_t *p_audio )
+static void transcode_queue_audio( sout_stream_id_sys_t *id, block_t *p_audio )
 {
-    struct decoder_owner *p_owner = dec_get_owner( p_dec );
-    sout_stream_id_sys_t *id = p_owner->id;
-
     vlc_mutex_lock(&id->fifo.lock);
     *id->fifo.audio.last = p_audio;
     id->fifo.audio.last = &p_audio->p_next;
     vlc_mutex_unlock(&id->fifo.lock);
 }
 
+static void decoder_queue_audio( decoder_t *p_dec, block_t *p_audio )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+    sout_stream_id_sys_t *id = p_owner->id;
+
+    /* The audio filters work in place: each follower gets its own copy */
+    sout_stream_id_sys_t *follower;
+    vlc_list_foreach( follower, &id->followers, follower_node )
+    {
+        block_t *p_copy = block_Duplicate( p_audio );
+        if( likely(p_copy != NULL) )
+            transcode_queue_audio( follower, p_copy );
+    }
+
+    transcode_queue_audio( id, p_audio );
+}
+
 static block_t *transcode_dequeue_all_audios( sout_stream_id_sys_t *id )
 {
     vlc_mutex_lock(&id->fifo.lock);
@@ -223,11 +247,29 @@ int transcode_audio_process( sout_stream_t *p_stream,
                                     sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
-    *out = NULL;
+    bool b_drain = in == NULL;
 
-    int ret = id->p_decoder->pf_decode( id->p_decoder, in );
-    if( ret != VLCDEC_SUCCESS )
-        return VLC_EGENERIC;
+    /* A shared decoder queues the samples from the stream of its leader */
+    if( !id->b_decoder_shared )
+    {
+        int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+        if( ret != VLCDEC_SUCCESS )
+        {
+            *out = NULL;
+            return VLC_EGENERIC;
+        }
+    }
+    else if( in != NULL )
+        block_Release( in );
+
+    return transcode_audio_output( p_stream, id, b_drain, out );
+}
+
+int transcode_audio_output( sout_stream_t *p_stream,
+                            sout_stream_id_sys_t *id,
+                            bool b_drain, block_t **out )
+{
+    *out = NULL;
 
     block_t *p_audio_bufs = transcode_dequeue_all_audios( id );
 
@@ -334,7 +376,6 @@ int transcode_audio_process( sout_stream_t *p_stream,
 
             block_t *p_block = transcode_encoder_encode( id->encoder, p_audio_buf );
             block_ChainAppend( out, p_block );
-            block_Release( p_audio_buf );
         }
         continue;
 error:
@@ -344,10 +385,12 @@ error:
     } while( p_audio_bufs );
 
     /* Drain encoder */
-    if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
+    if( unlikely( !id->b_error && b_drain ) && transcode_encoder_opened( id->encoder ) )
     {
         transcode_encoder_drain( id->encoder, out );
     }
+    else if( !id->b_error )
+        block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
 
     return id->b_error ? VLC_EGENERIC : VLC_SUCCESS;
 }
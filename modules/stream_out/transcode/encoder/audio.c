@@ -66,14 +66,20 @@ int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
     p_enc->p_encoder->p_module = module_need( p_enc->p_encoder, "audio encoder",
                                               p_cfg->psz_name, true );
 
-    if( p_enc->p_encoder->p_module )
+    if( !p_enc->p_encoder->p_module )
+        return VLC_EGENERIC;
+
+    assert( p_enc->p_encoder->ops != NULL );
+    p_enc->p_encoder->fmt_out.i_codec =
+            vlc_fourcc_GetCodec( AUDIO_ES, p_enc->p_encoder->fmt_out.i_codec );
+
+    if( transcode_encoder_async_start( p_enc, p_cfg ) )
     {
-        assert( p_enc->p_encoder->ops != NULL );
-        p_enc->p_encoder->fmt_out.i_codec =
-                vlc_fourcc_GetCodec( AUDIO_ES, p_enc->p_encoder->fmt_out.i_codec );
+        module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+        p_enc->p_encoder->p_module = NULL;
+        return VLC_EGENERIC;
     }
-
-    return ( p_enc->p_encoder->p_module ) ? VLC_SUCCESS: VLC_EGENERIC;
+    return VLC_SUCCESS;
 }
 
 static int encoder_audio_configure( const transcode_encoder_config_t *p_cfg,
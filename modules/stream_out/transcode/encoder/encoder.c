@@ -23,7 +23,6 @@
 #include <vlc_common.h>
 #include <vlc_modules.h>
 #include <vlc_codec.h>
-#include <vlc_picture_fifo.h>
 #include <vlc_aout.h>
 #include <vlc_sout.h>
 
@@ -46,11 +45,8 @@ void transcode_encoder_delete( transcode_encoder_t *p_enc )
 {
     if( p_enc->p_encoder )
     {
-        if( p_enc->p_encoder->fmt_in.i_cat == VIDEO_ES )
-        {
-            block_ChainRelease( p_enc->p_buffers );
-            picture_fifo_Delete( p_enc->pp_pics );
-        }
+        block_ChainRelease( p_enc->p_buffers );
+        free( p_enc->queue.pp_items );
         es_format_Clean( &p_enc->p_encoder->fmt_in );
         es_format_Clean( &p_enc->p_encoder->fmt_out );
         vlc_object_delete(p_enc->p_encoder);
@@ -93,23 +89,7 @@ transcode_encoder_t * transcode_encoder_new( encoder_t *p_encoder,
     if( p_enc->p_encoder->fmt_in.psz_language )
         p_enc->p_encoder->fmt_out.psz_language = strdup( p_enc->p_encoder->fmt_in.psz_language );
 
-    switch( p_fmt->i_cat )
-    {
-        case VIDEO_ES:
-            p_enc->pp_pics = picture_fifo_New();
-            if( !p_enc->pp_pics )
-            {
-                es_format_Clean( &p_enc->p_encoder->fmt_in );
-                es_format_Clean( &p_enc->p_encoder->fmt_out );
-                vlc_object_delete(p_enc->p_encoder);
-                free( p_enc );
-                return NULL;
-            }
-            vlc_mutex_init( &p_enc->lock_out );
-            break;
-        default:
-            break;
-    }
+    vlc_mutex_init( &p_enc->lock_out );
 
     return p_enc;
 }
@@ -153,7 +133,7 @@ bool transcode_encoder_opened( const transcode_encoder_t *p_enc )
     return p_enc->p_encoder && p_enc->p_encoder->p_module;
 }
 
-block_t * transcode_encoder_encode( transcode_encoder_t *p_enc, void *in )
+static block_t * Encode( transcode_encoder_t *p_enc, void *in )
 {
     switch( p_enc->p_encoder->fmt_in.i_cat )
     {
@@ -169,8 +149,49 @@ block_t * transcode_encoder_encode( transcode_encoder_t *p_enc, void *in )
     }
 }
 
+static void ReleaseInput( transcode_encoder_t *p_enc, void *in )
+{
+    switch( p_enc->p_encoder->fmt_in.i_cat )
+    {
+        case VIDEO_ES:
+            picture_Release( in );
+            break;
+        case AUDIO_ES:
+            block_Release( in );
+            break;
+        case SPU_ES:
+            subpicture_Delete( in );
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+}
+
+block_t * transcode_encoder_encode( transcode_encoder_t *p_enc, void *in )
+{
+    if( p_enc->b_threaded )
+    {
+        if( in )
+            transcode_encoder_async_push( p_enc, in );
+        return NULL;
+    }
+
+    block_t *p_block = Encode( p_enc, in );
+    if( in )
+        ReleaseInput( p_enc, in );
+    return p_block;
+}
+
+bool transcode_encoder_async( const transcode_encoder_t *p_enc )
+{
+    return p_enc->b_threaded;
+}
+
 block_t * transcode_encoder_get_output_async( transcode_encoder_t *p_enc )
 {
+    if( !p_enc->b_threaded )
+        return NULL;
+
     vlc_mutex_lock( &p_enc->lock_out );
     block_t *p_data = p_enc->p_buffers;
     p_enc->p_buffers = NULL;
@@ -178,11 +199,183 @@ block_t * transcode_encoder_get_output_async( transcode_encoder_t *p_enc )
     return p_data;
 }
 
+static void *EncoderThread( void *obj )
+{
+    vlc_thread_set_name("vlc-encoder");
+
+    transcode_encoder_t *p_enc = obj;
+    int canc = vlc_savecancel ();
+
+    vlc_mutex_lock( &p_enc->lock_out );
+
+    for( ;; )
+    {
+        while( !p_enc->b_abort && p_enc->queue.i_count == 0 )
+            vlc_cond_wait( &p_enc->cond, &p_enc->lock_out );
+        /* Encode what we have in the queue on closing */
+        if( p_enc->queue.i_count == 0 )
+            break;
+
+        void *in = p_enc->queue.pp_items[p_enc->queue.i_first];
+        p_enc->queue.i_first = (p_enc->queue.i_first + 1) % p_enc->queue.i_size;
+        p_enc->queue.i_count--;
+        unsigned i_flushes = p_enc->i_flushes;
+        vlc_sem_post( &p_enc->pool_has_room );
+
+        /* release lock while encoding */
+        vlc_mutex_unlock( &p_enc->lock_out );
+        block_t *p_block = Encode( p_enc, in );
+        ReleaseInput( p_enc, in );
+        vlc_mutex_lock( &p_enc->lock_out );
+
+        if( i_flushes == p_enc->i_flushes )
+            block_ChainAppend( &p_enc->p_buffers, p_block );
+        else if( p_block )
+            block_ChainRelease( p_block );
+    }
+
+    /* Now flush encoder */
+    if( p_enc->b_drain && p_enc->p_encoder->fmt_in.i_cat != SPU_ES )
+    {
+        block_t *p_block;
+        do {
+            p_block = Encode( p_enc, NULL );
+            block_ChainAppend( &p_enc->p_buffers, p_block );
+        } while( p_block );
+    }
+
+    vlc_mutex_unlock( &p_enc->lock_out );
+
+    vlc_restorecancel (canc);
+
+    return NULL;
+}
+
+int transcode_encoder_async_start( transcode_encoder_t *p_enc,
+                                   const transcode_encoder_config_t *p_cfg )
+{
+    if( p_cfg->threads.i_count == 0 )
+        return VLC_SUCCESS;
+
+    size_t i_size = __MAX( p_cfg->threads.pool_size, 1 );
+    p_enc->queue.pp_items = vlc_alloc( i_size, sizeof(void *) );
+    if( !p_enc->queue.pp_items )
+        return VLC_ENOMEM;
+    p_enc->queue.i_size = i_size;
+    p_enc->queue.i_first = p_enc->queue.i_count = 0;
+
+    vlc_sem_init( &p_enc->pool_has_room, i_size );
+    vlc_cond_init( &p_enc->cond );
+    p_enc->p_buffers = NULL;
+    p_enc->b_abort = p_enc->b_drain = false;
+    p_enc->i_flushes = 0;
+    p_enc->i_queue_max = 0;
+    p_enc->i_queued = p_enc->i_waits = 0;
+
+    if( vlc_clone( &p_enc->thread, EncoderThread, p_enc ) )
+    {
+        free( p_enc->queue.pp_items );
+        p_enc->queue.pp_items = NULL;
+        return VLC_EGENERIC;
+    }
+    p_enc->b_threaded = true;
+    return VLC_SUCCESS;
+}
+
+void transcode_encoder_async_push( transcode_encoder_t *p_enc, void *in )
+{
+    /* The thread is gone after draining */
+    if( p_enc->b_abort )
+    {
+        ReleaseInput( p_enc, in );
+        return;
+    }
+
+    /* Wait for the encoder when it is late, this is the back pressure */
+    bool b_wait = vlc_sem_trywait( &p_enc->pool_has_room ) != 0;
+    if( b_wait )
+        vlc_sem_wait( &p_enc->pool_has_room );
+
+    vlc_mutex_lock( &p_enc->lock_out );
+    size_t i_last = (p_enc->queue.i_first + p_enc->queue.i_count) % p_enc->queue.i_size;
+    p_enc->queue.pp_items[i_last] = in;
+    p_enc->queue.i_count++;
+
+    p_enc->i_queued++;
+    if( b_wait )
+        p_enc->i_waits++;
+    if( p_enc->queue.i_count > p_enc->i_queue_max )
+        p_enc->i_queue_max = p_enc->queue.i_count;
+
+    vlc_cond_signal( &p_enc->cond );
+    vlc_mutex_unlock( &p_enc->lock_out );
+}
+
+void transcode_encoder_async_drain( transcode_encoder_t *p_enc, block_t **out )
+{
+    if( !p_enc->b_abort )
+    {
+        vlc_mutex_lock( &p_enc->lock_out );
+        p_enc->b_abort = true;
+        p_enc->b_drain = true;
+        vlc_cond_signal( &p_enc->cond );
+        vlc_mutex_unlock( &p_enc->lock_out );
+        vlc_join( p_enc->thread, NULL );
+    }
+    block_ChainAppend( out, transcode_encoder_get_output_async( p_enc ) );
+}
+
+void transcode_encoder_flush( transcode_encoder_t *p_enc )
+{
+    if( !p_enc->b_threaded )
+        return;
+
+    vlc_mutex_lock( &p_enc->lock_out );
+    while( p_enc->queue.i_count > 0 )
+    {
+        ReleaseInput( p_enc, p_enc->queue.pp_items[p_enc->queue.i_first] );
+        p_enc->queue.i_first = (p_enc->queue.i_first + 1) % p_enc->queue.i_size;
+        p_enc->queue.i_count--;
+        vlc_sem_post( &p_enc->pool_has_room );
+    }
+    /* Drop the output of the input being encoded too */
+    p_enc->i_flushes++;
+    block_ChainRelease( p_enc->p_buffers );
+    p_enc->p_buffers = NULL;
+    vlc_mutex_unlock( &p_enc->lock_out );
+}
+
+void transcode_encoder_async_stop( transcode_encoder_t *p_enc )
+{
+    if( !p_enc->b_threaded )
+        return;
+
+    if( !p_enc->b_abort )
+    {
+        transcode_encoder_flush( p_enc );
+        vlc_mutex_lock( &p_enc->lock_out );
+        p_enc->b_abort = true;
+        vlc_cond_signal( &p_enc->cond );
+        vlc_mutex_unlock( &p_enc->lock_out );
+        vlc_join( p_enc->thread, NULL );
+    }
+
+    msg_Dbg( p_enc->p_encoder, "encoder queue: %"PRIu64" inputs, %zu/%zu "
+             "at most, %"PRIu64" waits for room", p_enc->i_queued,
+             p_enc->i_queue_max, p_enc->queue.i_size, p_enc->i_waits );
+
+    free( p_enc->queue.pp_items );
+    p_enc->queue.pp_items = NULL;
+    p_enc->b_threaded = false;
+}
+
 void transcode_encoder_close( transcode_encoder_t *p_enc )
 {
     if( !p_enc->p_encoder->p_module )
         return;
 
+    transcode_encoder_async_stop( p_enc );
+
     switch( p_enc->p_encoder->fmt_in.i_cat )
     {
         case VIDEO_ES:
@@ -218,6 +411,12 @@ int transcode_encoder_drain( transcode_encoder_t *p_enc, block_t **out )
     if( !transcode_encoder_opened( p_enc ) )
         return VLC_EGENERIC;
 
+    if( p_enc->b_threaded )
+    {
+        transcode_encoder_async_drain( p_enc, out );
+        return VLC_SUCCESS;
+    }
+
     switch( p_enc->p_encoder->fmt_in.i_cat )
     {
         case VIDEO_ES:
@@ -29,6 +29,11 @@ typedef struct
     char         *psz_name;
     char         *psz_lang;
     config_chain_t *p_config_chain;
+    struct
+    {
+        unsigned int i_count; /* 0 to encode on the caller thread */
+        uint32_t     pool_size; /* bound of the queue to the encoder thread */
+    } threads;
     union
     {
         struct
@@ -39,11 +44,7 @@ typedef struct
             unsigned int    i_height, i_maxheight;
             bool            b_hurry_up;
             vlc_rational_t  fps;
-            struct
-            {
-                unsigned int i_count;
-                uint32_t     pool_size;
-            } threads;
+            int             i_keyint; /* >0 fixed GOP, <0 automatic, 0 encoder default */
         } video;
         struct
         {
@@ -69,7 +70,9 @@ void transcode_encoder_update_format_in( transcode_encoder_t *, const es_format_
 void transcode_encoder_update_format_out( transcode_encoder_t *, const es_format_t * );
 
 block_t * transcode_encoder_encode( transcode_encoder_t *, void * );
+bool transcode_encoder_async( const transcode_encoder_t * );
 block_t * transcode_encoder_get_output_async( transcode_encoder_t * );
+void transcode_encoder_flush( transcode_encoder_t * );
 void transcode_encoder_delete( transcode_encoder_t * );
 transcode_encoder_t * transcode_encoder_new( encoder_t *, const es_format_t * );
 void transcode_encoder_close( transcode_encoder_t * );
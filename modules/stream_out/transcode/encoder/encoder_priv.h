@@ -16,21 +16,34 @@
  * You should have received a copy of the GNU Lesser General Public License
  * along with this program; if not, If not, see https://www.gnu.org/licenses/
  *****************************************************************************/
-#include <vlc_picture_fifo.h>
-
 struct transcode_encoder_t
 {
     encoder_t       *p_encoder;
+
+    /* asynchronous encoding, when threads.i_count > 0 */
     vlc_thread_t    thread;
     vlc_mutex_t     lock_out;
-    bool            b_abort;
-    picture_fifo_t *pp_pics;
-    vlc_sem_t       picture_pool_has_room;
     vlc_cond_t      cond;
+    vlc_sem_t       pool_has_room;
+    bool            b_threaded;
+    bool            b_abort;
+    bool            b_drain; /* encode the delayed data before leaving */
+    unsigned        i_flushes; /* output of older inputs is discarded */
+    struct
+    {
+        void        **pp_items; /* pictures, blocks or subpictures */
+        size_t      i_first;
+        size_t      i_count;
+        size_t      i_size;
+    } queue;
+
+    /* queue statistics */
+    size_t          i_queue_max;
+    uint64_t        i_queued;
+    uint64_t        i_waits; /* queued after waiting for room */
 
     /* output buffers */
     block_t         *p_buffers;
-    bool b_threaded;
 };
 
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
@@ -40,6 +53,12 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
 int transcode_encoder_spu_open( transcode_encoder_t *p_enc,
                                 const transcode_encoder_config_t *p_cfg );
 
+int transcode_encoder_async_start( transcode_encoder_t *p_enc,
+                                   const transcode_encoder_config_t *p_cfg );
+void transcode_encoder_async_stop( transcode_encoder_t *p_enc );
+void transcode_encoder_async_push( transcode_encoder_t *p_enc, void *in );
+void transcode_encoder_async_drain( transcode_encoder_t *p_enc, block_t **out );
+
 void transcode_encoder_video_close( transcode_encoder_t *p_enc );
 
 block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t *p_pic );
@@ -45,10 +45,18 @@ int transcode_encoder_spu_open( transcode_encoder_t *p_enc,
     p_enc->p_encoder->p_module = module_need( p_enc->p_encoder, "spu encoder",
                                               p_cfg->psz_name, true );
 
-    assert( p_enc->p_encoder->p_module == NULL ||
-            p_enc->p_encoder->ops != NULL);
+    if( !p_enc->p_encoder->p_module )
+        return VLC_EGENERIC;
 
-    return ( p_enc->p_encoder->p_module ) ? VLC_SUCCESS: VLC_EGENERIC;
+    assert( p_enc->p_encoder->ops != NULL );
+
+    if( transcode_encoder_async_start( p_enc, p_cfg ) )
+    {
+        module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+        p_enc->p_encoder->p_module = NULL;
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
 }
 
 block_t * transcode_encoder_spu_encode( transcode_encoder_t *p_enc, subpicture_t *p_spu )
@@ -0,0 +1,429 @@
+/*****************************************************************************
+ * ladder.c: transcoding stream output module (video renditions)
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_sout.h>
+
+#include "transcode.h"
+
+/* Each rendition receives the pictures of the main video encoder, after the
+ * shared decoder and filters, and converts and encodes them on its own
+ * thread. The encoded blocks are sent downstream from the stream output
+ * thread, to their own elementary stream. */
+typedef struct
+{
+    sout_stream_t   *p_stream;
+    transcode_encoder_config_t cfg;
+
+    vlc_thread_t    thread;
+    vlc_mutex_t     lock;
+    vlc_cond_t      wait;
+    vlc_sem_t       room; /**< pictures allowed in the fifo */
+    picture_fifo_t *pics;
+    bool            b_abort; /**< drain the fifo and the encoder, and stop */
+    bool            b_discard; /**< drop the pending pictures instead */
+    bool            b_joined;
+    unsigned        i_flushes; /**< flushes since the rendition started */
+
+    /* only accessed by the rendition thread */
+    transcode_encoder_t *encoder;
+    filter_chain_t  *p_conv; /**< converter to the encoder format */
+    video_format_t  fmt_src;
+    bool            b_error;
+
+    /* protected by lock */
+    block_t         *p_out;
+    bool            b_ready; /**< fmt_out is valid */
+    es_format_t     fmt_out;
+
+    /* only accessed by the stream output thread */
+    es_format_t     fmt_orig;
+    void            *downstream_id;
+} transcode_rendition_t;
+
+struct transcode_ladder_t
+{
+    size_t                 i_count;
+    transcode_rendition_t *p_renditions;
+};
+
+static vlc_decoder_device *rendition_get_encoder_device( encoder_t *p_enc )
+{
+    VLC_UNUSED( p_enc );
+    /* renditions are encoded from software pictures */
+    return NULL;
+}
+
+static const struct encoder_owner_callbacks rendition_encoder_cbs = {
+    { rendition_get_encoder_device, }
+};
+
+static picture_t *rendition_filter_buffer_new( filter_t *p_filter )
+{
+    return picture_NewFromFormat( &p_filter->fmt_out.video );
+}
+
+static vlc_decoder_device *rendition_filter_hold_device( vlc_object_t *o,
+                                                         void *sys )
+{
+    VLC_UNUSED( o ); VLC_UNUSED( sys );
+    return NULL;
+}
+
+static const struct filter_video_callbacks rendition_filter_cbs =
+{
+    rendition_filter_buffer_new, rendition_filter_hold_device,
+};
+
+static int RenditionConverterInit( transcode_rendition_t *r )
+{
+    const es_format_t *p_enc_in = transcode_encoder_format_in( r->encoder );
+
+    transcode_remove_filters( &r->p_conv );
+    if( video_format_IsSimilar( &r->fmt_src, &p_enc_in->video ) )
+        return VLC_SUCCESS;
+
+    filter_owner_t owner = {
+        .video = &rendition_filter_cbs,
+        .sys = r,
+    };
+    r->p_conv = filter_chain_NewVideo( r->p_stream, false, &owner );
+    if( !r->p_conv )
+        return VLC_ENOMEM;
+
+    es_format_t src;
+    es_format_Init( &src, VIDEO_ES, r->fmt_src.i_chroma );
+    video_format_Copy( &src.video, &r->fmt_src );
+    filter_chain_Reset( r->p_conv, &src, NULL, p_enc_in );
+    es_format_Clean( &src );
+
+    return filter_chain_AppendConverter( r->p_conv, NULL );
+}
+
+static int RenditionOpen( transcode_rendition_t *r, const video_format_t *p_src )
+{
+    encoder_t *p_encoder = sout_EncoderCreate( r->p_stream,
+                                               sizeof(*p_encoder) );
+    if( unlikely(!p_encoder) )
+        return VLC_ENOMEM;
+    p_encoder->cbs = &rendition_encoder_cbs;
+
+    es_format_t fmt;
+    es_format_Init( &fmt, VIDEO_ES, p_src->i_chroma );
+    video_format_Copy( &fmt.video, p_src );
+    r->encoder = transcode_encoder_new( p_encoder, &fmt );
+    es_format_Clean( &fmt );
+    if( !r->encoder )
+        return VLC_ENOMEM;
+
+    transcode_encoder_video_configure( VLC_OBJECT(r->p_stream), p_src,
+                                       &r->cfg, p_src, NULL, r->encoder );
+    if( transcode_encoder_open( r->encoder, &r->cfg ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    video_format_Copy( &r->fmt_src, p_src );
+    if( RenditionConverterInit( r ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    const es_format_t *p_enc_out = transcode_encoder_format_out( r->encoder );
+    msg_Dbg( r->p_stream, "video rendition %ux%u opened",
+             p_enc_out->video.i_visible_width,
+             p_enc_out->video.i_visible_height );
+
+    vlc_mutex_lock( &r->lock );
+    es_format_Copy( &r->fmt_out, p_enc_out );
+    r->b_ready = true;
+    vlc_mutex_unlock( &r->lock );
+    return VLC_SUCCESS;
+}
+
+static block_t *RenditionEncode( transcode_rendition_t *r, picture_t *p_pic )
+{
+    if( !r->encoder )
+        r->b_error = RenditionOpen( r, &p_pic->format ) != VLC_SUCCESS;
+    else if( !video_format_IsSimilar( &p_pic->format, &r->fmt_src ) )
+    {
+        /* The encoder keeps its format, only the conversion changes */
+        video_format_Clean( &r->fmt_src );
+        video_format_Copy( &r->fmt_src, &p_pic->format );
+        r->b_error = RenditionConverterInit( r ) != VLC_SUCCESS;
+    }
+
+    if( r->b_error )
+    {
+        msg_Err( r->p_stream, "video rendition %ux%u failed, disabling it",
+                 r->cfg.video.i_width, r->cfg.video.i_height );
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    if( r->p_conv )
+    {
+        p_pic = filter_chain_VideoFilter( r->p_conv, p_pic );
+        if( !p_pic )
+            return NULL;
+    }
+
+    return transcode_encoder_encode( r->encoder, p_pic );
+}
+
+static void *RenditionThread( void *data )
+{
+    vlc_thread_set_name( "vlc-rendition" );
+
+    transcode_rendition_t *r = data;
+    int canc = vlc_savecancel();
+    bool b_discard;
+
+    for( ;; )
+    {
+        picture_t *p_pic;
+        unsigned i_flushes;
+
+        vlc_mutex_lock( &r->lock );
+        while( (p_pic = picture_fifo_Pop( r->pics )) == NULL && !r->b_abort )
+            vlc_cond_wait( &r->wait, &r->lock );
+        b_discard = r->b_discard;
+        i_flushes = r->i_flushes;
+        vlc_mutex_unlock( &r->lock );
+
+        if( !p_pic )
+            break;
+        vlc_sem_post( &r->room );
+
+        if( b_discard || r->b_error )
+        {
+            picture_Release( p_pic );
+            continue;
+        }
+
+        block_t *p_block = RenditionEncode( r, p_pic );
+        if( p_block )
+        {
+            vlc_mutex_lock( &r->lock );
+            /* Drop the output of a picture flushed while being encoded */
+            if( i_flushes != r->i_flushes )
+                block_ChainRelease( p_block );
+            else
+                block_ChainAppend( &r->p_out, p_block );
+            vlc_mutex_unlock( &r->lock );
+        }
+    }
+
+    if( !b_discard && !r->b_error && r->encoder &&
+        transcode_encoder_opened( r->encoder ) )
+    {
+        block_t *p_block = NULL;
+        transcode_encoder_drain( r->encoder, &p_block );
+        vlc_mutex_lock( &r->lock );
+        block_ChainAppend( &r->p_out, p_block );
+        vlc_mutex_unlock( &r->lock );
+    }
+
+    vlc_restorecancel( canc );
+    return NULL;
+}
+
+static void RenditionStop( transcode_rendition_t *r, bool b_discard )
+{
+    if( r->b_joined )
+        return;
+
+    vlc_mutex_lock( &r->lock );
+    r->b_abort = true;
+    r->b_discard = b_discard;
+    vlc_cond_signal( &r->wait );
+    vlc_mutex_unlock( &r->lock );
+
+    vlc_join( r->thread, NULL );
+    r->b_joined = true;
+}
+
+static void RenditionClean( sout_stream_t *p_stream, transcode_rendition_t *r )
+{
+    RenditionStop( r, true );
+
+    block_ChainRelease( r->p_out );
+    if( r->downstream_id )
+        sout_StreamIdDel( p_stream->p_next, r->downstream_id );
+
+    transcode_remove_filters( &r->p_conv );
+    if( r->encoder )
+    {
+        transcode_encoder_close( r->encoder );
+        transcode_encoder_delete( r->encoder );
+    }
+    picture_fifo_Delete( r->pics );
+    video_format_Clean( &r->fmt_src );
+    es_format_Clean( &r->fmt_out );
+    es_format_Clean( &r->fmt_orig );
+    transcode_encoder_config_clean( &r->cfg );
+}
+
+static int RenditionInit( sout_stream_t *p_stream, transcode_rendition_t *r,
+                          const es_format_t *p_fmt,
+                          const transcode_encoder_config_t *p_cfg )
+{
+    r->p_stream = p_stream;
+    r->cfg = *p_cfg;
+    r->cfg.psz_name = p_cfg->psz_name ? strdup( p_cfg->psz_name ) : NULL;
+    r->cfg.psz_lang = p_cfg->psz_lang ? strdup( p_cfg->psz_lang ) : NULL;
+    r->cfg.p_config_chain = config_ChainDuplicate( p_cfg->p_config_chain );
+
+    r->pics = picture_fifo_New();
+    if( !r->pics )
+    {
+        transcode_encoder_config_clean( &r->cfg );
+        return VLC_ENOMEM;
+    }
+    vlc_mutex_init( &r->lock );
+    vlc_cond_init( &r->wait );
+    vlc_sem_init( &r->room, __MAX( p_cfg->threads.pool_size, 1 ) );
+    video_format_Init( &r->fmt_src, 0 );
+    es_format_Init( &r->fmt_out, VIDEO_ES, 0 );
+
+    /* The renditions are distinct elementary streams of the same program */
+    es_format_Copy( &r->fmt_orig, p_fmt );
+    r->fmt_orig.i_id = -1;
+
+    if( vlc_clone( &r->thread, RenditionThread, r ) )
+    {
+        r->b_joined = true;
+        RenditionClean( p_stream, r );
+        return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+transcode_ladder_t *transcode_ladder_new( sout_stream_t *p_stream,
+                                          const es_format_t *p_fmt,
+                                          const transcode_encoder_config_t *p_cfgs,
+                                          size_t i_count )
+{
+    transcode_ladder_t *p_ladder = malloc( sizeof(*p_ladder) );
+    if( !p_ladder )
+        return NULL;
+
+    p_ladder->p_renditions = calloc( i_count, sizeof(transcode_rendition_t) );
+    if( !p_ladder->p_renditions )
+    {
+        free( p_ladder );
+        return NULL;
+    }
+
+    for( p_ladder->i_count = 0; p_ladder->i_count < i_count;
+         p_ladder->i_count++ )
+    {
+        if( RenditionInit( p_stream,
+                           &p_ladder->p_renditions[p_ladder->i_count],
+                           p_fmt, &p_cfgs[p_ladder->i_count] ) )
+        {
+            transcode_ladder_delete( p_stream, p_ladder );
+            return NULL;
+        }
+    }
+
+    msg_Dbg( p_stream, "%zu extra video renditions", i_count );
+    return p_ladder;
+}
+
+void transcode_ladder_push( transcode_ladder_t *p_ladder, picture_t *p_pic )
+{
+    for( size_t i = 0; i < p_ladder->i_count; i++ )
+    {
+        transcode_rendition_t *r = &p_ladder->p_renditions[i];
+
+        /* Wait for the slowest rendition, rather than buffering for it */
+        vlc_sem_wait( &r->room );
+        vlc_mutex_lock( &r->lock );
+        picture_fifo_Push( r->pics, picture_Hold( p_pic ) );
+        vlc_cond_signal( &r->wait );
+        vlc_mutex_unlock( &r->lock );
+    }
+}
+
+void transcode_ladder_flush( transcode_ladder_t *p_ladder )
+{
+    for( size_t i = 0; i < p_ladder->i_count; i++ )
+    {
+        transcode_rendition_t *r = &p_ladder->p_renditions[i];
+        picture_t *p_pic;
+
+        vlc_mutex_lock( &r->lock );
+        while( (p_pic = picture_fifo_Pop( r->pics )) != NULL )
+        {
+            picture_Release( p_pic );
+            vlc_sem_post( &r->room );
+        }
+        r->i_flushes++;
+        block_ChainRelease( r->p_out );
+        r->p_out = NULL;
+        vlc_mutex_unlock( &r->lock );
+    }
+}
+
+void transcode_ladder_send( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                            bool b_drain )
+{
+    transcode_ladder_t *p_ladder = id->p_ladder;
+
+    for( size_t i = 0; i < p_ladder->i_count; i++ )
+    {
+        transcode_rendition_t *r = &p_ladder->p_renditions[i];
+
+        if( b_drain )
+            RenditionStop( r, false );
+
+        vlc_mutex_lock( &r->lock );
+        block_t *p_out = r->p_out;
+        r->p_out = NULL;
+        if( r->b_ready && !r->downstream_id )
+        {
+            r->b_ready = false;
+            r->downstream_id =
+                id->pf_transcode_downstream_add( p_stream, &r->fmt_orig,
+                                                 &r->fmt_out );
+        }
+        vlc_mutex_unlock( &r->lock );
+
+        if( !p_out )
+            continue;
+        if( !r->downstream_id )
+            block_ChainRelease( p_out );
+        else if( sout_StreamIdSend( p_stream->p_next, r->downstream_id, p_out ) )
+            msg_Warn( p_stream, "could not send video rendition %zu", i );
+    }
+}
+
+void transcode_ladder_delete( sout_stream_t *p_stream,
+                              transcode_ladder_t *p_ladder )
+{
+    for( size_t i = 0; i < p_ladder->i_count; i++ )
+        RenditionClean( p_stream, &p_ladder->p_renditions[i] );
+    free( p_ladder->p_renditions );
+    free( p_ladder );
+}
@@ -242,13 +242,20 @@ int transcode_spu_process( sout_stream_t *p_stream,
             es_format_Clean( &fmt );
 
             p_block = transcode_encoder_encode( id->encoder, p_subpic );
-            subpicture_Delete( p_subpic );
             if( p_block )
                 block_ChainAppend( out, p_block );
-            else
+            else if( !transcode_encoder_async( id->encoder ) )
                 b_error = true;
         }
     } while( p_subpics );
 
+    if( id->encoder && transcode_encoder_opened( id->encoder ) )
+    {
+        if( in == NULL )
+            transcode_encoder_drain( id->encoder, out );
+        else
+            block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
+    }
+
     return b_error ? VLC_EGENERIC : VLC_SUCCESS;
 }
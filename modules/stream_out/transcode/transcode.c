@@ -33,6 +33,7 @@
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_modules.h>
 #include <vlc_sout.h>
 #include <vlc_spu.h>
 
@@ -75,6 +76,18 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define LADDER_TEXT N_("Video renditions")
+#define LADDER_LONGTEXT N_( \
+    "Comma-separated list of extra video renditions, encoded from the same " \
+    "decoded and filtered pictures, as WIDTHxHEIGHT@BITRATE (the bitrate in " \
+    "kb/s, the width or the height can be omitted to keep the aspect ratio). "\
+    "Each rendition is scaled and encoded on its own thread." )
+#define KEYINT_TEXT N_("Key frame interval")
+#define KEYINT_LONGTEXT N_( \
+    "Forces a closed GOP of this many frames on the video encoders, so that " \
+    "all the renditions have their key frames at the same positions. " \
+    "-1 uses two seconds of frames, 0 leaves it to the encoder, unless " \
+    "renditions are requested." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -103,6 +116,10 @@
 #define AFILTER_LONGTEXT N_( \
     "Audio filters will be applied to the audio streams (after conversion " \
     "filters are applied). You can enter a colon-separated list of filters." )
+#define ATHREAD_TEXT N_("Audio encoder thread")
+#define ATHREAD_LONGTEXT N_( \
+    "Encode the audio in a separate thread, so that slow audio encoders do " \
+    "not delay the other streams." )
 
 #define SENC_TEXT N_("Subtitle encoder")
 #define SENC_LONGTEXT N_( \
@@ -113,6 +130,9 @@
     "This is the subtitle codec that will be used." )
 
 #define SOVERLAY_TEXT N_("Subtitle overlay")
+#define STHREAD_TEXT N_("Subtitle encoder thread")
+#define STHREAD_LONGTEXT N_( \
+    "Encode the subtitles in a separate thread." )
 
 #define SFILTER_TEXT N_("Overlays")
 #define SFILTER_LONGTEXT N_( \
@@ -129,8 +149,8 @@
     "Runs the optional encoder thread at the OUTPUT priority instead of " \
     "VIDEO." )
 #define POOL_TEXT N_("Picture pool size")
-#define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
-    "between decoder/encoder threads when threads > 0" )
+#define POOL_LONGTEXT N_( "Defines how many pictures, audio buffers or "\
+    "subpictures we allow to be queued to an encoder thread" )
 
 
 /* Note: Skip adding translated accompanying labels - too technical, not worth it */
@@ -177,6 +197,11 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
+    add_string( SOUT_CFG_PREFIX "ladder", NULL, LADDER_TEXT,
+                LADDER_LONGTEXT )
+    add_integer( SOUT_CFG_PREFIX "keyint", 0, KEYINT_TEXT,
+                 KEYINT_LONGTEXT )
+        change_integer_range( -1, 1000 )
 
     set_section( N_("Audio"), NULL )
     add_module(SOUT_CFG_PREFIX "aenc", "audio encoder", "none",
@@ -195,6 +220,8 @@ vlc_module_begin ()
         change_integer_range( 0, 48000 )
     add_module_list(SOUT_CFG_PREFIX "afilter",  "audio filter", NULL,
                     AFILTER_TEXT, AFILTER_LONGTEXT)
+    add_bool( SOUT_CFG_PREFIX "athread", false, ATHREAD_TEXT,
+              ATHREAD_LONGTEXT )
 
     set_section( N_("Overlays/Subtitles"), NULL )
     add_module(SOUT_CFG_PREFIX "senc", "spu encoder", "none",
@@ -204,6 +231,8 @@ vlc_module_begin ()
     add_bool( SOUT_CFG_PREFIX "soverlay", false, SOVERLAY_TEXT, NULL )
     add_module_list(SOUT_CFG_PREFIX "sfilter", "sub source", NULL,
                     SFILTER_TEXT, SFILTER_LONGTEXT)
+    add_bool( SOUT_CFG_PREFIX "sthread", false, STHREAD_TEXT,
+              STHREAD_LONGTEXT )
 
     set_section( N_("Miscellaneous"), NULL )
     add_integer( SOUT_CFG_PREFIX "threads", 0, THREADS_TEXT,
@@ -221,6 +250,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
+    "ladder", "keyint", "athread", "sthread",
     NULL
 };
 
@@ -279,6 +309,9 @@ static void SetAudioEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
     }
 
     p_cfg->psz_lang = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "alang" );
+
+    p_cfg->threads.i_count = var_GetBool( p_stream, SOUT_CFG_PREFIX "athread" );
+    p_cfg->threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
 }
 
 static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
@@ -320,8 +353,74 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
     p_cfg->video.i_maxwidth = var_GetInteger( p_stream, SOUT_CFG_PREFIX "maxwidth" );
     p_cfg->video.i_maxheight = var_GetInteger( p_stream, SOUT_CFG_PREFIX "maxheight" );
 
-    p_cfg->video.threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
-    p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+    p_cfg->threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
+    p_cfg->threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+
+    p_cfg->video.i_keyint = var_GetInteger( p_stream, SOUT_CFG_PREFIX "keyint" );
+}
+
+static void SetVideoLadderConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_string = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "ladder" );
+    if( !psz_string )
+        return;
+
+    const transcode_encoder_config_t *p_main = &p_sys->venc_cfg;
+    char *psz_save;
+
+    for( char *psz_rung = strtok_r( psz_string, ",", &psz_save );
+         psz_rung != NULL; psz_rung = strtok_r( NULL, ",", &psz_save ) )
+    {
+        /* WIDTHxHEIGHT@BITRATE, with optional parts */
+        unsigned i_width, i_height = 0, i_bitrate = 0;
+        char *psz_end;
+
+        i_width = strtoul( psz_rung, &psz_end, 10 );
+        if( *psz_end == 'x' )
+            i_height = strtoul( psz_end + 1, &psz_end, 10 );
+        if( *psz_end == '@' )
+            i_bitrate = strtoul( psz_end + 1, &psz_end, 10 );
+        if( *psz_end != '\0' || ( !i_width && !i_height ) )
+        {
+            msg_Warn( p_stream, "invalid video rendition `%s'", psz_rung );
+            continue;
+        }
+
+        transcode_encoder_config_t *p_cfgs =
+            realloc( p_sys->p_vladder_cfg,
+                     (p_sys->i_vladder + 1) * sizeof(*p_cfgs) );
+        if( unlikely(!p_cfgs) )
+            break;
+        p_sys->p_vladder_cfg = p_cfgs;
+
+        transcode_encoder_config_t *p_cfg = &p_cfgs[p_sys->i_vladder++];
+        *p_cfg = *p_main;
+        p_cfg->psz_name = p_main->psz_name ? strdup( p_main->psz_name ) : NULL;
+        p_cfg->psz_lang = p_main->psz_lang ? strdup( p_main->psz_lang ) : NULL;
+        p_cfg->p_config_chain = config_ChainDuplicate( p_main->p_config_chain );
+        p_cfg->video.f_scale = 0.f;
+        p_cfg->video.i_width = i_width;
+        p_cfg->video.i_height = i_height;
+        p_cfg->video.i_maxwidth = p_cfg->video.i_maxheight = 0;
+        if( i_bitrate )
+            p_cfg->video.i_bitrate = i_bitrate < 16000 ? i_bitrate * 1000
+                                                       : i_bitrate;
+        /* the rendition has its own thread already */
+        p_cfg->threads.i_count = 0;
+
+        msg_Dbg( p_stream, "video rendition %ux%u %ukb/s", i_width, i_height,
+                 p_cfg->video.i_bitrate / 1000 );
+    }
+    free( psz_string );
+
+    /* Segmenters need the key frames of all the renditions at the same
+     * positions */
+    if( p_sys->i_vladder > 0 && p_sys->venc_cfg.video.i_keyint == 0 )
+    {
+        p_sys->venc_cfg.video.i_keyint = -1;
+        for( size_t i = 0; i < p_sys->i_vladder; i++ )
+            p_sys->p_vladder_cfg[i].video.i_keyint = -1;
+    }
 }
 
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
@@ -346,7 +445,61 @@ static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_conf
     }
     free( psz_string );
 
+    p_cfg->threads.i_count = var_GetBool( p_stream, SOUT_CFG_PREFIX "sthread" );
+    p_cfg->threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+}
+static const struct sout_stream_operations ops;
+
+static int ShareDecoder( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                         sout_stream_t *p_leader_stream,
+                         sout_stream_id_sys_t *leader )
+{
+    /* Only the decoders of other transcode streams can be shared */
+    if( p_leader_stream->ops != &ops || leader == id )
+        return VLC_EGENERIC;
+
+    /* The subtitles are rendered by the video of each stream */
+    int i_cat = id->p_decoder->fmt_in.i_cat;
+    if( i_cat != AUDIO_ES && i_cat != VIDEO_ES )
+        return VLC_EGENERIC;
+
+    if( !id->b_transcode || id->b_error || id->b_decoder_shared
+     || !vlc_list_is_empty( &id->followers ) )
+        return VLC_EGENERIC;
+    if( !leader->b_transcode || leader->b_error || leader->b_decoder_shared
+     || leader->p_decoder->p_module == NULL
+     || !es_format_IsSimilar( &leader->p_decoder->fmt_in,
+                              &id->p_decoder->fmt_in ) )
+        return VLC_EGENERIC;
+
+    msg_Dbg( p_stream, "sharing the %s decoder of another stream",
+             i_cat == VIDEO_ES ? "video" : "audio" );
+
+    module_unneed( id->p_decoder, id->p_decoder->p_module );
+    id->p_decoder->p_module = NULL;
+    id->b_decoder_shared = true;
+    id->p_leader = leader;
+    vlc_list_append( &id->follower_node, &leader->followers );
+    return VLC_SUCCESS;
+}
+
+static void UnshareDecoder( sout_stream_id_sys_t *id )
+{
+    /* The followers of a deleted leader do not get more data */
+    sout_stream_id_sys_t *follower;
+    vlc_list_foreach( follower, &id->followers, follower_node )
+    {
+        vlc_list_remove( &follower->follower_node );
+        follower->p_leader = NULL;
+    }
+
+    if( id->p_leader )
+    {
+        vlc_list_remove( &id->follower_node );
+        id->p_leader = NULL;
+    }
 }
+
 /*****************************************************************************
  * Control
  *****************************************************************************/
@@ -363,12 +516,39 @@ static int Control( sout_stream_t *p_stream, int i_query, va_list args )
                                            id->downstream_id, spu_hl );
             break;
         }
+        case SOUT_STREAM_ID_SHARE_DECODER:
+        {
+            sout_stream_id_sys_t *id = va_arg(args, void *);
+            sout_stream_t *p_leader_stream = va_arg(args, sout_stream_t *);
+            sout_stream_id_sys_t *leader = va_arg(args, void *);
+            return ShareDecoder( p_stream, id, p_leader_stream, leader );
+        }
     }
     return VLC_EGENERIC;
 }
 
+static void Flush( sout_stream_t *p_stream, void *_id )
+{
+    sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+
+    if( id->b_transcode )
+    {
+        /* A shared decoder is flushed by its leader */
+        if( !id->b_decoder_shared && id->p_decoder->pf_flush )
+            id->p_decoder->pf_flush( id->p_decoder );
+        /* Drop the data queued to the encoder thread */
+        if( id->encoder )
+            transcode_encoder_flush( id->encoder );
+        if( id->p_decoder->fmt_in.i_cat == VIDEO_ES && id->p_ladder )
+            transcode_ladder_flush( id->p_ladder );
+    }
+
+    if( id->downstream_id )
+        sout_StreamFlush( p_stream->p_next, id->downstream_id );
+}
+
 static const struct sout_stream_operations ops = {
-    Add, Del, Send, Control, NULL,
+    Add, Del, Send, Control, Flush,
 };
 
 /*****************************************************************************
@@ -411,6 +591,7 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_height,
                  p_sys->venc_cfg.video.f_scale,
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
+        SetVideoLadderConfig( p_stream, p_sys );
     }
 
     /* Video Filter Parameters */
@@ -470,6 +651,9 @@ static void Close( vlc_object_t * p_this )
     sout_stream_sys_t   *p_sys = p_stream->p_sys;
 
     transcode_encoder_config_clean( &p_sys->venc_cfg );
+    for( size_t i = 0; i < p_sys->i_vladder; i++ )
+        transcode_encoder_config_clean( &p_sys->p_vladder_cfg[i] );
+    free( p_sys->p_vladder_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
 
     transcode_encoder_config_clean( &p_sys->aenc_cfg );
@@ -573,6 +757,7 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
         return NULL;
 
     vlc_mutex_init(&id->fifo.lock);
+    vlc_list_init( &id->followers );
     id->pf_transcode_downstream_add = transcode_downstream_Add;
 
     /* Create decoder object */
@@ -668,6 +853,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
         {
         case AUDIO_ES:
             Send( p_stream, id, NULL );
+            UnshareDecoder( id );
             decoder_Destroy( id->p_decoder );
             vlc_mutex_lock( &p_sys->lock );
             if( id == p_sys->id_master_sync )
@@ -680,11 +866,14 @@ static void Del( sout_stream_t *p_stream, void *_id )
              * decoder/encoder might not even exist. */
             if(!id->b_error)
                 Send( p_stream, id, NULL );
+            UnshareDecoder( id );
             decoder_Destroy( id->p_decoder );
             vlc_mutex_lock( &p_sys->lock );
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
+            if( id->p_ladder )
+                transcode_ladder_delete( p_stream, id->p_ladder );
             transcode_video_clean( id );
             break;
         case SPU_ES:
@@ -702,9 +891,30 @@ static void Del( sout_stream_t *p_stream, void *_id )
     DeleteSoutStreamID( id );
 }
 
+static void SendDecoded( sout_stream_id_sys_t *id )
+{
+    sout_stream_t *p_stream = dec_get_owner( id->p_decoder )->p_stream;
+    block_t *p_out = NULL;
+    int i_ret;
+
+    /* Also run on errors, to release the queued data */
+    if( id->p_decoder->fmt_in.i_cat == AUDIO_ES )
+        i_ret = transcode_audio_output( p_stream, id, false, &p_out );
+    else
+        i_ret = transcode_video_output( p_stream, id, false, &p_out );
+
+    if( p_out &&
+        sout_StreamIdSend( p_stream->p_next, id->downstream_id, p_out ) )
+        i_ret = VLC_EGENERIC;
+
+    if (i_ret != VLC_SUCCESS)
+        id->b_error = true;
+}
+
 static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 {
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+    sout_stream_id_sys_t *follower;
     block_t *p_out = NULL;
 
     if( id->b_error )
@@ -718,6 +928,14 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
             goto error;
     }
 
+    if( p_buffer != NULL )
+    {
+        /* The decoder may modify its input in place */
+        p_buffer = block_Unshare( p_buffer );
+        if( unlikely(p_buffer == NULL) )
+            return VLC_ENOMEM;
+    }
+
     int i_ret;
     switch( id->p_decoder->fmt_in.i_cat )
     {
@@ -744,9 +962,21 @@ static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
     if (i_ret != VLC_SUCCESS)
         id->b_error = true;
 
+    /* Output what the streams sharing the decoder got from this block */
+    vlc_list_foreach( follower, &id->followers, follower_node )
+        SendDecoded( follower );
+
     return i_ret;
 error:
     if( p_buffer )
         block_Release( p_buffer );
+
+    /* The streams sharing the decoder will not get more pictures: output
+     * what they got, and fail them too */
+    vlc_list_foreach( follower, &id->followers, follower_node )
+    {
+        SendDecoded( follower );
+        follower->b_error = true;
+    }
     return VLC_EGENERIC;
 }
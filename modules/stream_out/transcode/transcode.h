@@ -1,3 +1,4 @@
+#include <vlc_list.h>
 #include <vlc_picture_fifo.h>
 #include <vlc_filter.h>
 #include <vlc_codec.h>
@@ -40,6 +41,7 @@ void sout_filters_config_clean( sout_filters_config_t *p_cfg )
 }
 
 typedef struct sout_stream_id_sys_t sout_stream_id_sys_t;
+typedef struct transcode_ladder_t transcode_ladder_t;
 
 typedef struct
 {
@@ -52,6 +54,9 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    /* Extra video renditions of the same decoded pictures */
+    transcode_encoder_config_t *p_vladder_cfg;
+    size_t          i_vladder;
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -83,6 +88,12 @@ struct sout_stream_id_sys_t
 
     /* Decoder */
     decoder_t       *p_decoder;
+    /* Decoder shared by the same ES in other transcode streams, see
+     * SOUT_STREAM_ID_SHARE_DECODER */
+    bool            b_decoder_shared; /**< decoded by another stream */
+    sout_stream_id_sys_t *p_leader; /**< decoding for this one, if any */
+    struct vlc_list followers; /**< decoded by this one */
+    struct vlc_list follower_node;
 
     struct
     {
@@ -127,6 +138,7 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             transcode_ladder_t *p_ladder; /**< extra renditions */
          };
          struct
          {
@@ -198,6 +210,8 @@ int  transcode_spu_init   ( sout_stream_t *, const es_format_t *, sout_stream_id
 void transcode_audio_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_audio_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
+int  transcode_audio_output ( sout_stream_t *, sout_stream_id_sys_t *,
+                              bool, block_t ** );
 int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
                               sout_stream_id_sys_t *);
 
@@ -206,8 +220,21 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 void transcode_video_clean  ( sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
+int  transcode_video_output ( sout_stream_t *, sout_stream_id_sys_t *,
+                              bool, block_t ** );
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
                                            unsigned *w, unsigned *h );
 void transcode_video_push_spu( sout_stream_t *, sout_stream_id_sys_t *, subpicture_t * );
 int  transcode_video_init    ( sout_stream_t *, const es_format_t *,
                                sout_stream_id_sys_t *);
+
+/* VIDEO LADDER */
+
+transcode_ladder_t *transcode_ladder_new( sout_stream_t *,
+                                          const es_format_t *,
+                                          const transcode_encoder_config_t *,
+                                          size_t );
+void transcode_ladder_push( transcode_ladder_t *, picture_t * );
+void transcode_ladder_flush( transcode_ladder_t * );
+void transcode_ladder_send( sout_stream_t *, sout_stream_id_sys_t *, bool );
+void transcode_ladder_delete( sout_stream_t *, transcode_ladder_t * );
@@ -48,6 +48,9 @@ struct encoder_owner
 
 static vlc_decoder_device *TranscodeHoldDecoderDevice(vlc_object_t *o, sout_stream_id_sys_t *id)
 {
+    /* The pictures of a shared decoder belong to the device of the leader */
+    if (id->p_leader != NULL)
+        id = id->p_leader;
     if (id->dec_dev == NULL)
         id->dec_dev = vlc_decoder_device_Create( o, NULL );
     return id->dec_dev ? vlc_decoder_device_Hold(id->dec_dev) : NULL;
@@ -61,10 +64,7 @@ static inline struct encoder_owner *enc_get_owner( encoder_t *p_enc )
 static vlc_decoder_device *video_get_encoder_device( encoder_t *enc )
 {
     struct encoder_owner *p_owner = enc_get_owner( enc );
-    if (p_owner->id->dec_dev == NULL)
-        p_owner->id->dec_dev = vlc_decoder_device_Create( &enc->obj, NULL );
-
-    return p_owner->id->dec_dev ? vlc_decoder_device_Hold(p_owner->id->dec_dev) : NULL;
+    return TranscodeHoldDecoderDevice( &enc->obj, p_owner->id );
 }
 
 static const struct encoder_owner_callbacks encoder_video_transcode_cbs = {
@@ -114,7 +114,7 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
                                          const es_format_t *p_dst,
                                          sout_stream_id_sys_t *id );
 
-static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vctx )
+static int video_update_format( decoder_t *p_dec, vlc_video_context *vctx )
 {
     struct decoder_owner *p_owner = dec_get_owner( p_dec );
     sout_stream_id_sys_t *id = p_owner->id;
@@ -243,19 +243,42 @@ error:
     return VLC_EGENERIC;
 }
 
-static picture_t *video_new_buffer_encoder( transcode_encoder_t *p_enc )
+static int video_update_format_decoder( decoder_t *p_dec, vlc_video_context *vctx )
 {
-    return picture_NewFromFormat( &transcode_encoder_format_in( p_enc )->video );
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+    int ret = video_update_format( p_dec, vctx );
+
+    /* The followers convert and encode the same pictures on their own */
+    sout_stream_id_sys_t *follower;
+    vlc_list_foreach( follower, &p_owner->id->followers, follower_node )
+    {
+        decoder_t *p_follower_dec = follower->p_decoder;
+
+        es_format_Clean( &p_follower_dec->fmt_out );
+        es_format_Copy( &p_follower_dec->fmt_out, &p_dec->fmt_out );
+        if( video_update_format( p_follower_dec, vctx ) != VLC_SUCCESS )
+            follower->b_error = true;
+    }
+    return ret;
 }
 
 static int transcode_process_picture( sout_stream_id_sys_t *id,
                                       picture_t *p_pic, block_t **out);
 
-static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
+/**
+ * Checks whether the user filters or the subpicture blending of a stream may
+ * write to its decoded pictures in place.
+ */
+static bool transcode_video_writes_in_place( const sout_stream_id_sys_t *id )
 {
-    struct decoder_owner *p_owner = dec_get_owner( p_dec );
-    sout_stream_id_sys_t *id = p_owner->id;
+    const sout_filters_config_t *p_cfg = id->p_filterscfg;
+
+    return p_cfg != NULL
+        && (p_cfg->psz_filters != NULL || p_cfg->video.b_reorient);
+}
 
+static void transcode_queue_picture( sout_stream_id_sys_t *id, picture_t *p_pic )
+{
     block_t *p_block = NULL;
     int ret = transcode_process_picture( id, p_pic, &p_block );
 
@@ -275,6 +298,35 @@ static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
     vlc_fifo_Unlock( id->output_fifo );
 }
 
+static void decoder_queue_video( decoder_t *p_dec, picture_t *p_pic )
+{
+    struct decoder_owner *p_owner = dec_get_owner( p_dec );
+    sout_stream_id_sys_t *id = p_owner->id;
+
+    /* The followers filter and blend the same pictures on their own: they
+     * only share the pixels if neither they nor the leader modify them */
+    const bool leader_writes = transcode_video_writes_in_place( id );
+    sout_stream_id_sys_t *follower;
+    vlc_list_foreach( follower, &id->followers, follower_node )
+    {
+        picture_t *p_copy;
+
+        if( leader_writes || transcode_video_writes_in_place( follower ) )
+        {
+            p_copy = picture_NewFromFormat( &p_pic->format );
+            if( likely(p_copy != NULL) )
+                picture_Copy( p_copy, p_pic );
+        }
+        else
+            p_copy = picture_Clone( p_pic );
+
+        if( likely(p_copy != NULL) )
+            transcode_queue_picture( follower, p_copy );
+    }
+
+    transcode_queue_picture( id, p_pic );
+}
+
 int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
                           sout_stream_id_sys_t *id )
 {
@@ -287,6 +339,20 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     if( id->output_fifo == NULL )
         return VLC_ENOMEM;
 
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    if( p_sys->i_vladder > 0 )
+    {
+        id->p_ladder = transcode_ladder_new( p_stream, p_fmt,
+                                             p_sys->p_vladder_cfg,
+                                             p_sys->i_vladder );
+        if( !id->p_ladder )
+        {
+            msg_Err( p_stream, "cannot create the video renditions" );
+            block_FifoRelease( id->output_fifo );
+            return VLC_EGENERIC;
+        }
+    }
+
     id->b_transcode = true;
     es_format_Init( &id->decoder_out, VIDEO_ES, 0 );
 
@@ -314,6 +380,11 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     {
         msg_Err( p_stream, "cannot find video decoder" );
         es_format_Clean( &id->decoder_out );
+        if( id->p_ladder )
+        {
+            transcode_ladder_delete( p_stream, id->p_ladder );
+            id->p_ladder = NULL;
+        }
         return VLC_EGENERIC;
     }
     if( id->decoder_out.i_codec == 0 ) /* format_update can happen on open() */
@@ -468,9 +539,8 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
     {
         if( filter_chain_IsEmpty( id->p_f_chain ) )
         {
-            /* We can't modify the picture, we need to duplicate it,
-                 * in this point the picture is already p_encoder->fmt.in format*/
-            picture_t *p_tmp = video_new_buffer_encoder( id->encoder );
+            /* We can't modify the picture, we need to duplicate it */
+            picture_t *p_tmp = picture_NewFromFormat( &p_pic->format );
             if( likely( p_tmp ) )
             {
                 picture_Copy( p_tmp, p_pic );
@@ -520,26 +590,31 @@ static int transcode_process_picture( sout_stream_id_sys_t *id,
         for( ;; p_in = NULL /* drain second time */ )
         {
             /* Run user specified filter chain */
-            filter_chain_t * secondary_chains[] = { id->p_uf_chain,
-                                                    id->p_final_conv_static };
-            for( size_t i=0; i<ARRAY_SIZE(secondary_chains); i++ )
+            if( id->p_uf_chain )
+                p_in = filter_chain_VideoFilter( id->p_uf_chain, p_in );
+
+            /* The extra renditions share the pictures up to there, with the
+             * subpictures blended before the conversions */
+            if( p_in && id->p_ladder )
             {
-                if( !secondary_chains[i] )
-                    continue;
-                p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
+                p_in = RenderSubpictures( id, p_in );
+                transcode_ladder_push( id->p_ladder, p_in );
             }
 
+            if( id->p_final_conv_static )
+                p_in = filter_chain_VideoFilter( id->p_final_conv_static, p_in );
+
             if( !p_in )
                 break;
 
             /* Blend subpictures */
-            p_in = RenderSubpictures( id, p_in );
+            if( !id->p_ladder )
+                p_in = RenderSubpictures( id, p_in );
 
             if( p_in )
             {
                 /* If a packetizer is used, multiple blocks might be returned, in w */
                 block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
-                picture_Release( p_in );
                 block_ChainAppend( out, p_encoded );
             }
         }
@@ -554,19 +629,45 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
     *out = NULL;
 
     bool b_eos = in && (in->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
+    bool b_drain = in == NULL;
 
-    int ret = id->p_decoder->pf_decode( id->p_decoder, in );
-    if( ret != VLCDEC_SUCCESS )
-        return VLC_EGENERIC;
+    /* A shared decoder queues the pictures from the stream of its leader */
+    if( !id->b_decoder_shared )
+    {
+        int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+        if( ret != VLCDEC_SUCCESS )
+            return VLC_EGENERIC;
+    }
+    else if( in != NULL )
+        block_Release( in );
+
+    int ret = transcode_video_output( p_stream, id, b_drain, out );
+
+    if( b_eos )
+        tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
+
+    return ret;
+}
+
+int transcode_video_output( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                            bool b_drain, block_t **out )
+{
+    *out = NULL;
 
-    /* Only drain if we drained the decoder too. */
-    if (in != NULL)
-        return VLC_SUCCESS;
+    if( id->p_ladder )
+        transcode_ladder_send( p_stream, id, b_drain );
 
-    /* Drain encoder */
     vlc_fifo_Lock( id->output_fifo );
+    bool has_error = id->b_error;
+    if( !has_error )
+    {
+        vlc_frame_t *pendings = vlc_fifo_DequeueAllUnlocked( id->output_fifo );
+        block_ChainAppend(out, pendings);
+    }
+
+    /* Drain encoder, only if we drained the decoder too. */
     assert(id->encoder);
-    if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
+    if( !has_error && b_drain && transcode_encoder_opened( id->encoder ) )
     {
         msg_Dbg( p_stream, "Flushing thread and waiting that");
         if( transcode_encoder_drain( id->encoder, out ) == VLC_SUCCESS )
@@ -574,16 +675,9 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
         else
             msg_Warn( p_stream, "Flushing failed");
     }
-    bool has_error = id->b_error;
-    if( !has_error )
-    {
-        vlc_frame_t *pendings = vlc_fifo_DequeueAllUnlocked( id->output_fifo );
-        block_ChainAppend(out, pendings);
-    }
+    else if( !has_error )
+        block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
     vlc_fifo_Unlock( id->output_fifo );
 
-    if( b_eos )
-        tag_last_block_with_flag( out, BLOCK_FLAG_END_OF_SEQUENCE );
-
     return has_error ? VLC_EGENERIC : VLC_SUCCESS;
 }
@@ -89,6 +89,8 @@ typedef struct vout_display_sys_t {
     void (*unlock)(void *sys, void *id, void *const *plane);
     void (*display)(void *sys, void *id);
     void (*cleanup)(void *sys);
+    void (*frame)(void *sys, picture_t *pic);
+    picture_t *frame_last; /**< last picture handed out (held) */
 
     unsigned pitches[PICTURE_PLANE_MAX];
     unsigned lines[PICTURE_PLANE_MAX];
@@ -108,6 +110,44 @@ static const struct vlc_display_operations ops = {
     .control = Control,
 };
 
+static void           PrepareFrame(vout_display_t *, picture_t *, subpicture_t *, vlc_tick_t);
+
+static const struct vlc_display_operations frame_ops = {
+    .close = Close,
+    .prepare = PrepareFrame,
+    .control = Control,
+};
+
+/* Subpictures are handed to the display, which ignores them, so that the
+ * decoded pictures are never copied to blend them. */
+static const vlc_fourcc_t frame_subpicture_chromas[] = { VLC_CODEC_RGBA, 0 };
+
+/*****************************************************************************
+ * OpenFrame: hands out the pictures without copying them
+ *****************************************************************************/
+static int OpenFrame(vout_display_t *vd, vout_display_sys_t *sys,
+                     video_format_t *fmtp)
+{
+    video_format_t fmt = *vd->source;
+
+    /* Opaque hardware surfaces must be converted first */
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(fmt.i_chroma);
+    if (dsc == NULL || dsc->plane_count == 0)
+        fmt.i_chroma = VLC_CODEC_I420;
+
+    sys->cleanup = NULL;
+    sys->opaque = var_InheritAddress(vd, "vmem-frame-data");
+    sys->frame_last = NULL;
+
+    *fmtp = fmt;
+
+    vd->info.subpicture_chromas = frame_subpicture_chromas;
+    vd->sys = sys;
+    vd->ops = &frame_ops;
+    return VLC_SUCCESS;
+}
+
 /*****************************************************************************
  * Open: allocates video thread
  *****************************************************************************
@@ -121,6 +161,12 @@ static int Open(vout_display_t *vd,
         return VLC_ENOMEM;
 
     /* Get the callbacks */
+    sys->frame = var_InheritAddress(vd, "vmem-frame");
+    if (sys->frame != NULL) {
+        (void) context;
+        return OpenFrame(vd, sys, fmtp);
+    }
+
     vlc_format_cb setup = var_InheritAddress(vd, "vmem-setup");
 
     sys->lock = var_InheritAddress(vd, "vmem-lock");
@@ -231,6 +277,8 @@ static void Close(vout_display_t *vd)
 
     if (sys->cleanup)
         sys->cleanup(sys->opaque);
+    if (sys->frame != NULL && sys->frame_last != NULL)
+        picture_Release(sys->frame_last);
     free(sys);
 }
 
@@ -262,6 +310,26 @@ static void Prepare(vout_display_t *vd, picture_t *pic, subpicture_t *subpic,
     (void) subpic;
 }
 
+static void PrepareFrame(vout_display_t *vd, picture_t *pic,
+                         subpicture_t *subpic, vlc_tick_t date)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    /* The video output redisplays the last picture when it has nothing new,
+     * e.g. while paused: do not hand it out twice. Distinct pictures may have
+     * the same date, so compare the pictures themselves. The last one is held
+     * so that its address cannot be reused by a new picture meanwhile. */
+    if (pic == sys->frame_last)
+        return;
+    if (sys->frame_last != NULL)
+        picture_Release(sys->frame_last);
+    sys->frame_last = picture_Hold(pic);
+
+    /* The callback takes ownership of the reference */
+    sys->frame(sys->opaque, picture_Hold(pic));
+    (void) subpic; (void) date;
+}
+
 static void Display(vout_display_t *vd, picture_t *pic)
 {
     vout_display_sys_t *sys = vd->sys;
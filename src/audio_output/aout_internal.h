@@ -138,6 +138,7 @@ struct vlc_aout_stream_cfg
     int profile;
     struct vlc_clock_t *clock;
     const char *str_id;
+    struct vlc_latency *latency;
     const audio_replay_gain_t *replay_gain;
 };
 
@@ -37,6 +37,7 @@
 
 #include "aout_internal.h"
 #include "clock/clock.h"
+#include "input/latency.h"
 #include "libvlc.h"
 
 struct vlc_aout_stream
@@ -62,6 +63,7 @@ struct vlc_aout_stream
     vlc_tick_t original_pts;
 
     const char *str_id;
+    struct vlc_latency *latency;
 
     /* Original input format and profile, won't change for the lifetime of a
      * stream (between vlc_aout_stream_New() and vlc_aout_stream_Delete()). */
@@ -192,6 +194,7 @@ vlc_aout_stream * vlc_aout_stream_New(audio_output_t *p_aout,
 
     stream->sync.clock = cfg->clock;
     stream->str_id = cfg->str_id;
+    stream->latency = cfg->latency;
 
     stream->filters = NULL;
     stream->filters_cfg = AOUT_FILTERS_CFG_INIT;
@@ -608,6 +611,9 @@ int vlc_aout_stream_Play(vlc_aout_stream *stream, block_t *block)
     const vlc_tick_t original_pts = stream->original_pts;
     stream->original_pts = VLC_TICK_INVALID;
 
+    if (stream->latency != NULL)
+        vlc_latency_Mark(stream->latency, VLC_LATENCY_FILTERED, original_pts);
+
     /* Software volume */
     if (stream->volume != NULL)
         aout_volume_Amplify(stream->volume, block);
@@ -643,6 +649,8 @@ int vlc_aout_stream_Play(vlc_aout_stream *stream, block_t *block)
     /* Output */
     stream->sync.discontinuity = false;
     aout->play(aout, block, play_date);
+    if (stream->latency != NULL)
+        vlc_latency_Mark(stream->latency, VLC_LATENCY_DISPLAYED, original_pts);
 
     atomic_fetch_add_explicit(&stream->buffers_played, 1, memory_order_relaxed);
     return ret;
@@ -32,6 +32,7 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_dialog.h>
 #include <vlc_modules.h>
 #include <vlc_aout.h>
@@ -40,6 +41,163 @@
 #include "aout_internal.h"
 #include "../video_output/vout_internal.h" /* for vout_Request */
 
+/*
+ * Audio buffer arena
+ *
+ * Filters of a pipeline get their output buffers through
+ * filter_NewAudioBuffer(). Released buffers are put back on a small free list
+ * and handed out again on the next period, so that a pipeline in steady state
+ * does not allocate. Buffers can outlive the pipeline (e.g. when queued by
+ * the audio output), hence the reference count on the arena.
+ */
+#define AOUT_ARENA_DEPTH 16
+#define AOUT_ARENA_ALIGN 32
+#define AOUT_ARENA_PADDING 32
+#define AOUT_ARENA_GRANULARITY 4096
+
+struct aout_arena_buffer
+{
+    block_t self;
+    struct aout_arena *arena;
+    struct aout_arena_buffer *next;
+    size_t capacity;
+};
+
+struct aout_arena
+{
+    vlc_atomic_rc_t rc;
+    vlc_mutex_t lock;
+    struct aout_arena_buffer *free_list;
+    unsigned free_count;
+    unsigned long allocations; /**< Buffers allocated from the heap */
+    unsigned long recycled; /**< Buffers served from the free list */
+};
+
+static struct aout_arena *aout_arena_New(void)
+{
+    struct aout_arena *arena = malloc(sizeof (*arena));
+    if (unlikely(arena == NULL))
+        return NULL;
+
+    vlc_atomic_rc_init(&arena->rc);
+    vlc_mutex_init(&arena->lock);
+    arena->free_list = NULL;
+    arena->free_count = 0;
+    arena->allocations = 0;
+    arena->recycled = 0;
+    return arena;
+}
+
+static void aout_arena_Release(struct aout_arena *arena)
+{
+    if (!vlc_atomic_rc_dec(&arena->rc))
+        return;
+
+    struct aout_arena_buffer *buf = arena->free_list;
+    while (buf != NULL)
+    {
+        struct aout_arena_buffer *next = buf->next;
+        free(buf);
+        buf = next;
+    }
+    free(arena);
+}
+
+static void aout_arena_BufferRelease(block_t *block)
+{
+    struct aout_arena_buffer *buf =
+        container_of(block, struct aout_arena_buffer, self);
+    struct aout_arena *arena = buf->arena;
+
+    vlc_mutex_lock(&arena->lock);
+    if (arena->free_count < AOUT_ARENA_DEPTH)
+    {
+        buf->next = arena->free_list;
+        arena->free_list = buf;
+        arena->free_count++;
+        buf = NULL;
+    }
+    vlc_mutex_unlock(&arena->lock);
+
+    free(buf);
+    aout_arena_Release(arena);
+}
+
+static const struct vlc_block_callbacks aout_arena_cbs =
+{
+    aout_arena_BufferRelease,
+};
+
+static block_t *aout_arena_Alloc(struct aout_arena *arena, size_t size)
+{
+    struct aout_arena_buffer *buf = NULL;
+
+    vlc_mutex_lock(&arena->lock);
+    for (struct aout_arena_buffer **pp = &arena->free_list; *pp != NULL;
+         pp = &(*pp)->next)
+        if ((*pp)->capacity >= size)
+        {
+            buf = *pp;
+            *pp = buf->next;
+            arena->free_count--;
+            arena->recycled++;
+            break;
+        }
+    if (buf == NULL)
+        arena->allocations++;
+    vlc_mutex_unlock(&arena->lock);
+
+    if (buf == NULL)
+    {
+        /* Round up so that buffers fit periods of slightly varying length,
+         * as output by resamplers. */
+        size_t capacity = (size + AOUT_ARENA_GRANULARITY - 1)
+                        & ~(size_t)(AOUT_ARENA_GRANULARITY - 1);
+        if (unlikely(capacity < size))
+            return NULL;
+
+        buf = malloc(sizeof (*buf) + AOUT_ARENA_ALIGN
+                     + 2 * AOUT_ARENA_PADDING + capacity);
+        if (unlikely(buf == NULL))
+            return NULL;
+        buf->arena = arena;
+        buf->capacity = capacity;
+    }
+
+    block_t *block = block_Init(&buf->self, &aout_arena_cbs, buf + 1,
+                                AOUT_ARENA_ALIGN + 2 * AOUT_ARENA_PADDING
+                                + buf->capacity);
+    block->p_buffer += AOUT_ARENA_PADDING + AOUT_ARENA_ALIGN - 1;
+    block->p_buffer = (void *)(((uintptr_t)block->p_buffer)
+                               & ~(AOUT_ARENA_ALIGN - 1));
+    block->i_buffer = size;
+
+    vlc_atomic_rc_inc(&arena->rc);
+    return block;
+}
+
+struct filter_owner_sys
+{
+    const vlc_clock_t *clock_source;
+    vlc_clock_t *clock;
+    vout_thread_t *vout;
+    struct aout_arena *arena;
+};
+
+static block_t *aout_filter_NewBuffer(filter_t *filter, size_t size)
+{
+    struct filter_owner_sys *owner_sys = filter->owner.sys;
+
+    if (owner_sys->arena == NULL)
+        return NULL;
+    return aout_arena_Alloc(owner_sys->arena, size);
+}
+
+static const struct filter_audio_callbacks aout_filter_cbs =
+{
+    .buffer_new = aout_filter_NewBuffer,
+};
+
 struct aout_filter
 {
     filter_t *f;
@@ -105,20 +263,22 @@ filter_t *aout_filter_Create(vlc_object_t *obj, const filter_owner_t *restrict o
 }
 
 static filter_t *FindConverter (vlc_object_t *obj,
+                                const filter_owner_t *restrict owner,
                                 const audio_sample_format_t *infmt,
                                 const audio_sample_format_t *outfmt)
 {
-    return aout_filter_Create(obj, NULL, "audio converter", NULL, infmt, outfmt,
-                              NULL, true);
+    return aout_filter_Create(obj, owner, "audio converter", NULL, infmt,
+                              outfmt, NULL, true);
 }
 
 static filter_t *FindResampler (vlc_object_t *obj,
+                                const filter_owner_t *restrict owner,
                                 const audio_sample_format_t *infmt,
                                 const audio_sample_format_t *outfmt)
 {
     char *modlist = var_InheritString(obj, "audio-resampler");
-    filter_t *filter = aout_filter_Create(obj, NULL, "audio resampler", modlist,
-                                          infmt, outfmt, NULL, true);
+    filter_t *filter = aout_filter_Create(obj, owner, "audio resampler",
+                                          modlist, infmt, outfmt, NULL, true);
     free(modlist);
     return filter;
 }
@@ -147,7 +307,9 @@ static void aout_FiltersPipelineDestroy(struct aout_filter *tab, unsigned n)
     }
 }
 
-static filter_t *TryFormat (vlc_object_t *obj, vlc_fourcc_t codec,
+static filter_t *TryFormat (vlc_object_t *obj,
+                            const filter_owner_t *restrict owner,
+                            vlc_fourcc_t codec,
                             audio_sample_format_t *restrict fmt)
 {
     audio_sample_format_t output = *fmt;
@@ -156,7 +318,7 @@ static filter_t *TryFormat (vlc_object_t *obj, vlc_fourcc_t codec,
     output.i_format = codec;
     aout_FormatPrepare (&output);
 
-    filter_t *filter = FindConverter (obj, fmt, &output);
+    filter_t *filter = FindConverter (obj, owner, fmt, &output);
     if (filter != NULL)
         *fmt = output;
     return filter;
@@ -165,6 +327,7 @@ static filter_t *TryFormat (vlc_object_t *obj, vlc_fourcc_t codec,
 /**
  * Allocates audio format conversion filters
  * @param obj parent VLC object for new filters
+ * @param owner owner of the new filters (or NULL)
  * @param filters table of filters [IN/OUT]
  * @param count pointer to the number of filters in the table [IN/OUT]
  * @param max size of filters table [IN]
@@ -172,7 +335,9 @@ static filter_t *TryFormat (vlc_object_t *obj, vlc_fourcc_t codec,
  * @param outfmt output audio format
  * @return 0 on success, -1 on failure
  */
-static int aout_FiltersPipelineCreate(vlc_object_t *obj, struct aout_filter *tab,
+static int aout_FiltersPipelineCreate(vlc_object_t *obj,
+                                      const filter_owner_t *restrict owner,
+                                      struct aout_filter *tab,
                                       unsigned *count, unsigned max,
                                  const audio_sample_format_t *restrict infmt,
                                  const audio_sample_format_t *restrict outfmt)
@@ -198,27 +363,11 @@ static int aout_FiltersPipelineCreate(vlc_object_t *obj, struct aout_filter *tab
      || infmt->i_chan_mode != outfmt->i_chan_mode
      || infmt->channel_type != outfmt->channel_type)
     {   /* Remixing currently requires FL32... TODO: S16N */
-        if (input.i_format != VLC_CODEC_FL32)
-        {
-            if (n == max)
-                goto overflow;
-
-            filter_t *f = TryFormat (obj, VLC_CODEC_FL32, &input);
-            if (f == NULL)
-            {
-                msg_Err (obj, "cannot find %s for conversion pipeline",
-                         "pre-mix converter");
-                goto error;
-            }
-
-            aout_filter_Init(&tab[n++], f);
-        }
-
         if (n == max)
             goto overflow;
 
         audio_sample_format_t output;
-        output.i_format = input.i_format;
+        output.i_format = VLC_CODEC_FL32;
         output.i_rate = input.i_rate;
         output.i_physical_channels = outfmt->i_physical_channels;
         output.channel_type = outfmt->channel_type;
@@ -229,9 +378,33 @@ static int aout_FiltersPipelineCreate(vlc_object_t *obj, struct aout_filter *tab
             infmt->channel_type != outfmt->channel_type ?
             "audio renderer" : "audio converter";
 
-        filter_t *f = aout_filter_Create(obj, NULL, filter_type, NULL,
-                                         &input, &output, NULL, true);
+        filter_t *f = NULL;
+
+        /* Some remixers can convert the sample format on the fly: try those
+         * first, so that samples are converted and remixed in a single pass
+         * rather than through a separate pre-mix converter. */
+        if (input.i_format != VLC_CODEC_FL32)
+            f = aout_filter_Create(obj, owner, filter_type, NULL,
+                                   &input, &output, NULL, true);
 
+        if (f == NULL && input.i_format != VLC_CODEC_FL32)
+        {
+            filter_t *conv = TryFormat (obj, owner, VLC_CODEC_FL32, &input);
+            if (conv == NULL)
+            {
+                msg_Err (obj, "cannot find %s for conversion pipeline",
+                         "pre-mix converter");
+                goto error;
+            }
+
+            aout_filter_Init(&tab[n++], conv);
+            if (n == max)
+                goto overflow;
+        }
+
+        if (f == NULL)
+            f = aout_filter_Create(obj, owner, filter_type, NULL,
+                                   &input, &output, NULL, true);
         if (f == NULL)
         {
             msg_Err (obj, "cannot find %s for conversion pipeline",
@@ -252,7 +425,7 @@ static int aout_FiltersPipelineCreate(vlc_object_t *obj, struct aout_filter *tab
         audio_sample_format_t output = input;
         output.i_rate = outfmt->i_rate;
 
-        filter_t *f = FindConverter (obj, &input, &output);
+        filter_t *f = FindConverter (obj, owner, &input, &output);
         if (f == NULL)
         {
             msg_Err (obj, "cannot find %s for conversion pipeline",
@@ -270,7 +443,7 @@ static int aout_FiltersPipelineCreate(vlc_object_t *obj, struct aout_filter *tab
         if (max == 0)
             goto overflow;
 
-        filter_t *f = TryFormat (obj, outfmt->i_format, &input);
+        filter_t *f = TryFormat (obj, owner, outfmt->i_format, &input);
         if (f == NULL)
         {
             msg_Err (obj, "cannot find %s for conversion pipeline",
@@ -370,6 +543,8 @@ struct aout_filters
     struct aout_filter resampler; /**< The resampler */
     int resampling; /**< Current resampling (Hz) */
     const vlc_clock_t *clock_source;
+    struct filter_owner_sys owner_sys; /**< Owner of all filters */
+    filter_owner_t owner;
 
     unsigned count; /**< Number of filters */
     struct aout_filter tab[AOUT_MAX_FILTERS]; /**< Configured user filters
@@ -403,13 +578,6 @@ static int VisualizationCallback (vlc_object_t *obj, const char *var,
     return VLC_SUCCESS;
 }
 
-struct filter_owner_sys
-{
-    const vlc_clock_t *clock_source;
-    vlc_clock_t *clock;
-    vout_thread_t *vout;
-};
-
 vout_thread_t *aout_filter_GetVout(filter_t *filter, const video_format_t *fmt)
 {
     struct filter_owner_sys *owner_sys = filter->owner.sys;
@@ -459,14 +627,18 @@ static int AppendFilter(vlc_object_t *obj, const char *type, const char *name,
         return -1;
     }
 
-    struct filter_owner_sys owner_sys = {
-        .clock_source = filters->clock_source,
-        .clock = NULL,
-        .vout = NULL,
-    };
-    const filter_owner_t owner = { .sys = &owner_sys };
-    filter_t *filter = aout_filter_Create(obj, &owner, type, name,
+    /* The clock and vout, if any, are handed over to the table entry below,
+     * so that the next user filter starts with a clean owner. */
+    struct filter_owner_sys *owner_sys = &filters->owner_sys;
+    assert(owner_sys->clock == NULL && owner_sys->vout == NULL);
+
+    filter_t *filter = aout_filter_Create(obj, &filters->owner, type, name,
                                           infmt, outfmt, cfg, false);
+    vlc_clock_t *clock = owner_sys->clock;
+    vout_thread_t *vout = owner_sys->vout;
+    owner_sys->clock = NULL;
+    owner_sys->vout = NULL;
+
     if (filter == NULL)
     {
         msg_Err (obj, "cannot add user %s \"%s\" (skipped)", type, name);
@@ -474,22 +646,23 @@ static int AppendFilter(vlc_object_t *obj, const char *type, const char *name,
     }
 
     /* convert to the filter input format if necessary */
-    if (aout_FiltersPipelineCreate (obj, filters->tab, &filters->count,
-                                    max - 1, infmt, &filter->fmt_in.audio))
+    if (aout_FiltersPipelineCreate (obj, &filters->owner, filters->tab,
+                                    &filters->count, max - 1, infmt,
+                                    &filter->fmt_in.audio))
     {
         msg_Err (filter, "cannot add user %s \"%s\" (skipped)", type, name);
         aout_FilterDestroy(filter);
-        if (owner_sys.vout != NULL)
-            vout_Close(owner_sys.vout);
-        if (owner_sys.clock != NULL)
-            vlc_clock_Delete(owner_sys.clock);
+        if (vout != NULL)
+            vout_Close(vout);
+        if (clock != NULL)
+            vlc_clock_Delete(clock);
         return -1;
     }
 
     assert (filters->count < max);
     aout_filter_Init(&filters->tab[filters->count], filter);
-    filters->tab[filters->count].clock = owner_sys.clock;
-    filters->tab[filters->count].vout = owner_sys.vout;
+    filters->tab[filters->count].clock = clock;
+    filters->tab[filters->count].vout = vout;
     filters->count++;
     *infmt = filter->fmt_out.audio;
     return 0;
@@ -550,11 +723,24 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
     if (unlikely(filters == NULL))
         return NULL;
 
+    filters->owner_sys.arena = aout_arena_New();
+    if (unlikely(filters->owner_sys.arena == NULL))
+    {
+        free(filters);
+        return NULL;
+    }
+
     filters->rate_filter = NULL;
     aout_filter_Init(&filters->resampler, NULL);
     filters->resampling = 0;
     filters->count = 0;
     filters->clock_source = clock;
+    filters->owner_sys.clock_source = clock;
+    filters->owner_sys.clock = NULL;
+    filters->owner_sys.vout = NULL;
+    filters->owner.audio = &aout_filter_cbs;
+    filters->owner.pf_get_attachments = NULL;
+    filters->owner.sys = &filters->owner_sys;
 
     /* Prepare format structure */
     aout_FormatPrint (obj, "input", infmt);
@@ -569,7 +755,7 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
         if (!AOUT_FMTS_IDENTICAL(infmt, outfmt))
         {
             aout_FormatsPrint (obj, "pass-through:", infmt, outfmt);
-            filter_t *f = FindConverter(obj, infmt, outfmt);
+            filter_t *f = FindConverter(obj, &filters->owner, infmt, outfmt);
             if (f == NULL)
             {
                 msg_Err (obj, "cannot setup pass-through");
@@ -593,8 +779,9 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
 
         /* convert to the output format (minus resampling) if necessary */
         output_format.i_rate = input_format.i_rate;
-        if (aout_FiltersPipelineCreate (obj, filters->tab, &filters->count,
-                                  AOUT_MAX_FILTERS, &input_format, &output_format))
+        if (aout_FiltersPipelineCreate (obj, &filters->owner, filters->tab,
+                                        &filters->count, AOUT_MAX_FILTERS,
+                                        &input_format, &output_format))
         {
             msg_Warn (obj, "cannot setup audio renderer pipeline");
             /* Fallback to bitmap without any conversions */
@@ -616,7 +803,8 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
         audio_sample_format_t input_phys_format = input_format;
         aout_SetWavePhysicalChannels(&input_phys_format);
 
-        filter_t *f = FindConverter (obj, &input_format, &input_phys_format);
+        filter_t *f = FindConverter (obj, &filters->owner, &input_format,
+                                     &input_phys_format);
         if (f == NULL)
         {
             msg_Err (obj, "cannot find channel converter");
@@ -662,8 +850,9 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
 
     /* convert to the output format (minus resampling) if necessary */
     output_format.i_rate = input_format.i_rate;
-    if (aout_FiltersPipelineCreate (obj, filters->tab, &filters->count,
-                              AOUT_MAX_FILTERS, &input_format, &output_format))
+    if (aout_FiltersPipelineCreate (obj, &filters->owner, filters->tab,
+                                    &filters->count, AOUT_MAX_FILTERS,
+                                    &input_format, &output_format))
     {
         msg_Err (obj, "cannot setup filtering pipeline");
         goto error;
@@ -673,7 +862,7 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
     /* insert the resampler */
     output_format.i_rate = outfmt->i_rate;
     assert (AOUT_FMTS_IDENTICAL(&output_format, outfmt));
-    filters->resampler.f = FindResampler(obj, &input_format,
+    filters->resampler.f = FindResampler(obj, &filters->owner, &input_format,
                                          &output_format);
     if (filters->resampler.f == NULL && input_format.i_rate != outfmt->i_rate)
     {
@@ -688,6 +877,7 @@ aout_filters_t *aout_FiltersNewWithClock(vlc_object_t *obj, const vlc_clock_t *c
 error:
     aout_FiltersPipelineDestroy (filters->tab, filters->count);
     var_DelCallback(obj, "visual", VisualizationCallback, NULL);
+    aout_arena_Release(filters->owner_sys.arena);
     free (filters);
     return NULL;
 }
@@ -755,6 +945,13 @@ void aout_FiltersDelete (vlc_object_t *obj, aout_filters_t *filters)
         aout_FiltersPipelineDestroy(&filters->resampler, 1);
     aout_FiltersPipelineDestroy (filters->tab, filters->count);
     var_DelCallback(obj, "visual", VisualizationCallback, NULL);
+
+    struct aout_arena *arena = filters->owner_sys.arena;
+    vlc_mutex_lock(&arena->lock);
+    msg_Dbg(obj, "buffer arena: %lu allocation(s), %lu recycled buffer(s)",
+            arena->allocations, arena->recycled);
+    vlc_mutex_unlock(&arena->lock);
+    aout_arena_Release(arena);
     free (filters);
 }
 
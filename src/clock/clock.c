@@ -23,6 +23,7 @@
 
 #include <vlc_common.h>
 #include <vlc_aout.h>
+#include <vlc_atomic.h>
 #include <assert.h>
 #include <limits.h>
 #include <vlc_tracer.h>
@@ -59,6 +60,22 @@ struct vlc_clock_main_t
     clock_point_t first_pcr;
     vlc_tick_t output_dejitter; /* Delay used to absorb the output clock jitter */
     vlc_tick_t input_dejitter; /* Delay used to absorb the input jitter */
+
+    /**
+     * Copy of the linear function, published by the writers (with the lock
+     * held) for the lock-less readers of vlc_clock_ConvertToSystem().
+     *
+     * This is a sequence lock: the sequence is odd while being written.
+     */
+    struct
+    {
+        atomic_uint sequence;
+        _Atomic double coeff;
+        _Atomic double rate;
+        _Atomic vlc_tick_t offset;
+        _Atomic vlc_tick_t delay;
+        _Atomic vlc_tick_t pause_date;
+    } published;
 };
 
 struct vlc_clock_t
@@ -78,8 +95,127 @@ struct vlc_clock_t
 
     const struct vlc_clock_cbs *cbs;
     void *cbs_data;
+
+    /* Published along with the main clock state, cf. vlc_clock_main_publish */
+    _Atomic vlc_tick_t published_delay;
+    atomic_bool published_slave;
 };
 
+static vlc_tick_t vlc_clock_slave_to_system_locked(vlc_clock_t *clock,
+                                                   vlc_tick_t now,
+                                                   vlc_tick_t ts, double rate);
+
+/* Number of lock-less read attempts before falling back to the lock */
+#define CLOCK_READ_ATTEMPTS 4
+
+/**
+ * Publish the main clock state, and optionally the state of one of its
+ * clocks, to the lock-less readers
+ *
+ * Must be called with the lock held, after any modification of the state used
+ * by vlc_clock_to_system_lockless().
+ */
+static void vlc_clock_main_publish(vlc_clock_main_t *main_clock,
+                                   vlc_clock_t *clock)
+{
+    vlc_mutex_assert(&main_clock->lock);
+
+    unsigned sequence = atomic_load_explicit(&main_clock->published.sequence,
+                                             memory_order_relaxed);
+    assert((sequence & 1) == 0);
+    atomic_store_explicit(&main_clock->published.sequence, sequence + 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&main_clock->published.coeff, main_clock->coeff,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->published.rate, main_clock->rate,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->published.offset, main_clock->offset,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->published.delay, main_clock->delay,
+                          memory_order_relaxed);
+    atomic_store_explicit(&main_clock->published.pause_date,
+                          main_clock->pause_date, memory_order_relaxed);
+    if (clock != NULL)
+    {
+        atomic_store_explicit(&clock->published_delay, clock->delay,
+                              memory_order_relaxed);
+        atomic_store_explicit(&clock->published_slave,
+                              clock->to_system_locked
+                                == vlc_clock_slave_to_system_locked,
+                              memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&main_clock->published.sequence, sequence + 2,
+                          memory_order_release);
+}
+
+/**
+ * Convert a timestamp without taking the lock
+ *
+ * This only handles the common case where the main clock has a reference
+ * point. The monotonic fallback, which modifies the main clock state, and
+ * the rare readers racing with a writer for too long are left to the locked
+ * path.
+ *
+ * @return true if the conversion succeeded
+ */
+static bool vlc_clock_to_system_lockless(vlc_clock_t *clock, vlc_tick_t ts,
+                                         double rate, vlc_tick_t *restrict out)
+{
+    vlc_clock_main_t *main_clock = clock->owner;
+
+    for (unsigned i = 0; i < CLOCK_READ_ATTEMPTS; i++)
+    {
+        unsigned sequence =
+            atomic_load_explicit(&main_clock->published.sequence,
+                                 memory_order_acquire);
+        if (sequence & 1)
+            continue; /* A writer is in progress */
+
+        double coeff = atomic_load_explicit(&main_clock->published.coeff,
+                                            memory_order_relaxed);
+        double main_rate = atomic_load_explicit(&main_clock->published.rate,
+                                                memory_order_relaxed);
+        vlc_tick_t offset =
+            atomic_load_explicit(&main_clock->published.offset,
+                                 memory_order_relaxed);
+        vlc_tick_t main_delay =
+            atomic_load_explicit(&main_clock->published.delay,
+                                 memory_order_relaxed);
+        vlc_tick_t pause_date =
+            atomic_load_explicit(&main_clock->published.pause_date,
+                                 memory_order_relaxed);
+        vlc_tick_t delay = atomic_load_explicit(&clock->published_delay,
+                                                memory_order_relaxed);
+        bool slave = atomic_load_explicit(&clock->published_slave,
+                                          memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&main_clock->published.sequence,
+                                 memory_order_relaxed) != sequence)
+            continue; /* Torn read */
+
+        /* Same logic as vlc_clock_{slave,master}_to_system_locked */
+        if (slave && pause_date != VLC_TICK_INVALID)
+        {
+            *out = VLC_TICK_MAX;
+            return true;
+        }
+
+        if (offset == VLC_TICK_INVALID)
+            return false;
+
+        vlc_tick_t system = ((vlc_tick_t) (ts * coeff / main_rate)) + offset;
+        if (slave)
+            delay -= main_delay;
+        *out = system + delay * rate;
+        return true;
+    }
+    return false;
+}
+
 static vlc_tick_t main_stream_to_system(vlc_clock_main_t *main_clock,
                                         vlc_tick_t ts)
 {
@@ -99,6 +235,7 @@ static void vlc_clock_main_reset(vlc_clock_main_t *main_clock)
     main_clock->wait_sync_ref_priority = UINT_MAX;
     main_clock->wait_sync_ref =
         main_clock->last = clock_point_Create(VLC_TICK_INVALID, VLC_TICK_INVALID);
+    vlc_clock_main_publish(main_clock, NULL);
     vlc_cond_broadcast(&main_clock->cond);
 }
 
@@ -164,6 +301,7 @@ static vlc_tick_t vlc_clock_master_update(vlc_clock_t *clock,
         main_clock->last = clock_point_Create(system_now, ts);
 
         main_clock->rate = rate;
+        vlc_clock_main_publish(main_clock, NULL);
         vlc_cond_broadcast(&main_clock->cond);
     }
 
@@ -198,6 +336,7 @@ static void vlc_clock_master_reset(vlc_clock_t *clock)
             main_clock->delay = delta;
         }
     }
+    vlc_clock_main_publish(main_clock, clock);
 
     vlc_mutex_unlock(&main_clock->lock);
 
@@ -226,6 +365,7 @@ static vlc_tick_t vlc_clock_master_set_delay(vlc_clock_t *clock, vlc_tick_t dela
     assert(main_clock->delay <= 0);
     assert(clock->delay >= 0);
 
+    vlc_clock_main_publish(main_clock, clock);
     vlc_cond_broadcast(&main_clock->cond);
     vlc_mutex_unlock(&main_clock->lock);
     return delta;
@@ -307,8 +447,6 @@ static vlc_tick_t vlc_clock_slave_update(vlc_clock_t *clock,
                                          unsigned frame_rate,
                                          unsigned frame_rate_base)
 {
-    vlc_clock_main_t *main_clock = clock->owner;
-
     if (system_now == VLC_TICK_MAX)
     {
         /* If system_now is VLC_TICK_MAX, the update is forced, don't modify
@@ -318,11 +456,7 @@ static vlc_tick_t vlc_clock_slave_update(vlc_clock_t *clock,
         return VLC_TICK_MAX;
     }
 
-    vlc_mutex_lock(&main_clock->lock);
-
-    vlc_tick_t computed = clock->to_system_locked(clock, system_now, ts, rate);
-
-    vlc_mutex_unlock(&main_clock->lock);
+    vlc_tick_t computed = vlc_clock_ConvertToSystem(clock, system_now, ts, rate);
 
     vlc_clock_on_update(clock, computed, ts, rate, frame_rate, frame_rate_base);
     return computed - system_now;
@@ -348,6 +482,7 @@ static vlc_tick_t vlc_clock_slave_set_delay(vlc_clock_t *clock, vlc_tick_t delay
 
     clock->delay = delay;
 
+    vlc_clock_main_publish(main_clock, clock);
     vlc_cond_broadcast(&main_clock->cond);
     vlc_mutex_unlock(&main_clock->lock);
     return 0;
@@ -430,6 +565,13 @@ vlc_clock_main_t *vlc_clock_main_New(struct vlc_logger *parent_logger, struct vl
 
     AvgInit(&main_clock->coeff_avg, 10);
 
+    atomic_init(&main_clock->published.sequence, 0);
+    atomic_init(&main_clock->published.coeff, main_clock->coeff);
+    atomic_init(&main_clock->published.rate, main_clock->rate);
+    atomic_init(&main_clock->published.offset, main_clock->offset);
+    atomic_init(&main_clock->published.delay, main_clock->delay);
+    atomic_init(&main_clock->published.pause_date, main_clock->pause_date);
+
     return main_clock;
 }
 
@@ -499,6 +641,7 @@ void vlc_clock_main_ChangePause(vlc_clock_main_t *main_clock, vlc_tick_t now,
         main_clock->pause_date = VLC_TICK_INVALID;
         vlc_cond_broadcast(&main_clock->cond);
     }
+    vlc_clock_main_publish(main_clock, NULL);
     vlc_mutex_unlock(&main_clock->lock);
 }
 
@@ -539,6 +682,20 @@ vlc_tick_t vlc_clock_ConvertToSystemLocked(vlc_clock_t *clock,
     return clock->to_system_locked(clock, system_now, ts, rate);
 }
 
+vlc_tick_t vlc_clock_ConvertToSystem(vlc_clock_t *clock, vlc_tick_t system_now,
+                                     vlc_tick_t ts, double rate)
+{
+    vlc_tick_t system;
+
+    if (vlc_clock_to_system_lockless(clock, ts, rate, &system))
+        return system;
+
+    vlc_mutex_lock(&clock->owner->lock);
+    system = clock->to_system_locked(clock, system_now, ts, rate);
+    vlc_mutex_unlock(&clock->owner->lock);
+    return system;
+}
+
 static void vlc_clock_set_master_callbacks(vlc_clock_t *clock)
 {
     clock->update = vlc_clock_master_update;
@@ -571,6 +728,9 @@ static vlc_clock_t *vlc_clock_main_Create(vlc_clock_main_t *main_clock,
     clock->cbs = cbs;
     clock->cbs_data = cbs_data;
     clock->priority = priority;
+    clock->to_system_locked = NULL;
+    atomic_init(&clock->published_delay, 0);
+    atomic_init(&clock->published_slave, false);
     assert(!cbs || cbs->on_update);
 
     return clock;
@@ -593,6 +753,7 @@ vlc_clock_t *vlc_clock_main_CreateMaster(vlc_clock_main_t *main_clock,
         vlc_clock_set_master_callbacks(clock);
     else
         vlc_clock_set_slave_callbacks(clock);
+    vlc_clock_main_publish(main_clock, clock);
 
     main_clock->master = clock;
     main_clock->rc++;
@@ -617,9 +778,13 @@ vlc_clock_t *vlc_clock_main_CreateInputMaster(vlc_clock_main_t *main_clock)
 
     /* Override the master ES clock if it exists */
     if (main_clock->master != NULL)
+    {
         vlc_clock_set_slave_callbacks(main_clock->master);
+        vlc_clock_main_publish(main_clock, main_clock->master);
+    }
 
     vlc_clock_set_master_callbacks(clock);
+    vlc_clock_main_publish(main_clock, clock);
     main_clock->input_master = clock;
     main_clock->rc++;
     vlc_mutex_unlock(&main_clock->lock);
@@ -657,6 +822,7 @@ vlc_clock_t *vlc_clock_main_CreateSlave(vlc_clock_main_t *main_clock,
 
     vlc_mutex_lock(&main_clock->lock);
     vlc_clock_set_slave_callbacks(clock);
+    vlc_clock_main_publish(main_clock, clock);
     main_clock->rc++;
     vlc_mutex_unlock(&main_clock->lock);
 
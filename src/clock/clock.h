@@ -219,15 +219,16 @@ vlc_tick_t vlc_clock_ConvertToSystemLocked(vlc_clock_t *clock,
                                            vlc_tick_t system_now, vlc_tick_t ts,
                                            double rate);
 
-static inline vlc_tick_t
-vlc_clock_ConvertToSystem(vlc_clock_t *clock, vlc_tick_t system_now,
-                          vlc_tick_t ts, double rate)
-{
-    vlc_clock_Lock(clock);
-    vlc_tick_t system =
-        vlc_clock_ConvertToSystemLocked(clock, system_now, ts, rate);
-    vlc_clock_Unlock(clock);
-    return system;
-}
+/**
+ * This function converts a timestamp from stream to system
+ *
+ * The clock mutex must not be locked. The conversion does not take the lock
+ * once the main clock has a reference point, so that it is not contended by
+ * the other outputs.
+ *
+ * @return the valid system time or VLC_TICK_MAX when the clock is paused
+ */
+vlc_tick_t vlc_clock_ConvertToSystem(vlc_clock_t *clock, vlc_tick_t system_now,
+                                     vlc_tick_t ts, double rate);
 
 #endif /*VLC_CLOCK_H*/
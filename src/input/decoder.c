@@ -50,6 +50,7 @@
 #include "../clock/clock.h"
 #include "input_internal.h"
 #include "decoder.h"
+#include "latency.h"
 #include "resource.h"
 #include "libvlc.h"
 
@@ -71,6 +72,7 @@ struct vlc_input_decoder_t
     input_resource_t*p_resource;
     vlc_clock_t     *p_clock;
     const char *psz_id;
+    struct vlc_latency *latency;
 
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
@@ -401,6 +403,7 @@ static int ModuleThread_UpdateAudioFormat( decoder_t *p_dec )
                 .profile = p_dec->fmt_out.i_profile,
                 .clock = p_owner->p_clock,
                 .str_id = p_owner->psz_id,
+                .latency = p_owner->latency,
                 .replay_gain = &p_dec->fmt_out.audio_replay_gain
             };
             p_astream = vlc_aout_stream_New( p_aout, &cfg );
@@ -503,7 +506,7 @@ static int ModuleThread_UpdateVideoFormat( decoder_t *p_dec, vlc_video_context *
 
     vout_configuration_t cfg = {
         .vout = p_owner->p_vout, .clock = p_owner->p_clock,
-        .str_id = p_owner->psz_id,
+        .str_id = p_owner->psz_id, .latency = p_owner->latency,
         .fmt = &p_dec->fmt_out.video,
         .mouse_event = MouseEvent, .mouse_opaque = p_dec,
     };
@@ -752,6 +755,7 @@ static subpicture_t *ModuleThread_NewSpuBuffer( decoder_t *p_dec,
         enum vlc_vout_order channel_order;
         p_owner->i_spu_channel =
             vout_RegisterSubpictureChannelInternal(p_vout, p_owner->p_clock,
+                                                   p_owner->latency,
                                                    &channel_order);
         p_owner->i_spu_order = 0;
 
@@ -1153,6 +1157,8 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
         vlc_tracer_TraceStreamPTS( tracer, "DEC", p_owner->psz_id,
                             "OUT", p_pic->date );
     }
+    if( p_owner->latency != NULL )
+        vlc_latency_Mark( p_owner->latency, VLC_LATENCY_DECODED, p_pic->date );
     int success = ModuleThread_PlayVideo( p_owner, p_pic );
 
     ModuleThread_UpdateStatVideo( p_owner, success != VLC_SUCCESS );
@@ -1288,6 +1294,9 @@ static void ModuleThread_QueueAudio( decoder_t *p_dec, vlc_frame_t *p_aout_buf )
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "OUT",
                             p_aout_buf->i_pts, p_aout_buf->i_dts );
     }
+    if( p_owner->latency != NULL && p_aout_buf != NULL )
+        vlc_latency_Mark( p_owner->latency, VLC_LATENCY_DECODED,
+                          p_aout_buf->i_pts );
     int success = ModuleThread_PlayAudio( p_owner, p_aout_buf );
 
     ModuleThread_UpdateStatAudio( p_owner, success != VLC_SUCCESS );
@@ -1332,6 +1341,9 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
         vlc_tracer_TraceStreamPTS( tracer, "DEC", p_owner->psz_id,
                             "OUT", p_spu->i_start );
     }
+    if( p_owner->latency != NULL )
+        vlc_latency_Mark( p_owner->latency, VLC_LATENCY_DECODED,
+                          p_spu->i_start );
 
     /* The vout must be created from a previous decoder_NewSubpicture call. */
     assert( p_owner->p_vout );
@@ -1343,6 +1355,8 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
         ( p_spu->i_stop == VLC_TICK_INVALID || p_spu->i_stop < p_owner->i_preroll_end ) )
     {
         vlc_mutex_unlock( &p_owner->lock );
+        if( p_owner->latency != NULL )
+            vlc_latency_Drop( p_owner->latency, p_spu->i_start );
         subpicture_Delete( p_spu );
     }
     else
@@ -1363,6 +1377,9 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "IN",
                             frame->i_pts, frame->i_dts );
     }
+    if( p_owner->latency != NULL && frame != NULL )
+        vlc_latency_Mark( p_owner->latency, VLC_LATENCY_DECODING,
+                          frame->i_pts );
 
     int ret = p_dec->pf_decode( p_dec, frame );
     switch( ret )
@@ -1471,6 +1488,9 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
                 vlc_frame_t *p_next = packetized_frame->p_next;
                 packetized_frame->p_next = NULL;
 
+                if( p_owner->latency != NULL )
+                    vlc_latency_Mark( p_owner->latency, VLC_LATENCY_PACKETIZED,
+                                      packetized_frame->i_pts );
                 DecoderThread_DecodeBlock( p_owner, packetized_frame );
                 if( p_owner->error )
                 {
@@ -1844,6 +1864,7 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_dec = &p_owner->dec;
 
     p_owner->psz_id = cfg->str_id;
+    p_owner->latency = cfg->latency;
     p_owner->p_clock = cfg->clock;
     p_owner->i_preroll_end = PREROLL_NONE;
     p_owner->p_resource = cfg->resource;
@@ -54,6 +54,7 @@ struct vlc_input_decoder_cfg
 {
     const es_format_t *fmt;
     const char *str_id;
+    struct vlc_latency *latency;
     vlc_clock_t *clock;
     input_resource_t *resource;
     sout_stream_t *sout;
@@ -35,6 +35,10 @@
 #include <vlc_modules.h>
 #include <vlc_strings.h>
 #include "input_internal.h"
+#include "modules/modules.h"
+
+/* Largest leading data checked against demux signatures */
+#define DEMUX_SIGNATURE_PEEK 1024
 
 typedef const struct
 {
@@ -93,10 +97,9 @@ static void demux_DestroyDemux(demux_t *demux)
     vlc_stream_Delete(demux->s);
 }
 
-static int demux_Probe(void *func, bool forced, va_list ap)
+static int demux_Probe(void *func, bool forced, demux_t *demux)
 {
     int (*probe)(vlc_object_t *) = func;
-    demux_t *demux = va_arg(ap, demux_t *);
 
     /* Restore input stream offset (in case previous probed demux failed to
      * to do so). */
@@ -114,6 +117,98 @@ static int demux_Probe(void *func, bool forced, va_list ap)
     return ret;
 }
 
+/**
+ * Discards demux candidates whose signatures do not match the stream.
+ *
+ * The stream is peeked once for all candidates. Forced candidates are always
+ * probed.
+ * \return the number of discarded candidates
+ */
+static size_t demux_FilterBySignature(demux_t *demux, module_t **mods,
+                                      size_t total, size_t strict_total)
+{
+    size_t size = 0, skipped = 0;
+
+    for (size_t i = strict_total; i < total; i++)
+    {
+        size_t sigsize = vlc_module_SignatureSize(mods[i]);
+        if (sigsize > size)
+            size = sigsize;
+    }
+
+    if (size == 0 || vlc_stream_Tell(demux->s) != 0)
+        return 0;
+    if (size > DEMUX_SIGNATURE_PEEK)
+        size = DEMUX_SIGNATURE_PEEK;
+
+    const uint8_t *peek;
+    ssize_t len = vlc_stream_Peek(demux->s, &peek, size);
+    if (len < 0)
+        return 0;
+
+    for (size_t i = strict_total; i < total; i++)
+        if (!vlc_module_MatchSignature(mods[i], peek, len))
+        {
+            mods[i] = NULL;
+            skipped++;
+        }
+    return skipped;
+}
+
+static module_t *demux_Load(demux_t *demux, const char *name, bool strict)
+{
+    module_t **mods;
+    size_t strict_total;
+    ssize_t total = vlc_module_match("demux", name, strict,
+                                     &mods, &strict_total);
+
+    if (unlikely(total < 0))
+        return NULL;
+
+    msg_Dbg(demux, "looking for demux module matching \"%s\": "
+            "%zd candidates", name, total);
+
+    vlc_tick_t start = vlc_tick_now();
+    size_t skipped = demux_FilterBySignature(demux, mods, total, strict_total);
+    unsigned probed = 0;
+    module_t *module = NULL;
+
+    for (size_t i = 0; i < (size_t)total; i++)
+    {
+        module_t *cand = mods[i];
+        if (cand == NULL)
+            continue;
+
+        int ret = VLC_EGENERIC;
+        void *cb = vlc_module_map(vlc_object_logger(demux), cand);
+
+        if (cb != NULL)
+        {
+            ret = demux_Probe(cb, i < strict_total, demux);
+            probed++;
+        }
+
+        if (ret == VLC_SUCCESS)
+        {
+            msg_Dbg(demux, "using demux module \"%s\"",
+                    module_get_object(cand));
+            module = cand;
+            break;
+        }
+        if (ret == VLC_ETIMEOUT)
+            break;
+    }
+
+    msg_Dbg(demux, "probed %u demux module(s), skipped %zu by signature, "
+            "in %"PRId64" us", probed, skipped,
+            US_FROM_VLC_TICK(vlc_tick_now() - start));
+    if (module == NULL)
+        msg_Dbg(demux, "no demux modules matched with name %s", name);
+
+    free(mods);
+    return module;
+}
+
 demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
                             const char *module, const char *url,
                             stream_t *s, es_out_t *out, bool b_preparsing )
@@ -191,8 +286,7 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         strict = false;
     }
 
-    priv->module = vlc_module_load(p_demux, "demux", module, strict,
-                                   demux_Probe, p_demux);
+    priv->module = demux_Load(p_demux, module, strict);
     free(modbuf);
 
     if (priv->module == NULL)
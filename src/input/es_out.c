@@ -51,6 +51,7 @@
 #include "resource.h"
 #include "info.h"
 #include "item.h"
+#include "latency.h"
 
 #include "../stream_output/stream_output.h"
 
@@ -133,6 +134,9 @@ struct es_out_id_t
     vlc_input_decoder_t   *p_dec_record;
     vlc_clock_t *p_clock;
 
+    /* NULL unless latency statistics are enabled */
+    struct vlc_latency *latency;
+
     /* Used by vlc_clock_cbs, need to be const during the lifetime of the clock */
     bool master;
 
@@ -636,6 +640,8 @@ static void EsRelease(es_out_id_t *es)
         free(es->psz_language_code);
         es_format_Clean(&es->fmt);
         input_source_Release(es->id.source);
+        if (es->latency != NULL)
+            vlc_latency_Delete(es->latency);
         free(es->id.str_id);
         free(es);
     }
@@ -952,7 +958,11 @@ static void EsOutChangePosition( es_out_t *out, bool b_flush )
         if( p_es->p_dec != NULL )
         {
             if( b_flush )
+            {
                 vlc_input_decoder_Flush( p_es->p_dec );
+                if( p_es->latency != NULL )
+                    vlc_latency_Flush( p_es->latency );
+            }
             if( !p_sys->b_buffering )
             {
                 vlc_input_decoder_StartWait( p_es->p_dec );
@@ -2224,6 +2234,9 @@ static es_out_id_t *EsOutAddLocked( es_out_t *out, input_source_t *source,
     es->p_dec = NULL;
     es->p_dec_record = NULL;
     es->p_clock = NULL;
+    es->latency = NULL;
+    if( p_master == NULL && var_InheritBool( p_input, "latency-stats" ) )
+        es->latency = vlc_latency_New();
     es->master = false;
     es->cc.type = 0;
     es->cc.i_bitmap = 0;
@@ -2348,6 +2361,7 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
     const struct vlc_input_decoder_cfg cfg = {
         .fmt = &p_es->fmt,
         .str_id = p_es->id.str_id,
+        .latency = p_es->latency,
         .clock = p_es->p_clock,
         .resource = priv->p_resource,
         .sout = priv->p_sout,
@@ -2986,6 +3000,9 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
         return VLC_SUCCESS;
     }
 
+    if( es->latency != NULL )
+        vlc_latency_Mark( es->latency, VLC_LATENCY_DEMUX, p_block->i_pts );
+
 #ifdef ENABLE_SOUT
     /* Check for sout mode */
     if( input_priv(p_input)->p_sout )
@@ -3078,6 +3095,10 @@ static void EsOutDelLocked( es_out_t *out, es_out_id_t *es )
         EsOutUnselectEs( out, es, es->p_pgrm == p_sys->p_pgrm );
     }
 
+    if( es->latency != NULL )
+        vlc_latency_Dump( es->latency, VLC_OBJECT(p_sys->p_input),
+                          es->id.str_id );
+
     EsTerminate(es);
 
     if( es->p_pgrm == p_sys->p_pgrm )
@@ -4623,3 +4644,8 @@ const input_source_t *vlc_es_id_GetSource(vlc_es_id_t *id)
 {
     return id->source;
 }
+
+struct vlc_latency *vlc_es_id_GetLatency(vlc_es_id_t *id)
+{
+    return vlc_es_id_get_out(id)->latency;
+}
@@ -249,5 +249,6 @@ es_out_t  *input_EsOutSourceNew(es_out_t *master_out, input_source_t *in);
 
 es_out_id_t *vlc_es_id_get_out(vlc_es_id_t *id);
 const input_source_t *vlc_es_id_GetSource(vlc_es_id_t *id);
+struct vlc_latency *vlc_es_id_GetLatency(vlc_es_id_t *id);
 
 #endif
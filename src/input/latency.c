@@ -0,0 +1,217 @@
+/*****************************************************************************
+ * latency.c: per elementary stream pipeline latency
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include "latency.h"
+
+/* Frames in flight: enough for the decoder fifo and the output buffers of
+ * a few seconds of audio. The oldest frames are forgotten first. */
+#define LATENCY_SLOTS 256
+
+struct vlc_latency_slot
+{
+    vlc_tick_t pts; /* VLC_TICK_INVALID if the slot is free */
+    vlc_tick_t date;
+    enum vlc_latency_stage stage;
+};
+
+struct vlc_latency
+{
+    vlc_mutex_t lock;
+    unsigned next;
+    struct vlc_es_latency stats;
+    struct vlc_latency_slot slots[LATENCY_SLOTS];
+};
+
+static const char *const stage_names[VLC_LATENCY_STAGE_COUNT] = {
+    [VLC_LATENCY_DEMUX] = "demux",
+    [VLC_LATENCY_PACKETIZED] = "packetizer",
+    [VLC_LATENCY_DECODING] = "decoder input",
+    [VLC_LATENCY_DECODED] = "decoder output",
+    [VLC_LATENCY_FILTERED] = "filters",
+    [VLC_LATENCY_PRERENDERED] = "prerender",
+    [VLC_LATENCY_DISPLAYED] = "display",
+};
+
+static void vlc_latency_Clear(struct vlc_latency *latency)
+{
+    for (size_t i = 0; i < LATENCY_SLOTS; i++)
+        latency->slots[i].pts = VLC_TICK_INVALID;
+    latency->next = 0;
+}
+
+struct vlc_latency *vlc_latency_New(void)
+{
+    struct vlc_latency *latency = malloc(sizeof (*latency));
+    if (unlikely(latency == NULL))
+        return NULL;
+
+    vlc_mutex_init(&latency->lock);
+    memset(&latency->stats, 0, sizeof (latency->stats));
+    vlc_latency_Clear(latency);
+    return latency;
+}
+
+void vlc_latency_Delete(struct vlc_latency *latency)
+{
+    free(latency);
+}
+
+static struct vlc_latency_slot *
+vlc_latency_Find(struct vlc_latency *latency, vlc_tick_t pts)
+{
+    /* Look up from the most recent frame */
+    for (unsigned i = 1; i <= LATENCY_SLOTS; i++)
+    {
+        struct vlc_latency_slot *slot =
+            &latency->slots[(latency->next - i) % LATENCY_SLOTS];
+        if (slot->pts == pts)
+            return slot;
+    }
+    return NULL;
+}
+
+static void vlc_latency_Account(struct vlc_latency_stage_stats *stats,
+                                vlc_tick_t delay)
+{
+    unsigned long long us = US_FROM_VLC_TICK(delay);
+    unsigned bucket = us < 2 ? 0 : 63 - vlc_clzll(us);
+
+    if (bucket >= VLC_LATENCY_BUCKETS)
+        bucket = VLC_LATENCY_BUCKETS - 1;
+
+    stats->count++;
+    stats->total += delay;
+    if (delay > stats->max)
+        stats->max = delay;
+    stats->histogram[bucket]++;
+}
+
+void vlc_latency_Mark(struct vlc_latency *latency,
+                      enum vlc_latency_stage stage, vlc_tick_t pts)
+{
+    assert(stage < VLC_LATENCY_STAGE_COUNT);
+
+    if (pts == VLC_TICK_INVALID)
+        return;
+
+    vlc_tick_t now = vlc_tick_now();
+
+    vlc_mutex_lock(&latency->lock);
+    struct vlc_latency_slot *slot = vlc_latency_Find(latency, pts);
+
+    if (stage == VLC_LATENCY_DEMUX)
+    {
+        /* Split frames share the PTS of their first part */
+        if (slot == NULL)
+        {
+            slot = &latency->slots[latency->next++ % LATENCY_SLOTS];
+            slot->pts = pts;
+            slot->date = now;
+            slot->stage = stage;
+            latency->stats.stages[stage].count++;
+        }
+    }
+    else if (slot != NULL && stage > slot->stage)
+    {
+        vlc_tick_t delay = now - slot->date;
+
+        vlc_latency_Account(&latency->stats.stages[stage],
+                            delay > 0 ? delay : 0);
+        slot->date = now;
+        slot->stage = stage;
+        if (stage == VLC_LATENCY_DISPLAYED)
+            slot->pts = VLC_TICK_INVALID;
+    }
+    vlc_mutex_unlock(&latency->lock);
+}
+
+void vlc_latency_Drop(struct vlc_latency *latency, vlc_tick_t pts)
+{
+    if (pts == VLC_TICK_INVALID)
+        return;
+
+    vlc_mutex_lock(&latency->lock);
+    struct vlc_latency_slot *slot = vlc_latency_Find(latency, pts);
+    if (slot != NULL)
+        slot->pts = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&latency->lock);
+}
+
+void vlc_latency_Flush(struct vlc_latency *latency)
+{
+    vlc_mutex_lock(&latency->lock);
+    vlc_latency_Clear(latency);
+    vlc_mutex_unlock(&latency->lock);
+}
+
+void vlc_latency_Get(struct vlc_latency *latency, struct vlc_es_latency *stats)
+{
+    vlc_mutex_lock(&latency->lock);
+    *stats = latency->stats;
+    for (size_t i = 0; i < LATENCY_SLOTS; i++)
+    {
+        const struct vlc_latency_slot *slot = &latency->slots[i];
+        if (slot->pts != VLC_TICK_INVALID)
+            stats->stages[slot->stage].queued++;
+    }
+    vlc_mutex_unlock(&latency->lock);
+}
+
+void vlc_latency_Dump(struct vlc_latency *latency, vlc_object_t *obj,
+                      const char *name)
+{
+    struct vlc_es_latency stats;
+
+    vlc_latency_Get(latency, &stats);
+    if (stats.stages[VLC_LATENCY_DEMUX].count == 0)
+        return;
+
+    msg_Info(obj, "latency of %s: %"PRIu64" frame(s) demuxed", name,
+             stats.stages[VLC_LATENCY_DEMUX].count);
+
+    for (size_t i = VLC_LATENCY_DEMUX + 1; i < VLC_LATENCY_STAGE_COUNT; i++)
+    {
+        const struct vlc_latency_stage_stats *stage = &stats.stages[i];
+        if (stage->count == 0)
+            continue;
+
+        /* Median bucket upper bound */
+        uint64_t half = (stage->count + 1) / 2, sum = 0;
+        unsigned median = 0;
+        while (median < VLC_LATENCY_BUCKETS - 1
+            && (sum += stage->histogram[median]) < half)
+            median++;
+
+        msg_Info(obj, " %-14s %8"PRIu64" frame(s), average %"PRId64" us, "
+                 "median < %u us, max %"PRId64" us", stage_names[i],
+                 stage->count,
+                 US_FROM_VLC_TICK(stage->total / (vlc_tick_t)stage->count),
+                 2u << median, US_FROM_VLC_TICK(stage->max));
+    }
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * latency.h: per elementary stream pipeline latency
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_INPUT_LATENCY_H
+#define LIBVLC_INPUT_LATENCY_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Latency tracker of one elementary stream
+ *
+ * Frames are followed by their PTS through the pipeline stages. The tracker
+ * is only created if the "latency-stats" option is set, and all the pipeline
+ * stages skip the stamping if it is NULL.
+ *
+ * All functions are thread-safe.
+ */
+struct vlc_latency;
+
+struct vlc_latency *vlc_latency_New(void);
+void vlc_latency_Delete(struct vlc_latency *);
+
+/**
+ * Stamps a frame at a given stage
+ *
+ * Frames enter the tracker at the VLC_LATENCY_DEMUX stage and leave it at
+ * the VLC_LATENCY_DISPLAYED stage. Unknown frames and frames that already
+ * went through a later stage are ignored.
+ */
+void vlc_latency_Mark(struct vlc_latency *, enum vlc_latency_stage,
+                      vlc_tick_t pts);
+
+/**
+ * Forgets a frame that will not be displayed, e.g. a late subpicture
+ */
+void vlc_latency_Drop(struct vlc_latency *, vlc_tick_t pts);
+
+/**
+ * Forgets the frames in flight, e.g. on flush
+ */
+void vlc_latency_Flush(struct vlc_latency *);
+
+void vlc_latency_Get(struct vlc_latency *, struct vlc_es_latency *);
+
+void vlc_latency_Dump(struct vlc_latency *, vlc_object_t *, const char *name);
+
+#endif
@@ -99,6 +99,12 @@ static const char *const ppsz_snap_formats[] =
     "This enables colorization of the messages sent to the console. " \
     "Your terminal needs Linux color support for this to work.")
 
+#define LOG_ASYNC_TEXT N_("Asynchronous logging")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Write the messages to the log from a dedicated thread, so that " \
+    "logging never blocks the playback. Messages are dropped if the log " \
+    "cannot keep up.")
+
 #define INTERACTION_TEXT N_("Interface interaction")
 #define INTERACTION_LONGTEXT N_( \
     "When this is enabled, the interface will show a dialog box each time " \
@@ -1112,6 +1118,11 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
 
+#define LATENCY_STATS_TEXT N_("Collect pipeline latency statistics")
+#define LATENCY_STATS_LONGTEXT N_( \
+     "Measure the delays of each elementary stream frame from the demuxer " \
+     "to the display, and print a summary when the stream ends.")
+
 #define ONEINSTANCE_TEXT N_("Allow only one running instance")
 #define ONEINSTANCE_LONGTEXT N_( \
     "Allowing only one running instance of VLC can sometimes be useful, " \
@@ -1187,6 +1198,16 @@ static const char *const clock_sources_text[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define PREPARSE_CACHE_TEXT N_( "Preparsing cache" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Keep the results of preparsing local files in the cache directory, " \
+    "and reuse them until the files are modified." )
+
+#define PREPARSE_LIGHT_TEXT N_( "Light preparsing" )
+#define PREPARSE_LIGHT_LONGTEXT N_( \
+    "Preparse local files by probing the demuxer only, without starting " \
+    "an input thread. Other items are preparsed as usual." )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
@@ -2144,6 +2165,12 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT )
 
+    add_bool( "preparse-cache", false, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT )
+
+    add_bool( "preparse-light", false, PREPARSE_LIGHT_TEXT,
+              PREPARSE_LIGHT_LONGTEXT )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT )
 
@@ -2203,11 +2230,14 @@ vlc_module_begin ()
 
     add_bool( "color", true, COLOR_TEXT, COLOR_LONGTEXT )
         change_volatile ()
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT )
     add_obsolete_bool( "advanced" ) /* since 4.0.0 */
     add_bool( "interact", true, INTERACTION_TEXT,
               INTERACTION_LONGTEXT )
 
     add_bool ( "stats", true, STATS_TEXT, STATS_LONGTEXT )
+    add_bool( "latency-stats", false, LATENCY_STATS_TEXT,
+              LATENCY_STATS_LONGTEXT )
 
     set_subcategory( SUBCAT_INTERFACE_MAIN )
     add_module_cat("intf", SUBCAT_INTERFACE_MAIN, NULL,
@@ -491,6 +491,25 @@ int libvlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
     return vlc_MetadataRequest(libvlc, item, i_options, cbs, cbs_userdata, timeout, id);
 }
 
+/**
+ * Applies cached meta data to a batch of input items.
+ * Items found in the preparse cache are marked as preparsed.
+ *
+ * The files are stat'ed to validate the cache entries: do not call this
+ * with a lock held. Preparse requests use the cache anyway, from the
+ * preparser threads.
+ */
+size_t libvlc_MetadataWarmup(libvlc_int_t *libvlc, input_item_t *const *items,
+                             size_t count)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+
+    if (unlikely(priv->parser == NULL))
+        return 0;
+
+    return input_preparser_Warmup(priv->parser, items, count);
+}
+
 /**
  * Requests retrieving/downloading art for an input item.
  * The retrieval is performed asynchronously.
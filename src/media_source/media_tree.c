@@ -25,12 +25,21 @@
 #include "media_tree.h"
 
 #include <assert.h>
+#ifdef HAVE_SEARCH_H
+# include <search.h>
+#endif
+#include <sys/stat.h>
 #include <vlc_common.h>
 #include <vlc_arrays.h>
 #include <vlc_atomic.h>
+#include <vlc_fs.h>
+#include <vlc_fs_watcher.h>
 #include <vlc_input_item.h>
 #include <vlc_threads.h>
+#include <vlc_url.h>
+#include <vlc_vector.h>
 #include "libvlc.h"
+#include "input/input_interface.h"
 
 struct vlc_media_tree_listener_id
 {
@@ -39,11 +48,50 @@ struct vlc_media_tree_listener_id
     struct vlc_list node; /**< node of media_tree_private_t.listeners */
 };
 
+/** Node of a media, as indexed */
+struct media_tree_ref
+{
+    input_item_node_t *node;
+    input_item_node_t *parent;
+    char *uri; /**< URI of the media when indexed, or NULL */
+};
+
+/** Entry of the index of the nodes by media */
+struct media_tree_entry
+{
+    const input_item_t *media;
+    /** nodes of the media, the same media can be added several times */
+    struct VLC_VECTOR(struct media_tree_ref) refs;
+};
+
+/** Entry of the index of the nodes by parent and URI */
+struct media_tree_uri_entry
+{
+    const input_item_node_t *parent;
+    char *uri;
+    struct VLC_VECTOR(input_item_node_t *) nodes;
+};
+
+struct media_tree_watch
+{
+    vlc_media_tree_t *tree;
+    libvlc_int_t *libvlc;
+    input_item_t *media;
+    char *path;
+    char *base_uri; /**< media URI, with a trailing separator */
+    bool show_hidden;
+    vlc_fs_watcher_t *watcher;
+    struct vlc_list node; /**< node of media_tree_private_t.watches */
+};
+
 typedef struct
 {
     vlc_media_tree_t public_data;
 
     struct vlc_list listeners; /**< list of vlc_media_tree_listener_id.node */
+    struct vlc_list watches; /**< list of media_tree_watch.node */
+    void *entries; /**< media_tree_entry search tree, by media */
+    void *uri_entries; /**< media_tree_uri_entry search tree, by URI */
     vlc_mutex_t lock;
     vlc_atomic_rc_t rc;
 } media_tree_private_t;
@@ -60,6 +108,9 @@ vlc_media_tree_New(void)
     vlc_mutex_init(&priv->lock);
     vlc_atomic_rc_init(&priv->rc);
     vlc_list_init(&priv->listeners);
+    vlc_list_init(&priv->watches);
+    priv->entries = NULL;
+    priv->uri_entries = NULL;
 
     vlc_media_tree_t *tree = &priv->public_data;
     input_item_node_t *root = &tree->root;
@@ -93,52 +144,246 @@ do { \
         vlc_media_tree_NotifyListener(tree, listener, event, ##__VA_ARGS__); \
 } while (0)
 
-static bool
-vlc_media_tree_FindNodeByMedia(input_item_node_t *parent,
-                               const input_item_t *media,
-                               input_item_node_t **result,
-                               input_item_node_t **result_parent)
+static int
+vlc_media_tree_EntryCmp(const void *a, const void *b)
+{
+    const struct media_tree_entry *ea = a, *eb = b;
+    uintptr_t ma = (uintptr_t)ea->media;
+    uintptr_t mb = (uintptr_t)eb->media;
+
+    return (ma > mb) - (ma < mb);
+}
+
+static int
+vlc_media_tree_UriEntryCmp(const void *a, const void *b)
+{
+    const struct media_tree_uri_entry *ea = a, *eb = b;
+    uintptr_t pa = (uintptr_t)ea->parent;
+    uintptr_t pb = (uintptr_t)eb->parent;
+
+    if (pa != pb)
+        return (pa > pb) - (pa < pb);
+    return strcmp(ea->uri, eb->uri);
+}
+
+static int
+vlc_media_tree_IndexUri(vlc_media_tree_t *tree, input_item_node_t *parent,
+                        input_item_node_t *node, const char *uri)
 {
-    for (int i = 0; i < parent->i_children; ++i)
+    media_tree_private_t *priv = mt_priv(tree);
+    struct media_tree_uri_entry key = { .parent = parent, .uri = (char *)uri };
+    struct media_tree_uri_entry *entry;
+
+    void **slot = tfind(&key, &priv->uri_entries, vlc_media_tree_UriEntryCmp);
+    if (slot != NULL)
+        entry = *slot;
+    else
     {
-        input_item_node_t *child = parent->pp_children[i];
-        if (child->p_item == media)
+        entry = malloc(sizeof(*entry));
+        if (unlikely(!entry))
+            return VLC_ENOMEM;
+        entry->parent = parent;
+        entry->uri = strdup(uri);
+        vlc_vector_init(&entry->nodes);
+        if (unlikely(entry->uri == NULL)
+         || tsearch(entry, &priv->uri_entries,
+                    vlc_media_tree_UriEntryCmp) == NULL)
         {
-            *result = child;
-            if (result_parent)
-                *result_parent = parent;
-            return true;
+            free(entry->uri);
+            free(entry);
+            return VLC_ENOMEM;
         }
+    }
 
-        if (vlc_media_tree_FindNodeByMedia(child, media, result, result_parent))
-            return true;
+    if (!vlc_vector_push(&entry->nodes, node))
+    {
+        if (entry->nodes.size == 0)
+        {
+            tdelete(&key, &priv->uri_entries, vlc_media_tree_UriEntryCmp);
+            free(entry->uri);
+            free(entry);
+        }
+        return VLC_ENOMEM;
     }
+    return VLC_SUCCESS;
+}
 
-    return false;
+static void
+vlc_media_tree_UnindexUri(vlc_media_tree_t *tree,
+                          const struct media_tree_ref *ref)
+{
+    media_tree_private_t *priv = mt_priv(tree);
+    struct media_tree_uri_entry key = {
+        .parent = ref->parent, .uri = ref->uri,
+    };
+
+    void **slot = tfind(&key, &priv->uri_entries, vlc_media_tree_UriEntryCmp);
+    assert(slot != NULL);
+
+    struct media_tree_uri_entry *entry = *slot;
+    for (size_t i = 0; i < entry->nodes.size; ++i)
+        if (entry->nodes.data[i] == ref->node)
+        {
+            vlc_vector_remove(&entry->nodes, i);
+            break;
+        }
+
+    if (entry->nodes.size == 0)
+    {
+        tdelete(&key, &priv->uri_entries, vlc_media_tree_UriEntryCmp);
+        vlc_vector_destroy(&entry->nodes);
+        free(entry->uri);
+        free(entry);
+    }
+}
+
+/**
+ * Index a new node by its media, and by its parent and URI.
+ */
+static int
+vlc_media_tree_Index(vlc_media_tree_t *tree, input_item_node_t *parent,
+                     input_item_node_t *node)
+{
+    media_tree_private_t *priv = mt_priv(tree);
+    input_item_t *media = node->p_item;
+    struct media_tree_entry key = { .media = media };
+    struct media_tree_entry *entry;
+    struct media_tree_ref ref = { .node = node, .parent = parent };
+
+    vlc_mutex_lock(&media->lock);
+    if (media->psz_uri != NULL)
+        ref.uri = strdup(media->psz_uri);
+    vlc_mutex_unlock(&media->lock);
+
+    void **slot = tfind(&key, &priv->entries, vlc_media_tree_EntryCmp);
+    if (slot != NULL)
+        entry = *slot;
+    else
+    {
+        entry = malloc(sizeof(*entry));
+        if (unlikely(!entry))
+            goto error;
+        entry->media = media;
+        vlc_vector_init(&entry->refs);
+        if (tsearch(entry, &priv->entries, vlc_media_tree_EntryCmp) == NULL)
+        {
+            free(entry);
+            goto error;
+        }
+    }
+
+    if (!vlc_vector_push(&entry->refs, ref))
+        goto error_entry;
+    if (ref.uri != NULL
+     && vlc_media_tree_IndexUri(tree, parent, node, ref.uri) != VLC_SUCCESS)
+    {
+        vlc_vector_remove(&entry->refs, entry->refs.size - 1);
+        goto error_entry;
+    }
+    return VLC_SUCCESS;
+
+error_entry:
+    if (entry->refs.size == 0)
+    {
+        tdelete(&key, &priv->entries, vlc_media_tree_EntryCmp);
+        vlc_vector_destroy(&entry->refs);
+        free(entry);
+    }
+error:
+    free(ref.uri);
+    return VLC_ENOMEM;
+}
+
+/**
+ * Remove a node and all its descendants from the index.
+ */
+static void
+vlc_media_tree_Unindex(vlc_media_tree_t *tree, input_item_node_t *node)
+{
+    media_tree_private_t *priv = mt_priv(tree);
+
+    for (int i = 0; i < node->i_children; ++i)
+        vlc_media_tree_Unindex(tree, node->pp_children[i]);
+
+    struct media_tree_entry key = { .media = node->p_item };
+    void **slot = tfind(&key, &priv->entries, vlc_media_tree_EntryCmp);
+    if (slot == NULL)
+        return;
+
+    struct media_tree_entry *entry = *slot;
+    for (size_t i = 0; i < entry->refs.size; ++i)
+    {
+        struct media_tree_ref *ref = &entry->refs.data[i];
+        if (ref->node != node)
+            continue;
+
+        if (ref->uri != NULL)
+        {
+            vlc_media_tree_UnindexUri(tree, ref);
+            free(ref->uri);
+        }
+        vlc_vector_remove(&entry->refs, i);
+        break;
+    }
+
+    if (entry->refs.size == 0)
+    {
+        tdelete(&key, &priv->entries, vlc_media_tree_EntryCmp);
+        vlc_vector_destroy(&entry->refs);
+        free(entry);
+    }
+}
+
+static bool
+vlc_media_tree_FindNodeByMedia(vlc_media_tree_t *tree,
+                               const input_item_t *media,
+                               input_item_node_t **result,
+                               input_item_node_t **result_parent)
+{
+    media_tree_private_t *priv = mt_priv(tree);
+    struct media_tree_entry key = { .media = media };
+
+    void **slot = tfind(&key, &priv->entries, vlc_media_tree_EntryCmp);
+    if (slot == NULL)
+        return false;
+
+    /* The first node added for the media */
+    const struct media_tree_entry *entry = *slot;
+    assert(entry->refs.size > 0);
+    *result = entry->refs.data[0].node;
+    if (result_parent)
+        *result_parent = entry->refs.data[0].parent;
+    return true;
 }
 
 static input_item_node_t *
-vlc_media_tree_AddChild(input_item_node_t *parent, input_item_t *media);
+vlc_media_tree_AddChild(vlc_media_tree_t *tree, input_item_node_t *parent,
+                        input_item_t *media);
 
 static void
-vlc_media_tree_AddSubtree(input_item_node_t *to, input_item_node_t *from)
+vlc_media_tree_AddSubtree(vlc_media_tree_t *tree, input_item_node_t *to,
+                          input_item_node_t *from)
 {
     for (int i = 0; i < from->i_children; ++i)
     {
         input_item_node_t *child = from->pp_children[i];
-        input_item_node_t *node = vlc_media_tree_AddChild(to, child->p_item);
+        input_item_node_t *node =
+            vlc_media_tree_AddChild(tree, to, child->p_item);
         if (unlikely(!node))
             break; /* what could we do? */
 
-        vlc_media_tree_AddSubtree(node, child);
+        vlc_media_tree_AddSubtree(tree, node, child);
     }
 }
 
 static void
-vlc_media_tree_ClearChildren(input_item_node_t *root)
+vlc_media_tree_ClearChildren(vlc_media_tree_t *tree, input_item_node_t *root)
 {
     for (int i = 0; i < root->i_children; ++i)
+    {
+        vlc_media_tree_Unindex(tree, root->pp_children[i]);
         input_item_node_Delete(root->pp_children[i]);
+    }
 
     free(root->pp_children);
     root->pp_children = NULL;
@@ -153,17 +398,16 @@ media_subtree_changed(input_item_t *media, input_item_node_t *node,
 
     vlc_media_tree_Lock(tree);
     input_item_node_t *subtree_root;
-    /* TODO retrieve the node without traversing the tree */
-    bool found = vlc_media_tree_FindNodeByMedia(&tree->root, media,
-                                                &subtree_root, NULL);
+    bool found = vlc_media_tree_FindNodeByMedia(tree, media, &subtree_root,
+                                                NULL);
     if (!found) {
         /* the node probably failed to be allocated */
         vlc_media_tree_Unlock(tree);
         return;
     }
 
-    vlc_media_tree_ClearChildren(subtree_root);
-    vlc_media_tree_AddSubtree(subtree_root, node);
+    vlc_media_tree_ClearChildren(tree, subtree_root);
+    vlc_media_tree_AddSubtree(tree, subtree_root, node);
     vlc_media_tree_Notify(tree, on_children_reset, subtree_root);
     vlc_media_tree_Unlock(tree);
 }
@@ -177,9 +421,8 @@ media_subtree_preparse_ended(input_item_t *media,
 
     vlc_media_tree_Lock(tree);
     input_item_node_t *subtree_root;
-    /* TODO retrieve the node without traversing the tree */
-    bool found = vlc_media_tree_FindNodeByMedia(&tree->root, media,
-                                                &subtree_root, NULL);
+    bool found = vlc_media_tree_FindNodeByMedia(tree, media, &subtree_root,
+                                                NULL);
     if (!found) {
         /* the node probably failed to be allocated */
         vlc_media_tree_Unlock(tree);
@@ -192,13 +435,20 @@ media_subtree_preparse_ended(input_item_t *media,
 static inline void
 vlc_media_tree_DestroyRootNode(vlc_media_tree_t *tree)
 {
-    vlc_media_tree_ClearChildren(&tree->root);
+    vlc_media_tree_ClearChildren(tree, &tree->root);
 }
 
+static void
+vlc_media_tree_WatchDelete(struct media_tree_watch *watch);
+
 static void
 vlc_media_tree_Delete(vlc_media_tree_t *tree)
 {
     media_tree_private_t *priv = mt_priv(tree);
+    struct media_tree_watch *watch;
+    vlc_list_foreach(watch, &priv->watches, node)
+        vlc_media_tree_WatchDelete(watch);
+
     vlc_media_tree_listener_id *listener;
     vlc_list_foreach(listener, &priv->listeners, node)
         free(listener);
@@ -237,12 +487,19 @@ vlc_media_tree_Unlock(vlc_media_tree_t *tree)
 }
 
 static input_item_node_t *
-vlc_media_tree_AddChild(input_item_node_t *parent, input_item_t *media)
+vlc_media_tree_AddChild(vlc_media_tree_t *tree, input_item_node_t *parent,
+                        input_item_t *media)
 {
     input_item_node_t *node = input_item_node_Create(media);
     if (unlikely(!node))
         return NULL;
 
+    if (vlc_media_tree_Index(tree, parent, node) != VLC_SUCCESS)
+    {
+        input_item_node_Delete(node);
+        return NULL;
+    }
+
     input_item_node_AppendNode(parent, node);
 
     return node;
@@ -296,7 +553,7 @@ vlc_media_tree_Add(vlc_media_tree_t *tree, input_item_node_t *parent,
 {
     vlc_media_tree_AssertLocked(tree);
 
-    input_item_node_t *node = vlc_media_tree_AddChild(parent, media);
+    input_item_node_t *node = vlc_media_tree_AddChild(tree, parent, media);
     if (unlikely(!node))
         return NULL;
 
@@ -312,10 +569,7 @@ vlc_media_tree_Find(vlc_media_tree_t *tree, const input_item_t *media,
 {
     vlc_media_tree_AssertLocked(tree);
 
-    /* quick & dirty depth-first O(n) implementation, with n the number of nodes
-     * in the tree */
-    return vlc_media_tree_FindNodeByMedia(&tree->root, media, result,
-                                          result_parent);
+    return vlc_media_tree_FindNodeByMedia(tree, media, result, result_parent);
 }
 
 bool
@@ -325,9 +579,10 @@ vlc_media_tree_Remove(vlc_media_tree_t *tree, input_item_t *media)
 
     input_item_node_t *node;
     input_item_node_t *parent;
-    if (!vlc_media_tree_FindNodeByMedia(&tree->root, media, &node, &parent))
+    if (!vlc_media_tree_FindNodeByMedia(tree, media, &node, &parent))
         return false;
 
+    vlc_media_tree_Unindex(tree, node);
     input_item_node_RemoveNode(parent, node);
     vlc_media_tree_Notify(tree, on_children_removed, parent, &node, 1);
     input_item_node_Delete(node);
@@ -368,3 +623,305 @@ vlc_media_tree_PreparseCancel(libvlc_int_t *libvlc, void* id)
     libvlc_MetadataCancel(libvlc, id);
 #endif
 }
+
+#ifndef TEST_MEDIA_SOURCE
+static input_item_node_t *
+vlc_media_tree_FindChildByUri(vlc_media_tree_t *tree,
+                              const input_item_node_t *parent,
+                              const char *uri)
+{
+    media_tree_private_t *priv = mt_priv(tree);
+    struct media_tree_uri_entry key = {
+        .parent = parent, .uri = (char *)uri,
+    };
+
+    void **slot = tfind(&key, &priv->uri_entries, vlc_media_tree_UriEntryCmp);
+    if (slot == NULL)
+        return NULL;
+
+    const struct media_tree_uri_entry *entry = *slot;
+    assert(entry->nodes.size > 0);
+    return entry->nodes.data[0];
+}
+
+/**
+ * Find the child node of a watched directory matching an entry name.
+ *
+ * \param parent the node of the watched directory [OUT]
+ * \return the child node, or NULL if not found (or on error)
+ */
+static input_item_node_t *
+vlc_media_tree_WatchFind(struct media_tree_watch *watch, const char *uri,
+                         input_item_node_t **parent)
+{
+    if (!vlc_media_tree_FindNodeByMedia(watch->tree, watch->media, parent,
+                                        NULL))
+    {
+        *parent = NULL;
+        return NULL;
+    }
+    return vlc_media_tree_FindChildByUri(watch->tree, *parent, uri);
+}
+
+static char *
+vlc_media_tree_WatchUri(struct media_tree_watch *watch, const char *name)
+{
+    char *encoded = vlc_uri_encode(name);
+    if (unlikely(encoded == NULL))
+        return NULL;
+
+    char *uri;
+    if (asprintf(&uri, "%s%s", watch->base_uri, encoded) == -1)
+        uri = NULL;
+    free(encoded);
+    return uri;
+}
+
+static int
+vlc_media_tree_WatchStat(struct media_tree_watch *watch, const char *name,
+                         struct stat *st)
+{
+    char *path;
+    if (asprintf(&path, "%s"DIR_SEP"%s", watch->path, name) == -1)
+        return -1;
+
+    int ret = vlc_stat(path, st);
+    free(path);
+    return ret;
+}
+
+static void
+vlc_media_tree_WatchAdded(vlc_fs_watcher_t *watcher, const char *name,
+                          void *data)
+{
+    struct media_tree_watch *watch = data;
+    vlc_media_tree_t *tree = watch->tree;
+    struct stat st;
+    int type;
+    VLC_UNUSED(watcher);
+
+    if (!watch->show_hidden && name[0] == '.')
+        return;
+    if (vlc_media_tree_WatchStat(watch, name, &st))
+        return; /* already gone */
+
+    if (S_ISREG(st.st_mode))
+        type = ITEM_TYPE_FILE;
+    else if (S_ISDIR(st.st_mode))
+        type = ITEM_TYPE_DIRECTORY;
+    else
+        return; /* special files are not listed by default */
+
+    char *uri = vlc_media_tree_WatchUri(watch, name);
+    if (unlikely(uri == NULL))
+        return;
+
+    vlc_media_tree_Lock(tree);
+    input_item_node_t *parent;
+    if (vlc_media_tree_WatchFind(watch, uri, &parent) == NULL
+     && parent != NULL)
+    {
+        input_item_t *media =
+            input_item_NewExt(uri, name, INPUT_DURATION_UNSET, type,
+                              ITEM_NET_UNKNOWN);
+        if (likely(media != NULL))
+        {
+            input_item_AddStat(media, "mtime", st.st_mtime);
+            input_item_AddStat(media, "size", st.st_size);
+            vlc_media_tree_Add(tree, parent, media);
+            input_item_Release(media);
+        }
+    }
+    vlc_media_tree_Unlock(tree);
+    free(uri);
+}
+
+static void
+vlc_media_tree_WatchRemoved(vlc_fs_watcher_t *watcher, const char *name,
+                            void *data)
+{
+    struct media_tree_watch *watch = data;
+    vlc_media_tree_t *tree = watch->tree;
+    VLC_UNUSED(watcher);
+
+    char *uri = vlc_media_tree_WatchUri(watch, name);
+    if (unlikely(uri == NULL))
+        return;
+
+    vlc_media_tree_Lock(tree);
+    input_item_node_t *parent;
+    input_item_node_t *node = vlc_media_tree_WatchFind(watch, uri, &parent);
+    if (node != NULL)
+    {
+        vlc_media_tree_Unindex(tree, node);
+        input_item_node_RemoveNode(parent, node);
+        vlc_media_tree_Notify(tree, on_children_removed, parent, &node, 1);
+        input_item_node_Delete(node);
+    }
+    vlc_media_tree_Unlock(tree);
+    free(uri);
+}
+
+static void
+vlc_media_tree_WatchModified(vlc_fs_watcher_t *watcher, const char *name,
+                             void *data)
+{
+    struct media_tree_watch *watch = data;
+    vlc_media_tree_t *tree = watch->tree;
+    struct stat st;
+    VLC_UNUSED(watcher);
+
+    if (vlc_media_tree_WatchStat(watch, name, &st))
+        return;
+
+    char *uri = vlc_media_tree_WatchUri(watch, name);
+    if (unlikely(uri == NULL))
+        return;
+
+    vlc_media_tree_Lock(tree);
+    input_item_node_t *parent;
+    input_item_node_t *node = vlc_media_tree_WatchFind(watch, uri, &parent);
+    if (node != NULL)
+    {
+        input_item_AddStat(node->p_item, "mtime", st.st_mtime);
+        input_item_AddStat(node->p_item, "size", st.st_size);
+        /* The content changed: preparse it again on next request */
+        input_item_SetPreparsed(node->p_item, false);
+    }
+    vlc_media_tree_Unlock(tree);
+    free(uri);
+}
+
+static void
+media_tree_watch_preparse_ended(input_item_t *media,
+                                enum input_item_preparse_status status,
+                                void *user_data)
+{
+    vlc_media_tree_t *tree = user_data;
+
+    media_subtree_preparse_ended(media, status, tree);
+    vlc_media_tree_Release(tree);
+}
+
+/* The request holds the tree, which may be released before it ends */
+static const input_preparser_callbacks_t media_tree_watch_preparser_cbs = {
+    .on_subtree_added = media_subtree_changed,
+    .on_preparse_ended = media_tree_watch_preparse_ended,
+};
+
+static void
+vlc_media_tree_WatchOverflow(vlc_fs_watcher_t *watcher, void *data)
+{
+    struct media_tree_watch *watch = data;
+    vlc_media_tree_t *tree = watch->tree;
+    VLC_UNUSED(watcher);
+
+    /* Changes were lost, list the whole directory again. The request is
+     * cancelled with the watch. */
+    vlc_media_tree_Hold(tree);
+    watch->media->i_preparse_depth = 1;
+    if (vlc_MetadataRequest(watch->libvlc, watch->media,
+                            META_REQUEST_OPTION_SCOPE_ANY,
+                            &media_tree_watch_preparser_cbs, tree, 0,
+                            watch) != VLC_SUCCESS)
+        vlc_media_tree_Release(tree);
+}
+
+static const struct vlc_fs_watcher_callbacks media_tree_watcher_cbs = {
+    .on_added = vlc_media_tree_WatchAdded,
+    .on_removed = vlc_media_tree_WatchRemoved,
+    .on_modified = vlc_media_tree_WatchModified,
+    .on_overflow = vlc_media_tree_WatchOverflow,
+};
+#endif
+
+static void
+vlc_media_tree_WatchDelete(struct media_tree_watch *watch)
+{
+#ifndef TEST_MEDIA_SOURCE
+    vlc_fs_watcher_Delete(watch->watcher);
+    vlc_media_tree_PreparseCancel(watch->libvlc, watch);
+#endif
+    input_item_Release(watch->media);
+    free(watch->base_uri);
+    free(watch->path);
+    free(watch);
+}
+
+int
+vlc_media_tree_Watch(vlc_media_tree_t *tree, libvlc_int_t *libvlc,
+                     input_item_t *media)
+{
+#ifdef TEST_MEDIA_SOURCE
+    VLC_UNUSED(tree);
+    VLC_UNUSED(libvlc);
+    VLC_UNUSED(media);
+    return VLC_ENOTSUP;
+#else
+    struct media_tree_watch *watch = malloc(sizeof(*watch));
+    if (unlikely(!watch))
+        return VLC_ENOMEM;
+
+    watch->base_uri = NULL;
+    vlc_mutex_lock(&media->lock);
+    watch->path = media->psz_uri != NULL ? vlc_uri2path(media->psz_uri)
+                                         : NULL;
+    if (watch->path != NULL)
+    {
+        size_t len = strlen(media->psz_uri);
+        bool sep = len > 0 && media->psz_uri[len - 1] == '/';
+        if (asprintf(&watch->base_uri, "%s%s", media->psz_uri,
+                     sep ? "" : "/") == -1)
+            watch->base_uri = NULL;
+    }
+    vlc_mutex_unlock(&media->lock);
+
+    if (watch->path == NULL || watch->base_uri == NULL)
+        goto error;
+
+    watch->tree = tree;
+    watch->libvlc = libvlc;
+    watch->media = media;
+    watch->show_hidden = var_InheritBool(libvlc, "show-hiddenfiles");
+    input_item_Hold(media);
+
+    watch->watcher = vlc_fs_watcher_New(libvlc, watch->path,
+                                        &media_tree_watcher_cbs, watch);
+    if (watch->watcher == NULL)
+    {
+        input_item_Release(media);
+        goto error;
+    }
+
+    vlc_media_tree_Lock(tree);
+    vlc_list_append(&watch->node, &mt_priv(tree)->watches);
+    vlc_media_tree_Unlock(tree);
+    return VLC_SUCCESS;
+
+error:
+    free(watch->base_uri);
+    free(watch->path);
+    free(watch);
+    return VLC_ENOTSUP;
+#endif
+}
+
+void
+vlc_media_tree_Unwatch(vlc_media_tree_t *tree, input_item_t *media)
+{
+    struct media_tree_watch *watch, *found = NULL;
+
+    vlc_media_tree_Lock(tree);
+    vlc_list_foreach(watch, &mt_priv(tree)->watches, node)
+        if (watch->media == media)
+        {
+            vlc_list_remove(&watch->node);
+            found = watch;
+            break;
+        }
+    vlc_media_tree_Unlock(tree);
+
+    /* Not locked, the watcher callbacks lock the tree */
+    if (found != NULL)
+        vlc_media_tree_WatchDelete(found);
+}
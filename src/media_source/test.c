@@ -80,6 +80,45 @@ test_media_tree(void)
     vlc_media_tree_Release(tree);
 }
 
+static void
+test_media_tree_duplicate(void)
+{
+    vlc_media_tree_t *tree = vlc_media_tree_New();
+    vlc_media_tree_Lock(tree);
+
+    input_item_t *media = input_item_New("vlc://item", "aaa");
+    assert(media);
+    input_item_t *media2 = input_item_New("vlc://child", "bbb");
+    assert(media2);
+
+    /* The same media, in two places */
+    input_item_node_t *node = vlc_media_tree_Add(tree, &tree->root, media);
+    assert(node);
+    input_item_node_t *node2 = vlc_media_tree_Add(tree, node, media2);
+    assert(node2);
+    input_item_node_t *dup = vlc_media_tree_Add(tree, &tree->root, media2);
+    assert(dup);
+
+    input_item_node_t *result, *parent;
+    assert(vlc_media_tree_Find(tree, media2, &result, &parent));
+    assert(result == node2 && parent == node);
+
+    /* The other node is still found once the first one is removed */
+    assert(vlc_media_tree_Remove(tree, media2));
+    assert(node->i_children == 0);
+    assert(vlc_media_tree_Find(tree, media2, &result, &parent));
+    assert(result == dup && parent == &tree->root);
+
+    assert(vlc_media_tree_Remove(tree, media2));
+    assert(!vlc_media_tree_Find(tree, media2, &result, &parent));
+    assert(!vlc_media_tree_Remove(tree, media2));
+
+    input_item_Release(media2);
+    input_item_Release(media);
+    vlc_media_tree_Unlock(tree);
+    vlc_media_tree_Release(tree);
+}
+
 struct children_reset_report
 {
     input_item_node_t *node;
@@ -310,6 +349,7 @@ test_media_tree_callbacks_on_add_listener(void)
 int main(void)
 {
     test_media_tree();
+    test_media_tree_duplicate();
     test_media_tree_callbacks();
     test_media_tree_callbacks_on_add_listener();
     return 0;
@@ -149,6 +149,170 @@ void vlc_frame_Release(vlc_frame_t *frame)
     frame->cbs->free(frame);
 }
 
+static const struct vlc_frame_callbacks vlc_frame_range_cbs;
+
+/** Payload shared by several reference frames */
+struct vlc_frame_shared
+{
+    vlc_atomic_rc_t rc;
+    atomic_bool spare_taken; /**< whether a reference took the headroom */
+    vlc_frame_t *frame; /**< backing frame */
+};
+
+struct vlc_frame_ref
+{
+    vlc_frame_t self;
+    struct vlc_frame_shared *shared;
+    bool has_spare;
+};
+
+static void vlc_frame_ref_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_ref *ref = container_of(frame, struct vlc_frame_ref, self);
+    struct vlc_frame_shared *shared = ref->shared;
+
+    if (vlc_atomic_rc_dec(&shared->rc))
+    {
+        vlc_frame_Release(shared->frame);
+        free(shared);
+    }
+    free(ref);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_ref_cbs =
+{
+    vlc_frame_ref_Release,
+};
+
+static vlc_frame_t *vlc_frame_ref_New(struct vlc_frame_shared *shared,
+                                      const vlc_frame_t *src)
+{
+    struct vlc_frame_ref *ref = malloc(sizeof (*ref));
+    if (unlikely(ref == NULL))
+        return NULL;
+
+    ref->shared = shared;
+    ref->has_spare = false;
+
+    /* The reference covers its payload only, so that any growth reallocates
+     * instead of writing over the bytes of the other references. */
+    vlc_frame_t *frame = vlc_frame_Init(&ref->self, &vlc_frame_ref_cbs,
+                                        src->p_buffer, src->i_buffer);
+    vlc_frame_CopyProperties(frame, src);
+    return frame;
+}
+
+vlc_frame_t *vlc_frame_Share(vlc_frame_t *frame)
+{
+    if (frame->cbs == &vlc_frame_ref_cbs)
+        return frame;
+
+    struct vlc_frame_shared *shared = malloc(sizeof (*shared));
+    if (unlikely(shared == NULL))
+        return frame;
+
+    vlc_frame_t *ref = vlc_frame_ref_New(shared, frame);
+    if (unlikely(ref == NULL))
+    {
+        free(shared);
+        return frame;
+    }
+
+    vlc_atomic_rc_init(&shared->rc);
+    atomic_init(&shared->spare_taken, false);
+    shared->frame = frame;
+
+    ref->p_next = frame->p_next;
+    frame->p_next = NULL;
+    return ref;
+}
+
+vlc_frame_t *vlc_frame_Clone(const vlc_frame_t *frame)
+{
+    if (frame->cbs != &vlc_frame_ref_cbs)
+        return vlc_frame_Duplicate(frame);
+
+    const struct vlc_frame_ref *ref =
+        container_of(frame, const struct vlc_frame_ref, self);
+    vlc_frame_t *clone = vlc_frame_ref_New(ref->shared, frame);
+    if (likely(clone != NULL))
+        vlc_atomic_rc_inc(&ref->shared->rc);
+    return clone;
+}
+
+bool vlc_frame_IsShared(const vlc_frame_t *frame)
+{
+    if (frame->cbs == &vlc_frame_range_cbs)
+        return true; /* the payload must remain the same as the file */
+    if (frame->cbs != &vlc_frame_ref_cbs)
+        return false;
+
+    const struct vlc_frame_ref *ref =
+        container_of(frame, const struct vlc_frame_ref, self);
+    if (ref->shared->frame->cbs == &vlc_frame_range_cbs)
+        return true;
+    /* Pairs with the release of the other references */
+    return atomic_load_explicit(&ref->shared->rc.refs,
+                                memory_order_acquire) > 1;
+}
+
+vlc_frame_t *vlc_frame_Unshare(vlc_frame_t *frame)
+{
+    if (!vlc_frame_IsShared(frame))
+        return frame;
+
+    vlc_frame_t *dup = vlc_frame_Duplicate(frame);
+    if (likely(dup != NULL))
+        dup->p_next = frame->p_next;
+    vlc_frame_Release(frame);
+    return dup;
+}
+
+/**
+ * Grows a reference frame.
+ *
+ * The payload can only be prepended in place, within the headroom of the
+ * backing frame, and by a single reference: the muxers prepending their
+ * headers then do not copy the payload for one of the outputs, as before it
+ * was shared.
+ */
+static bool vlc_frame_ref_TryGrow(vlc_frame_t *frame, size_t prebody,
+                                  size_t body)
+{
+    if (body > frame->i_buffer)
+        return false;
+    if (prebody == 0)
+        return true;
+    if (frame->cbs != &vlc_frame_ref_cbs)
+        return false;
+
+    struct vlc_frame_ref *ref = container_of(frame, struct vlc_frame_ref, self);
+    const vlc_frame_t *backing = ref->shared->frame;
+
+    if (frame->p_buffer > backing->p_buffer
+     || (size_t)(frame->p_buffer - backing->p_start) < prebody)
+        return false;
+
+    if (!ref->has_spare)
+    {
+        if (atomic_exchange_explicit(&ref->shared->spare_taken, true,
+                                     memory_order_relaxed))
+            return false;
+        ref->has_spare = true;
+    }
+
+    uint8_t *end = frame->p_start + frame->i_size;
+
+    frame->p_buffer -= prebody;
+    frame->i_buffer += prebody;
+    if (frame->p_buffer < frame->p_start)
+    {
+        frame->p_start = frame->p_buffer;
+        frame->i_size = end - frame->p_start;
+    }
+    return true;
+}
+
 static vlc_frame_t *vlc_frame_ReallocDup( vlc_frame_t *frame, ssize_t i_prebody, size_t requested )
 {
     vlc_frame_t *p_rea = vlc_frame_Alloc( requested );
@@ -199,6 +363,14 @@ vlc_frame_t *vlc_frame_TryRealloc (vlc_frame_t *frame, ssize_t i_prebody, size_t
 
     size_t requested = i_prebody + i_body;
 
+    if( frame->cbs == &vlc_frame_ref_cbs || frame->cbs == &vlc_frame_range_cbs )
+    {   /* Shared payload: never write over the bytes of other references,
+         * nor over those of the file */
+        if( vlc_frame_ref_TryGrow( frame, i_prebody, i_body ) )
+            return frame;
+        return vlc_frame_ReallocDup( frame, i_prebody, requested );
+    }
+
     if( frame->i_buffer == 0 )
     {   /* Corner case: nothing to preserve */
         if( requested <= frame->i_size )
@@ -514,6 +686,112 @@ vlc_frame_t *vlc_frame_FilePath(const char *path, bool write)
     return frame;
 }
 
+/** Frame of a mapped file range */
+struct vlc_frame_range
+{
+    vlc_frame_t self;
+    void *map;
+    size_t map_length;
+    uint8_t *base; /**< address of the file range */
+    uint64_t offset; /**< file offset of the range */
+    int fd;
+};
+
+#ifdef HAVE_MMAP
+static void vlc_frame_range_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_range *range =
+        container_of(frame, struct vlc_frame_range, self);
+
+    munmap(range->map, range->map_length);
+    vlc_close(range->fd);
+    free(range);
+}
+#endif
+
+static const struct vlc_frame_callbacks vlc_frame_range_cbs =
+{
+#ifdef HAVE_MMAP
+    vlc_frame_range_Release,
+#else
+    NULL,
+#endif
+};
+
+vlc_frame_t *vlc_frame_FileRange(int fd, uint64_t offset, size_t length)
+{
+#ifdef HAVE_MMAP
+    long page_mask = sysconf(_SC_PAGESIZE) - 1;
+    size_t left = offset & page_mask;
+
+    if (length > 0 && length <= SIZE_MAX - left)
+    {
+        struct vlc_frame_range *range = malloc(sizeof (*range));
+        if (unlikely(range == NULL))
+            return NULL;
+
+        range->fd = vlc_dup(fd);
+        if (range->fd == -1)
+        {
+            free(range);
+            return NULL;
+        }
+
+        /* The payload is shared with the file: it is mapped read-only, so
+         * that writing to it without vlc_frame_Unshare() fails loudly,
+         * rather than diverging silently from the copied file range. */
+        range->map_length = left + length;
+        range->map = mmap(NULL, range->map_length, PROT_READ,
+                          MAP_PRIVATE, fd, offset - left);
+        if (range->map != MAP_FAILED)
+        {
+            range->base = (uint8_t *)range->map + left;
+            range->offset = offset;
+            /* No spare room: growing the frame copies its payload */
+            return vlc_frame_Init(&range->self, &vlc_frame_range_cbs,
+                                  range->base, length);
+        }
+        vlc_close(range->fd);
+        free(range);
+    }
+#endif
+
+    /* If mmap() is not implemented by the OS _or_ the filesystem... */
+    vlc_frame_t *frame = vlc_frame_Alloc(length);
+    if (frame == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < length;)
+    {
+        ssize_t len = pread(fd, frame->p_buffer + i, length - i, offset + i);
+        if (len <= 0)
+        {
+            if (len == 0)
+                errno = EIO;
+            vlc_frame_Release(frame);
+            return NULL;
+        }
+        i += len;
+    }
+    return frame;
+}
+
+int vlc_frame_GetFileRange(const vlc_frame_t *frame, uint64_t *restrict offset)
+{
+    const vlc_frame_t *backing = frame;
+
+    if (frame->cbs == &vlc_frame_ref_cbs)
+        backing = container_of(frame, const struct vlc_frame_ref,
+                               self)->shared->frame;
+    if (backing->cbs != &vlc_frame_range_cbs)
+        return -1;
+
+    const struct vlc_frame_range *range =
+        container_of(backing, const struct vlc_frame_range, self);
+    *offset = range->offset + (frame->p_buffer - range->base);
+    return range->fd;
+}
+
 int
 vlc_frame_AttachAncillary(vlc_frame_t *frame, struct vlc_ancillary *ancillary)
 {
@@ -0,0 +1,58 @@
+/*****************************************************************************
+ * fs_watcher.c: file system watcher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs_watcher.h>
+#include <vlc_modules.h>
+#include "libvlc.h"
+
+#undef vlc_fs_watcher_New
+vlc_fs_watcher_t *vlc_fs_watcher_New(vlc_object_t *parent, const char *path,
+                                     const struct vlc_fs_watcher_callbacks *cbs,
+                                     void *data)
+{
+    vlc_fs_watcher_t *watcher = vlc_custom_create(parent, sizeof (*watcher),
+                                                  "fs watcher");
+    if (unlikely(watcher == NULL))
+        return NULL;
+
+    watcher->path = path;
+    watcher->cbs = cbs;
+    watcher->cbs_data = data;
+    watcher->sys = NULL;
+
+    watcher->module = module_need(watcher, "fs watcher", NULL, false);
+    if (watcher->module == NULL)
+    {
+        vlc_object_delete(watcher);
+        return NULL;
+    }
+    return watcher;
+}
+
+void vlc_fs_watcher_Delete(vlc_fs_watcher_t *watcher)
+{
+    module_unneed(watcher, watcher->module);
+    vlc_object_delete(watcher);
+}
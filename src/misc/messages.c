@@ -37,8 +37,10 @@
 #include <assert.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_interface.h>
 #include <vlc_charset.h>
+#include <vlc_configuration.h>
 #include <vlc_modules.h>
 #include "rcu.h"
 #include "../libvlc.h"
@@ -435,6 +437,266 @@ static struct vlc_logger *vlc_LogModuleCreate(vlc_object_t *parent)
     return &module->frontend;
 }
 
+/**
+ * Asynchronous message log.
+ *
+ * A message log that formats messages into a bounded lock-free ring, from
+ * which a dedicated thread passes them to another log. The calling threads
+ * never wait for the output; if the ring is full, messages are dropped and
+ * counted. Messages more verbose than any log outputs are discarded upfront,
+ * so that they neither get formatted nor take cells.
+ */
+#define LOG_ASYNC_CELLS 1024 /* must be a power of two */
+#define LOG_ASYNC_TEXT  480
+
+struct vlc_log_async_cell {
+    atomic_size_t seq;
+    int type;
+    vlc_log_t meta;
+    char *msg; /* message too long for the text buffer, or NULL */
+    char text[LOG_ASYNC_TEXT]; /* module, header and message */
+};
+
+struct vlc_logger_async {
+    struct vlc_logger logger;
+    struct vlc_logger *sink;
+    vlc_thread_t thread;
+
+    atomic_size_t enqueue_pos;
+    size_t dequeue_pos;
+    atomic_size_t dropped;
+    int verbosity; /* most verbose message type to pass */
+    atomic_bool sleeping;
+    atomic_uint wakeup;
+    atomic_bool stopping;
+
+    struct vlc_log_async_cell cells[LOG_ASYNC_CELLS];
+};
+
+static size_t vlc_LogAsyncCopy(char *buf, size_t size, const char *str)
+{
+    size_t len = strnlen(str, size - 1);
+
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+    return len + 1;
+}
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, logger);
+    struct vlc_log_async_cell *cell;
+
+    if (type > async->verbosity)
+        return;
+
+    size_t pos = atomic_load_explicit(&async->enqueue_pos,
+                                      memory_order_relaxed);
+
+    /* Claim a free cell (Vyukov's bounded queue) */
+    for (;;) {
+        cell = &async->cells[pos % LOG_ASYNC_CELLS];
+
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&async->enqueue_pos,
+                                                      &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&async->dropped, 1,
+                                      memory_order_relaxed);
+            return;
+        } else
+            pos = atomic_load_explicit(&async->enqueue_pos,
+                                       memory_order_relaxed);
+    }
+
+    /* The module name may be on the stack of the caller and the header
+     * belongs to the object: copy both. Others fields are static. */
+    char *text = cell->text;
+    size_t len = vlc_LogAsyncCopy(text, 64, item->psz_module);
+
+    cell->type = type;
+    cell->meta = *item;
+    cell->meta.psz_module = text;
+    cell->meta.psz_header = NULL;
+    if (item->psz_header != NULL) {
+        cell->meta.psz_header = text + len;
+        len += vlc_LogAsyncCopy(text + len, 128, item->psz_header);
+    }
+
+    va_list aq;
+    va_copy(aq, ap);
+    int n = vsnprintf(text + len, LOG_ASYNC_TEXT - len, format, aq);
+    va_end(aq);
+
+    cell->msg = NULL;
+    if (n < 0)
+        text[len] = '\0';
+    else if ((size_t)n >= LOG_ASYNC_TEXT - len
+          && vasprintf(&cell->msg, format, ap) == -1)
+        cell->msg = NULL; /* keep the truncated message */
+
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    /* Wake the thread up if it is about to sleep (or sleeping) */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&async->sleeping, memory_order_relaxed)
+     && atomic_exchange_explicit(&async->sleeping, false,
+                                 memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&async->wakeup, 1, memory_order_relaxed);
+        vlc_atomic_notify_one(&async->wakeup);
+    }
+}
+
+static bool vlc_LogAsyncDrain(struct vlc_logger_async *async)
+{
+    bool drained = false;
+
+    for (;;) {
+        size_t pos = async->dequeue_pos;
+        struct vlc_log_async_cell *cell = &async->cells[pos % LOG_ASYNC_CELLS];
+
+        if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1)
+            break;
+
+        const char *text = cell->msg;
+        if (text == NULL)
+            text = cell->text + strlen(cell->text) + 1
+                 + (cell->meta.psz_header != NULL
+                    ? strlen(cell->meta.psz_header) + 1 : 0);
+
+        vlc_LogCallback(async->sink, cell->type, &cell->meta, "%s", text);
+        free(cell->msg);
+
+        atomic_store_explicit(&cell->seq, pos + LOG_ASYNC_CELLS,
+                              memory_order_release);
+        async->dequeue_pos = pos + 1;
+        drained = true;
+    }
+
+    size_t dropped = atomic_exchange_explicit(&async->dropped, 0,
+                                              memory_order_relaxed);
+    if (dropped > 0) {
+        const vlc_log_t meta = {
+            .i_object_id = (uintptr_t)(void *)async,
+            .psz_object_type = "logger",
+            .psz_module = "main",
+            .file = __FILE__,
+            .line = __LINE__,
+            .func = __func__,
+            .tid = vlc_thread_id(),
+        };
+
+        /* As an error, lest it be filtered out by the verbosity */
+        vlc_LogCallback(async->sink, VLC_MSG_ERR, &meta,
+                        "%zu log message(s) dropped", dropped);
+    }
+    return drained;
+}
+
+static void *vlc_LogAsyncThread(void *data)
+{
+    struct vlc_logger_async *async = data;
+
+    vlc_thread_set_name("vlc-logger");
+
+    for (;;) {
+        unsigned wakeup = atomic_load_explicit(&async->wakeup,
+                                               memory_order_relaxed);
+
+        if (vlc_LogAsyncDrain(async))
+            continue;
+        if (atomic_load_explicit(&async->stopping, memory_order_acquire))
+            break;
+
+        atomic_store_explicit(&async->sleeping, true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        size_t pos = async->dequeue_pos;
+        if (atomic_load_explicit(&async->cells[pos % LOG_ASYNC_CELLS].seq,
+                                 memory_order_relaxed) != pos + 1)
+            vlc_atomic_wait(&async->wakeup, wakeup);
+        atomic_store_explicit(&async->sleeping, false, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+static void vlc_LogAsyncClose(void *d)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, logger);
+
+    atomic_store_explicit(&async->stopping, true, memory_order_release);
+    atomic_fetch_add_explicit(&async->wakeup, 1, memory_order_relaxed);
+    vlc_atomic_notify_one(&async->wakeup);
+    vlc_join(async->thread, NULL);
+
+    /* Messages logged after the last drain */
+    vlc_LogAsyncDrain(async);
+    vlc_LogDestroy(async->sink);
+    free(async);
+}
+
+static const struct vlc_logger_operations async_ops = {
+    vlc_vaLogAsync,
+    vlc_LogAsyncClose,
+};
+
+/**
+ * Returns the most verbose message type that the log modules may output.
+ */
+static int vlc_LogAsyncVerbosity(vlc_object_t *obj)
+{
+    /* The system logs filter the messages by themselves */
+    if (config_GetType("syslog") && var_InheritBool(obj, "syslog"))
+        return VLC_MSG_DBG;
+
+    int verbosity = var_InheritInteger(obj, "verbose");
+    const char *str = getenv("VLC_VERBOSE");
+
+    if (str != NULL)
+        verbosity = __MAX(verbosity, atoi(str));
+    if (config_GetType("log-verbose"))
+        verbosity = __MAX(verbosity, var_InheritInteger(obj, "log-verbose"));
+
+    return __MIN(__MAX(verbosity, -1) + VLC_MSG_ERR, VLC_MSG_DBG);
+}
+
+static struct vlc_logger *vlc_LogAsyncCreate(struct vlc_logger *sink,
+                                             int verbosity)
+{
+    struct vlc_logger_async *async = malloc(sizeof (*async));
+    if (unlikely(async == NULL))
+        return NULL;
+
+    async->logger.ops = &async_ops;
+    async->sink = sink;
+    atomic_init(&async->enqueue_pos, 0);
+    async->dequeue_pos = 0;
+    atomic_init(&async->dropped, 0);
+    async->verbosity = verbosity;
+    atomic_init(&async->sleeping, false);
+    atomic_init(&async->wakeup, 0);
+    atomic_init(&async->stopping, false);
+    for (size_t i = 0; i < LOG_ASYNC_CELLS; i++)
+        atomic_init(&async->cells[i].seq, i);
+
+    if (vlc_clone(&async->thread, vlc_LogAsyncThread, async)) {
+        free(async);
+        return NULL;
+    }
+    return &async->logger;
+}
+
 /**
  * Initializes the messages logging subsystem and drain the early messages to
  * the configured log.
@@ -444,6 +706,12 @@ void vlc_LogInit(libvlc_int_t *vlc)
     struct vlc_logger *logger = vlc_LogModuleCreate(VLC_OBJECT(vlc));
     if (logger == NULL)
         logger = &discard_log;
+    else if (var_InheritBool(vlc, "log-async")) {
+        struct vlc_logger *async =
+            vlc_LogAsyncCreate(logger, vlc_LogAsyncVerbosity(VLC_OBJECT(vlc)));
+        if (async != NULL)
+            logger = async;
+    }
 
     vlc_LogSwitch(vlc->obj.logger, logger);
 }
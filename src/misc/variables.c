@@ -27,9 +27,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <float.h>
 #include <math.h>
@@ -67,7 +64,10 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    uint32_t     hash;     /**< Hash of the name */
+    /** Next variable in the same hash table bucket */
+    struct variable_t *next;
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -138,23 +138,85 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
-static int varcmp( const void *a, const void *b )
+/* FNV-1a */
+static uint32_t VarHash( const char *psz_name )
+{
+    uint32_t hash = 2166136261u;
+
+    for( const unsigned char *p = (const unsigned char *)psz_name; *p; p++ )
+        hash = (hash ^ *p) * 16777619u;
+    return hash;
+}
+
+static variable_t **VarBucket( vlc_object_internals_t *priv, uint32_t hash )
 {
-    const variable_t *va = a, *vb = b;
+    return &priv->var_table[hash & (priv->var_table_size - 1)];
+}
+
+static variable_t *VarFind( vlc_object_internals_t *priv,
+                            const char *psz_name, uint32_t hash )
+{
+    if( priv->var_table_size == 0 )
+        return NULL;
+
+    for( variable_t *var = *VarBucket( priv, hash ); var != NULL;
+         var = var->next )
+        if( var->hash == hash && strcmp( var->psz_name, psz_name ) == 0 )
+            return var;
+    return NULL;
+}
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+/**
+ * Inserts a variable in the object hash table, which grows to keep about one
+ * variable per bucket.
+ */
+static int VarInsert( vlc_object_internals_t *priv, variable_t *var )
+{
+    if( priv->var_count >= priv->var_table_size )
+    {
+        size_t size = priv->var_table_size ? 2 * priv->var_table_size : 16;
+        variable_t **table = calloc( size, sizeof (*table) );
+        if( unlikely(table == NULL) )
+            return VLC_ENOMEM;
+
+        for( size_t i = 0; i < priv->var_table_size; i++ )
+            for( variable_t *cur = priv->var_table[i], *next; cur != NULL;
+                 cur = next )
+            {
+                next = cur->next;
+                cur->next = table[cur->hash & (size - 1)];
+                table[cur->hash & (size - 1)] = cur;
+            }
+
+        free( priv->var_table );
+        priv->var_table = table;
+        priv->var_table_size = size;
+    }
+
+    variable_t **bucket = VarBucket( priv, var->hash );
+    var->next = *bucket;
+    *bucket = var;
+    priv->var_count++;
+    return VLC_SUCCESS;
+}
+
+static void VarRemove( vlc_object_internals_t *priv, variable_t *var )
+{
+    variable_t **pp = VarBucket( priv, var->hash );
+
+    while( *pp != var )
+        pp = &(*pp)->next;
+    *pp = var->next;
+    priv->var_count--;
 }
 
 static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    void **pp_var;
+    uint32_t hash = VarHash( psz_name );
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
-    return (pp_var != NULL) ? *pp_var : NULL;
+    return VarFind( priv, psz_name, hash );
 }
 
 static void Destroy( variable_t *p_var )
@@ -295,6 +357,7 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->hash = VarHash( psz_name );
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -354,17 +417,18 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         var_Inherit(p_this, psz_name, i_type, &p_var->val);
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    void **pp_var;
     variable_t *p_oldvar;
     int ret = VLC_SUCCESS;
 
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
-        ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
-        p_var = NULL; /* Variable created */
+    p_oldvar = VarFind( p_priv, psz_name, p_var->hash );
+    if( p_oldvar == NULL ) /* Variable create */
+    {
+        ret = VarInsert( p_priv, p_var );
+        if( likely(ret == VLC_SUCCESS) )
+            p_var = NULL; /* Variable created */
+    }
     else /* Variable already exists */
     {
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
@@ -394,7 +458,7 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
     else if( --p_var->i_usage == 0 )
     {
         assert(!p_var->b_incallback);
-        tdelete( p_var, &p_priv->var_root, varcmp );
+        VarRemove( p_priv, p_var );
     }
     else
     {
@@ -407,17 +471,22 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
         Destroy( p_var );
 }
 
-static void CleanupVar( void *var )
-{
-    Destroy( var );
-}
-
 void var_DestroyAll( vlc_object_t *obj )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    for( size_t i = 0; i < priv->var_table_size; i++ )
+        for( variable_t *var = priv->var_table[i], *next; var != NULL;
+             var = next )
+        {
+            next = var->next;
+            Destroy( var );
+        }
+
+    free( priv->var_table );
+    priv->var_table = NULL;
+    priv->var_table_size = 0;
+    priv->var_count = 0;
 }
 
 int (var_Change)(vlc_object_t *p_this, const char *psz_name, int i_action, ...)
@@ -1137,21 +1206,6 @@ error:
     return VLC_EGENERIC;
 }
 
-static thread_local void *twalk_ctx;
-
-static void TwalkGetNames(const void *data, const VISIT which, const int depth)
-{
-    if (which != postorder && which != leaf)
-        return;
-    (void) depth;
-
-    const variable_t *var = *(const variable_t **)data;
-    DECL_ARRAY(char *) *names = twalk_ctx;
-    char *dup = strdup(var->psz_name);
-    if (dup != NULL)
-        ARRAY_APPEND(*names, dup);
-}
-
 char **var_GetAllNames(vlc_object_t *obj)
 {
     vlc_object_internals_t *priv = vlc_internals(obj);
@@ -1159,9 +1213,15 @@ char **var_GetAllNames(vlc_object_t *obj)
     DECL_ARRAY(char *) names;
     ARRAY_INIT(names);
 
-    twalk_ctx = &names;
     vlc_mutex_lock(&priv->var_lock);
-    twalk(priv->var_root, TwalkGetNames);
+    for (size_t i = 0; i < priv->var_table_size; i++)
+        for (const variable_t *var = priv->var_table[i]; var != NULL;
+             var = var->next)
+        {
+            char *dup = strdup(var->psz_name);
+            if (dup != NULL)
+                ARRAY_APPEND(names, dup);
+        }
     vlc_mutex_unlock(&priv->var_lock);
 
     if (names.i_size == 0)
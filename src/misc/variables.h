@@ -38,7 +38,9 @@ struct vlc_object_internals
     const char *typename; /**< Object type human-readable name */
 
     /* Object variables */
-    void           *var_root;
+    struct variable_t **var_table; /**< hash table, by name */
+    size_t          var_table_size; /**< power of two, or zero */
+    size_t          var_count;
     vlc_mutex_t     var_lock;
 
     /* Object resources */
@@ -108,25 +108,29 @@ vlc_plugin_t *vlc_plugins = NULL;
 static int vlc_module_store(module_t *mod)
 {
     const char *name = module_get_capability(mod);
-    vlc_modcap_t *cap = malloc(sizeof (*cap));
-    if (unlikely(cap == NULL))
-        return -1;
+    vlc_modcap_t key = { .name = (char *)name }, *cap;
 
-    cap->name = strdup(name);
-    cap->modv = NULL;
-    cap->modc = 0;
+    /* Most modules share their capability with an earlier one */
+    void **cp = tfind(&key, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp != NULL)
+        cap = *cp;
+    else
+    {
+        cap = malloc(sizeof (*cap));
+        if (unlikely(cap == NULL))
+            return -1;
 
-    if (unlikely(cap->name == NULL))
-        goto error;
+        cap->name = strdup(name);
+        cap->modv = NULL;
+        cap->modc = 0;
 
-    void **cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
-    if (unlikely(cp == NULL))
-        goto error;
+        if (unlikely(cap->name == NULL))
+            goto error;
 
-    if (*cp != cap)
-    {
-        vlc_modcap_free(cap);
-        cap = *cp;
+        cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
+        if (unlikely(cp == NULL))
+            goto error;
+        assert(*cp == cap);
     }
 
     module_t **modv = realloc(cap->modv, sizeof (*modv) * (cap->modc + 1));
@@ -806,6 +810,10 @@ void module_LoadPlugins(vlc_object_t *obj)
         config_UnsortConfig ();
         config_SortConfig ();
 
+        /* This is cheap compared to the rest of the bank setup. A sorted
+         * index could not be taken from the plugins cache as is anyway:
+         * static modules and plugins missing from the cache would need to be
+         * merged into it. */
         twalk(modules.caps_tree, vlc_modcap_sort);
     }
     vlc_mutex_unlock (&modules.lock);
@@ -57,7 +57,7 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 37
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
@@ -318,6 +318,22 @@ static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
     LOAD_STRING(module->deactivate_name);
     LOAD_STRING(module->psz_capability);
     LOAD_IMMEDIATE(module->i_score);
+
+    LOAD_IMMEDIATE(module->i_signatures);
+    if (module->i_signatures > MODULE_SIGNATURE_MAX)
+        goto error;
+    if (module->i_signatures > 0)
+    {
+        module->signatures =
+            xmalloc(sizeof (*module->signatures) * module->i_signatures);
+        for (unsigned j = 0; j < module->i_signatures; j++)
+        {
+            LOAD_IMMEDIATE(module->signatures[j].offset);
+            LOAD_STRING(module->signatures[j].magic);
+            if (module->signatures[j].magic == NULL)
+                goto error;
+        }
+    }
     return 0;
 error:
     return -1;
@@ -443,7 +459,7 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return NULL;
     }
 
-    vlc_plugin_t *cache = NULL;
+    vlc_plugin_t *cache = NULL, **tailp = &cache;
 
     while (file->i_buffer > 0)
     {
@@ -459,9 +475,12 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
             goto error;
         }
 
-        plugin->next = cache;
-        cache = plugin;
+        /* Keep the saving order, which is normally also the order of the
+         * directory scan, so that vlc_cache_lookup() finds plug-ins early. */
+        *tailp = plugin;
+        tailp = &plugin->next;
     }
+    *tailp = NULL;
 
     file->p_next = *backingp;
     *backingp = file;
@@ -591,6 +610,13 @@ static int CacheSaveModule(FILE *file, const module_t *module)
     SAVE_STRING(module->deactivate_name);
     SAVE_STRING(module->psz_capability);
     SAVE_IMMEDIATE(module->i_score);
+    SAVE_IMMEDIATE(module->i_signatures);
+
+    for (size_t j = 0; j < module->i_signatures; j++)
+    {
+        SAVE_IMMEDIATE(module->signatures[j].offset);
+        SAVE_STRING(module->signatures[j].magic);
+    }
     return 0;
 error:
     return -1;
@@ -70,6 +70,8 @@ module_t *vlc_module_create(vlc_plugin_t *plugin)
     module->i_shortcuts = 0;
     module->psz_capability = NULL;
     module->i_score = (parent != NULL) ? parent->i_score : 1;
+    module->i_signatures = 0;
+    module->signatures = NULL;
     module->activate_name = NULL;
     module->deactivate_name = NULL;
     module->pf_activate = NULL;
@@ -87,6 +89,7 @@ void vlc_module_destroy (module_t *module)
         module_t *next = module->next;
 
         free(module->pp_shortcuts);
+        free(module->signatures);
         free(module);
         module = next;
     }
@@ -314,6 +317,28 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             plugin->textdomain = va_arg(ap, const char *);
             break;
 
+        case VLC_MODULE_SIGNATURE:
+        {
+            unsigned index = module->i_signatures;
+            /* The cache loader accept only a small number of signatures */
+            assert(index < MODULE_SIGNATURE_MAX);
+
+            struct vlc_module_signature *tab =
+                realloc(module->signatures, sizeof (*tab) * (index + 1));
+            if (unlikely(tab == NULL))
+            {
+                ret = -1;
+                break;
+            }
+            module->signatures = tab;
+            tab[index].offset = va_arg(ap, unsigned);
+            tab[index].magic = va_arg(ap, const char *);
+            assert(strlen(tab[index].magic) > 0);
+            assert(strlen(tab[index].magic) % 2 == 0);
+            module->i_signatures = index + 1;
+            break;
+        }
+
         case VLC_CONFIG_NAME:
         {
             struct vlc_param *param = tgt;
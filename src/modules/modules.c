@@ -187,6 +187,71 @@ void *vlc_module_map(vlc_logger_t *log, module_t *module)
     return vlc_plugin_Map(log, module->plugin) ? NULL : module->pf_activate;
 }
 
+size_t vlc_module_SignatureSize(const module_t *m)
+{
+    size_t size = 0;
+
+    for (unsigned i = 0; i < m->i_signatures; i++)
+    {
+        const struct vlc_module_signature *sig = &m->signatures[i];
+        size_t end = sig->offset + strlen(sig->magic) / 2;
+
+        if (end > size)
+            size = end;
+    }
+    return size;
+}
+
+static int vlc_hexdigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static bool vlc_module_MatchOne(const struct vlc_module_signature *sig,
+                                const uint8_t *buf, size_t len)
+{
+    const char *magic = sig->magic;
+
+    if (sig->offset > len)
+        return false;
+
+    buf += sig->offset;
+    len -= sig->offset;
+
+    for (; magic[0] != '\0' && magic[1] != '\0'; magic += 2, buf++, len--)
+    {
+        if (len == 0)
+            return false;
+        if (magic[0] == '?' && magic[1] == '?')
+            continue;
+
+        int hi = vlc_hexdigit(magic[0]), lo = vlc_hexdigit(magic[1]);
+        if (hi < 0 || lo < 0)
+            return true; /* Malformed signature: do not filter */
+        if (*buf != ((hi << 4) | lo))
+            return false;
+    }
+    return true;
+}
+
+bool vlc_module_MatchSignature(const module_t *m, const uint8_t *buf,
+                               size_t len)
+{
+    if (m->i_signatures == 0)
+        return true;
+
+    for (unsigned i = 0; i < m->i_signatures; i++)
+        if (vlc_module_MatchOne(&m->signatures[i], buf, len))
+            return true;
+    return false;
+}
+
 /**
  * Finds and instantiates the best module of a certain type.
  * All candidates modules having the specified capability and name will be
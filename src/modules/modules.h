@@ -64,6 +64,16 @@ typedef struct vlc_plugin_t
 extern struct vlc_plugin_t *vlc_plugins;
 
 #define MODULE_SHORTCUT_MAX 20
+#define MODULE_SIGNATURE_MAX 16
+
+/**
+ * Magic bytes expected by a module
+ */
+struct vlc_module_signature
+{
+    unsigned offset; /**< Byte offset of the magic */
+    const char *magic; /**< Hexadecimal digits, "??" matches any byte */
+};
 
 /** Plugin entry point prototype */
 typedef int (*vlc_plugin_cb) (int (*)(void *, void *, int, ...), void *);
@@ -96,6 +106,10 @@ struct module_t
     const char *psz_capability;                              /**< Capability */
     int      i_score;                          /**< Score for the capability */
 
+    /** Accepted data signatures (none if the module must always be probed) */
+    unsigned i_signatures;
+    struct vlc_module_signature *signatures;
+
     /* Callbacks */
     const char *activate_name;
     const char *deactivate_name;
@@ -134,6 +148,27 @@ void *vlc_plugin_Symbol(struct vlc_logger *, vlc_plugin_t *, const char *name);
  */
 size_t module_list_cap(module_t *const **tab, const char *name);
 
+/**
+ * Gets the number of leading data bytes needed to check the signatures of a
+ * module.
+ *
+ * \return the size in bytes, or zero if the module has no signatures
+ */
+size_t vlc_module_SignatureSize(const module_t *);
+
+/**
+ * Checks whether data matches any of the signatures of a module.
+ *
+ * \note Modules without signatures match any data.
+ *
+ * \param buf leading bytes of the data
+ * \param len number of bytes available in the buffer
+ * \retval true if the module may accept the data
+ * \retval false if the module will certainly reject the data
+ */
+bool vlc_module_MatchSignature(const module_t *, const uint8_t *buf,
+                               size_t len);
+
 int vlc_bindtextdomain (const char *);
 
 /* Low-level OS-dependent handler */
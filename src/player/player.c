@@ -34,6 +34,8 @@
 #include <vlc_http.h>
 
 #include "libvlc.h"
+#include "input/es_out.h"
+#include "input/latency.h"
 #include "input/resource.h"
 #include "audio_output/aout_internal.h"
 
@@ -402,6 +404,19 @@ vlc_player_GetTrack(vlc_player_t *player, vlc_es_id_t *id)
     return trackpriv ? &trackpriv->t : NULL;
 }
 
+int
+vlc_player_GetTrackLatency(vlc_player_t *player, vlc_es_id_t *es_id,
+                           struct vlc_es_latency *stats)
+{
+    vlc_player_assert_locked(player);
+
+    struct vlc_latency *latency = vlc_es_id_GetLatency(es_id);
+    if (latency == NULL)
+        return VLC_EGENERIC;
+    vlc_latency_Get(latency, stats);
+    return VLC_SUCCESS;
+}
+
 vout_thread_t *
 vlc_player_GetEsIdVout(vlc_player_t *player, vlc_es_id_t *es_id,
                        enum vlc_vout_order *order)
@@ -1471,6 +1486,13 @@ vlc_player_GetRenderer(vlc_player_t *player)
     return player->renderer;
 }
 
+void
+vlc_player_SetStreamOutput(vlc_player_t *player, const char *chain)
+{
+    vlc_player_assert_locked(player);
+    var_SetString(player, "sout", chain != NULL ? chain : "");
+}
+
 int
 vlc_player_SetAtoBLoop(vlc_player_t *player, enum vlc_player_abloop abloop)
 {
@@ -0,0 +1,762 @@
+/*****************************************************************************
+ * cache.c: persistent preparsing results
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+#include <vlc_block.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_memstream.h>
+#include <vlc_meta.h>
+#include <vlc_url.h>
+
+#include "input/item.h"
+#include "cache.h"
+
+#define CACHE_NAME "preparse.dat"
+/* Change the version whenever the record layout changes */
+#define CACHE_MAGIC "VLC preparse cache 2\n"
+
+#define CACHE_STRING_NONE UINT32_MAX
+
+struct cache_entry
+{
+    int64_t size;
+    int64_t mtime; /**< in nanoseconds */
+    size_t length;
+    unsigned char data[]; /**< Serialized item */
+};
+
+struct input_preparse_cache_t
+{
+    vlc_object_t *owner;
+    vlc_mutex_t lock;
+    vlc_dictionary_t entries; /**< URI to struct cache_entry */
+    bool loaded;
+    bool dirty;
+};
+
+/* Serialization */
+
+static void WriteU32(struct vlc_memstream *ms, uint32_t value)
+{
+    vlc_memstream_write(ms, &value, sizeof (value));
+}
+
+static void WriteI64(struct vlc_memstream *ms, int64_t value)
+{
+    vlc_memstream_write(ms, &value, sizeof (value));
+}
+
+static void WriteString(struct vlc_memstream *ms, const char *str)
+{
+    if (str == NULL)
+    {
+        WriteU32(ms, CACHE_STRING_NONE);
+        return;
+    }
+
+    size_t len = strlen(str);
+    WriteU32(ms, len);
+    vlc_memstream_write(ms, str, len);
+}
+
+struct cache_reader
+{
+    const unsigned char *p;
+    size_t left;
+};
+
+static int ReadRaw(struct cache_reader *rd, void *out, size_t size)
+{
+    if (rd->left < size)
+        return -1;
+    memcpy(out, rd->p, size);
+    rd->p += size;
+    rd->left -= size;
+    return 0;
+}
+
+static int ReadU32(struct cache_reader *rd, uint32_t *value)
+{
+    return ReadRaw(rd, value, sizeof (*value));
+}
+
+static int ReadI64(struct cache_reader *rd, int64_t *value)
+{
+    return ReadRaw(rd, value, sizeof (*value));
+}
+
+static int ReadString(struct cache_reader *rd, char **str)
+{
+    uint32_t len;
+
+    if (ReadU32(rd, &len))
+        return -1;
+    if (len == CACHE_STRING_NONE)
+    {
+        *str = NULL;
+        return 0;
+    }
+    if (rd->left < len)
+        return -1;
+
+    *str = strndup((const char *)rd->p, len);
+    if (unlikely(*str == NULL))
+        return -1;
+    rd->p += len;
+    rd->left -= len;
+    return 0;
+}
+
+static void WriteTrack(struct vlc_memstream *ms, const es_format_t *fmt)
+{
+    WriteU32(ms, fmt->i_cat);
+    WriteU32(ms, fmt->i_codec);
+    WriteU32(ms, fmt->i_original_fourcc);
+    WriteU32(ms, fmt->i_id);
+    WriteU32(ms, fmt->i_profile);
+    WriteU32(ms, fmt->i_level);
+    WriteU32(ms, fmt->i_bitrate);
+    WriteString(ms, fmt->psz_language);
+    WriteString(ms, fmt->psz_description);
+
+    switch (fmt->i_cat)
+    {
+        case VIDEO_ES:
+            WriteU32(ms, fmt->video.i_width);
+            WriteU32(ms, fmt->video.i_height);
+            WriteU32(ms, fmt->video.i_visible_width);
+            WriteU32(ms, fmt->video.i_visible_height);
+            WriteU32(ms, fmt->video.i_sar_num);
+            WriteU32(ms, fmt->video.i_sar_den);
+            WriteU32(ms, fmt->video.i_frame_rate);
+            WriteU32(ms, fmt->video.i_frame_rate_base);
+            WriteU32(ms, fmt->video.orientation);
+            break;
+        case AUDIO_ES:
+            WriteU32(ms, fmt->audio.i_rate);
+            WriteU32(ms, fmt->audio.i_channels);
+            WriteU32(ms, fmt->audio.i_bitspersample);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Reads a track.
+ *
+ * On error, the track is left uninitialized.
+ */
+static int ReadTrack(struct cache_reader *rd, es_format_t *fmt)
+{
+    uint32_t cat, v[9];
+
+    if (ReadU32(rd, &cat)
+     || (cat != UNKNOWN_ES && cat != VIDEO_ES && cat != AUDIO_ES
+      && cat != SPU_ES && cat != DATA_ES))
+        return -1;
+
+    es_format_Init(fmt, cat, 0);
+
+    for (size_t i = 0; i < 6; i++)
+        if (ReadU32(rd, &v[i]))
+            goto error;
+    fmt->i_codec = v[0];
+    fmt->i_original_fourcc = v[1];
+    fmt->i_id = v[2];
+    fmt->i_profile = v[3];
+    fmt->i_level = v[4];
+    fmt->i_bitrate = v[5];
+
+    if (ReadString(rd, &fmt->psz_language)
+     || ReadString(rd, &fmt->psz_description))
+        goto error;
+
+    switch (cat)
+    {
+        case VIDEO_ES:
+            for (size_t i = 0; i < 9; i++)
+                if (ReadU32(rd, &v[i]))
+                    goto error;
+            fmt->video.i_width = v[0];
+            fmt->video.i_height = v[1];
+            fmt->video.i_visible_width = v[2];
+            fmt->video.i_visible_height = v[3];
+            fmt->video.i_sar_num = v[4];
+            fmt->video.i_sar_den = v[5];
+            fmt->video.i_frame_rate = v[6];
+            fmt->video.i_frame_rate_base = v[7];
+            if (v[8] > ORIENT_MAX)
+                goto error;
+            fmt->video.orientation = v[8];
+            break;
+        case AUDIO_ES:
+            for (size_t i = 0; i < 3; i++)
+                if (ReadU32(rd, &v[i]))
+                    goto error;
+            fmt->audio.i_rate = v[0];
+            fmt->audio.i_channels = v[1];
+            fmt->audio.i_bitspersample = v[2];
+            break;
+        default:
+            break;
+    }
+    return 0;
+
+error:
+    es_format_Clean(fmt);
+    return -1;
+}
+
+static void SerializeItem(struct vlc_memstream *ms, input_item_t *item)
+{
+    vlc_mutex_lock(&item->lock);
+    WriteI64(ms, item->i_duration);
+
+    uint32_t count = 0;
+    for (int i = 0; i < VLC_META_TYPE_COUNT; i++)
+        if (item->p_meta != NULL && vlc_meta_Get(item->p_meta, i) != NULL)
+            count++;
+    WriteU32(ms, count);
+    for (int i = 0; i < VLC_META_TYPE_COUNT && count > 0; i++)
+    {
+        const char *value = vlc_meta_Get(item->p_meta, i);
+        if (value == NULL)
+            continue;
+        WriteU32(ms, i);
+        WriteString(ms, value);
+    }
+
+    char **names = NULL;
+    count = 0;
+    if (item->p_meta != NULL)
+    {
+        names = vlc_meta_CopyExtraNames(item->p_meta);
+        if (names != NULL)
+            while (names[count] != NULL)
+                count++;
+    }
+    WriteU32(ms, count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        WriteString(ms, names[i]);
+        WriteString(ms, vlc_meta_GetExtra(item->p_meta, names[i]));
+        free(names[i]);
+    }
+    free(names);
+
+    WriteU32(ms, item->i_es);
+    for (int i = 0; i < item->i_es; i++)
+        WriteTrack(ms, item->es[i]);
+    vlc_mutex_unlock(&item->lock);
+}
+
+struct cached_item
+{
+    vlc_tick_t duration;
+    vlc_meta_t *meta;
+    size_t track_count;
+    es_format_t *tracks;
+};
+
+static void CachedItemClean(struct cached_item *cached)
+{
+    if (cached->meta != NULL)
+        vlc_meta_Delete(cached->meta);
+    for (size_t i = 0; i < cached->track_count; i++)
+        es_format_Clean(&cached->tracks[i]);
+    free(cached->tracks);
+}
+
+static int DeserializeItem(struct cache_reader *rd, struct cached_item *cached)
+{
+    int64_t duration;
+    uint32_t count;
+
+    cached->meta = vlc_meta_New();
+    cached->track_count = 0;
+    cached->tracks = NULL;
+    if (unlikely(cached->meta == NULL))
+        return -1;
+
+    if (ReadI64(rd, &duration))
+        return -1;
+    cached->duration = duration;
+
+    if (ReadU32(rd, &count))
+        return -1;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t type;
+        char *value;
+
+        if (ReadU32(rd, &type) || type >= VLC_META_TYPE_COUNT
+         || ReadString(rd, &value))
+            return -1;
+        vlc_meta_Set(cached->meta, type, value);
+        free(value);
+    }
+
+    if (ReadU32(rd, &count))
+        return -1;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        char *name, *value;
+
+        if (ReadString(rd, &name))
+            return -1;
+        if (ReadString(rd, &value))
+        {
+            free(name);
+            return -1;
+        }
+        if (name != NULL)
+            vlc_meta_AddExtra(cached->meta, name, value);
+        free(name);
+        free(value);
+    }
+
+    if (ReadU32(rd, &count) || count > rd->left)
+        return -1;
+    if (count > 0)
+    {
+        cached->tracks = vlc_alloc(count, sizeof (*cached->tracks));
+        if (unlikely(cached->tracks == NULL))
+            return -1;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        /* Only count the initialized tracks, for CachedItemClean() */
+        if (ReadTrack(rd, &cached->tracks[i]))
+            return -1;
+        cached->track_count++;
+    }
+    return rd->left == 0 ? 0 : -1;
+}
+
+/* Storage */
+
+static char *CachePath(void)
+{
+    char *dir = config_GetUserDir(VLC_CACHE_DIR), *path;
+
+    if (dir == NULL)
+        return NULL;
+    if (asprintf(&path, "%s" DIR_SEP CACHE_NAME, dir) == -1)
+        path = NULL;
+    free(dir);
+    return path;
+}
+
+static void EntryFree(void *data, void *obj)
+{
+    free(data);
+    (void) obj;
+}
+
+static struct cache_entry *EntryNew(int64_t size, int64_t mtime,
+                                    const void *data, size_t length)
+{
+    struct cache_entry *entry = malloc(sizeof (*entry) + length);
+    if (unlikely(entry == NULL))
+        return NULL;
+
+    entry->size = size;
+    entry->mtime = mtime;
+    entry->length = length;
+    memcpy(entry->data, data, length);
+    return entry;
+}
+
+static void CacheInsert(input_preparse_cache_t *cache, const char *uri,
+                        struct cache_entry *entry)
+{
+    vlc_dictionary_remove_value_for_key(&cache->entries, uri, EntryFree,
+                                        NULL);
+    vlc_dictionary_insert(&cache->entries, uri, entry);
+}
+
+/**
+ * Gets the modification time of a file, in nanoseconds where the system
+ * provides them, as a file can change twice within a second.
+ */
+static int64_t StatMTime(const struct stat *st)
+{
+#if defined (__APPLE__)
+    return st->st_mtimespec.tv_sec * INT64_C(1000000000)
+         + st->st_mtimespec.tv_nsec;
+#elif defined (_WIN32) || defined (__OS2__)
+    return st->st_mtime * INT64_C(1000000000);
+#else
+    return st->st_mtim.tv_sec * INT64_C(1000000000) + st->st_mtim.tv_nsec;
+#endif
+}
+
+/**
+ * Checks whether the file of an entry still exists.
+ */
+static bool EntryFileExists(const char *uri)
+{
+    char *path = vlc_uri2path(uri);
+    if (path == NULL)
+        return false;
+
+    struct stat st;
+    bool exists = vlc_stat(path, &st) == 0 || errno != ENOENT;
+    free(path);
+    return exists;
+}
+
+static void CacheLoad(input_preparse_cache_t *cache)
+{
+    vlc_mutex_assert(&cache->lock);
+
+    if (cache->loaded)
+        return;
+    cache->loaded = true;
+
+    char *path = CachePath();
+    if (path == NULL)
+        return;
+
+    block_t *file = block_FilePath(path, false);
+    if (file == NULL)
+    {
+        if (errno != ENOENT)
+            msg_Warn(cache->owner, "cannot read %s: %s", path,
+                     vlc_strerror_c(errno));
+        free(path);
+        return;
+    }
+
+    struct cache_reader rd = { file->p_buffer, file->i_buffer };
+    char magic[sizeof (CACHE_MAGIC) - 1];
+    size_t count = 0, removed = 0;
+
+    if (ReadRaw(&rd, magic, sizeof (magic))
+     || memcmp(magic, CACHE_MAGIC, sizeof (magic)))
+    {
+        msg_Warn(cache->owner, "ignoring invalid preparse cache %s", path);
+        goto out;
+    }
+
+    while (rd.left > 0)
+    {
+        char *uri;
+        int64_t size, mtime;
+        uint32_t length;
+
+        if (ReadString(&rd, &uri))
+            goto corrupted;
+        if (uri == NULL || ReadI64(&rd, &size) || ReadI64(&rd, &mtime)
+         || ReadU32(&rd, &length) || rd.left < length)
+        {
+            free(uri);
+            goto corrupted;
+        }
+
+        /* Drop the entries of deleted files, so that the cache does not
+         * grow forever */
+        if (!EntryFileExists(uri))
+        {
+            cache->dirty = true;
+            removed++;
+        }
+        else
+        {
+            struct cache_entry *entry = EntryNew(size, mtime, rd.p, length);
+            if (likely(entry != NULL))
+            {
+                CacheInsert(cache, uri, entry);
+                count++;
+            }
+        }
+        free(uri);
+        rd.p += length;
+        rd.left -= length;
+    }
+
+    msg_Dbg(cache->owner, "loaded %zu preparsed item(s) from %s, "
+            "%zu of deleted file(s) dropped", count, path, removed);
+    goto out;
+
+corrupted:
+    msg_Warn(cache->owner, "preparse cache %s is truncated", path);
+out:
+    block_Release(file);
+    free(path);
+}
+
+static int CacheWrite(input_preparse_cache_t *cache, FILE *stream)
+{
+    if (fputs(CACHE_MAGIC, stream) == EOF)
+        return -1;
+
+    for (int i = 0; i < cache->entries.i_size; i++)
+        for (const vlc_dictionary_entry_t *e = cache->entries.p_entries[i];
+             e != NULL; e = e->p_next)
+        {
+            const struct cache_entry *entry = e->p_value;
+            struct vlc_memstream ms;
+
+            vlc_memstream_open(&ms);
+            WriteString(&ms, e->psz_key);
+            WriteI64(&ms, entry->size);
+            WriteI64(&ms, entry->mtime);
+            WriteU32(&ms, entry->length);
+            if (vlc_memstream_close(&ms))
+                return -1;
+
+            bool ok = fwrite(ms.ptr, ms.length, 1, stream) == 1
+                   && (entry->length == 0
+                    || fwrite(entry->data, entry->length, 1, stream) == 1);
+            free(ms.ptr);
+            if (!ok)
+                return -1;
+        }
+
+    return fflush(stream) ? -1 : 0;
+}
+
+static void CacheSave(input_preparse_cache_t *cache)
+{
+    char *path = CachePath(), *tmppath;
+    if (path == NULL)
+        return;
+    if (asprintf(&tmppath, "%s.%lu", path, (unsigned long)getpid()) == -1)
+    {
+        free(path);
+        return;
+    }
+
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (dir != NULL)
+    {
+        vlc_mkdir(dir, 0700);
+        free(dir);
+    }
+
+    FILE *stream = vlc_fopen(tmppath, "wb");
+    if (stream == NULL)
+    {
+        msg_Warn(cache->owner, "cannot create %s: %s", tmppath,
+                 vlc_strerror_c(errno));
+        goto out;
+    }
+
+    if (CacheWrite(cache, stream))
+    {
+        msg_Warn(cache->owner, "cannot write %s: %s", tmppath,
+                 vlc_strerror_c(errno));
+        fclose(stream);
+        vlc_unlink(tmppath);
+        goto out;
+    }
+
+#if !defined( _WIN32 ) && !defined( __OS2__ )
+    vlc_rename(tmppath, path); /* atomically replace old cache */
+    fclose(stream);
+#else
+    vlc_unlink(path);
+    fclose(stream);
+    vlc_rename(tmppath, path);
+#endif
+out:
+    free(tmppath);
+    free(path);
+}
+
+/* Public functions */
+
+/**
+ * Gets the local path and identity of an item file.
+ */
+static char *ItemFile(input_item_t *item, struct stat *st)
+{
+    char *uri = NULL;
+
+    vlc_mutex_lock(&item->lock);
+    if (item->i_type == ITEM_TYPE_FILE && !item->b_net
+     && item->psz_uri != NULL)
+        uri = strdup(item->psz_uri);
+    vlc_mutex_unlock(&item->lock);
+
+    if (uri == NULL)
+        return NULL;
+
+    char *path = vlc_uri2path(uri);
+    if (path == NULL || vlc_stat(path, st) || !S_ISREG(st->st_mode))
+    {
+        free(path);
+        free(uri);
+        return NULL;
+    }
+    free(path);
+    return uri;
+}
+
+input_preparse_cache_t *input_preparse_cache_New(vlc_object_t *owner)
+{
+    if (!var_InheritBool(owner, "preparse-cache"))
+        return NULL;
+
+    input_preparse_cache_t *cache = malloc(sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    cache->owner = owner;
+    vlc_mutex_init(&cache->lock);
+    vlc_dictionary_init(&cache->entries, 0);
+    cache->loaded = false;
+    cache->dirty = false;
+    return cache;
+}
+
+bool input_preparse_cache_Lookup(input_preparse_cache_t *cache,
+                                 input_item_t *item)
+{
+    struct stat st;
+    char *uri = ItemFile(item, &st);
+    if (uri == NULL)
+        return false;
+
+    struct cached_item cached = { .meta = NULL };
+    bool found = false;
+
+    vlc_mutex_lock(&cache->lock);
+    CacheLoad(cache);
+
+    struct cache_entry *entry =
+        vlc_dictionary_value_for_key(&cache->entries, uri);
+    if (entry != kVLCDictionaryNotFound)
+    {
+        struct cache_reader rd = { entry->data, entry->length };
+
+        if (entry->size == (int64_t)st.st_size
+         && entry->mtime == StatMTime(&st)
+         && DeserializeItem(&rd, &cached) == 0)
+            found = true;
+        else
+        {   /* The file changed (or the entry is broken) */
+            CachedItemClean(&cached);
+            vlc_dictionary_remove_value_for_key(&cache->entries, uri,
+                                                EntryFree, NULL);
+            cache->dirty = true;
+        }
+    }
+    vlc_mutex_unlock(&cache->lock);
+    free(uri);
+
+    if (!found)
+        return false;
+
+    input_item_SetDuration(item, cached.duration);
+    for (int i = 0; i < VLC_META_TYPE_COUNT; i++)
+    {
+        const char *value = vlc_meta_Get(cached.meta, i);
+        if (value != NULL)
+            input_item_SetMeta(item, i, value);
+    }
+
+    char **names = vlc_meta_CopyExtraNames(cached.meta);
+    if (names != NULL)
+    {
+        vlc_mutex_lock(&item->lock);
+        if (item->p_meta == NULL)
+            item->p_meta = vlc_meta_New();
+        for (size_t i = 0; names[i] != NULL; i++)
+        {
+            if (likely(item->p_meta != NULL))
+                vlc_meta_AddExtra(item->p_meta, names[i],
+                                  vlc_meta_GetExtra(cached.meta, names[i]));
+            free(names[i]);
+        }
+        vlc_mutex_unlock(&item->lock);
+        free(names);
+    }
+
+    for (size_t i = 0; i < cached.track_count; i++)
+        input_item_UpdateTracksInfo(item, &cached.tracks[i]);
+
+    CachedItemClean(&cached);
+    return true;
+}
+
+void input_preparse_cache_Store(input_preparse_cache_t *cache,
+                                input_item_t *item)
+{
+    /* Playlists and directories have no tracks, and must be parsed again
+     * to get their sub-items */
+    vlc_mutex_lock(&item->lock);
+    bool has_tracks = item->i_es > 0;
+    vlc_mutex_unlock(&item->lock);
+    if (!has_tracks)
+        return;
+
+    struct stat st;
+    char *uri = ItemFile(item, &st);
+    if (uri == NULL)
+        return;
+
+    struct vlc_memstream ms;
+    vlc_memstream_open(&ms);
+    SerializeItem(&ms, item);
+    if (vlc_memstream_close(&ms))
+    {
+        free(uri);
+        return;
+    }
+
+    struct cache_entry *entry = EntryNew(st.st_size, StatMTime(&st),
+                                         ms.ptr, ms.length);
+    free(ms.ptr);
+
+    if (likely(entry != NULL))
+    {
+        vlc_mutex_lock(&cache->lock);
+        CacheLoad(cache);
+        CacheInsert(cache, uri, entry);
+        cache->dirty = true;
+        vlc_mutex_unlock(&cache->lock);
+    }
+    free(uri);
+}
+
+void input_preparse_cache_Delete(input_preparse_cache_t *cache)
+{
+    if (cache->dirty)
+        CacheSave(cache);
+
+    vlc_dictionary_clear(&cache->entries, EntryFree, NULL);
+    free(cache);
+}
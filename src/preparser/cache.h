@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * cache.h: persistent preparsing results
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSE_CACHE_H
+#define _INPUT_PREPARSE_CACHE_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Preparse cache opaque structure.
+ *
+ * The preparse cache stores the duration, tracks and meta data of local
+ * files, keyed by URI, file size and modification time. It is loaded from
+ * the user cache directory on first use, and saved back on deletion.
+ */
+typedef struct input_preparse_cache_t input_preparse_cache_t;
+
+/**
+ * This function creates the preparse cache, if enabled.
+ *
+ * @return the cache, or NULL if the "preparse-cache" option is not set
+ */
+input_preparse_cache_t *input_preparse_cache_New( vlc_object_t * );
+
+/**
+ * This function applies the cached preparsing results to an item.
+ *
+ * Entries of files that changed since they were stored are dropped.
+ *
+ * @retval true if the item was found and is up to date
+ * @retval false otherwise (the item is left untouched)
+ */
+bool input_preparse_cache_Lookup( input_preparse_cache_t *, input_item_t * );
+
+/**
+ * This function stores the preparsing results of an item.
+ *
+ * Only local files with tracks are stored, other items are ignored.
+ */
+void input_preparse_cache_Store( input_preparse_cache_t *, input_item_t * );
+
+/**
+ * This function destroys the preparse cache, saving it if it was modified.
+ */
+void input_preparse_cache_Delete( input_preparse_cache_t * );
+
+#endif
@@ -0,0 +1,300 @@
+/*****************************************************************************
+ * light.c: preparsing without input thread
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_input.h>
+#include <vlc_list.h>
+#include <vlc_meta.h>
+#include <vlc_modules.h>
+
+#include "input/demux.h"
+#include "input/item.h"
+#include "input/stream.h"
+#include "light.h"
+
+struct es_out_id_t
+{
+    es_format_t fmt;
+    struct vlc_list node;
+};
+
+struct light_out
+{
+    es_out_t out;
+    struct vlc_list es; /**< list of es_out_id_t */
+    vlc_meta_t *meta;
+    bool full_needed; /**< set if the demux posted sub-items */
+};
+
+static es_out_id_t *LightOutAdd(es_out_t *out, input_source_t *in,
+                                const es_format_t *fmt)
+{
+    struct light_out *sys = container_of(out, struct light_out, out);
+    VLC_UNUSED(in);
+
+    es_out_id_t *es = malloc(sizeof (*es));
+    if (unlikely(es == NULL))
+        return NULL;
+
+    if (es_format_Copy(&es->fmt, fmt) != VLC_SUCCESS)
+    {
+        free(es);
+        return NULL;
+    }
+    vlc_list_append(&es->node, &sys->es);
+    return es;
+}
+
+static int LightOutSend(es_out_t *out, es_out_id_t *es, block_t *block)
+{
+    VLC_UNUSED(out); VLC_UNUSED(es);
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void LightOutDel(es_out_t *out, es_out_id_t *es)
+{
+    VLC_UNUSED(out);
+    vlc_list_remove(&es->node);
+    es_format_Clean(&es->fmt);
+    free(es);
+}
+
+static int LightOutControl(es_out_t *out, input_source_t *in, int query,
+                           va_list args)
+{
+    struct light_out *sys = container_of(out, struct light_out, out);
+    VLC_UNUSED(in);
+
+    switch (query)
+    {
+        case ES_OUT_SET_ES_FMT:
+        {
+            es_out_id_t *es = va_arg(args, es_out_id_t *);
+            const es_format_t *fmt = va_arg(args, const es_format_t *);
+            es_format_t copy;
+
+            if (es_format_Copy(&copy, fmt) != VLC_SUCCESS)
+                return VLC_EGENERIC;
+            es_format_Clean(&es->fmt);
+            es->fmt = copy;
+            return VLC_SUCCESS;
+        }
+
+        case ES_OUT_GET_ES_STATE:
+            va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = false;
+            return VLC_SUCCESS;
+
+        case ES_OUT_GET_EMPTY:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+
+        case ES_OUT_SET_META:
+            vlc_meta_Merge(sys->meta, va_arg(args, const vlc_meta_t *));
+            return VLC_SUCCESS;
+
+        case ES_OUT_POST_SUBNODE:
+            input_item_node_Delete(va_arg(args, input_item_node_t *));
+            sys->full_needed = true;
+            return VLC_SUCCESS;
+
+        default:
+            /* Nothing is decoded nor timed */
+            return VLC_EGENERIC;
+    }
+}
+
+static void LightOutDestroy(es_out_t *out)
+{
+    struct light_out *sys = container_of(out, struct light_out, out);
+
+    es_out_id_t *es;
+    vlc_list_foreach(es, &sys->es, node)
+        LightOutDel(out, es);
+}
+
+static const struct es_out_callbacks light_out_cbs =
+{
+    .add = LightOutAdd,
+    .send = LightOutSend,
+    .del = LightOutDel,
+    .control = LightOutControl,
+    .destroy = LightOutDestroy,
+};
+
+static char *ItemLocalURI(input_item_t *item)
+{
+    char *uri = NULL;
+
+    vlc_mutex_lock(&item->lock);
+    /* Options and anchors may change how the input opens the item */
+    if (item->i_type == ITEM_TYPE_FILE && !item->b_net
+     && item->i_options == 0 && item->psz_uri != NULL
+     && strncasecmp(item->psz_uri, "file://", 7) == 0
+     && strchr(item->psz_uri, '#') == NULL)
+        uri = strdup(item->psz_uri);
+    vlc_mutex_unlock(&item->lock);
+    return uri;
+}
+
+static demux_t *DemuxNew(vlc_object_t *obj, es_out_t *out, const char *uri)
+{
+    stream_t *stream = stream_AccessNew(obj, NULL, out, true, uri);
+    if (stream == NULL)
+        return NULL;
+
+    /* Access-demuxes are left to the input */
+    if (stream->pf_read == NULL && stream->pf_block == NULL
+     && stream->pf_readdir == NULL)
+    {
+        vlc_stream_Delete(stream);
+        return NULL;
+    }
+
+    stream = stream_FilterAutoNew(stream);
+
+    char *filters = var_InheritString(obj, "stream-filter");
+    if (filters != NULL)
+    {
+        stream = stream_FilterChainNew(stream, filters);
+        free(filters);
+    }
+
+    char *name = var_InheritString(obj, "demux");
+    demux_t *demux = demux_NewAdvanced(obj, NULL,
+                                       name != NULL ? name : "any", uri,
+                                       stream, out, true);
+    free(name);
+
+    if (demux == NULL)
+        vlc_stream_Delete(stream);
+    return demux;
+}
+
+static void ReadMeta(vlc_object_t *obj, demux_t *demux, input_item_t *item,
+                     vlc_meta_t *meta)
+{
+    bool has_meta = demux_Control(demux, DEMUX_GET_META, meta) == VLC_SUCCESS;
+    bool has_unsupported;
+
+    if (demux_Control(demux, DEMUX_HAS_UNSUPPORTED_META, &has_unsupported))
+        has_unsupported = true;
+    if (has_meta && !has_unsupported)
+        return;
+
+    /* Same fallback as the input thread */
+    demux_meta_t *demux_meta = vlc_custom_create(obj, sizeof (*demux_meta),
+                                                 "demux meta");
+    if (unlikely(demux_meta == NULL))
+        return;
+    demux_meta->p_item = item;
+
+    module_t *reader = module_need(demux_meta, "meta reader", NULL, false);
+    if (reader != NULL)
+    {
+        if (demux_meta->p_meta != NULL)
+        {
+            vlc_meta_Merge(meta, demux_meta->p_meta);
+            vlc_meta_Delete(demux_meta->p_meta);
+        }
+        for (int i = 0; i < demux_meta->i_attachments; i++)
+            vlc_input_attachment_Release(demux_meta->attachments[i]);
+        free(demux_meta->attachments);
+        module_unneed(demux_meta, reader);
+    }
+    vlc_object_delete(demux_meta);
+}
+
+int input_preparse_light_Parse(vlc_object_t *obj, input_item_t *item)
+{
+    char *uri = ItemLocalURI(item);
+    if (uri == NULL)
+        return VLC_ENOTSUP;
+
+    struct light_out sys = {
+        .out = { .cbs = &light_out_cbs },
+        .meta = vlc_meta_New(),
+        .full_needed = false,
+    };
+    vlc_list_init(&sys.es);
+
+    if (unlikely(sys.meta == NULL))
+    {
+        free(uri);
+        return VLC_ENOMEM;
+    }
+
+    int ret = VLC_EGENERIC;
+    demux_t *demux = DemuxNew(obj, &sys.out, uri);
+    if (demux == NULL)
+        goto out;
+
+    /* Directories and playlists are left to the input */
+    ret = VLC_ENOTSUP;
+    if (demux->pf_readdir != NULL || sys.full_needed)
+        goto out;
+
+    vlc_tick_t length;
+    if (demux_Control(demux, DEMUX_GET_LENGTH, &length))
+        length = VLC_TICK_INVALID;
+
+    ReadMeta(obj, demux, item, sys.meta);
+
+    /* Cover art embedded in the file requires the input attachments */
+    const char *art = vlc_meta_Get(sys.meta, vlc_meta_ArtworkURL);
+    if (sys.full_needed
+     || (art != NULL && strncmp(art, "attachment://", 13) == 0))
+        goto out;
+
+    es_out_id_t *es;
+    vlc_list_foreach(es, &sys.es, node)
+        input_item_UpdateTracksInfo(item, &es->fmt);
+
+    if (length != VLC_TICK_INVALID)
+        input_item_SetDuration(item, length);
+
+    vlc_mutex_lock(&item->lock);
+    vlc_meta_Merge(item->p_meta, sys.meta);
+    vlc_mutex_unlock(&item->lock);
+
+    const char *title = vlc_meta_Get(sys.meta, vlc_meta_Title);
+    if (title != NULL)
+        input_item_SetName(item, title);
+
+    ret = VLC_SUCCESS;
+out:
+    if (demux != NULL)
+        demux_Delete(demux);
+    es_out_Delete(&sys.out);
+    vlc_meta_Delete(sys.meta);
+    free(uri);
+    return ret;
+}
@@ -0,0 +1,44 @@
+/*****************************************************************************
+ * light.h: preparsing without input thread
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSE_LIGHT_H
+#define _INPUT_PREPARSE_LIGHT_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * This function preparses a local file in the calling thread.
+ *
+ * The stream and demux are opened with a minimal ES output that only records
+ * the track formats, then the length and meta data are queried from the
+ * demux, and everything is closed again. No input thread, ES output, clock
+ * or decoder is created.
+ *
+ * The function can be interrupted through the interrupt context of the
+ * calling thread.
+ *
+ * @retval VLC_SUCCESS if the item was preparsed
+ * @retval VLC_ENOTSUP if the item requires a full preparsing (not a plain
+ *         local file, sub-items, attachments...), the item is left untouched
+ * @retval VLC_EGENERIC if the item could not be opened
+ */
+int input_preparse_light_Parse( vlc_object_t *, input_item_t * );
+
+#endif
@@ -25,18 +25,24 @@
 #include <vlc_common.h>
 #include <vlc_atomic.h>
 #include <vlc_executor.h>
+#include <vlc_interrupt.h>
 
 #include "input/input_interface.h"
 #include "input/input_internal.h"
+#include "misc/interrupt.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "cache.h"
+#include "light.h"
 
 struct input_preparser_t
 {
     vlc_object_t* owner;
     input_fetcher_t* fetcher;
+    input_preparse_cache_t *cache;
     vlc_executor_t *executor;
     vlc_tick_t default_timeout;
+    bool light;
     atomic_bool deactivated;
 
     vlc_mutex_t lock;
@@ -54,6 +60,8 @@ struct task
     vlc_tick_t timeout;
 
     input_item_parser_id_t *parser;
+    bool subtree_added;
+    vlc_interrupt_t interrupt; /**< for light parsing */
 
     vlc_sem_t preparse_ended;
     vlc_sem_t fetch_ended;
@@ -90,6 +98,8 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
     input_item_Hold(item);
 
     task->parser = NULL;
+    task->subtree_added = false;
+    vlc_interrupt_init(&task->interrupt);
     vlc_sem_init(&task->preparse_ended, 0);
     vlc_sem_init(&task->fetch_ended, 0);
     atomic_init(&task->preparse_status, ITEM_PREPARSE_SKIPPED);
@@ -105,6 +115,7 @@ static void
 TaskDelete(struct task *task)
 {
     input_item_Release(task->item);
+    vlc_interrupt_deinit(&task->interrupt);
     free(task);
 }
 
@@ -161,6 +172,7 @@ OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     VLC_UNUSED(item);
     struct task *task = task_;
 
+    task->subtree_added = true;
     if (task->cbs && task->cbs->on_subtree_added)
         task->cbs->on_subtree_added(task->item, subtree, task->userdata);
 }
@@ -212,6 +224,44 @@ Parse(struct task *task, vlc_tick_t deadline)
     input_item_parser_id_Release(task->parser);
 }
 
+static void
+OnLightTimeout(void *task_)
+{
+    struct task *task = task_;
+
+    atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_TIMEOUT,
+                          memory_order_relaxed);
+    atomic_store(&task->interrupted, true);
+    vlc_interrupt_kill(&task->interrupt);
+}
+
+static int
+ParseLight(struct task *task, vlc_tick_t deadline)
+{
+    vlc_timer_t timer;
+    bool timed = deadline != VLC_TICK_INVALID;
+
+    if (timed)
+    {
+        if (vlc_timer_create(&timer, OnLightTimeout, task))
+            return VLC_ENOMEM;
+        vlc_timer_schedule(timer, true, deadline, VLC_TIMER_FIRE_ONCE);
+    }
+
+    /* Parse in the executor thread, interruptible by Interrupt() */
+    vlc_interrupt_t *oldint = vlc_interrupt_set(&task->interrupt);
+    int ret = input_preparse_light_Parse(task->preparser->owner, task->item);
+    vlc_interrupt_set(oldint);
+
+    if (timed)
+        vlc_timer_destroy(timer);
+
+    if (ret == VLC_SUCCESS && !atomic_load(&task->interrupted))
+        atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_DONE,
+                              memory_order_relaxed);
+    return ret;
+}
+
 static void
 Fetch(struct task *task)
 {
@@ -241,10 +291,31 @@ RunnableRun(void *userdata)
     if (atomic_load(&task->interrupted))
         goto end;
 
-    Parse(task, deadline);
+    input_preparse_cache_t *cache = task->preparser->cache;
 
-    if (atomic_load(&task->interrupted))
-        goto end;
+    if (cache != NULL && input_preparse_cache_Lookup(cache, task->item))
+        atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_DONE,
+                              memory_order_relaxed);
+    else
+    {
+        /* Fall back to the input thread for anything the light path cannot
+         * handle, or failed to open */
+        if (!task->preparser->light || ParseLight(task, deadline))
+        {
+            if (atomic_load(&task->interrupted))
+                goto end;
+            Parse(task, deadline);
+        }
+
+        if (atomic_load(&task->interrupted))
+            goto end;
+
+        /* Items with sub-items must always be parsed to expand them */
+        if (cache != NULL && !task->subtree_added
+         && atomic_load_explicit(&task->preparse_status,
+                                 memory_order_relaxed) == ITEM_PREPARSE_DONE)
+            input_preparse_cache_Store(cache, task->item);
+    }
 
     Fetch(task);
 
@@ -264,6 +335,7 @@ static void
 Interrupt(struct task *task)
 {
     atomic_store(&task->interrupted, true);
+    vlc_interrupt_kill(&task->interrupt);
 
     /* Wake up the preparser cond_wait */
     atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_TIMEOUT,
@@ -293,8 +365,10 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if (preparser->default_timeout < 0)
         preparser->default_timeout = 0;
 
+    preparser->light = var_InheritBool(parent, "preparse-light");
     preparser->owner = parent;
     preparser->fetcher = input_fetcher_New( parent );
+    preparser->cache = input_preparse_cache_New( parent );
     atomic_init( &preparser->deactivated, false );
 
     vlc_mutex_init(&preparser->lock);
@@ -349,6 +423,29 @@ int input_preparser_Push( input_preparser_t *preparser,
     return VLC_SUCCESS;
 }
 
+size_t input_preparser_Warmup( input_preparser_t *preparser,
+                               input_item_t *const *items, size_t count )
+{
+    size_t hits = 0;
+
+    if( preparser->cache == NULL )
+        return 0;
+
+    for( size_t i = 0; i < count; i++ )
+    {
+        input_item_t *item = items[i];
+
+        if( input_item_IsPreparsed( item ) )
+            continue;
+        if( input_preparse_cache_Lookup( preparser->cache, item ) )
+        {
+            input_item_SetPreparsed( item, true );
+            hits++;
+        }
+    }
+    return hits;
+}
+
 void input_preparser_fetcher_Push( input_preparser_t *preparser,
     input_item_t *item, input_item_meta_request_option_t options,
     const input_fetcher_callbacks_t *cbs, void *cbs_userdata )
@@ -399,6 +496,8 @@ void input_preparser_Delete( input_preparser_t *preparser )
 
     if( preparser->fetcher )
         input_fetcher_Delete( preparser->fetcher );
+    if( preparser->cache )
+        input_preparse_cache_Delete( preparser->cache );
 
     free( preparser );
 }
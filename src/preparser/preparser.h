@@ -60,6 +60,18 @@ int input_preparser_Push( input_preparser_t *, input_item_t *,
                            void *cbs_userdata,
                            int timeout, void *id );
 
+/**
+ * This function applies cached preparsing results to a batch of items.
+ *
+ * Items found in the preparse cache are marked as preparsed, so that they
+ * need not be pushed. This is a no-op if the preparse cache is disabled.
+ * This blocks on file system accesses, to validate the cache entries.
+ *
+ * @return the number of items found in the cache
+ */
+size_t input_preparser_Warmup( input_preparser_t *,
+                               input_item_t *const *items, size_t count );
+
 void input_preparser_fetcher_Push( input_preparser_t *, input_item_t *,
                                    input_item_meta_request_option_t,
                                    const input_fetcher_callbacks_t *cbs,
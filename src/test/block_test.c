@@ -86,11 +86,128 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Share (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = VLC_TICK_0;
+
+    /* A frame which is not shared is cloned by copy */
+    block_t *copy = block_Clone (block);
+    assert (copy != NULL);
+    assert (copy->p_buffer != block->p_buffer);
+    assert (!block_IsShared (copy));
+    block_Release (copy);
+
+    uint8_t *payload = block->p_buffer;
+    block = block_Share (block);
+    assert (block != NULL);
+    assert (block_Share (block) == block);
+    assert (!block_IsShared (block));
+
+    /* Clones reference the payload, without copying it */
+    block_t *clone = block_Clone (block);
+    assert (clone != NULL);
+    assert (clone->p_buffer == payload && block->p_buffer == payload);
+    assert (clone->i_buffer == sizeof (text));
+    assert (clone->i_pts == VLC_TICK_0);
+    assert (block_IsShared (block) && block_IsShared (clone));
+
+    /* Only one reference prepends in place, the other one copies */
+    clone = block_Realloc (clone, 4, clone->i_buffer);
+    assert (clone != NULL);
+    assert (clone->p_buffer + 4 == payload);
+    memset (clone->p_buffer, 'A', 4);
+
+    block_t *other = block_Clone (block);
+    assert (other != NULL);
+    other = block_Realloc (other, 4, other->i_buffer);
+    assert (other != NULL);
+    assert (other->p_buffer + 4 != payload);
+    assert (!memcmp (other->p_buffer + 4, text, sizeof (text)));
+    assert (!block_IsShared (other));
+    block_Release (other);
+
+    /* Appending always copies */
+    other = block_Clone (block);
+    assert (other != NULL);
+    other->i_buffer--;
+    other = block_Realloc (other, 0, sizeof (text));
+    assert (other != NULL);
+    assert (other->p_buffer != payload);
+    block_Release (other);
+
+    /* Writing in place requires the payload not to be shared */
+    block = block_Unshare (block);
+    assert (block != NULL);
+    assert (block->p_buffer != payload);
+    memset (block->p_buffer, 'B', block->i_buffer);
+    assert (!memcmp (clone->p_buffer + 4, text, sizeof (text)));
+    block_Release (block);
+
+    assert (!block_IsShared (clone));
+    assert (block_Unshare (clone) == clone);
+    block_Release (clone);
+}
+
+static void test_block_FileRange (void)
+{
+    uint8_t data[10000];
+    FILE *stream;
+    uint64_t offset;
+
+    for (size_t i = 0; i < sizeof (data); i++)
+        data[i] = i * 7;
+
+    stream = fopen ("testfile.bin", "wb+e");
+    assert (stream != NULL);
+    assert (fwrite (data, sizeof (data), 1, stream) == 1);
+    assert (fflush (stream) != EOF);
+
+    block_t *block = block_FileRange (fileno (stream), 5000, 3000);
+    fclose (stream);
+    remove ("testfile.bin");
+
+    assert (block != NULL);
+    assert (block->i_buffer == 3000);
+    assert (!memcmp (block->p_buffer, data + 5000, 3000));
+    assert (block_IsShared (block));
+
+    int fd = block_GetFileRange (block, &offset);
+    if (fd == -1)
+    {   /* The range could not be mapped */
+        block_Release (block);
+        return;
+    }
+    assert (offset == 5000);
+    block->p_buffer += 10;
+    block->i_buffer -= 10;
+    assert (block_GetFileRange (block, &offset) == fd && offset == 5010);
+
+    /* References to the range keep it */
+    block = block_Share (block);
+    block_t *clone = block_Clone (block);
+    assert (clone != NULL);
+    assert (block_GetFileRange (clone, &offset) == fd && offset == 5010);
+    assert (block_IsShared (clone));
+    block_Release (block);
+
+    /* The file range is lost when the payload is modified */
+    clone = block_Realloc (clone, 0, clone->i_buffer + 1);
+    assert (clone != NULL);
+    assert (block_GetFileRange (clone, &offset) == -1);
+    assert (!memcmp (clone->p_buffer, data + 5010, 2990));
+    block_Release (clone);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Share ();
+    test_block_FileRange ();
     return 0;
 }
 
@@ -0,0 +1,239 @@
+/*****************************************************************************
+ * src/test/clock.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_es.h>
+#include <vlc_tick.h>
+
+#include "../clock/clock.h"
+
+const char vlc_module_name[] = "test_clock";
+
+#define READERS 4
+#define BENCH_DURATION VLC_TICK_FROM_MS(200)
+
+/* Reference point of the master clock */
+#define REF_SYSTEM VLC_TICK_FROM_SEC(1000)
+#define REF_STREAM VLC_TICK_FROM_SEC(10)
+
+static void test_convert(void)
+{
+    vlc_clock_main_t *main_clock = vlc_clock_main_New(NULL, NULL);
+    assert(main_clock != NULL);
+
+    vlc_clock_t *master = vlc_clock_main_CreateMaster(main_clock, NULL,
+                                                      NULL, NULL);
+    assert(master != NULL);
+    vlc_clock_t *slave = vlc_clock_main_CreateSlave(main_clock, NULL,
+                                                    VIDEO_ES, NULL, NULL);
+    assert(slave != NULL);
+
+    /* No reference point yet: monotonic fallback */
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t system = vlc_clock_ConvertToSystem(slave, now, REF_STREAM, 1.);
+    assert(system != VLC_TICK_INVALID && system != VLC_TICK_MAX);
+
+    const vlc_tick_t ts = REF_STREAM + VLC_TICK_FROM_MS(40);
+    const vlc_tick_t expected = REF_SYSTEM + VLC_TICK_FROM_MS(40);
+
+    vlc_clock_Update(master, REF_SYSTEM, REF_STREAM, 1.);
+    assert(vlc_clock_ConvertToSystem(slave, now, ts, 1.) == expected);
+    assert(vlc_clock_ConvertToSystem(master, now, ts, 1.) == expected);
+
+    /* The lock-less and locked conversions must agree */
+    vlc_clock_Lock(slave);
+    assert(vlc_clock_ConvertToSystemLocked(slave, now, ts, 1.) == expected);
+    vlc_clock_Unlock(slave);
+
+    /* Slave delay */
+    vlc_clock_SetDelay(slave, VLC_TICK_FROM_MS(10));
+    assert(vlc_clock_ConvertToSystem(slave, now, ts, 1.)
+           == expected + VLC_TICK_FROM_MS(10));
+
+    /* A negative master delay delays the slaves instead */
+    vlc_clock_SetDelay(master, -VLC_TICK_FROM_MS(5));
+    assert(vlc_clock_ConvertToSystem(slave, now, ts, 1.)
+           == expected + VLC_TICK_FROM_MS(15));
+    assert(vlc_clock_ConvertToSystem(master, now, ts, 1.) == expected);
+    vlc_clock_SetDelay(master, 0);
+    vlc_clock_SetDelay(slave, 0);
+    assert(vlc_clock_ConvertToSystem(slave, now, ts, 1.) == expected);
+
+    /* Rate changes */
+    vlc_clock_Update(master, REF_SYSTEM, REF_STREAM, 2.);
+    assert(vlc_clock_ConvertToSystem(slave, now, ts, 2.)
+           == REF_SYSTEM + VLC_TICK_FROM_MS(20));
+    vlc_clock_Update(master, REF_SYSTEM, REF_STREAM, 1.);
+
+    /* Pause only affects the slaves */
+    vlc_clock_main_ChangePause(main_clock, REF_SYSTEM, true);
+    assert(vlc_clock_ConvertToSystem(slave, now, ts, 1.) == VLC_TICK_MAX);
+    assert(vlc_clock_ConvertToSystem(master, now, ts, 1.) == expected);
+    vlc_clock_main_ChangePause(main_clock, REF_SYSTEM + VLC_TICK_FROM_SEC(1),
+                               false);
+    assert(vlc_clock_ConvertToSystem(slave, now, ts, 1.)
+           == expected + VLC_TICK_FROM_SEC(1));
+
+    /* Reset: back to the monotonic fallback */
+    vlc_clock_Reset(master);
+    system = vlc_clock_ConvertToSystem(slave, now, ts, 1.);
+    assert(system != VLC_TICK_INVALID && system != VLC_TICK_MAX);
+
+    vlc_clock_Delete(slave);
+    vlc_clock_Delete(master);
+    vlc_clock_main_Delete(main_clock);
+}
+
+struct bench
+{
+    vlc_clock_main_t *main_clock;
+    vlc_clock_t *master;
+    bool locked;
+    atomic_bool stop;
+    atomic_ulong conversions;
+};
+
+struct bench_reader
+{
+    struct bench *bench;
+    vlc_clock_t *clock;
+};
+
+/* The writer alternates between two rates: any torn read of the linear
+ * function would produce another value. */
+static vlc_tick_t bench_expected(double rate)
+{
+    const vlc_tick_t ts = REF_STREAM + VLC_TICK_FROM_MS(40);
+    return (vlc_tick_t) (ts / rate) + REF_SYSTEM
+         - (vlc_tick_t) (REF_STREAM / rate);
+}
+
+static void *bench_reader(void *data)
+{
+    struct bench_reader *reader = data;
+    struct bench *bench = reader->bench;
+    const vlc_tick_t ts = REF_STREAM + VLC_TICK_FROM_MS(40);
+    const vlc_tick_t expected1 = bench_expected(1.), expected2 = bench_expected(2.);
+    unsigned long count = 0;
+
+    while (!atomic_load_explicit(&bench->stop, memory_order_relaxed))
+    {
+        vlc_tick_t system;
+
+        if (bench->locked)
+        {
+            vlc_clock_Lock(reader->clock);
+            system = vlc_clock_ConvertToSystemLocked(reader->clock,
+                                                     VLC_TICK_0, ts, 1.);
+            vlc_clock_Unlock(reader->clock);
+        }
+        else
+            system = vlc_clock_ConvertToSystem(reader->clock, VLC_TICK_0,
+                                               ts, 1.);
+        assert(system == expected1 || system == expected2);
+        count++;
+    }
+
+    atomic_fetch_add(&bench->conversions, count);
+    return NULL;
+}
+
+static void *bench_writer(void *data)
+{
+    struct bench *bench = data;
+    vlc_tick_t deadline = vlc_tick_now();
+    unsigned i = 0;
+
+    while (!atomic_load_explicit(&bench->stop, memory_order_relaxed))
+    {
+        vlc_clock_Update(bench->master, REF_SYSTEM, REF_STREAM,
+                         (i++ & 1) ? 2. : 1.);
+        deadline += VLC_TICK_FROM_MS(1);
+        vlc_tick_wait(deadline);
+    }
+    return NULL;
+}
+
+static unsigned long bench_convert(bool locked)
+{
+    struct bench bench = { .locked = locked };
+    struct bench_reader readers[READERS];
+    vlc_thread_t reader_threads[READERS], writer_thread;
+
+    atomic_init(&bench.stop, false);
+    atomic_init(&bench.conversions, 0);
+
+    bench.main_clock = vlc_clock_main_New(NULL, NULL);
+    assert(bench.main_clock != NULL);
+    bench.master = vlc_clock_main_CreateMaster(bench.main_clock, NULL,
+                                               NULL, NULL);
+    assert(bench.master != NULL);
+    vlc_clock_Update(bench.master, REF_SYSTEM, REF_STREAM, 1.);
+
+    for (size_t i = 0; i < READERS; i++)
+    {
+        readers[i].bench = &bench;
+        readers[i].clock = vlc_clock_main_CreateSlave(bench.main_clock, NULL,
+                                                      i == 0 ? SPU_ES : VIDEO_ES,
+                                                      NULL, NULL);
+        assert(readers[i].clock != NULL);
+    }
+
+    for (size_t i = 0; i < READERS; i++)
+        assert(vlc_clone(&reader_threads[i], bench_reader, &readers[i]) == 0);
+    assert(vlc_clone(&writer_thread, bench_writer, &bench) == 0);
+
+    vlc_tick_wait(vlc_tick_now() + BENCH_DURATION);
+    atomic_store(&bench.stop, true);
+
+    vlc_join(writer_thread, NULL);
+    for (size_t i = 0; i < READERS; i++)
+    {
+        vlc_join(reader_threads[i], NULL);
+        vlc_clock_Delete(readers[i].clock);
+    }
+    vlc_clock_Delete(bench.master);
+    vlc_clock_main_Delete(bench.main_clock);
+
+    unsigned long conversions = atomic_load(&bench.conversions);
+    printf("%s: %lu conversions in %"PRId64" ms from %u threads\n",
+           locked ? "locked" : "lock-less", conversions,
+           MS_FROM_VLC_TICK(BENCH_DURATION), READERS);
+    return conversions;
+}
+
+int main(void)
+{
+    test_convert();
+
+    bench_convert(true);
+    assert(bench_convert(false) > 0);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*****************************************************************************
+ * src/test/latency.c
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../input/latency.h"
+
+const char vlc_module_name[] = "test_latency";
+
+#define PTS(i) (VLC_TICK_0 + VLC_TICK_FROM_MS(40) * (i))
+
+static uint64_t histogram_count(const struct vlc_latency_stage_stats *stage)
+{
+    uint64_t count = 0;
+    for (size_t i = 0; i < VLC_LATENCY_BUCKETS; i++)
+        count += stage->histogram[i];
+    return count;
+}
+
+static void test_stages(void)
+{
+    struct vlc_latency *latency = vlc_latency_New();
+    struct vlc_es_latency stats;
+    assert(latency != NULL);
+
+    vlc_latency_Mark(latency, VLC_LATENCY_DEMUX, PTS(0));
+    vlc_latency_Mark(latency, VLC_LATENCY_DEMUX, PTS(1));
+    /* Split frames are only counted once */
+    vlc_latency_Mark(latency, VLC_LATENCY_DEMUX, PTS(1));
+    /* Undated frames are not tracked */
+    vlc_latency_Mark(latency, VLC_LATENCY_DEMUX, VLC_TICK_INVALID);
+
+    vlc_tick_sleep(VLC_TICK_FROM_MS(10));
+
+    /* Decoders output in presentation order, the packetizer is skipped */
+    vlc_latency_Mark(latency, VLC_LATENCY_DECODING, PTS(1));
+    vlc_latency_Mark(latency, VLC_LATENCY_DECODING, PTS(0));
+    /* Unknown frames are ignored */
+    vlc_latency_Mark(latency, VLC_LATENCY_DECODING, PTS(2));
+
+    vlc_latency_Get(latency, &stats);
+    assert(stats.stages[VLC_LATENCY_DEMUX].count == 2);
+    assert(stats.stages[VLC_LATENCY_DEMUX].queued == 0);
+    assert(stats.stages[VLC_LATENCY_PACKETIZED].count == 0);
+    assert(stats.stages[VLC_LATENCY_DECODING].count == 2);
+    assert(stats.stages[VLC_LATENCY_DECODING].queued == 2);
+    assert(stats.stages[VLC_LATENCY_DECODING].max >= VLC_TICK_FROM_MS(10));
+    assert(stats.stages[VLC_LATENCY_DECODING].total
+           >= 2 * VLC_TICK_FROM_MS(10));
+    assert(histogram_count(&stats.stages[VLC_LATENCY_DECODING]) == 2);
+    /* At least 10 ms: 2^13 µs and above */
+    for (size_t i = 0; i < 13; i++)
+        assert(stats.stages[VLC_LATENCY_DECODING].histogram[i] == 0);
+
+    vlc_latency_Mark(latency, VLC_LATENCY_DISPLAYED, PTS(0));
+    /* A redisplayed frame is not counted again */
+    vlc_latency_Mark(latency, VLC_LATENCY_DISPLAYED, PTS(0));
+    /* Nor a stage going backward */
+    vlc_latency_Mark(latency, VLC_LATENCY_DECODED, PTS(0));
+
+    vlc_latency_Get(latency, &stats);
+    assert(stats.stages[VLC_LATENCY_DISPLAYED].count == 1);
+    assert(stats.stages[VLC_LATENCY_DISPLAYED].queued == 0);
+    assert(stats.stages[VLC_LATENCY_DECODED].count == 0);
+    assert(stats.stages[VLC_LATENCY_DECODING].queued == 1);
+
+    /* A dropped frame leaves the tracker without being counted */
+    vlc_latency_Drop(latency, PTS(1));
+    vlc_latency_Mark(latency, VLC_LATENCY_DISPLAYED, PTS(1));
+    vlc_latency_Get(latency, &stats);
+    assert(stats.stages[VLC_LATENCY_DISPLAYED].count == 1);
+    assert(stats.stages[VLC_LATENCY_DECODING].queued == 0);
+
+    /* Frames in flight are forgotten, not the statistics */
+    vlc_latency_Mark(latency, VLC_LATENCY_DEMUX, PTS(2));
+    vlc_latency_Flush(latency);
+    vlc_latency_Mark(latency, VLC_LATENCY_DISPLAYED, PTS(2));
+    vlc_latency_Get(latency, &stats);
+    assert(stats.stages[VLC_LATENCY_DISPLAYED].count == 1);
+    assert(stats.stages[VLC_LATENCY_DEMUX].count == 3);
+    assert(stats.stages[VLC_LATENCY_DEMUX].queued == 0);
+    assert(stats.stages[VLC_LATENCY_DECODING].count == 2);
+
+    vlc_latency_Delete(latency);
+}
+
+static void test_overflow(void)
+{
+    struct vlc_latency *latency = vlc_latency_New();
+    struct vlc_es_latency stats;
+    assert(latency != NULL);
+
+    /* Frames that never leave the pipeline do not fill the tracker */
+    for (int i = 0; i < 10000; i++)
+        vlc_latency_Mark(latency, VLC_LATENCY_DEMUX, PTS(i));
+    vlc_latency_Mark(latency, VLC_LATENCY_DECODED, PTS(0));
+    vlc_latency_Mark(latency, VLC_LATENCY_DECODED, PTS(9999));
+
+    vlc_latency_Get(latency, &stats);
+    assert(stats.stages[VLC_LATENCY_DEMUX].count == 10000);
+    assert(stats.stages[VLC_LATENCY_DECODED].count == 1);
+    assert(stats.stages[VLC_LATENCY_DEMUX].queued
+         + stats.stages[VLC_LATENCY_DECODED].queued < 10000);
+    assert(stats.stages[VLC_LATENCY_DECODED].queued == 1);
+
+    vlc_latency_Delete(latency);
+}
+
+int main(void)
+{
+    test_stages();
+    test_overflow();
+    return 0;
+}
@@ -59,6 +59,7 @@
 #include "video_window.h"
 #include "../misc/variables.h"
 #include "../clock/clock.h"
+#include "../input/latency.h"
 #include "statistic.h"
 #include "chrono.h"
 #include "control.h"
@@ -75,6 +76,7 @@ typedef struct vout_thread_sys_t
     char            *splitter_name;
 
     const char      *str_id;
+    struct vlc_latency *latency;
     vlc_clock_t     *clock;
     float           rate;
     vlc_tick_t      delay;
@@ -321,6 +323,7 @@ ssize_t vout_RegisterSubpictureChannel( vout_thread_t *vout )
 
 ssize_t vout_RegisterSubpictureChannelInternal(vout_thread_t *vout,
                                                vlc_clock_t *clock,
+                                               struct vlc_latency *latency,
                                                enum vlc_vout_order *out_order)
 {
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
@@ -328,7 +331,8 @@ ssize_t vout_RegisterSubpictureChannelInternal(vout_thread_t *vout,
     ssize_t channel = VOUT_SPU_CHANNEL_INVALID;
 
     if (sys->spu)
-        channel = spu_RegisterChannelInternal(sys->spu, clock, out_order);
+        channel = spu_RegisterChannelInternal(sys->spu, clock, latency,
+                                              out_order);
 
     return channel;
 }
@@ -1230,6 +1234,9 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
     if (!filtered)
         return VLC_EGENERIC;
 
+    if (sys->latency != NULL)
+        vlc_latency_Mark(sys->latency, VLC_LATENCY_FILTERED, filtered->date);
+
     vlc_mutex_lock(&sys->display_lock);
 
     picture_t *todisplay;
@@ -1243,6 +1250,8 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
 
     vlc_tick_t system_now = vlc_tick_now();
     const vlc_tick_t pts = todisplay->date;
+    if (sys->latency != NULL)
+        vlc_latency_Mark(sys->latency, VLC_LATENCY_PRERENDERED, pts);
     vlc_tick_t system_pts = render_now ? system_now :
         vlc_clock_ConvertToSystem(sys->clock, system_now, pts, sys->rate);
     if (unlikely(system_pts == VLC_TICK_MAX))
@@ -1257,8 +1266,15 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
     const unsigned frame_rate = todisplay->format.i_frame_rate;
     const unsigned frame_rate_base = todisplay->format.i_frame_rate_base;
 
+    struct vlc_tracer *tracer = GetTracer(sys);
     if (vd->ops->prepare != NULL)
+    {
+        if (tracer != NULL)
+            vlc_tracer_TraceBegin(tracer, "RENDER", sys->str_id, "prepare");
         vd->ops->prepare(vd, todisplay, subpic, system_pts);
+        if (tracer != NULL)
+            vlc_tracer_TraceEnd(tracer, "RENDER", sys->str_id, "prepare");
+    }
 
     vout_chrono_Stop(&sys->chrono.render);
 
@@ -1268,7 +1284,6 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
         const vlc_tick_t late = system_now - system_pts;
         if (unlikely(late > 0))
         {
-            struct vlc_tracer *tracer = GetTracer(sys);
             if (tracer != NULL)
                 vlc_tracer_TraceEvent(tracer, "RENDER", sys->str_id, "late");
             msg_Dbg(vd, "picture displayed late (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
@@ -1318,7 +1333,13 @@ static int RenderPicture(vout_thread_sys_t *sys, bool render_now)
                           frame_rate, frame_rate_base);
 
     /* Display the direct buffer returned by vout_RenderPicture */
+    if (tracer != NULL)
+        vlc_tracer_TraceBegin(tracer, "RENDER", sys->str_id, "display");
     vout_display_Display(vd, todisplay);
+    if (tracer != NULL)
+        vlc_tracer_TraceEnd(tracer, "RENDER", sys->str_id, "display");
+    if (sys->latency != NULL)
+        vlc_latency_Mark(sys->latency, VLC_LATENCY_DISPLAYED, pts);
     vlc_mutex_unlock(&sys->display_lock);
 
     picture_Release(todisplay);
@@ -1820,6 +1841,7 @@ static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
         spu_Detach(sys->spu);
     sys->clock = NULL;
     sys->str_id = NULL;
+    sys->latency = NULL;
 }
 
 void vout_StopDisplay(vout_thread_t *vout)
@@ -2129,6 +2151,7 @@ int vout_Request(const vout_configuration_t *cfg, vlc_video_context *vctx, input
     sys->delay = 0;
     sys->rate = 1.f;
     sys->str_id = cfg->str_id;
+    sys->latency = cfg->latency;
     sys->clock = cfg->clock;
     sys->delay = 0;
 
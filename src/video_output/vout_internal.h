@@ -44,6 +44,7 @@ typedef struct {
     vout_thread_t        *vout;
     vlc_clock_t          *clock;
     const char           *str_id;
+    struct vlc_latency   *latency;
     const video_format_t *fmt;
     vlc_mouse_event      mouse_event;
     void                 *mouse_opaque;
@@ -176,8 +177,11 @@ enum vlc_video_fitting var_InheritFit(vlc_object_t *);
 /* */
 ssize_t vout_RegisterSubpictureChannelInternal( vout_thread_t *,
                                                 vlc_clock_t *clock,
+                                                struct vlc_latency *latency,
                                                 enum vlc_vout_order *out_order );
-ssize_t spu_RegisterChannelInternal( spu_t *, vlc_clock_t *, enum vlc_vout_order * );
+ssize_t spu_RegisterChannelInternal( spu_t *, vlc_clock_t *,
+                                     struct vlc_latency *,
+                                     enum vlc_vout_order * );
 void spu_Attach( spu_t *, input_thread_t *input );
 void spu_Detach( spu_t * );
 void spu_SetClockDelay(spu_t *spu, size_t channel_id, vlc_tick_t delay);
@@ -43,6 +43,7 @@
 #include "vout_internal.h"
 #include "../misc/subpicture.h"
 #include "../input/input_internal.h"
+#include "../input/latency.h"
 #include "../clock/clock.h"
 
 /*****************************************************************************
@@ -69,6 +70,7 @@ struct spu_channel {
     size_t id;
     enum vlc_vout_order order;
     vlc_clock_t *clock;
+    struct vlc_latency *latency;
     vlc_tick_t delay;
     float rate;
 };
@@ -138,10 +140,12 @@ static void spu_PrerenderSync(spu_private_t *, const subpicture_t *);
 static void spu_PrerenderCancel(spu_private_t *, const subpicture_t *);
 
 static void spu_channel_Init(struct spu_channel *channel, size_t id,
-                             enum vlc_vout_order order, vlc_clock_t *clock)
+                             enum vlc_vout_order order, vlc_clock_t *clock,
+                             struct vlc_latency *latency)
 {
     channel->id = id;
     channel->clock = clock;
+    channel->latency = latency;
     channel->delay = 0;
     channel->rate = 1.f;
     channel->order = order;
@@ -162,12 +166,21 @@ static int spu_channel_Push(struct spu_channel *channel, subpicture_t *subpic,
     return vlc_vector_push(&channel->entries, entry) ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+/* Deletes a subpicture, which is not displayed anymore, if ever */
+static void spu_channel_Drop(struct spu_channel *channel,
+                             const spu_render_entry_t *entry)
+{
+    if (channel->latency != NULL)
+        vlc_latency_Drop(channel->latency, entry->orgstart);
+    subpicture_Delete(entry->subpic);
+}
+
 static void spu_channel_DeleteAt(struct spu_channel *channel, size_t index)
 {
     assert(index < channel->entries.size);
     assert(channel->entries.data[index].subpic);
 
-    subpicture_Delete(channel->entries.data[index].subpic);
+    spu_channel_Drop(channel, &channel->entries.data[index]);
     vlc_vector_remove(&channel->entries, index);
 }
 
@@ -177,7 +190,7 @@ static void spu_channel_Clean(spu_private_t *sys, struct spu_channel *channel)
     {
         assert(channel->entries.data[i].subpic);
         spu_PrerenderCancel(sys, channel->entries.data[i].subpic);
-        subpicture_Delete(channel->entries.data[i].subpic);
+        spu_channel_Drop(channel, &channel->entries.data[i]);
     }
     vlc_vector_destroy(&channel->entries);
 }
@@ -758,11 +771,14 @@ spu_SelectSubpictures(spu_t *spu, vlc_tick_t system_now,
             if (is_rejected)
             {
                 spu_PrerenderCancel(sys, current);
-                subpicture_Delete(current);
-                vlc_vector_remove(&channel->entries, index);
+                spu_channel_DeleteAt(channel, index);
             }
             else
             {
+                /* Only the first rendering is accounted */
+                if (channel->latency != NULL)
+                    vlc_latency_Mark(channel->latency, VLC_LATENCY_DISPLAYED,
+                                     render_entry->orgstart);
                 render_entry->channel_order = channel->order;
                 subpicture_array[(*subpicture_count)++] = *render_entry;
                 index++;
@@ -1653,7 +1669,7 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     for (size_t i = 0; i < VOUT_SPU_CHANNEL_OSD_COUNT; ++i)
     {
         struct spu_channel channel;
-        spu_channel_Init(&channel, i, VLC_VOUT_ORDER_PRIMARY, NULL);
+        spu_channel_Init(&channel, i, VLC_VOUT_ORDER_PRIMARY, NULL, NULL);
         vlc_vector_push(&sys->channels, channel);
     }
 
@@ -1880,6 +1896,8 @@ void spu_PutSubpicture(spu_t *spu, subpicture_t *subpic)
 
     if (spu_channel_Push(channel, subpic, orgstart, orgstop))
     {
+        if (channel->latency != NULL)
+            vlc_latency_Drop(channel->latency, orgstart);
         vlc_mutex_unlock(&sys->lock);
         msg_Err(spu, "subpicture heap full");
         subpicture_Delete(subpic);
@@ -2002,6 +2020,7 @@ subpicture_t *spu_Render(spu_t *spu,
 }
 
 ssize_t spu_RegisterChannelInternal(spu_t *spu, vlc_clock_t *clock,
+                                    struct vlc_latency *latency,
                                     enum vlc_vout_order *order)
 {
     spu_private_t *sys = spu->p;
@@ -2014,7 +2033,8 @@ ssize_t spu_RegisterChannelInternal(spu_t *spu, vlc_clock_t *clock,
     {
         struct spu_channel channel;
         spu_channel_Init(&channel, channel_id,
-                         order ? *order : VLC_VOUT_ORDER_PRIMARY, clock);
+                         order ? *order : VLC_VOUT_ORDER_PRIMARY, clock,
+                         latency);
         if (vlc_vector_push(&sys->channels, channel))
         {
             vlc_mutex_unlock(&sys->lock);
@@ -2030,7 +2050,7 @@ ssize_t spu_RegisterChannelInternal(spu_t *spu, vlc_clock_t *clock,
 ssize_t spu_RegisterChannel(spu_t *spu)
 {
     /* Public call, order is always primary (used for OSD or dvd/bluray spus) */
-    return spu_RegisterChannelInternal(spu, NULL, NULL);
+    return spu_RegisterChannelInternal(spu, NULL, NULL, NULL);
 }
 
 static void spu_channel_Clear(spu_private_t *sys,
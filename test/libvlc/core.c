@@ -82,6 +82,29 @@ static void test_audio_output (void)
     libvlc_release (vlc);
 }
 
+static void test_startup (const char ** argv, int argc)
+{
+    const unsigned count = 20;
+
+    test_log ("Testing repeated instance creation\n");
+
+    /* The first instance pays for the module bank */
+    libvlc_instance_t *vlc = libvlc_new (argc, argv);
+    assert (vlc != NULL);
+    libvlc_release (vlc);
+
+    int64_t start = libvlc_clock ();
+    for (unsigned i = 0; i < count; i++)
+    {
+        vlc = libvlc_new (argc, argv);
+        assert (vlc != NULL);
+        libvlc_release (vlc);
+    }
+
+    int64_t elapsed = libvlc_clock () - start;
+    test_log ("%"PRId64" us per instance\n", elapsed / count);
+}
+
 int main (void)
 {
     test_init();
@@ -89,6 +112,7 @@ int main (void)
     test_core (test_defaults_args, test_defaults_nargs);
     test_audiovideofilterlists (test_defaults_args, test_defaults_nargs);
     test_audio_output ();
+    test_startup (test_defaults_args, test_defaults_nargs);
 
     return 0;
 }
@@ -21,6 +21,7 @@
  **********************************************************************/
 
 #include "test.h"
+#include <poll.h>
 #include <vlc_common.h>
 
 struct event_ctx
@@ -667,6 +668,155 @@ static void test_media_player_programs(const char** argv, int argc)
     libvlc_release (vlc);
 }
 
+static void test_media_player_video_frames(const char** argv, int argc)
+{
+    test_log ("Testing zero-copy video frames\n");
+
+    const char *file = "mock://video_track_count=1;length=10000000;"
+                       "video_width=320;video_height=240";
+
+    libvlc_instance_t *vlc = libvlc_new (argc, argv);
+    assert (vlc != NULL);
+
+    libvlc_media_t *md = libvlc_media_new_location (vlc, file);
+    assert (md != NULL);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media (md);
+    assert (mp != NULL);
+    libvlc_media_release (md);
+
+    libvlc_video_frame_queue_t *queue = libvlc_video_frame_queue_new (mp, 2);
+    assert (queue != NULL);
+    assert (libvlc_video_frame_queue_pop (queue, 0) == NULL);
+
+    play_and_wait (mp);
+
+    int64_t last_pts = -1;
+    for (unsigned i = 0; i < 10; i++)
+    {
+        libvlc_video_frame_t *frame = libvlc_video_frame_queue_pop (queue, -1);
+        assert (frame != NULL);
+
+        assert (strcmp (libvlc_video_frame_get_chroma (frame), "I420") == 0);
+        assert (libvlc_video_frame_get_width (frame) == 320);
+        assert (libvlc_video_frame_get_height (frame) == 240);
+        assert (libvlc_video_frame_get_plane_count (frame) == 3);
+
+        size_t pitch;
+        unsigned lines;
+        const unsigned char *pixels =
+            libvlc_video_frame_get_plane (frame, 0, &pitch, &lines);
+        assert (pixels != NULL && pitch >= 320 && lines == 240);
+        pixels = libvlc_video_frame_get_plane (frame, 1, &pitch, &lines);
+        assert (pixels != NULL && pitch >= 160 && lines == 120);
+
+        int64_t pts = libvlc_video_frame_get_pts (frame);
+        assert (pts > last_pts);
+        last_pts = pts;
+
+        /* Frames may outlive the callback and be shared */
+        libvlc_video_frame_t *ref = libvlc_video_frame_retain (frame);
+        libvlc_video_frame_release (frame);
+        libvlc_video_frame_release (ref);
+    }
+
+    libvlc_media_player_stop_async (mp);
+    libvlc_media_player_release (mp);
+    test_log ("%"PRIu64" frame(s) dropped\n",
+              libvlc_video_frame_queue_get_dropped (queue));
+    libvlc_video_frame_queue_destroy (queue);
+    libvlc_release (vlc);
+}
+
+static void test_media_player_audio_tap(const char** argv, int argc)
+{
+    test_log ("Testing the decoded audio tap\n");
+
+    const vlc_tick_t length = VLC_TICK_FROM_SEC(10);
+    char file[64];
+    snprintf (file, sizeof (file),
+              "mock://audio_track_count=1;video_track_count=1;length=%"PRId64,
+              length);
+
+    libvlc_instance_t *vlc = libvlc_new (argc, argv);
+    assert (vlc != NULL);
+
+    libvlc_media_t *md = libvlc_media_new_location (vlc, file);
+    assert (md != NULL);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new (vlc);
+    assert (mp != NULL);
+
+    assert (libvlc_audio_tap_queue_new (mp, "mp4a", 0, 0, 4) == NULL);
+    libvlc_audio_tap_queue_t *queue =
+        libvlc_audio_tap_queue_new (mp, "FL32", 48000, 2, 4);
+    assert (queue != NULL);
+    assert (libvlc_audio_tap_queue_pop (queue, 0) == NULL);
+    assert (!libvlc_audio_tap_queue_ended (queue));
+
+    libvlc_media_player_set_media (mp, md);
+    libvlc_media_release (md);
+
+    vlc_tick_t start = vlc_tick_now ();
+    play_and_wait (mp);
+
+    int64_t last_pts = -1;
+    uint64_t samples = 0;
+    while (!libvlc_audio_tap_queue_ended (queue))
+    {
+        libvlc_audio_buffer_t *buffer =
+            libvlc_audio_tap_queue_pop (queue, -1);
+        if (buffer == NULL)
+            continue; /* end of stream */
+
+        assert (strcmp (libvlc_audio_buffer_get_format (buffer), "FL32") == 0);
+        assert (libvlc_audio_buffer_get_rate (buffer) == 48000);
+        assert (libvlc_audio_buffer_get_channels (buffer) == 2);
+
+        size_t size;
+        const void *data = libvlc_audio_buffer_get_data (buffer, &size);
+        unsigned count = libvlc_audio_buffer_get_samples (buffer);
+        assert (data != NULL && size == count * 2 * sizeof (float));
+        samples += count;
+
+        int64_t pts = libvlc_audio_buffer_get_pts (buffer);
+        assert (pts > last_pts);
+        last_pts = pts;
+
+        libvlc_audio_buffer_release (buffer);
+    }
+    vlc_tick_t elapsed = vlc_tick_now () - start;
+
+    test_log ("%"PRIu64" sample(s) tapped in %"PRId64" ms\n", samples,
+              MS_FROM_VLC_TICK(elapsed));
+    /* Decoding is not paced by the clock */
+    assert (elapsed < length);
+    assert (samples > 0);
+
+    libvlc_media_player_stop_async (mp);
+    libvlc_audio_tap_queue_destroy (queue);
+
+    /* Disabling the tap while the decoding waits for a full queue */
+    queue = libvlc_audio_tap_queue_new (mp, "S16N", 0, 0, 1);
+    assert (queue != NULL);
+    md = libvlc_media_new_location (vlc, file);
+    assert (md != NULL);
+    libvlc_media_player_set_media (mp, md);
+    libvlc_media_release (md);
+    play_and_wait (mp);
+
+    libvlc_audio_buffer_t *buffer = libvlc_audio_tap_queue_pop (queue, -1);
+    assert (buffer != NULL);
+    libvlc_audio_buffer_release (buffer);
+    poll (NULL, 0, 100); /* let the decoding fill the queue up */
+    assert (libvlc_audio_set_tap_callback (mp, NULL, 0, 0, NULL, NULL) == 0);
+
+    libvlc_media_player_stop_async (mp);
+    libvlc_media_player_release (mp);
+    libvlc_audio_tap_queue_destroy (queue);
+    libvlc_release (vlc);
+}
+
 /* Regression test when having multiple libvlc instances */
 static void test_media_player_multiple_instance(const char** argv, int argc)
 {
@@ -704,6 +854,8 @@ int main (void)
     test_media_player_pause_stop (test_defaults_args, test_defaults_nargs);
     test_media_player_tracks (test_defaults_args, test_defaults_nargs);
     test_media_player_programs (test_defaults_args, test_defaults_nargs);
+    test_media_player_video_frames (test_defaults_args, test_defaults_nargs);
+    test_media_player_audio_tap (test_defaults_args, test_defaults_nargs);
     test_media_player_multiple_instance (test_defaults_args, test_defaults_nargs);
 
     return 0;
@@ -0,0 +1,73 @@
+/*
+ * wav.h - WAV files for the tests
+ */
+
+/**********************************************************************
+ *  Copyright (C) 2026 VLC authors and VideoLAN                       *
+ *  This program is free software; you can redistribute and/or modify *
+ *  it under the terms of the GNU General Public License as published *
+ *  by the Free Software Foundation; version 2 of the license, or (at *
+ *  your option) any later version.                                   *
+ *                                                                    *
+ *  This program is distributed in the hope that it will be useful,   *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of    *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.              *
+ *  See the GNU General Public License for more details.              *
+ *                                                                    *
+ *  You should have received a copy of the GNU General Public License *
+ *  along with this program; if not, you can get it from:             *
+ *  http://www.gnu.org/copyleft/gpl.html                              *
+ **********************************************************************/
+
+#ifndef TEST_WAV_H
+#define TEST_WAV_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static inline void test_wav_le32(FILE *stream, uint32_t v)
+{
+    uint8_t b[4] = { v, v >> 8, v >> 16, v >> 24 };
+    assert(fwrite(b, sizeof (b), 1, stream) == 1);
+}
+
+static inline void test_wav_le16(FILE *stream, uint16_t v)
+{
+    uint8_t b[2] = { v, v >> 8 };
+    assert(fwrite(b, sizeof (b), 1, stream) == 1);
+}
+
+/**
+ * Writes a 16-bits PCM WAV file
+ *
+ * The samples are silent, or, if pattern is true, a counter incremented
+ * every 4 bytes, to check that the data is not moved around.
+ */
+static inline void test_write_wav(const char *path, unsigned channels,
+                                  unsigned rate, unsigned seconds,
+                                  bool pattern)
+{
+    uint32_t size = seconds * rate * channels * 2;
+    FILE *stream = fopen(path, "wb");
+    assert(stream != NULL);
+
+    assert(fwrite("RIFF", 4, 1, stream) == 1);
+    test_wav_le32(stream, 36 + size);
+    assert(fwrite("WAVEfmt ", 8, 1, stream) == 1);
+    test_wav_le32(stream, 16);
+    test_wav_le16(stream, 1); /* PCM */
+    test_wav_le16(stream, channels);
+    test_wav_le32(stream, rate);
+    test_wav_le32(stream, rate * channels * 2);
+    test_wav_le16(stream, channels * 2);
+    test_wav_le16(stream, 16);
+    assert(fwrite("data", 4, 1, stream) == 1);
+    test_wav_le32(stream, size);
+    for (uint32_t i = 0; i < size / 4; i++)
+        test_wav_le32(stream, pattern ? i : 0);
+    assert(fclose(stream) == 0);
+}
+
+#endif
@@ -0,0 +1,165 @@
+/*****************************************************************************
+ * directory.c: test and benchmark for the directory access
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+
+const char vlc_module_name[] = "test_directory";
+
+/* 5k entries: the tree is created within the test timeout */
+#define DIRS 5
+#define FILES 1000
+
+static void make_tree(const char *root)
+{
+    char path[256];
+
+    for (unsigned i = 0; i < DIRS; i++)
+    {
+        snprintf(path, sizeof (path), "%s/dir%03u", root, i);
+        assert(mkdir(path, 0700) == 0);
+
+        for (unsigned j = 0; j < FILES; j++)
+        {
+            snprintf(path, sizeof (path), "%s/dir%03u/file%04u.mkv", root,
+                     i, j);
+            int fd = open(path, O_WRONLY|O_CREAT|O_EXCL, 0600);
+            assert(fd != -1);
+            close(fd);
+        }
+        /* Ignored without stat() */
+        snprintf(path, sizeof (path), "%s/dir%03u/.hidden", root, i);
+        assert(mkfifo(path, 0600) == 0);
+    }
+}
+
+static void remove_tree(const char *root)
+{
+    char path[256];
+
+    for (unsigned i = 0; i < DIRS; i++)
+    {
+        for (unsigned j = 0; j < FILES; j++)
+        {
+            snprintf(path, sizeof (path), "%s/dir%03u/file%04u.mkv", root,
+                     i, j);
+            unlink(path);
+        }
+        snprintf(path, sizeof (path), "%s/dir%03u/.hidden", root, i);
+        unlink(path);
+        snprintf(path, sizeof (path), "%s/dir%03u", root, i);
+        rmdir(path);
+    }
+    rmdir(root);
+}
+
+/* Lists a directory recursively, returns the number of files */
+static size_t list(vlc_object_t *obj, const char *uri)
+{
+    stream_t *stream = vlc_stream_NewURL(obj, uri);
+    assert(stream != NULL);
+
+    input_item_t *item = input_item_New(uri, NULL);
+    assert(item != NULL);
+    input_item_node_t *node = input_item_node_Create(item);
+    assert(node != NULL);
+
+    assert(vlc_stream_ReadDir(stream, node) == VLC_SUCCESS);
+    vlc_stream_Delete(stream);
+
+    size_t files = 0;
+    const char *prev = NULL;
+
+    for (int i = 0; i < node->i_children; i++)
+    {
+        input_item_t *child = node->pp_children[i]->p_item;
+
+        /* Sorted, with the stat information */
+        if (prev != NULL)
+            assert(strcmp(prev, child->psz_name) < 0);
+        prev = child->psz_name;
+
+        if (child->i_type == ITEM_TYPE_DIRECTORY)
+            files += list(obj, child->psz_uri);
+        else
+        {
+            assert(child->i_type == ITEM_TYPE_FILE);
+            char *size = input_item_GetInfo(child, ".stat", "size");
+            assert(size != NULL && strcmp(size, "0") == 0);
+            free(size);
+            files++;
+        }
+    }
+
+    input_item_node_Delete(node);
+    input_item_Release(item);
+    return files;
+}
+
+static void test_list(const char *uri, const char *threads)
+{
+    const char *argv[] = {
+        "-v", "--ignore-config", "--no-sub-autodetect-file",
+        "--directory-stat-threads", threads,
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_tick_t start = vlc_tick_now();
+    size_t files = list(VLC_OBJECT(vlc->p_libvlc_int), uri);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    test_log("%s thread(s): %zu entries in %"PRId64" ms\n", threads, files,
+             MS_FROM_VLC_TICK(elapsed));
+    assert(files == DIRS * FILES);
+    libvlc_release(vlc);
+}
+
+int main(void)
+{
+    char root[] = "/tmp/vlc-directory-XXXXXX";
+
+    test_init();
+
+    assert(mkdtemp(root) != NULL);
+    make_tree(root);
+
+    char *uri = vlc_path2uri(root, NULL);
+    assert(uri != NULL);
+
+    test_list(uri, "1");
+    test_list(uri, "8");
+
+    free(uri);
+    alarm(0);
+    remove_tree(root);
+    return 0;
+}
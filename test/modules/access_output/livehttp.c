@@ -0,0 +1,233 @@
+/*****************************************************************************
+ * livehttp.c: test for the HTTP live streaming CMAF and partial segments
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../libvlc/wav.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+
+const char vlc_module_name[] = "test_access_output_livehttp";
+
+#define RATE 48000
+#define SECONDS 12
+
+static void on_stopped(const struct libvlc_event_t *event, void *data)
+{
+    VLC_UNUSED(event);
+    vlc_sem_post(data);
+}
+
+static void stream(libvlc_instance_t *vlc, const char *wav, const char *dir)
+{
+    char *sout;
+    assert(asprintf(&sout, ":sout=#std{access=livehttp{seglen=3,"
+                    "delsegs=false,index=%s/index.m3u8,cmaf,part-length=500},"
+                    "mux=mp4stream,dst=%s/seg-###.m4s}", dir, dir) != -1);
+
+    libvlc_media_t *media = libvlc_media_new_path(vlc, wav);
+    assert(media != NULL);
+    libvlc_media_add_option(media, sout);
+    free(sout);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(media);
+    assert(mp != NULL);
+    libvlc_media_release(media);
+
+    vlc_sem_t stopped;
+    vlc_sem_init(&stopped, 0);
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    assert(libvlc_event_attach(em, libvlc_MediaPlayerStopped, on_stopped,
+                               &stopped) == 0);
+
+    assert(libvlc_media_player_play(mp) == 0);
+    vlc_sem_wait(&stopped);
+    libvlc_event_detach(em, libvlc_MediaPlayerStopped, on_stopped, &stopped);
+
+    /* The stream output, and the writer thread, are closed with the player */
+    libvlc_media_player_release(mp);
+}
+
+static uint8_t *load(const char *path, size_t *size)
+{
+    FILE *stream = fopen(path, "rb");
+    assert(stream != NULL);
+    assert(fseek(stream, 0, SEEK_END) == 0);
+    *size = ftell(stream);
+    rewind(stream);
+
+    uint8_t *data = malloc(*size);
+    assert(data != NULL);
+    assert(*size == 0 || fread(data, *size, 1, stream) == 1);
+    fclose(stream);
+    return data;
+}
+
+static bool is_box(const uint8_t *p, size_t size, const char *type)
+{
+    return size >= 8 && memcmp(p + 4, type, 4) == 0;
+}
+
+/* Checks that the partial segments cover the segment with whole fragments */
+static void check_parts(const char *index, const char *uri, size_t *parts)
+{
+    size_t size;
+    uint8_t *data = load(uri, &size);
+    uint64_t end = 0;
+    char prefix[256];
+    char line[1024];
+
+    snprintf(prefix, sizeof (prefix), "URI=\"%s\",BYTERANGE=\"", uri);
+
+    FILE *stream = fopen(index, "rt");
+    assert(stream != NULL);
+    while (fgets(line, sizeof (line), stream) != NULL)
+    {
+        if (strncmp(line, "#EXT-X-PART:", 12))
+            continue;
+        const char *range = strstr(line, prefix);
+        if (range == NULL)
+            continue;
+
+        uint64_t length, offset;
+        assert(sscanf(range + strlen(prefix), "%"SCNu64"@%"SCNu64,
+                      &length, &offset) == 2);
+        assert(offset == end);
+        assert(offset + length <= size);
+        assert(is_box(data + offset, length, "moof"));
+        end = offset + length;
+        (*parts)++;
+    }
+    fclose(stream);
+
+    if (end > 0)
+        assert(end == size);
+    free(data);
+}
+
+static void check(const char *dir)
+{
+    char index[256], init[256];
+    snprintf(index, sizeof (index), "%s/index.m3u8", dir);
+    snprintf(init, sizeof (init), "%s/seg-init.m4s", dir);
+
+    FILE *stream = fopen(index, "rt");
+    assert(stream != NULL);
+
+    char line[1024], map[300], uris[8][256];
+    double duration = 0.;
+    size_t segments = 0, parts = 0;
+    bool endlist = false, part_inf = false, has_map = false;
+
+    snprintf(map, sizeof (map), "#EXT-X-MAP:URI=\"%s\"\n", init);
+
+    while (fgets(line, sizeof (line), stream) != NULL)
+    {
+        double length;
+
+        if (!strcmp(line, map))
+            has_map = true;
+        else if (!strncmp(line, "#EXT-X-PART-INF:", 16))
+            part_inf = true;
+        else if (!strcmp(line, "#EXT-X-ENDLIST\n"))
+            endlist = true;
+        /* All the segments are complete */
+        assert(strncmp(line, "#EXT-X-PRELOAD-HINT:", 20));
+
+        if (sscanf(line, "#EXTINF:%lf,", &length) != 1)
+            continue;
+        duration += length;
+
+        assert(fgets(line, sizeof (line), stream) != NULL);
+        line[strcspn(line, "\n")] = '\0';
+        assert(segments < ARRAY_SIZE(uris));
+        strcpy(uris[segments++], line);
+    }
+    fclose(stream);
+
+    assert(has_map && part_inf && endlist);
+    test_log("%zu segments, %.2f s\n", segments, duration);
+    assert(segments >= SECONDS / 3 - 1);
+    /* The whole input is listed, to an audio block (50 ms) */
+    assert(duration > SECONDS - .1 && duration < SECONDS + .1);
+
+    /* The initialization segment holds the header, the segments start with
+     * a fragment */
+    size_t size;
+    uint8_t *data = load(init, &size);
+    assert(is_box(data, size, "ftyp"));
+    free(data);
+
+    for (size_t i = 0; i < segments; i++)
+    {
+        data = load(uris[i], &size);
+        assert(is_box(data, size, "moof"));
+        free(data);
+        check_parts(index, uris[i], &parts);
+    }
+    test_log("%zu partial segments\n", parts);
+    assert(parts > 0);
+
+    for (size_t i = 0; i < segments; i++)
+        unlink(uris[i]);
+    unlink(init);
+    unlink(index);
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/vlc-livehttp-XXXXXX";
+    char wav[sizeof (dir) + 16];
+
+    test_init();
+
+    const char *argv[] = {
+        "-v", "--ignore-config", "--no-audio", "--no-video",
+        "--sout-keep",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    /* The module depends on an optional library */
+    if (!module_exists("livehttp"))
+    {
+        test_log("livehttp not available\n");
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    assert(mkdtemp(dir) != NULL);
+    snprintf(wav, sizeof (wav), "%s/test.wav", dir);
+    test_write_wav(wav, 2, RATE, SECONDS, true);
+
+    stream(vlc, wav, dir);
+    libvlc_release(vlc);
+
+    check(dir);
+
+    unlink(wav);
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*****************************************************************************
+ * resampler.c: quality and throughput benchmark for audio resamplers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_tick.h>
+
+#define PERIOD_SAMPLES 1024
+#define SECONDS 10
+#define TONE 997.
+
+struct result
+{
+    double thdn; /**< THD+N in dB */
+    double speed; /**< Input frames per second of CPU time */
+    size_t samples;
+    size_t expected; /**< Output samples expected from the nominal ratio */
+};
+
+/* Fits a sine of known frequency by least squares and returns the ratio of
+ * the residual energy to the fitted sine energy in dB. */
+static double measure_thdn(const float *y, size_t count, double freq,
+                           unsigned rate)
+{
+    double ss = 0., sc = 0., cc = 0., ys = 0., yc = 0.;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double w = 2. * M_PI * freq * i / rate;
+        double s = sin(w), c = cos(w);
+
+        ss += s * s; sc += s * c; cc += c * c;
+        ys += y[i] * s; yc += y[i] * c;
+    }
+
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+    double signal = 0., noise = 0.;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double w = 2. * M_PI * freq * i / rate;
+        double fit = a * sin(w) + b * cos(w);
+
+        signal += fit * fit;
+        noise += (y[i] - fit) * (y[i] - fit);
+    }
+    return 10. * log10(noise / signal);
+}
+
+static struct result run(vlc_object_t *obj, unsigned in_rate,
+                         unsigned out_rate, unsigned channels, int drift)
+{
+    audio_sample_format_t infmt = {
+        .i_format = VLC_CODEC_FL32,
+        .i_rate = in_rate,
+        .i_physical_channels = channels == 1 ? AOUT_CHAN_CENTER
+                                             : AOUT_CHANS_STEREO,
+        .channel_type = AUDIO_CHANNEL_TYPE_BITMAP,
+    };
+    aout_FormatPrepare(&infmt);
+    audio_sample_format_t outfmt = infmt;
+    outfmt.i_rate = out_rate;
+
+    aout_filters_t *filters = aout_FiltersNew(obj, &infmt, &outfmt, NULL);
+    assert(filters != NULL);
+
+    const size_t total = (size_t)out_rate * (SECONDS + 1);
+    float *out = malloc(total * sizeof (*out));
+    assert(out != NULL);
+
+    size_t count = 0, in_frames = 0;
+    vlc_tick_t date = VLC_TICK_0, elapsed = 0;
+
+    while (in_frames < (size_t)in_rate * SECONDS)
+    {
+        block_t *block = block_Alloc(PERIOD_SAMPLES * infmt.i_bytes_per_frame);
+        assert(block != NULL);
+
+        float *p = (float *)block->p_buffer;
+        for (size_t i = 0; i < PERIOD_SAMPLES; i++)
+        {
+            float v = .5 * sin(2. * M_PI * TONE * (in_frames + i) / in_rate);
+            for (unsigned c = 0; c < channels; c++)
+                *(p++) = v;
+        }
+        block->i_nb_samples = PERIOD_SAMPLES;
+        block->i_pts = block->i_dts = date;
+        block->i_length = vlc_tick_from_samples(PERIOD_SAMPLES, in_rate);
+        date += block->i_length;
+        in_frames += PERIOD_SAMPLES;
+
+        /* Emulate the drift compensation of the audio output: the input
+         * rate oscillates around its nominal value. */
+        if (drift != 0 && (in_frames / PERIOD_SAMPLES) % 16 == 0)
+            aout_FiltersAdjustResampling(filters,
+                ((in_frames / PERIOD_SAMPLES) % 32) ? drift : -drift);
+
+        vlc_tick_t start = vlc_tick_now();
+        block = aout_FiltersPlay(filters, block, 1.f);
+        elapsed += vlc_tick_now() - start;
+
+        if (block == NULL)
+            continue;
+        assert(block->i_nb_samples * outfmt.i_bytes_per_frame
+               == block->i_buffer);
+
+        const float *q = (const float *)block->p_buffer;
+        for (size_t i = 0; i < block->i_nb_samples && count < total; i++)
+            out[count++] = q[i * channels];
+        block_Release(block);
+    }
+    aout_FiltersDelete(obj, filters);
+
+    struct result res;
+    /* Skip the start-up transient */
+    const size_t skip = out_rate / 10;
+    assert(count > 2 * skip);
+    res.thdn = drift ? 0. : measure_thdn(out + skip, count - 2 * skip,
+                                         TONE, out_rate);
+    res.speed = elapsed > 0 ? in_frames / secf_from_vlc_tick(elapsed) : 0.;
+    res.samples = count;
+    res.expected = (uint64_t)in_frames * out_rate / in_rate;
+    free(out);
+    return res;
+}
+
+static void test_resampler(vlc_object_t *obj, const char *name,
+                           int quality, double min_thdn)
+{
+    var_SetString(obj, "audio-resampler", name);
+    if (quality >= 0)
+        var_SetInteger(obj, "polyphase-resampler-quality", quality);
+
+    static const unsigned rates[][2] = {
+        { 44100, 48000 }, { 48000, 44100 }, { 32000, 48000 },
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(rates); i++)
+    {
+        struct result mono = run(obj, rates[i][0], rates[i][1], 1, 0);
+        struct result stereo = run(obj, rates[i][0], rates[i][1], 2, 0);
+
+        test_log("%s/%d: %u -> %u Hz: %zu samples, THD+N %.1f dB, "
+                 "%.1f Mframes/s mono, %.1f Mframes/s stereo\n", name,
+                 quality, rates[i][0], rates[i][1], mono.samples, mono.thdn,
+                 mono.speed / 1e6, stereo.speed / 1e6);
+
+        /* The output length must follow the ratio */
+        assert(mono.samples + PERIOD_SAMPLES >= mono.expected);
+        assert(mono.samples <= mono.expected + 1);
+        assert(mono.thdn <= min_thdn);
+    }
+
+    /* Drift compensation: the rate changes every few periods */
+    struct result drift = run(obj, 48000, 48000, 2, 10);
+    test_log("%s/%d: 48000 +/- 10 Hz: %zu samples, %.1f Mframes/s\n",
+             name, quality, drift.samples, drift.speed / 1e6);
+    assert(drift.samples + 2 * PERIOD_SAMPLES >= drift.expected);
+}
+
+int main(void)
+{
+    static const char *argv[] = {
+        "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+        "--no-audio-time-stretch",
+    };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = vlc_object_create(vlc->p_libvlc_int, sizeof (*obj));
+    assert(obj != NULL);
+    var_Create(obj, "visual", VLC_VAR_STRING);
+    var_Create(obj, "audio-resampler", VLC_VAR_STRING);
+    var_Create(obj, "polyphase-resampler-quality", VLC_VAR_INTEGER);
+
+    test_resampler(obj, "polyphase", 0, -55.);
+    test_resampler(obj, "polyphase", 1, -85.);
+    test_resampler(obj, "polyphase", 2, -100.);
+    /* Reference, for comparison only: sample-and-hold is not band-limited */
+    test_resampler(obj, "ugly", -1, HUGE_VAL);
+
+    var_Destroy(obj, "polyphase-resampler-quality");
+    var_Destroy(obj, "audio-resampler");
+    var_Destroy(obj, "visual");
+    vlc_object_delete(obj);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*****************************************************************************
+ * binary.c: test for the binary ring buffer tracer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_tracer.h>
+
+#define THREADS 4
+#define SPANS 50
+#define FLOOD 100000
+
+/* File layout, see modules/logger/binary.c */
+#define HEADER_SIZE 256
+#define RECORD_SIZE 256
+#define ENTRY_SIZE 40
+#define ENTRIES_OFFSET 16
+#define KEY_SIZE 15
+#define VALUE_OFFSET 16
+
+struct record
+{
+    int64_t ts;
+    uint32_t thread;
+    uint32_t count;
+    const unsigned char *entries;
+};
+
+static const unsigned char *record_find(const struct record *rec,
+                                        const char *key, uint8_t *type)
+{
+    for (unsigned i = 0; i < rec->count; i++)
+    {
+        const unsigned char *e = rec->entries + i * ENTRY_SIZE;
+
+        if (strncmp((const char *)e, key, KEY_SIZE) == 0)
+        {
+            *type = e[KEY_SIZE];
+            return e + VALUE_OFFSET;
+        }
+    }
+    return NULL;
+}
+
+static void *span_thread(void *data)
+{
+    struct vlc_tracer *tracer = data;
+
+    for (unsigned i = 0; i < SPANS; i++)
+    {
+        vlc_tracer_TraceBegin(tracer, "TEST", "span", "work");
+        vlc_tracer_TraceStreamPTS(tracer, "TEST", "span", "IN",
+                                  VLC_TICK_FROM_MS(i));
+        vlc_tracer_TraceEnd(tracer, "TEST", "span", "work");
+    }
+    return NULL;
+}
+
+static void *flood_thread(void *data)
+{
+    struct vlc_tracer *tracer = data;
+
+    /* Much faster than the drain thread: most records are dropped */
+    for (unsigned i = 0; i < FLOOD; i++)
+        vlc_tracer_TraceEvent(tracer, "TEST", "flood", "event");
+    return NULL;
+}
+
+static void test_trace(const char *path)
+{
+    char option[256];
+    snprintf(option, sizeof (option), "--binary-tracer-file=%s", path);
+
+    const char *argv[] = { "-v", "--tracer=binary", option };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    struct vlc_tracer *tracer =
+        vlc_object_get_tracer(VLC_OBJECT(vlc->p_libvlc_int));
+    assert(tracer != NULL);
+
+    vlc_thread_t threads[THREADS], flood;
+    for (size_t i = 0; i < THREADS; i++)
+        assert(vlc_clone(&threads[i], span_thread, tracer) == 0);
+    assert(vlc_clone(&flood, flood_thread, tracer) == 0);
+    for (size_t i = 0; i < THREADS; i++)
+        vlc_join(threads[i], NULL);
+    vlc_join(flood, NULL);
+
+    /* A string longer than the records */
+    vlc_tracer_TraceEvent(tracer, "TEST", "main",
+                          "a very long event name that must be truncated");
+
+    /* Flushes the rings */
+    libvlc_release(vlc);
+
+    FILE *stream = fopen(path, "rb");
+    assert(stream != NULL);
+    assert(fseek(stream, 0, SEEK_END) == 0);
+    long size = ftell(stream);
+    assert(size >= HEADER_SIZE && (size - HEADER_SIZE) % RECORD_SIZE == 0);
+    rewind(stream);
+
+    unsigned char *data = malloc(size);
+    assert(data != NULL);
+    assert(fread(data, 1, size, stream) == (size_t)size);
+    fclose(stream);
+
+    assert(memcmp(data, "VLCTRACE", 8) == 0);
+    uint32_t fields[3];
+    memcpy(fields, data + 8, sizeof (fields));
+    assert(fields[0] == 1 && fields[1] == 0x01020304
+        && fields[2] == RECORD_SIZE);
+
+    unsigned begins = 0, ends = 0, pts = 0, flooded = 0, truncated = 0;
+    int64_t dropped = 0;
+    uint32_t span_threads[THREADS];
+    unsigned nthreads = 0;
+
+    for (long offset = HEADER_SIZE; offset < size; offset += RECORD_SIZE)
+    {
+        struct record rec;
+        memcpy(&rec.ts, data + offset, 8);
+        memcpy(&rec.thread, data + offset + 8, 4);
+        memcpy(&rec.count, data + offset + 12, 4);
+        rec.entries = data + offset + ENTRIES_OFFSET;
+        assert(rec.count > 0 && rec.count <= 6);
+
+        uint8_t type;
+        const unsigned char *value = record_find(&rec, "type", &type);
+        assert(value != NULL && type == VLC_TRACER_STRING);
+
+        if (strcmp((const char *)value, "TRACER") == 0)
+        {
+            int64_t count;
+            value = record_find(&rec, "dropped", &type);
+            assert(value != NULL && type == VLC_TRACER_INT);
+            memcpy(&count, value, sizeof (count));
+            dropped += count;
+            continue;
+        }
+        assert(strcmp((const char *)value, "TEST") == 0);
+
+        if (record_find(&rec, "begin", &type) != NULL)
+        {
+            begins++;
+
+            bool found = false;
+            for (unsigned i = 0; i < nthreads; i++)
+                found |= span_threads[i] == rec.thread;
+            if (!found)
+            {
+                assert(nthreads < THREADS);
+                span_threads[nthreads++] = rec.thread;
+            }
+        }
+        else if (record_find(&rec, "end", &type) != NULL)
+            ends++;
+        else if ((value = record_find(&rec, "pts", &type)) != NULL)
+        {
+            int64_t ns;
+            assert(type == VLC_TRACER_TICK);
+            memcpy(&ns, value, sizeof (ns));
+            assert(ns >= 0 && ns < NS_FROM_VLC_TICK(VLC_TICK_FROM_MS(SPANS)));
+            pts++;
+        }
+        else
+        {
+            value = record_find(&rec, "event", &type);
+            assert(value != NULL && type == VLC_TRACER_STRING);
+            if (strncmp((const char *)value, "a very long", 11) == 0)
+                truncated++;
+            else
+                flooded++;
+        }
+    }
+    free(data);
+
+    test_log("%u span(s) from %u thread(s), %u flood record(s), "
+             "%"PRId64" dropped\n", begins, nthreads, flooded, dropped);
+
+    /* The span threads never fill their ring */
+    assert(nthreads == THREADS);
+    assert(begins == THREADS * SPANS && ends == begins && pts == begins);
+    /* Every record is either written or accounted for */
+    assert(flooded + dropped == FLOOD);
+    assert(truncated == 1);
+}
+
+int main(void)
+{
+    char path[] = "/tmp/vlc-trace-XXXXXX";
+
+    test_init();
+
+    int fd = mkstemp(path);
+    assert(fd != -1);
+    close(fd);
+
+    test_trace(path);
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*****************************************************************************
+ * mp4.c: test for the MP4 muxer fast start finalization
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../libvlc/wav.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+
+const char vlc_module_name[] = "test_mux_mp4";
+
+#define RATE 48000
+#define SECONDS 60
+
+static void on_stopped(const struct libvlc_event_t *event, void *data)
+{
+    VLC_UNUSED(event);
+    vlc_sem_post(data);
+}
+
+/* Muxes the WAV file, and returns the finalization time */
+static vlc_tick_t mux(libvlc_instance_t *vlc, const char *wav,
+                      const char *path, const char *options)
+{
+    char *sout;
+    assert(asprintf(&sout, ":sout=#std{access=file,mux=mp4{%s},dst=%s}",
+                    options, path) != -1);
+
+    libvlc_media_t *media = libvlc_media_new_path(vlc, wav);
+    assert(media != NULL);
+    libvlc_media_add_option(media, sout);
+    free(sout);
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(media);
+    assert(mp != NULL);
+    libvlc_media_release(media);
+
+    vlc_sem_t stopped;
+    vlc_sem_init(&stopped, 0);
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    assert(libvlc_event_attach(em, libvlc_MediaPlayerStopped, on_stopped,
+                               &stopped) == 0);
+
+    assert(libvlc_media_player_play(mp) == 0);
+    vlc_sem_wait(&stopped);
+    libvlc_event_detach(em, libvlc_MediaPlayerStopped, on_stopped, &stopped);
+
+    /* The stream output is kept until the player is released, which closes
+     * the muxer */
+    vlc_tick_t start = vlc_tick_now();
+    libvlc_media_player_release(mp);
+    return vlc_tick_now() - start;
+}
+
+struct mp4_file
+{
+    uint8_t *data;
+    size_t size;
+    size_t moov, mdat; /* box offsets */
+    uint64_t mdat_start, mdat_end; /* payload */
+    const uint8_t *chunks; /* stco or co64 */
+    bool co64;
+};
+
+static const uint8_t *find_box(const uint8_t *p, const uint8_t *end,
+                               const char *type)
+{
+    while (end - p >= 8)
+    {
+        uint64_t size = GetDWBE(p);
+        if (size == 1)
+            size = GetQWBE(p + 8);
+        assert(size >= 8 && size <= (uint64_t)(end - p));
+        if (memcmp(p + 4, type, 4) == 0)
+            return p;
+        p += size;
+    }
+    return NULL;
+}
+
+static void load(const char *path, struct mp4_file *file)
+{
+    FILE *stream = fopen(path, "rb");
+    assert(stream != NULL);
+    assert(fseek(stream, 0, SEEK_END) == 0);
+    file->size = ftell(stream);
+    rewind(stream);
+    file->data = malloc(file->size);
+    assert(file->data != NULL);
+    assert(fread(file->data, file->size, 1, stream) == 1);
+    fclose(stream);
+
+    const uint8_t *begin = file->data, *end = begin + file->size;
+    const uint8_t *moov = find_box(begin, end, "moov");
+    const uint8_t *mdat = find_box(begin, end, "mdat");
+    assert(moov != NULL && mdat != NULL);
+    file->moov = moov - begin;
+    file->mdat = mdat - begin;
+
+    uint64_t size = GetDWBE(mdat);
+    unsigned header = 8;
+    if (size == 1)
+    {
+        size = GetQWBE(mdat + 8);
+        header = 16;
+    }
+    file->mdat_start = file->mdat + header;
+    file->mdat_end = file->mdat + size;
+
+    /* moov/trak/mdia/minf/stbl/stco */
+    const uint8_t *box = moov;
+    static const char *const path_boxes[] = {
+        "trak", "mdia", "minf", "stbl",
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(path_boxes); i++)
+    {
+        const uint8_t *box_end = box + GetDWBE(box);
+        box = find_box(box + 8, box_end, path_boxes[i]);
+        assert(box != NULL);
+    }
+    const uint8_t *stbl_end = box + GetDWBE(box);
+    file->chunks = find_box(box + 8, stbl_end, "stco");
+    file->co64 = file->chunks == NULL;
+    if (file->co64)
+        file->chunks = find_box(box + 8, stbl_end, "co64");
+    assert(file->chunks != NULL);
+}
+
+static uint64_t chunk_offset(const struct mp4_file *file, uint32_t i)
+{
+    const uint8_t *p = file->chunks + 16;
+    return file->co64 ? GetQWBE(p + 8 * i) : GetDWBE(p + 4 * i);
+}
+
+/* Checks that the fast start file holds the same data as the reference,
+ * and that the chunk offsets were moved along */
+static void check(const struct mp4_file *ref, const char *path)
+{
+    struct mp4_file file;
+    load(path, &file);
+
+    assert(file.moov < file.mdat);
+    assert(file.mdat_end - file.mdat_start == ref->mdat_end - ref->mdat_start);
+    assert(memcmp(file.data + file.mdat_start, ref->data + ref->mdat_start,
+                  file.mdat_end - file.mdat_start) == 0);
+
+    uint32_t count = GetDWBE(file.chunks + 12);
+    assert(count > 0 && count == GetDWBE(ref->chunks + 12));
+    for (uint32_t i = 0; i < count; i++)
+        assert(chunk_offset(&file, i) - file.mdat_start
+               == chunk_offset(ref, i) - ref->mdat_start);
+    free(file.data);
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/vlc-mux-mp4-XXXXXX";
+    char wav[sizeof (dir) + 16], ref[sizeof (dir) + 16];
+    char out[sizeof (dir) + 16];
+
+    test_init();
+
+    assert(mkdtemp(dir) != NULL);
+    snprintf(wav, sizeof (wav), "%s/test.wav", dir);
+    snprintf(ref, sizeof (ref), "%s/ref.mp4", dir);
+    snprintf(out, sizeof (out), "%s/out.mp4", dir);
+    test_write_wav(wav, 2, RATE, SECONDS, true);
+
+    const char *argv[] = {
+        "-v", "--ignore-config", "--no-audio", "--no-video",
+        "--sout-keep",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    mux(vlc, wav, ref, "");
+
+    struct mp4_file reference;
+    load(ref, &reference);
+    assert(reference.mdat < reference.moov);
+
+    static const char *const options[] = {
+        /* the data is moved */
+        "faststart",
+        /* the moov fits, the data is not moved */
+        "faststart,faststart-reserve=64",
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(options); i++)
+    {
+        vlc_tick_t elapsed = mux(vlc, wav, out, options[i]);
+        test_log("%s: %zu bytes finalized in %"PRId64" us\n", options[i],
+                 reference.size, US_FROM_VLC_TICK(elapsed));
+        check(&reference, out);
+        unlink(out);
+    }
+
+    libvlc_release(vlc);
+    free(reference.data);
+
+    unlink(ref);
+    unlink(wav);
+    rmdir(dir);
+    return 0;
+}
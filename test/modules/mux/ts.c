@@ -0,0 +1,263 @@
+/*****************************************************************************
+ * ts.c: test for the TS muxer output blocks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* Define a builtin access output recording the muxer output */
+#define MODULE_NAME test_mux_ts
+#define MODULE_STRING "test_mux_ts"
+#undef __PLUGIN__
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_block.h>
+#include <vlc_sout.h>
+
+#define FPS 25
+#define FRAME_SIZE (40000000 / 8 / FPS) /* 40 Mbit/s */
+#define SECONDS 10
+#define PID_VIDEO 100
+
+struct output
+{
+    unsigned blocks;
+    unsigned packets;
+    unsigned max_packets; /* per block */
+    unsigned key_blocks; /* flagged as headers or key frames */
+    uint8_t cc[8192];
+    uint32_t hash; /* of the video packets */
+};
+
+static struct output output;
+
+static ssize_t Write(sout_access_out_t *access, block_t *block)
+{
+    size_t total = 0;
+    VLC_UNUSED(access);
+
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        assert(block->i_buffer > 0 && block->i_buffer % 188 == 0);
+        assert(block->i_buffer / 188 <= output.max_packets);
+        output.blocks++;
+
+        /* A flagged block starts with the tables or with the key frame, as
+         * the access outputs cut the stream there */
+        if (block->i_flags & (BLOCK_FLAG_HEADER | BLOCK_FLAG_TYPE_I))
+        {
+            const uint8_t *p = block->p_buffer;
+            unsigned pid = ((p[1] & 0x1f) << 8) | p[2];
+
+            assert(pid == 0 || (pid == PID_VIDEO && (p[1] & 0x40)));
+            output.key_blocks++;
+        }
+
+        for (size_t i = 0; i < block->i_buffer; i += 188)
+        {
+            const uint8_t *p = &block->p_buffer[i];
+            unsigned pid = ((p[1] & 0x1f) << 8) | p[2];
+
+            assert(p[0] == 0x47);
+            if (p[3] & 0x10) /* payload */
+            {
+                uint8_t cc = p[3] & 0xf;
+                if (output.cc[pid] != 0xff)
+                    assert(cc == ((output.cc[pid] + 1) & 0xf));
+                output.cc[pid] = cc;
+            }
+            if (pid == PID_VIDEO)
+                for (size_t j = 0; j < 188; j++)
+                    output.hash = (output.hash ^ p[j]) * 16777619;
+            output.packets++;
+        }
+        total += block->i_buffer;
+        block_Release(block);
+        block = next;
+    }
+    return total;
+}
+
+static int Control(sout_access_out_t *access, int query, va_list args)
+{
+    switch (query)
+    {
+        case ACCESS_OUT_CAN_SEEK:
+            /* the file destination behaves like a seekable file */
+            *va_arg(args, bool *) = !strcmp(access->psz_path, "file");
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static int Open(vlc_object_t *obj)
+{
+    sout_access_out_t *access = (sout_access_out_t *)obj;
+
+    access->pf_write = Write;
+    access->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_capability("sout access", 0)
+    set_callback(Open)
+    add_shortcut("test_mux_ts")
+vlc_module_end()
+
+/* Helper typedef for vlc_static_modules */
+typedef int (*vlc_plugin_cb)(vlc_set_cb, void*);
+
+VLC_EXPORT const vlc_plugin_cb vlc_static_modules[];
+const vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+/* Muxes synthetic MPEG video frames, returns the muxing time */
+static vlc_tick_t mux(vlc_object_t *obj, const char *dst, const char *mux,
+                      unsigned max_packets)
+{
+    memset(&output, 0, sizeof (output));
+    memset(output.cc, 0xff, sizeof (output.cc));
+    output.max_packets = max_packets;
+    output.hash = 2166136261;
+
+    sout_access_out_t *access = sout_AccessOutNew(obj, "test_mux_ts", dst);
+    assert(access != NULL);
+    sout_mux_t *p_mux = sout_MuxNew(access, mux);
+    if (p_mux == NULL)
+    {
+        sout_AccessOutDelete(access);
+        return VLC_TICK_INVALID;
+    }
+
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_MPGV);
+    fmt.video.i_width = fmt.video.i_visible_width = 1920;
+    fmt.video.i_height = fmt.video.i_visible_height = 1080;
+    sout_input_t *input = sout_MuxAddStream(p_mux, &fmt);
+    assert(input != NULL);
+
+    uint32_t seed = 1;
+    vlc_tick_t start = vlc_tick_now();
+
+    for (unsigned i = 0; i < SECONDS * FPS; i++)
+    {
+        block_t *frame = block_Alloc(FRAME_SIZE);
+        assert(frame != NULL);
+        for (size_t j = 0; j < FRAME_SIZE; j++)
+            frame->p_buffer[j] = (seed = seed * 1103515245 + 12345) >> 24;
+
+        frame->i_dts = VLC_TICK_0 + vlc_tick_from_samples(i, FPS);
+        frame->i_pts = frame->i_dts + vlc_tick_from_samples(1, FPS);
+        frame->i_length = vlc_tick_from_samples(1, FPS);
+        if (i % 12 == 0)
+            frame->i_flags |= BLOCK_FLAG_TYPE_I;
+        assert(sout_MuxSendBuffer(p_mux, input, frame) == VLC_SUCCESS);
+    }
+
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    sout_MuxDeleteStream(p_mux, input);
+    sout_MuxDelete(p_mux);
+    sout_AccessOutDelete(access);
+    return elapsed;
+}
+
+int main(void)
+{
+    test_init();
+
+    const char *argv[] = {
+        "-v", "--ignore-config", "--mtu=1400",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    static const struct
+    {
+        const char *dst;
+        const char *mux;
+        unsigned max_packets;
+        bool compare;
+    } tests[] = {
+        /* one TS packet per block */
+        { "stream", "ts{aggregate=1,pid-video=100,use-key-frames}", 1, true },
+        /* one datagram per block */
+        { "stream", "ts{pid-video=100,use-key-frames}", (1400 - 12) / 188,
+          true },
+        /* large blocks for files */
+        { "file", "ts{pid-video=100,use-key-frames}", 65536 / 188, true },
+        /* a datagram at most, whatever the aggregate */
+        { "stream", "ts{aggregate=64,pid-video=100,use-key-frames}",
+          (1400 - 12) / 188, true },
+        /* fewer tables, so other PCR values */
+        { "file", "ts{aggregate=64,pid-video=100}", 64, false },
+    };
+    uint32_t hash = 0;
+    unsigned packets = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(tests); i++)
+    {
+        vlc_tick_t elapsed = mux(obj, tests[i].dst, tests[i].mux,
+                                 tests[i].max_packets);
+        if (elapsed == VLC_TICK_INVALID)
+        {
+            test_log("TS muxer not available\n");
+            libvlc_release(vlc);
+            return 77;
+        }
+
+        test_log("%s on %s: %u packets in %u blocks (%u blocks/s of stream), "
+                 "muxed in %"PRId64" ms\n", tests[i].mux, tests[i].dst,
+                 output.packets, output.blocks, output.blocks / SECONDS,
+                 MS_FROM_VLC_TICK(elapsed));
+        /* the muxer keeps the last frames on close */
+        assert(output.packets >= (SECONDS - 1) * FPS * FRAME_SIZE / 184);
+        assert(output.key_blocks > 0);
+
+        /* The aggregation does not change the muxed packets, nor their
+         * timestamps */
+        if (!tests[i].compare)
+            continue;
+        if (i == 0)
+        {
+            hash = output.hash;
+            packets = output.packets;
+        }
+        assert(output.hash == hash);
+        assert(output.packets == packets);
+    }
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,325 @@
+/*****************************************************************************
+ * rtsp.c: RTP stream output benchmark with many RTSP sessions
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+const char vlc_module_name[] = "test_stream_out_rtsp";
+
+#define SESSIONS 500
+#define DURATION VLC_TICK_FROM_SEC(2)
+/* Each session uses two client sockets, and at least two on the server */
+#define FILES (SESSIONS * 5 + 64)
+
+#define SESSION_SIZE 64
+
+static struct
+{
+    int rtp;
+    int rtsp;
+    uint16_t port;
+    char id[SESSION_SIZE];
+} sessions[SESSIONS];
+
+static int bind_loopback(int type, uint16_t *port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addrlen = sizeof (addr);
+
+    int fd = socket(AF_INET, type, 0);
+    assert(fd != -1);
+    assert(bind(fd, (struct sockaddr *)&addr, sizeof (addr)) == 0);
+    assert(getsockname(fd, (struct sockaddr *)&addr, &addrlen) == 0);
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static void send_request(int fd, const char *req)
+{
+    assert(send(fd, req, strlen(req), 0) == (ssize_t)strlen(req));
+}
+
+/* Receives a reply, returns its status and its session identifier */
+static int recv_reply(int fd, char *session)
+{
+    char reply[2048];
+    const char *body;
+    size_t len = 0, length = 0;
+    ssize_t val;
+
+    do
+    {
+        val = recv(fd, reply + len, sizeof (reply) - 1 - len, 0);
+        assert(val > 0);
+        len += val;
+        reply[len] = '\0';
+    }
+    while ((body = strstr(reply, "\r\n\r\n")) == NULL);
+
+    /* Skip the body, if any, e.g. of errors */
+    const char *cl = strstr(reply, "\r\nContent-Length: ");
+    if (cl != NULL && cl < body)
+        length = strtoul(cl + 18, NULL, 10);
+    body += 4;
+    while ((size_t)(reply + len - body) < length)
+    {
+        val = recv(fd, reply + len, sizeof (reply) - 1 - len, 0);
+        assert(val > 0);
+        len += val;
+    }
+
+    int status;
+    assert(sscanf(reply, "RTSP/1.0 %d ", &status) == 1);
+    if (status != 200)
+        return status;
+
+    const char *s = strstr(reply, "\r\nSession: ");
+    assert(s != NULL);
+    s += 11;
+    size_t n = strcspn(s, ";\r");
+    assert(n < SESSION_SIZE);
+    memcpy(session, s, n);
+    session[n] = '\0';
+    return status;
+}
+
+static void send_setup(uint16_t port, int i)
+{
+    char req[256];
+
+    snprintf(req, sizeof (req),
+             "SETUP rtsp://127.0.0.1:%u/test/trackID=0 RTSP/1.0\r\n"
+             "CSeq: 1\r\n"
+             "Transport: RTP/AVP;unicast;client_port=%u-%u\r\n\r\n",
+             port, sessions[i].port, sessions[i].port + 1);
+    send_request(sessions[i].rtsp, req);
+}
+
+static void send_play(uint16_t port, int i)
+{
+    char req[256];
+
+    snprintf(req, sizeof (req),
+             "PLAY rtsp://127.0.0.1:%u/test RTSP/1.0\r\n"
+             "CSeq: 2\r\n"
+             "Session: %s\r\n\r\n", port, sessions[i].id);
+    send_request(sessions[i].rtsp, req);
+}
+
+/* Sets all the sessions up. The server handles the requests of all its
+ * connections at once, so they are sent before the replies are read. */
+static void setup(uint16_t port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        .sin_port = htons(port),
+    };
+
+    for (int i = 0; i < SESSIONS; i++)
+    {
+        /* The RTCP port is not listened to */
+        sessions[i].rtp = bind_loopback(SOCK_DGRAM, &sessions[i].port);
+        sessions[i].rtsp = socket(AF_INET, SOCK_STREAM, 0);
+        assert(sessions[i].rtsp != -1);
+        assert(connect(sessions[i].rtsp, (struct sockaddr *)&addr,
+                       sizeof (addr)) == 0);
+    }
+
+    /* The track is added asynchronously after the playback started */
+    int status;
+    do
+    {
+        send_setup(port, 0);
+        status = recv_reply(sessions[0].rtsp, sessions[0].id);
+    }
+    while (status == 404 && poll(NULL, 0, 10) == 0);
+    assert(status == 200);
+
+    for (int i = 1; i < SESSIONS; i++)
+        send_setup(port, i);
+    for (int i = 1; i < SESSIONS; i++)
+        assert(recv_reply(sessions[i].rtsp, sessions[i].id) == 200);
+
+    for (int i = 0; i < SESSIONS; i++)
+        send_play(port, i);
+    for (int i = 0; i < SESSIONS; i++)
+    {
+        char id[SESSION_SIZE];
+        assert(recv_reply(sessions[i].rtsp, id) == 200);
+        close(sessions[i].rtsp);
+    }
+}
+
+/* Returns the number of RTP packets pending on the socket */
+static unsigned drain(int fd)
+{
+    uint8_t buf[2048];
+    unsigned count = 0;
+    ssize_t len;
+
+    while ((len = recv(fd, buf, sizeof (buf), MSG_DONTWAIT)) != -1)
+    {
+        assert(len >= 12);
+        if (buf[1] < 200 || buf[1] > 204) /* not RTCP */
+            count++;
+    }
+    assert(errno == EAGAIN || errno == EWOULDBLOCK);
+    return count;
+}
+
+static vlc_tick_t cpu_time(void)
+{
+    struct rusage ru;
+
+    assert(getrusage(RUSAGE_SELF, &ru) == 0);
+    return vlc_tick_from_timeval(&ru.ru_utime)
+         + vlc_tick_from_timeval(&ru.ru_stime);
+}
+
+/* Raises the limit of open files, returns false if it is too low */
+static bool raise_files_limit(void)
+{
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl))
+        return false;
+    if (rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur < FILES)
+    {
+        rl.rlim_cur = rl.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &rl))
+            return false;
+    }
+    return rl.rlim_cur == RLIM_INFINITY || rl.rlim_cur >= FILES;
+}
+
+/* Measures the packet rate and the CPU time per packet */
+static void benchmark(void)
+{
+    /* Only the first session is read continuously: the others have queued
+     * packets, if their socket buffer is not full */
+    vlc_tick_t cpu = cpu_time();
+    vlc_tick_t deadline = vlc_tick_now() + DURATION;
+    unsigned packets = 0;
+
+    while (vlc_tick_now() < deadline)
+    {
+        struct pollfd ufd = { .fd = sessions[0].rtp, .events = POLLIN };
+
+        poll(&ufd, 1, 100);
+        packets += drain(sessions[0].rtp);
+    }
+    cpu = cpu_time() - cpu;
+
+    assert(packets > 0);
+    test_log("%u packets per session, %.2f us of CPU per packet\n", packets,
+             (double)US_FROM_VLC_TICK(cpu) / ((double)packets * SESSIONS));
+}
+
+static void on_playing(const struct libvlc_event_t *event, void *data)
+{
+    VLC_UNUSED(event);
+    vlc_sem_post(data);
+}
+
+int main(void)
+{
+    uint16_t port;
+    char args[64];
+
+    test_init();
+
+    if (!raise_files_limit())
+    {
+        test_log("skipped: fewer than %d files can be opened\n", FILES);
+        return 77;
+    }
+
+    /* Find a free port for the RTSP server */
+    close(bind_loopback(SOCK_STREAM, &port));
+    snprintf(args, sizeof (args), "--rtsp-port=%u", port);
+
+    const char *argv[] = {
+        "-v", "--rtsp-host=127.0.0.1", args, "--rtsp-timeout=0",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    libvlc_media_t *media = libvlc_media_new_location(vlc,
+        "mock://audio_track_count=1;audio_format=s16b;audio_sinewave=false;"
+        "length=60000000");
+    assert(media != NULL);
+    libvlc_media_add_option(media, ":sout=#rtp{sdp=rtsp://127.0.0.1/test}");
+
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(media);
+    assert(mp != NULL);
+    libvlc_media_release(media);
+
+    vlc_sem_t playing;
+    vlc_sem_init(&playing, 0);
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(mp);
+    assert(libvlc_event_attach(em, libvlc_MediaPlayerPlaying, on_playing,
+                               &playing) == 0);
+    assert(libvlc_media_player_play(mp) == 0);
+
+    /* The RTSP server is running once the stream output is open */
+    vlc_sem_wait(&playing);
+    libvlc_event_detach(em, libvlc_MediaPlayerPlaying, on_playing, &playing);
+
+    vlc_tick_t start = vlc_tick_now();
+    setup(port);
+    test_log("%d sessions set up in %"PRId64" ms\n", SESSIONS,
+             MS_FROM_VLC_TICK(vlc_tick_now() - start));
+
+    for (int i = 0; i < SESSIONS; i++)
+        drain(sessions[i].rtp);
+
+    /* The throughput is only measured on request, as it depends on the
+     * machine: the test checks that every session receives packets */
+    if (getenv("VLC_TEST_BENCHMARK") != NULL)
+        benchmark();
+
+    for (int i = 0; i < SESSIONS; i++)
+    {
+        struct pollfd ufd = { .fd = sessions[i].rtp, .events = POLLIN };
+
+        while (drain(sessions[i].rtp) == 0)
+            assert(poll(&ufd, 1, -1) == 1);
+        close(sessions[i].rtp);
+    }
+
+    libvlc_media_player_release(mp);
+    libvlc_release(vlc);
+    return 0;
+}
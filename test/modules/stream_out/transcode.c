@@ -37,6 +37,7 @@ const char vlc_module_name[] = MODULE_STRING;
 #include <vlc_access.h>
 #include <vlc_demux.h>
 #include <vlc_codec.h>
+#include <vlc_aout.h>
 #include <vlc_window.h>
 #include <vlc_interface.h>
 #include <vlc_player.h>
@@ -122,6 +123,65 @@ static int OpenDecoder(vlc_object_t *obj)
     return VLC_SUCCESS;
 }
 
+static int DecodeAudio(decoder_t *dec, block_t *block)
+{
+    if (block == NULL)
+        return VLCDEC_SUCCESS;
+
+    if (decoder_UpdateAudioFormat(dec))
+    {
+        block_Release(block);
+        return VLCDEC_SUCCESS;
+    }
+    block->i_nb_samples = block->i_buffer / dec->fmt_out.audio.i_bytes_per_frame;
+
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    return scenario->audio_decoder_decode(dec, block);
+}
+
+static int OpenAudioDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t*)obj;
+
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    if (scenario->audio_decoder_decode == NULL)
+        return VLC_EGENERIC;
+
+    dec->pf_decode = DecodeAudio;
+    es_format_Clean(&dec->fmt_out);
+    es_format_Copy(&dec->fmt_out, &dec->fmt_in);
+    dec->fmt_out.i_codec = dec->fmt_out.audio.i_format = VLC_CODEC_FL32;
+    aout_FormatPrepare(&dec->fmt_out.audio);
+    return VLC_SUCCESS;
+}
+
+static int DecodeSpu(decoder_t *dec, block_t *block)
+{
+    if (block == NULL)
+        return VLCDEC_SUCCESS;
+
+    subpicture_t *spu = decoder_NewSubpicture(dec, NULL);
+    assert(spu);
+    spu->i_start = block->i_pts;
+    spu->i_stop = block->i_pts + block->i_length;
+    block_Release(block);
+
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    return scenario->spu_decoder_decode(dec, spu);
+}
+
+static int OpenSpuDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t*)obj;
+
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    if (scenario->spu_decoder_decode == NULL)
+        return VLC_EGENERIC;
+
+    dec->pf_decode = DecodeSpu;
+    return VLC_SUCCESS;
+}
+
 static int OpenFilter(vlc_object_t *obj)
 {
     filter_t *filter = (filter_t *)obj;
@@ -132,11 +192,25 @@ static int OpenFilter(vlc_object_t *obj)
     };
     filter->ops = &ops;
 
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    if (scenario->filter_setup != NULL)
+        scenario->filter_setup(filter);
+
     return VLC_SUCCESS;
 }
 
 static picture_t *ConverterFilter(filter_t *filter, picture_t *input)
 {
+    if (input->format.i_width != filter->fmt_out.video.i_width)
+    {
+        /* Scaled pictures are new, the input might be shared */
+        picture_t *output = picture_NewFromFormat(&filter->fmt_out.video);
+        assert(output);
+        output->date = input->date;
+        picture_Release(input);
+        return output;
+    }
+
     video_format_Clean(&input->format);
     video_format_Copy(&input->format, &filter->fmt_out.video);
     return input;
@@ -186,11 +260,75 @@ static void CloseEncoder(encoder_t *enc)
         scenario->encoder_close(enc);
 }
 
+static block_t *EncodeAudio(encoder_t *enc, block_t *in)
+{
+    if (in == NULL)
+        return NULL;
+
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    scenario->audio_encoder_encode(enc, in);
+    return block_Alloc(4);
+}
+
+static int OpenAudioEncoder(encoder_t *enc)
+{
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    if (scenario->audio_encoder_encode == NULL)
+        return VLC_EGENERIC;
+
+    enc->fmt_in.i_codec = enc->fmt_in.audio.i_format = VLC_CODEC_FL32;
+
+    static const struct vlc_encoder_operations ops =
+    {
+        .encode_audio = EncodeAudio,
+        .close = CloseEncoder,
+    };
+    enc->ops = &ops;
+
+    return VLC_SUCCESS;
+}
+
+static block_t *EncodeSpu(encoder_t *enc, subpicture_t *spu)
+{
+    if (spu == NULL)
+        return NULL;
+
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    scenario->spu_encoder_encode(enc, spu);
+    return block_Alloc(4);
+}
+
+static int OpenSpuEncoder(encoder_t *enc)
+{
+    struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
+    if (scenario->spu_encoder_encode == NULL)
+        return VLC_EGENERIC;
+
+    static const struct vlc_encoder_operations ops =
+    {
+        .encode_sub = EncodeSpu,
+        .close = CloseEncoder,
+    };
+    enc->ops = &ops;
+
+    return VLC_SUCCESS;
+}
+
 static int OpenEncoder(vlc_object_t *obj)
 {
     encoder_t *enc = (encoder_t *)obj;
     enc->p_sys = NULL;
 
+    switch (enc->fmt_out.i_cat)
+    {
+        case AUDIO_ES:
+            return OpenAudioEncoder(enc);
+        case SPU_ES:
+            return OpenSpuEncoder(enc);
+        default:
+            break;
+    }
+
     struct transcode_scenario *scenario = &transcode_scenarios[current_scenario];
     assert(scenario->encoder_setup != NULL);
     scenario->encoder_setup(enc);
@@ -280,7 +418,7 @@ static void play_scenario(intf_thread_t *intf, struct transcode_scenario *scenar
     vlc_player_Start(player);
     vlc_player_Unlock(player);
 
-    transcode_scenario_wait(scenario);
+    transcode_scenario_wait(scenario, player);
 
     vlc_player_Lock(player);
     vlc_player_Stop(player);
@@ -318,13 +456,23 @@ static int OpenIntf(vlc_object_t *obj)
  * Inject the mocked modules as a static plugin:
  *  - access for triggering the correct decoder
  *  - decoder for generating video format and context
+ *  - audio and spu decoders, for the scenarios transcoding them
  *  - filter for generating video format and context
- *  - encoder to check the previous video format and context
+ *  - encoder to check the previous video format and context, and the
+ *    audio and spu encoders
  **/
 vlc_module_begin()
     set_callbacks(OpenDecoder, CloseDecoder)
     set_capability("video decoder", INT_MAX)
 
+    add_submodule()
+        set_callback(OpenAudioDecoder)
+        set_capability("audio decoder", 0)
+
+    add_submodule()
+        set_callback(OpenSpuDecoder)
+        set_capability("spu decoder", 0)
+
     add_submodule()
         set_callback(OpenErrorChecker)
         set_capability("sout filter", 0)
@@ -346,6 +494,14 @@ vlc_module_begin()
         set_callback(OpenEncoder)
         set_capability("video encoder", 0)
 
+    add_submodule()
+        set_callback(OpenEncoder)
+        set_capability("audio encoder", 0)
+
+    add_submodule()
+        set_callback(OpenEncoder)
+        set_capability("spu encoder", 0)
+
     add_submodule()
         set_callback(OpenIntf)
         set_capability("interface", 0)
@@ -25,6 +25,7 @@
 #undef __PLUGIN__
 
 #include <vlc_fourcc.h>
+#include <vlc_player.h>
 
 #define TEST_FLAG_CONVERTER 0x01
 #define TEST_FLAG_FILTER 0x02
@@ -40,11 +41,17 @@ struct transcode_scenario {
     void (*filter_setup)(filter_t *);
     void (*converter_setup)(filter_t *);
     void (*report_error)(sout_stream_t *);
+    int (*audio_decoder_decode)(decoder_t *, block_t *);
+    void (*audio_encoder_encode)(encoder_t *, block_t *);
+    int (*spu_decoder_decode)(decoder_t *, subpicture_t *);
+    void (*spu_encoder_encode)(encoder_t *, subpicture_t *);
+    void (*player_control)(vlc_player_t *);
 };
 
 
 void transcode_scenario_init(void);
-void transcode_scenario_wait(struct transcode_scenario *scenario);
+void transcode_scenario_wait(struct transcode_scenario *scenario,
+                             vlc_player_t *player);
 void transcode_scenario_check(struct transcode_scenario *scenario);
 extern size_t transcode_scenarios_count;
 extern struct transcode_scenario transcode_scenarios[];
@@ -42,8 +42,50 @@ static struct scenario_data
     bool encoder_opened;
     bool encoder_closed;
     bool error_reported;
+
+    /* renditions encoded on their own threads */
+    vlc_mutex_t lock;
+    unsigned ladder_count;
+    struct
+    {
+        unsigned width;
+        unsigned pictures;
+    } ladder[3];
+    int ladder_keyint;
+    bool ladder_done;
+
+    /* duplicated outputs sharing the decoder */
+    unsigned decoded_count;
+    struct
+    {
+        encoder_t *encoder;
+        unsigned pictures;
+        bool filtered;
+    } shared[2];
+
+    /* pictures, audio blocks or subpictures queued to the encoder thread */
+    struct
+    {
+        unsigned long decoder_thread;
+        unsigned decoded;
+        unsigned encoded;
+    } async;
+
+    /* pictures queued to the encoder thread when seeking */
+    struct
+    {
+        vlc_sem_t queued;
+        vlc_sem_t seeked;
+        vlc_sem_t release;
+        bool released;
+        unsigned decoded;
+        unsigned encoded;
+        unsigned encoded_after;
+    } flush;
 } scenario_data;
 
+#define FLUSH_SEEK_TIME VLC_TICK_FROM_SEC(60)
+
 static void decoder_fixed_size(decoder_t *dec, vlc_fourcc_t chroma,
         unsigned width, unsigned height)
 {
@@ -83,6 +125,70 @@ static int decoder_decode_dummy(decoder_t *dec, picture_t *pic)
     return VLC_SUCCESS;
 }
 
+static int decoder_decode_shared(decoder_t *dec, picture_t *pic)
+{
+    scenario_data.decoded_count++;
+    return decoder_decode_dummy(dec, pic);
+}
+
+static int decoder_decode_blank(decoder_t *dec, picture_t *pic)
+{
+    /* The pictures of the mock decoder have no pixels */
+    picture_t *blank = picture_NewFromFormat(&pic->format);
+    assert(blank != NULL);
+    picture_CopyProperties(blank, pic);
+    picture_Release(pic);
+
+    for (int i = 0; i < blank->i_planes; i++)
+        memset(blank->p[i].p_pixels, 0,
+               blank->p[i].i_pitch * blank->p[i].i_lines);
+    return decoder_decode_shared(dec, blank);
+}
+
+static void async_decoded(void)
+{
+    vlc_mutex_lock(&scenario_data.lock);
+    scenario_data.async.decoder_thread = vlc_thread_id();
+    scenario_data.async.decoded++;
+    vlc_mutex_unlock(&scenario_data.lock);
+}
+
+static int decoder_decode_async(decoder_t *dec, picture_t *pic)
+{
+    async_decoded();
+    return decoder_decode_dummy(dec, pic);
+}
+
+static int audio_decoder_decode_async(decoder_t *dec, block_t *block)
+{
+    async_decoded();
+    decoder_QueueAudio(dec, block);
+    return VLCDEC_SUCCESS;
+}
+
+static int spu_decoder_decode_async(decoder_t *dec, subpicture_t *spu)
+{
+    async_decoded();
+    decoder_QueueSub(dec, spu);
+    return VLCDEC_SUCCESS;
+}
+
+static int decoder_decode_flush(decoder_t *dec, picture_t *pic)
+{
+    vlc_mutex_lock(&scenario_data.lock);
+    if (pic->date < FLUSH_SEEK_TIME)
+    {
+        /* The encoder holds the first picture, two are queued and the
+         * fourth one waits for room */
+        if (++scenario_data.flush.decoded == 4)
+            vlc_sem_post(&scenario_data.flush.queued);
+    }
+    else if (!scenario_data.flush.released)
+        vlc_sem_post(&scenario_data.flush.seeked);
+    vlc_mutex_unlock(&scenario_data.lock);
+    return decoder_decode_dummy(dec, pic);
+}
+
 /* Picture context implementation */
 static void picture_context_destroy(struct picture_context_t *ctx)
     { free(ctx); }
@@ -210,6 +316,174 @@ static void encoder_encode_wait_10_images(encoder_t *enc, picture_t *pic)
         vlc_sem_post(&scenario_data.wait_stop);
 }
 
+static void encoder_i420_ladder(encoder_t *enc)
+{
+    vlc_mutex_lock(&scenario_data.lock);
+    assert(scenario_data.ladder_count < ARRAY_SIZE(scenario_data.ladder));
+    msg_Info(enc, "Setting up the rendition encoder %u: %ux%u, keyint %d",
+             scenario_data.ladder_count, enc->fmt_in.video.i_width,
+             enc->fmt_in.video.i_height, enc->i_iframes);
+
+    /* All the renditions have the same forced key frame interval */
+    assert(enc->i_iframes > 0);
+    if (scenario_data.ladder_count == 0)
+        scenario_data.ladder_keyint = enc->i_iframes;
+    assert(enc->i_iframes == scenario_data.ladder_keyint);
+
+    assert(enc->fmt_in.i_codec == VLC_CODEC_I420);
+    scenario_data.ladder[scenario_data.ladder_count++].width =
+        enc->fmt_in.video.i_width;
+    scenario_data.encoder_opened = true;
+    vlc_mutex_unlock(&scenario_data.lock);
+}
+
+static void encoder_encode_ladder(encoder_t *enc, picture_t *pic)
+{
+    assert(pic->format.i_width == enc->fmt_in.video.i_width);
+
+    vlc_mutex_lock(&scenario_data.lock);
+    bool done = scenario_data.ladder_count == ARRAY_SIZE(scenario_data.ladder);
+    for (size_t i = 0; i < scenario_data.ladder_count; i++)
+    {
+        if (scenario_data.ladder[i].width == pic->format.i_width)
+            scenario_data.ladder[i].pictures++;
+        done = done && scenario_data.ladder[i].pictures >= 10;
+    }
+    if (done && !scenario_data.ladder_done)
+    {
+        scenario_data.ladder_done = true;
+        vlc_sem_post(&scenario_data.wait_stop);
+    }
+    vlc_mutex_unlock(&scenario_data.lock);
+}
+
+static void encoder_i420_shared(encoder_t *enc)
+{
+    size_t i = scenario_data.shared[0].encoder != NULL;
+    assert(scenario_data.shared[i].encoder == NULL);
+    scenario_data.shared[i].encoder = enc;
+
+    enc->fmt_in.video.i_chroma = enc->fmt_in.i_codec = VLC_CODEC_I420;
+    enc->fmt_in.video.i_visible_width = enc->fmt_in.video.i_width = 800;
+    enc->fmt_in.video.i_visible_height = enc->fmt_in.video.i_height = 600;
+    scenario_data.encoder_opened = true;
+}
+
+static void encoder_encode_shared(encoder_t *enc, picture_t *pic)
+{
+    (void)pic;
+    size_t i = scenario_data.shared[1].encoder == enc;
+    assert(scenario_data.shared[i].encoder == enc);
+    scenario_data.shared[i].pictures++;
+
+    unsigned min = __MIN(scenario_data.shared[0].pictures,
+                         scenario_data.shared[1].pictures);
+    if (min == 10)
+    {
+        /* Each decoded picture was encoded by both outputs */
+        assert(scenario_data.decoded_count < 2 * min);
+        vlc_sem_post(&scenario_data.wait_stop);
+    }
+}
+
+static void encoder_encode_filtered(encoder_t *enc, picture_t *pic)
+{
+    size_t i = scenario_data.shared[1].encoder == enc;
+    assert(scenario_data.shared[i].encoder == enc);
+
+    /* Only the output with the filter gets filtered pictures */
+    bool filtered = pic->p[0].p_pixels[0] == 0xFF;
+    if (scenario_data.shared[i].pictures == 0)
+        scenario_data.shared[i].filtered = filtered;
+    assert(scenario_data.shared[i].filtered == filtered);
+    scenario_data.shared[i].pictures++;
+
+    unsigned min = __MIN(scenario_data.shared[0].pictures,
+                         scenario_data.shared[1].pictures);
+    if (min == 10)
+    {
+        assert(scenario_data.shared[0].filtered
+            != scenario_data.shared[1].filtered);
+        vlc_sem_post(&scenario_data.wait_stop);
+    }
+}
+
+static void async_encoded(void)
+{
+    vlc_mutex_lock(&scenario_data.lock);
+    assert(vlc_thread_id() != scenario_data.async.decoder_thread);
+    /* At most pool-size inputs queued, one being encoded, and one
+     * decoded waiting for room */
+    assert(scenario_data.async.decoded - scenario_data.async.encoded <= 2 + 2);
+    if (++scenario_data.async.encoded == 10)
+        vlc_sem_post(&scenario_data.wait_stop);
+    vlc_mutex_unlock(&scenario_data.lock);
+}
+
+static void encoder_encode_async(encoder_t *enc, picture_t *pic)
+{
+    (void)enc; (void)pic;
+    async_encoded();
+}
+
+static void audio_encoder_encode_async(encoder_t *enc, block_t *block)
+{
+    (void)enc; (void)block;
+    async_encoded();
+}
+
+static void spu_encoder_encode_async(encoder_t *enc, subpicture_t *spu)
+{
+    (void)enc; (void)spu;
+    async_encoded();
+}
+
+static void encoder_encode_flush(encoder_t *enc, picture_t *pic)
+{
+    (void)enc;
+    vlc_mutex_lock(&scenario_data.lock);
+    bool wait = !scenario_data.flush.released;
+    vlc_mutex_unlock(&scenario_data.lock);
+
+    /* Hold the pictures from before the seek until they are released */
+    if (wait)
+        vlc_sem_wait(&scenario_data.flush.release);
+
+    vlc_mutex_lock(&scenario_data.lock);
+    if (pic->date < FLUSH_SEEK_TIME)
+    {
+        assert(scenario_data.flush.encoded_after == 0);
+        scenario_data.flush.encoded++;
+    }
+    else if (++scenario_data.flush.encoded_after == 10)
+    {
+        /* The pictures queued when seeking were not encoded */
+        assert(scenario_data.flush.encoded < scenario_data.flush.decoded);
+        vlc_sem_post(&scenario_data.wait_stop);
+    }
+    vlc_mutex_unlock(&scenario_data.lock);
+}
+
+static void player_seek_flush(vlc_player_t *player)
+{
+    vlc_sem_wait(&scenario_data.flush.queued);
+
+    vlc_player_Lock(player);
+    vlc_player_SetTime(player, FLUSH_SEEK_TIME);
+    vlc_player_Unlock(player);
+
+    /* Release the pictures one by one, until the seek flushed the queue.
+     * The seek is handled once the decoder got room for its picture. */
+    while (vlc_sem_timedwait(&scenario_data.flush.seeked,
+                             vlc_tick_now() + VLC_TICK_FROM_MS(100)))
+        vlc_sem_post(&scenario_data.flush.release);
+
+    vlc_mutex_lock(&scenario_data.lock);
+    scenario_data.flush.released = true;
+    vlc_mutex_unlock(&scenario_data.lock);
+    vlc_sem_post(&scenario_data.flush.release);
+}
+
 static void encoder_close(encoder_t *enc)
 {
     (void)enc;
@@ -253,7 +527,35 @@ static void converter_i420_to_nv12_800_600_vctx(filter_t *filter)
     assert(filter->vctx_in == scenario_data.decoder_vctx);
 }
 
+static void converter_i420_ladder(filter_t *filter)
+{
+    /* Scaling of the shared pictures to a rendition */
+    assert(filter->fmt_in.video.i_width == 800);
+    assert(filter->fmt_in.video.i_height == 600);
+    assert(filter->fmt_out.video.i_width < 800);
+    assert(filter->fmt_in.video.i_chroma == VLC_CODEC_I420);
+    assert(filter->fmt_out.video.i_chroma == VLC_CODEC_I420);
+    scenario_data.converter_opened = true;
+}
+
+static picture_t *filter_in_place(filter_t *filter, picture_t *pic)
+{
+    (void)filter;
+    memset(pic->p[0].p_pixels, 0xFF, pic->p[0].i_pitch * pic->p[0].i_lines);
+    return pic;
+}
+
+static void filter_setup_in_place(filter_t *filter)
+{
+    static const struct vlc_filter_operations ops = {
+        .filter_video = filter_in_place,
+    };
+    filter->ops = &ops;
+}
+
 const char source_800_600[] = "mock://video_track_count=1;length=100000000000;video_width=800;video_height=600";
+const char source_audio[] = "mock://audio_track_count=1;length=100000000000";
+const char source_sub[] = "mock://sub_track_count=1;length=100000000000";
 struct transcode_scenario transcode_scenarios[] =
 {{
     .source = source_800_600,
@@ -350,6 +652,70 @@ struct transcode_scenario transcode_scenarios[] =
     .decoder_decode = decoder_decode_error,
     .report_error = wait_error_reported,
     .encoder_close = encoder_close,
+},{
+    /* Decode once, and encode two extra renditions on their own threads,
+     * with the key frames aligned. */
+    .source = source_800_600,
+    .sout = "sout=#transcode{ladder=\"640x480@800,x240@400\"}:dummy",
+    .decoder_setup = decoder_i420_800_600,
+    .decoder_decode = decoder_decode_dummy,
+    .encoder_setup = encoder_i420_ladder,
+    .encoder_encode = encoder_encode_ladder,
+    .encoder_close = encoder_close,
+    .converter_setup = converter_i420_ladder,
+},{
+    /* Decode once for the duplicated outputs transcoding the same ES */
+    .source = source_800_600,
+    .sout = "sout=#duplicate{dst=transcode:dummy,dst=transcode:dummy}",
+    .decoder_setup = decoder_i420_800_600,
+    .decoder_decode = decoder_decode_shared,
+    .encoder_setup = encoder_i420_shared,
+    .encoder_encode = encoder_encode_shared,
+    .encoder_close = encoder_close,
+},{
+    /* Encode on a thread, with a bounded queue from the decoder */
+    .source = source_800_600,
+    .sout = "sout=#transcode{threads=1,pool-size=2}:dummy",
+    .decoder_setup = decoder_i420_800_600,
+    .decoder_decode = decoder_decode_async,
+    .encoder_setup = encoder_i420_800_600,
+    .encoder_encode = encoder_encode_async,
+    .encoder_close = encoder_close,
+},{
+    /* Encode the audio on a thread */
+    .source = source_audio,
+    .sout = "sout=#transcode{aenc=" MODULE_STRING ",acodec=test,athread,"
+            "pool-size=2}:dummy",
+    .audio_decoder_decode = audio_decoder_decode_async,
+    .audio_encoder_encode = audio_encoder_encode_async,
+},{
+    /* Encode the subtitles on a thread */
+    .source = source_sub,
+    .sout = "sout=#transcode{senc=" MODULE_STRING ",scodec=test,sthread,"
+            "pool-size=2}:dummy",
+    .spu_decoder_decode = spu_decoder_decode_async,
+    .spu_encoder_encode = spu_encoder_encode_async,
+},{
+    /* Seeking discards the pictures queued to the encoder thread */
+    .source = source_800_600,
+    .sout = "sout=#transcode{threads=1,pool-size=2}:dummy",
+    .decoder_setup = decoder_i420_800_600,
+    .decoder_decode = decoder_decode_flush,
+    .encoder_setup = encoder_i420_800_600,
+    .encoder_encode = encoder_encode_flush,
+    .encoder_close = encoder_close,
+    .player_control = player_seek_flush,
+},{
+    /* The filters of an output do not modify the pictures of the others */
+    .source = source_800_600,
+    .sout = "sout=#duplicate{dst=transcode:dummy,"
+            "dst=\"transcode{vfilter=" MODULE_STRING "}:dummy\"}",
+    .decoder_setup = decoder_i420_800_600,
+    .decoder_decode = decoder_decode_blank,
+    .encoder_setup = encoder_i420_shared,
+    .encoder_encode = encoder_encode_filtered,
+    .encoder_close = encoder_close,
+    .filter_setup = filter_setup_in_place,
 }};
 size_t transcode_scenarios_count = ARRAY_SIZE(transcode_scenarios);
 
@@ -359,12 +725,25 @@ void transcode_scenario_init(void)
     scenario_data.encoder_picture_count = 0;
     scenario_data.converter_opened = false;
     scenario_data.encoder_opened = false;
+    vlc_mutex_init(&scenario_data.lock);
+    scenario_data.ladder_count = 0;
+    memset(scenario_data.ladder, 0, sizeof (scenario_data.ladder));
+    scenario_data.ladder_done = false;
+    scenario_data.decoded_count = 0;
+    memset(scenario_data.shared, 0, sizeof (scenario_data.shared));
+    memset(&scenario_data.async, 0, sizeof (scenario_data.async));
+    memset(&scenario_data.flush, 0, sizeof (scenario_data.flush));
+    vlc_sem_init(&scenario_data.flush.queued, 0);
+    vlc_sem_init(&scenario_data.flush.seeked, 0);
+    vlc_sem_init(&scenario_data.flush.release, 0);
     vlc_sem_init(&scenario_data.wait_stop, 0);
 }
 
-void transcode_scenario_wait(struct transcode_scenario *scenario)
+void transcode_scenario_wait(struct transcode_scenario *scenario,
+                             vlc_player_t *player)
 {
-    (void)scenario;
+    if (scenario->player_control != NULL)
+        scenario->player_control(player);
     vlc_sem_wait(&scenario_data.wait_stop);
 }
 
@@ -0,0 +1,160 @@
+/*****************************************************************************
+ * filters.c: test and allocation benchmark for the audio filters pipeline
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_tick.h>
+
+#define PERIODS 2000
+#define PERIOD_SAMPLES 1024
+
+static unsigned long arena_allocations, arena_recycled;
+static bool arena_reported;
+
+static void log_cb(void *data, int level, const libvlc_log_t *ctx,
+                   const char *fmt, va_list args)
+{
+    char *str;
+    (void) data; (void) level; (void) ctx;
+
+    if (vasprintf(&str, fmt, args) == -1)
+        return;
+    if (sscanf(str, "buffer arena: %lu allocation(s), %lu recycled",
+               &arena_allocations, &arena_recycled) == 2)
+        arena_reported = true;
+    free(str);
+}
+
+static void test_pipeline(vlc_object_t *obj, const char *name,
+                          const audio_sample_format_t *infmt,
+                          const audio_sample_format_t *outfmt)
+{
+    aout_filters_t *filters = aout_FiltersNew(obj, infmt, outfmt, NULL);
+    assert(filters != NULL);
+
+    const size_t size = PERIOD_SAMPLES * infmt->i_bytes_per_frame;
+    vlc_tick_t date = VLC_TICK_0;
+    size_t out_samples = 0;
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < PERIODS; i++)
+    {
+        block_t *block = block_Alloc(size);
+        assert(block != NULL);
+        memset(block->p_buffer, 0, size);
+        block->i_nb_samples = PERIOD_SAMPLES;
+        block->i_pts = block->i_dts = date;
+        block->i_length = vlc_tick_from_samples(PERIOD_SAMPLES, infmt->i_rate);
+        date += block->i_length;
+
+        block = aout_FiltersPlay(filters, block, 1.f);
+        if (block != NULL)
+        {
+            assert(block->i_buffer
+                   == block->i_nb_samples * outfmt->i_bytes_per_frame);
+            out_samples += block->i_nb_samples;
+            block_Release(block);
+        }
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    block_t *block = aout_FiltersDrain(filters);
+    if (block != NULL)
+        block_Release(block);
+
+    arena_reported = false;
+    aout_FiltersDelete(obj, filters);
+    assert(arena_reported);
+
+    test_log("%s: %u periods in %"PRId64" us, %zu samples out, "
+             "%lu allocation(s), %lu recycled\n", name, PERIODS,
+             US_FROM_VLC_TICK(elapsed), out_samples,
+             arena_allocations, arena_recycled);
+
+    /* In steady state, every filter output buffer must be recycled. */
+    assert(arena_allocations < 16);
+}
+
+static void test_pipelines(vlc_object_t *obj)
+{
+    audio_sample_format_t s16_stereo = {
+        .i_format = VLC_CODEC_S16N,
+        .i_rate = 44100,
+        .i_physical_channels = AOUT_CHANS_STEREO,
+        .channel_type = AUDIO_CHANNEL_TYPE_BITMAP,
+    };
+    aout_FormatPrepare(&s16_stereo);
+
+    audio_sample_format_t fl32_5_1 = {
+        .i_format = VLC_CODEC_FL32,
+        .i_rate = 48000,
+        .i_physical_channels = AOUT_CHANS_5_1,
+        .channel_type = AUDIO_CHANNEL_TYPE_BITMAP,
+    };
+    aout_FormatPrepare(&fl32_5_1);
+
+    audio_sample_format_t fl32_stereo = fl32_5_1;
+    fl32_stereo.i_physical_channels = AOUT_CHANS_STEREO;
+    aout_FormatPrepare(&fl32_stereo);
+
+    audio_sample_format_t s16_stereo_48k = s16_stereo;
+    s16_stereo_48k.i_rate = 48000;
+
+    /* Format conversion and resampling */
+    test_pipeline(obj, "s16 stereo 44.1kHz -> fl32 stereo 48kHz",
+                  &s16_stereo, &fl32_stereo);
+    /* Fused format conversion and upmixing, then resampling */
+    test_pipeline(obj, "s16 stereo 44.1kHz -> fl32 5.1 48kHz",
+                  &s16_stereo, &fl32_5_1);
+    /* Downmixing, then format conversion */
+    test_pipeline(obj, "fl32 5.1 48kHz -> s16 stereo 48kHz",
+                  &fl32_5_1, &s16_stereo_48k);
+}
+
+int main(void)
+{
+    static const char *argv[] = {
+        "-vv", "--vout=vdummy", "--aout=adummy", "--text-renderer=tdummy",
+        "--no-audio-time-stretch",
+    };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+    libvlc_log_set(vlc, log_cb, NULL);
+
+    vlc_object_t *obj = vlc_object_create(vlc->p_libvlc_int, sizeof (*obj));
+    assert(obj != NULL);
+    var_Create(obj, "visual", VLC_VAR_STRING);
+
+    test_pipelines(obj);
+
+    var_Destroy(obj, "visual");
+    vlc_object_delete(obj);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,251 @@
+/*****************************************************************************
+ * watch.c: stress test for the media tree file system watching
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* Define a builtin services discovery exposing the test directory */
+#define MODULE_NAME test_media_source_watch
+#define MODULE_STRING "test_media_source_watch"
+#undef __PLUGIN__
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_media_source.h>
+#include <vlc_services_discovery.h>
+#include <vlc_url.h>
+
+#define FILES 5000
+
+static char root[] = "/tmp/vlc-watch-XXXXXX";
+
+static int OpenSD(vlc_object_t *obj)
+{
+    services_discovery_t *sd = (services_discovery_t *)obj;
+    char *uri = vlc_path2uri(root, NULL);
+    assert(uri != NULL);
+
+    input_item_t *item = input_item_NewExt(uri, "root", INPUT_DURATION_UNSET,
+                                           ITEM_TYPE_DIRECTORY,
+                                           ITEM_LOCAL);
+    assert(item != NULL);
+    free(uri);
+
+    sd->description = "watch test";
+    services_discovery_AddItem(sd, item);
+    input_item_Release(item);
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_capability("services_discovery", 0)
+    set_callback(OpenSD)
+vlc_module_end()
+
+/* Helper typedef for vlc_static_modules */
+typedef int (*vlc_plugin_cb)(vlc_set_cb, void*);
+
+VLC_EXPORT const vlc_plugin_cb vlc_static_modules[];
+const vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+struct watch_test
+{
+    vlc_mutex_t lock;
+    vlc_cond_t changed;
+    input_item_node_t *node; /**< watched directory node */
+};
+
+static void on_children_changed(vlc_media_tree_t *tree,
+                                input_item_node_t *node,
+                                input_item_node_t *const children[],
+                                size_t count, void *data)
+{
+    struct watch_test *test = data;
+    VLC_UNUSED(tree); VLC_UNUSED(node); VLC_UNUSED(children);
+    VLC_UNUSED(count);
+
+    vlc_mutex_lock(&test->lock);
+    vlc_cond_signal(&test->changed);
+    vlc_mutex_unlock(&test->lock);
+}
+
+static void on_children_reset(vlc_media_tree_t *tree, input_item_node_t *node,
+                              void *data)
+{
+    on_children_changed(tree, node, NULL, 0, data);
+}
+
+static const struct vlc_media_tree_callbacks cbs = {
+    .on_children_reset = on_children_reset,
+    .on_children_added = on_children_changed,
+    .on_children_removed = on_children_changed,
+};
+
+/* Waits until the watched directory node has the expected children count */
+static void wait_children(vlc_media_tree_t *tree, struct watch_test *test,
+                          int expected)
+{
+    for (;;)
+    {
+        vlc_media_tree_Lock(tree);
+        int count = test->node->i_children;
+        vlc_media_tree_Unlock(tree);
+
+        if (count == expected)
+            break;
+
+        vlc_mutex_lock(&test->lock);
+        vlc_cond_timedwait(&test->changed, &test->lock,
+                           vlc_tick_now() + VLC_TICK_FROM_MS(100));
+        vlc_mutex_unlock(&test->lock);
+    }
+}
+
+static void file_path(char *buf, size_t size, unsigned i)
+{
+    snprintf(buf, size, "%s/file%05u.mkv", root, i);
+}
+
+static uint64_t file_size(vlc_media_tree_t *tree, struct watch_test *test,
+                          const char *name)
+{
+    uint64_t size = 0;
+
+    vlc_media_tree_Lock(tree);
+    for (int i = 0; i < test->node->i_children; i++)
+    {
+        input_item_t *item = test->node->pp_children[i]->p_item;
+        if (strcmp(item->psz_name, name) == 0)
+        {
+            char *str = input_item_GetInfo(item, ".stat", "size");
+            size = strtoull(str, NULL, 10);
+            free(str);
+        }
+    }
+    vlc_media_tree_Unlock(tree);
+    return size;
+}
+
+int main(void)
+{
+    char path[sizeof (root) + 32], hidden[sizeof (root) + 32];
+
+    test_init();
+    assert(mkdtemp(root) != NULL);
+
+    const char *argv[] = {
+        "-v", "--ignore-config", "--no-media-library",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_media_source_provider_t *provider =
+        vlc_media_source_provider_Get(vlc->p_libvlc_int);
+    vlc_media_source_t *ms =
+        vlc_media_source_provider_GetMediaSource(provider, MODULE_STRING);
+    assert(ms != NULL);
+
+    vlc_media_tree_t *tree = ms->tree;
+    struct watch_test test;
+    vlc_mutex_init(&test.lock);
+    vlc_cond_init(&test.changed);
+
+    vlc_media_tree_Lock(tree);
+    assert(tree->root.i_children == 1);
+    test.node = tree->root.pp_children[0];
+    input_item_t *media = test.node->p_item;
+    vlc_media_tree_Unlock(tree);
+
+    vlc_media_tree_listener_id *listener =
+        vlc_media_tree_AddListener(tree, &cbs, &test, false);
+    assert(listener != NULL);
+
+    if (vlc_media_tree_Watch(tree, vlc->p_libvlc_int, media) != VLC_SUCCESS)
+    {
+        test_log("file system watching not supported, skipping\n");
+        vlc_media_tree_RemoveListener(tree, listener);
+        vlc_media_source_Release(ms);
+        libvlc_release(vlc);
+        rmdir(root);
+        return 77;
+    }
+
+    /* Creation */
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < FILES; i++)
+    {
+        file_path(path, sizeof (path), i);
+        int fd = open(path, O_WRONLY|O_CREAT|O_EXCL, 0600);
+        assert(fd != -1);
+        close(fd);
+    }
+    wait_children(tree, &test, FILES);
+    test_log("%u files added in %"PRId64" ms\n", FILES,
+             MS_FROM_VLC_TICK(vlc_tick_now() - start));
+
+    /* Modification */
+    file_path(path, sizeof (path), 0);
+    FILE *stream = fopen(path, "wb");
+    assert(stream != NULL);
+    assert(fwrite("modified", 8, 1, stream) == 1);
+    assert(fclose(stream) == 0);
+    while (file_size(tree, &test, "file00000.mkv") != 8)
+        poll(NULL, 0, 10);
+
+    /* Hidden files are ignored (checked by the final count) */
+    snprintf(hidden, sizeof (hidden), "%s/.hidden", root);
+    int fd = open(hidden, O_WRONLY|O_CREAT|O_EXCL, 0600);
+    assert(fd != -1);
+    close(fd);
+
+    /* Deletion */
+    start = vlc_tick_now();
+    for (unsigned i = 0; i < FILES; i++)
+    {
+        file_path(path, sizeof (path), i);
+        assert(unlink(path) == 0);
+    }
+    wait_children(tree, &test, 0);
+    test_log("%u files removed in %"PRId64" ms\n", FILES,
+             MS_FROM_VLC_TICK(vlc_tick_now() - start));
+
+    unlink(hidden);
+    vlc_media_tree_Unwatch(tree, media);
+    vlc_media_tree_RemoveListener(tree, listener);
+    vlc_media_source_Release(ms);
+    libvlc_release(vlc);
+    rmdir(root);
+    return 0;
+}
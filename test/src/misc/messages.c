@@ -0,0 +1,186 @@
+/*****************************************************************************
+ * messages.c: test for the asynchronous message log
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+
+const char vlc_module_name[] = "test_messages";
+
+#define THREADS 4
+#define MESSAGES 20000
+#define LONG_SIZE 1000
+
+static void *log_thread(void *data)
+{
+    vlc_object_t *obj = data;
+
+    for (unsigned i = 0; i < MESSAGES; i++)
+        msg_Dbg(obj, "bench message %u", i);
+    return NULL;
+}
+
+static void *spam_thread(void *data)
+{
+    vlc_object_t *obj = data;
+
+    for (unsigned i = 0; i < MESSAGES; i++)
+    {
+        msg_Dbg(obj, "spam message %u", i);
+        if ((i % 1000) == 0)
+            msg_Err(obj, "error message %u", i);
+    }
+    return NULL;
+}
+
+/* Filtered out messages must not take the room of the others */
+static void test_log_filtered(const char *path)
+{
+    char option[256];
+    snprintf(option, sizeof (option), "--logfile=%s", path);
+
+    const char *argv[] = {
+        "--file-logging", option, "--log-verbose=0", "--log-async",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    vlc_thread_t threads[THREADS];
+
+    for (size_t i = 0; i < THREADS; i++)
+        assert(vlc_clone(&threads[i], spam_thread, obj) == 0);
+    for (size_t i = 0; i < THREADS; i++)
+        vlc_join(threads[i], NULL);
+    libvlc_release(vlc);
+
+    FILE *stream = fopen(path, "rt");
+    assert(stream != NULL);
+
+    unsigned long errors = 0;
+    char line[256];
+
+    while (fgets(line, sizeof (line), stream) != NULL)
+    {
+        assert(strstr(line, "spam message ") == NULL);
+        assert(strstr(line, "dropped") == NULL);
+        if (strstr(line, "error message ") != NULL)
+            errors++;
+    }
+    fclose(stream);
+    assert(errors == THREADS * (MESSAGES / 1000));
+}
+
+static void test_log_bench(const char *path, bool async)
+{
+    char option[256];
+    snprintf(option, sizeof (option), "--logfile=%s", path);
+
+    const char *argv[] = {
+        "--file-logging", option, "--log-verbose=2",
+        async ? "--log-async" : "--no-log-async",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* Longer than the ring cells */
+    char long_msg[LONG_SIZE + 1];
+    memset(long_msg, 'x', LONG_SIZE);
+    long_msg[LONG_SIZE] = '\0';
+    msg_Dbg(obj, "long %s", long_msg);
+
+    vlc_thread_t threads[THREADS];
+    vlc_tick_t start = vlc_tick_now();
+    for (size_t i = 0; i < THREADS; i++)
+        assert(vlc_clone(&threads[i], log_thread, obj) == 0);
+    for (size_t i = 0; i < THREADS; i++)
+        vlc_join(threads[i], NULL);
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    /* Flushes the log */
+    libvlc_release(vlc);
+
+    FILE *stream = fopen(path, "rt");
+    assert(stream != NULL);
+
+    unsigned long messages = 0, dropped = 0;
+    bool long_found = false;
+    char line[LONG_SIZE + 256];
+
+    while (fgets(line, sizeof (line), stream) != NULL)
+    {
+        const char *msg = strstr(line, ": ");
+        unsigned long count;
+
+        if (msg == NULL)
+            continue;
+        msg += 2;
+        if (strncmp(msg, "bench message ", 14) == 0)
+            messages++;
+        else if (sscanf(msg, "%lu log message(s) dropped", &count) == 1)
+            dropped += count;
+        else if (strncmp(msg, "long ", 5) == 0)
+        {
+            assert(strlen(msg + 5) == LONG_SIZE + 1 /* new line */);
+            long_found = true;
+        }
+    }
+    fclose(stream);
+
+    test_log("%s: %lu calls/s, %lu message(s) written, %lu dropped\n",
+             async ? "asynchronous" : "synchronous",
+             (unsigned long)(THREADS * MESSAGES * CLOCK_FREQ
+                             / (elapsed > 0 ? elapsed : 1)),
+             messages, dropped);
+
+    assert(long_found);
+    /* Every message is either written or accounted for (the drop counter
+     * also includes messages from other threads) */
+    assert(messages <= THREADS * MESSAGES);
+    assert(messages + dropped >= THREADS * MESSAGES);
+    if (!async)
+        assert(dropped == 0);
+}
+
+int main(void)
+{
+    char path[] = "/tmp/vlc-log-XXXXXX";
+
+    test_init();
+
+    int fd = mkstemp(path);
+    assert(fd != -1);
+    close(fd);
+
+    test_log_bench(path, false);
+    assert(truncate(path, 0) == 0);
+    test_log_bench(path, true);
+    assert(truncate(path, 0) == 0);
+    test_log_filtered(path);
+    unlink(path);
+    return 0;
+}
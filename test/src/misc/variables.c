@@ -444,6 +444,53 @@ static void test_creation_and_type( libvlc_int_t *p_libvlc )
     assert( var_Get( p_libvlc, "bla", &val ) == VLC_ENOENT );
 }
 
+#define BENCH_VARS 1000
+#define BENCH_LOOPS 200
+
+/* Checks many variables on one object, and measures the lookup rate */
+static void test_many( libvlc_int_t *p_libvlc )
+{
+    char name[32];
+
+    for( int i = 0; i < BENCH_VARS; i++ )
+    {
+        snprintf( name, sizeof (name), "bench-%d", i );
+        assert( var_Create( p_libvlc, name, VLC_VAR_INTEGER ) == VLC_SUCCESS );
+        var_SetInteger( p_libvlc, name, i );
+    }
+
+    vlc_tick_t start = vlc_tick_now();
+    for( int j = 0; j < BENCH_LOOPS; j++ )
+        for( int i = 0; i < BENCH_VARS; i++ )
+        {
+            snprintf( name, sizeof (name), "bench-%d", i );
+            assert( var_GetInteger( p_libvlc, name ) == i + j );
+            var_SetInteger( p_libvlc, name, i + j + 1 );
+        }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+    if( elapsed <= 0 )
+        elapsed = 1;
+    test_log( "%d get/set pairs, %"PRId64" pairs/s\n",
+              BENCH_VARS * BENCH_LOOPS,
+              BENCH_VARS * BENCH_LOOPS * CLOCK_FREQ / elapsed );
+
+    start = vlc_tick_now();
+    for( int j = 0; j < BENCH_LOOPS; j++ )
+        (void) var_InheritBool( p_libvlc, "fullscreen" );
+    elapsed = vlc_tick_now() - start;
+    if( elapsed <= 0 )
+        elapsed = 1;
+    test_log( "%d inherited look-ups, %"PRId64" look-ups/s\n", BENCH_LOOPS,
+              BENCH_LOOPS * CLOCK_FREQ / elapsed );
+
+    for( int i = 0; i < BENCH_VARS; i++ )
+    {
+        snprintf( name, sizeof (name), "bench-%d", i );
+        var_Destroy( p_libvlc, name );
+        assert( var_Type( p_libvlc, name ) == 0 );
+    }
+}
+
 static void test_variables( libvlc_instance_t *p_vlc )
 {
     libvlc_int_t *p_libvlc = p_vlc->p_libvlc_int;
@@ -481,6 +528,9 @@ static void test_variables( libvlc_instance_t *p_vlc )
 
     test_log( "Testing type at creation\n" );
     test_creation_and_type( p_libvlc );
+
+    test_log( "Testing many variables\n" );
+    test_many( p_libvlc );
 }
 
 
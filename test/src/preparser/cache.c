@@ -0,0 +1,265 @@
+/*****************************************************************************
+ * cache.c: test for the preparse cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../libvlc/wav.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef __GLIBC__
+# include <malloc.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_input_item.h>
+#include <vlc_memstream.h>
+#include <vlc_url.h>
+
+const char vlc_module_name[] = "test_preparse_cache";
+
+#define RATE 8000
+#define SECONDS 2
+
+static void on_preparse_ended(input_item_t *item,
+                              enum input_item_preparse_status status,
+                              void *data)
+{
+    VLC_UNUSED(item);
+    assert(status == ITEM_PREPARSE_DONE);
+    vlc_sem_post(data);
+}
+
+static const input_preparser_callbacks_t cbs = {
+    .on_preparse_ended = on_preparse_ended,
+};
+
+/* Preparses a file, and returns its duration */
+static vlc_tick_t preparse(libvlc_instance_t *vlc, const char *uri,
+                           bool warmup)
+{
+    input_item_t *item = input_item_New(uri, "test");
+    assert(item != NULL);
+
+    if (warmup)
+    {
+        assert(libvlc_MetadataWarmup(vlc->p_libvlc_int, &item, 1) == 1);
+        assert(input_item_IsPreparsed(item));
+    }
+    else
+    {
+        vlc_sem_t sem;
+        vlc_sem_init(&sem, 0);
+        assert(libvlc_MetadataRequest(vlc->p_libvlc_int, item,
+                                      META_REQUEST_OPTION_SCOPE_LOCAL, &cbs,
+                                      &sem, -1, NULL) == VLC_SUCCESS);
+        vlc_sem_wait(&sem);
+    }
+
+    vlc_mutex_lock(&item->lock);
+    assert(item->i_es == 1);
+    assert(item->es[0]->i_cat == AUDIO_ES);
+    assert(item->es[0]->audio.i_rate == RATE);
+    vlc_mutex_unlock(&item->lock);
+
+    vlc_tick_t duration = input_item_GetDuration(item);
+    input_item_Release(item);
+    return duration;
+}
+
+static void write_u32(struct vlc_memstream *ms, uint32_t v)
+{
+    vlc_memstream_write(ms, &v, sizeof (v));
+}
+
+static void write_i64(struct vlc_memstream *ms, int64_t v)
+{
+    vlc_memstream_write(ms, &v, sizeof (v));
+}
+
+/* Writes a cache with one corrupt entry for a file: its second track has an
+ * invalid category, or is truncated. The entry has a wrong duration, so that
+ * it shows if the entry is used. */
+static void write_corrupt_cache(const char *cache, const char *uri,
+                                const char *path, bool truncated)
+{
+    struct vlc_memstream data, ms;
+    struct stat st;
+
+    assert(stat(path, &st) == 0);
+
+    vlc_memstream_open(&data);
+    write_i64(&data, VLC_TICK_FROM_SEC(1234));
+    write_u32(&data, 0); /* meta */
+    write_u32(&data, 0); /* extra meta */
+    write_u32(&data, 2); /* tracks */
+    write_u32(&data, AUDIO_ES);
+    for (int i = 0; i < 6; i++)
+        write_u32(&data, 0);
+    write_u32(&data, UINT32_MAX); /* no language */
+    write_u32(&data, UINT32_MAX); /* no description */
+    write_u32(&data, RATE);
+    write_u32(&data, 1);
+    write_u32(&data, 16);
+    if (truncated)
+    {
+        write_u32(&data, AUDIO_ES);
+        write_u32(&data, 0);
+    }
+    else
+        write_u32(&data, 42); /* invalid category */
+    assert(vlc_memstream_close(&data) == 0);
+
+    vlc_memstream_open(&ms);
+    vlc_memstream_puts(&ms, "VLC preparse cache 2\n");
+    write_u32(&ms, strlen(uri));
+    vlc_memstream_puts(&ms, uri);
+    write_i64(&ms, st.st_size);
+    write_i64(&ms, st.st_mtim.tv_sec * INT64_C(1000000000)
+                   + st.st_mtim.tv_nsec);
+    write_u32(&ms, data.length);
+    vlc_memstream_write(&ms, data.ptr, data.length);
+    assert(vlc_memstream_close(&ms) == 0);
+    free(data.ptr);
+
+    FILE *stream = fopen(cache, "wb");
+    assert(stream != NULL);
+    assert(fwrite(ms.ptr, ms.length, 1, stream) == 1);
+    assert(fclose(stream) == 0);
+    free(ms.ptr);
+}
+
+/* Checks whether the cache has an entry for a URI */
+static bool cache_has(const char *cache, const char *uri)
+{
+    char buf[4096];
+    FILE *stream = fopen(cache, "rb");
+    assert(stream != NULL);
+    size_t len = fread(buf, 1, sizeof (buf), stream);
+    assert(len < sizeof (buf));
+    fclose(stream);
+
+    for (size_t i = 0; i + strlen(uri) <= len; i++)
+        if (!memcmp(buf + i, uri, strlen(uri)))
+            return true;
+    return false;
+}
+
+static libvlc_instance_t *create_instance(void)
+{
+    const char *argv[] = {
+        "-v", "--ignore-config", "--preparse-cache",
+        "--no-metadata-network-access",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+    return vlc;
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/vlc-preparse-XXXXXX";
+    char path[sizeof (dir) + 16], cache[sizeof (dir) + 32];
+
+    test_init();
+#ifdef M_PERTURB
+    /* Fill allocations with garbage, so that uninitialized tracks show */
+    mallopt(M_PERTURB, 0xA5);
+#endif
+
+    assert(mkdtemp(dir) != NULL);
+    setenv("XDG_CACHE_HOME", dir, 1);
+    snprintf(path, sizeof (path), "%s/test.wav", dir);
+    snprintf(cache, sizeof (cache), "%s/vlc/preparse.dat", dir);
+    test_write_wav(path, 1, RATE, SECONDS, false);
+
+    char *uri = vlc_path2uri(path, NULL);
+    assert(uri != NULL);
+
+    /* First run: the file is parsed and stored */
+    libvlc_instance_t *vlc = create_instance();
+    vlc_tick_t duration = preparse(vlc, uri, false);
+    assert(duration == VLC_TICK_FROM_SEC(SECONDS));
+    libvlc_release(vlc);
+
+    struct stat st;
+    assert(stat(cache, &st) == 0);
+
+    /* Break the file without changing its identity: the cache must be used */
+    struct stat wav;
+    assert(stat(path, &wav) == 0);
+    FILE *stream = fopen(path, "r+b");
+    assert(stream != NULL);
+    assert(fwrite("JUNK", 4, 1, stream) == 1);
+    assert(fclose(stream) == 0);
+    const struct timespec times[2] = { wav.st_atim, wav.st_mtim };
+    assert(utimensat(AT_FDCWD, path, times, 0) == 0);
+
+    vlc = create_instance();
+    assert(preparse(vlc, uri, false) == duration);
+    assert(preparse(vlc, uri, true) == duration);
+    libvlc_release(vlc);
+
+    /* Modified files are parsed again */
+    test_write_wav(path, 1, RATE, 2 * SECONDS, false);
+    vlc = create_instance();
+    assert(preparse(vlc, uri, false) == 2 * duration);
+    libvlc_release(vlc);
+
+    /* Corrupt entries are dropped, and the files parsed again */
+    for (int i = 0; i < 2; i++)
+    {
+        write_corrupt_cache(cache, uri, path, i != 0);
+        vlc = create_instance();
+        assert(preparse(vlc, uri, false) == 2 * duration);
+        libvlc_release(vlc);
+    }
+
+    /* The entries of deleted files are dropped */
+    char gone[sizeof (dir) + 16];
+    snprintf(gone, sizeof (gone), "%s/gone.wav", dir);
+    test_write_wav(gone, 1, RATE, SECONDS, false);
+    char *gone_uri = vlc_path2uri(gone, NULL);
+    assert(gone_uri != NULL);
+
+    vlc = create_instance();
+    assert(preparse(vlc, gone_uri, false) == duration);
+    libvlc_release(vlc);
+    assert(cache_has(cache, gone_uri));
+
+    unlink(gone);
+    vlc = create_instance();
+    assert(preparse(vlc, uri, false) == 2 * duration);
+    libvlc_release(vlc);
+    assert(!cache_has(cache, gone_uri));
+    assert(cache_has(cache, uri));
+    free(gone_uri);
+
+    free(uri);
+    unlink(path);
+    unlink(cache);
+    snprintf(cache, sizeof (cache), "%s/vlc", dir);
+    rmdir(cache);
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,223 @@
+/*****************************************************************************
+ * light.c: test and benchmark for the light preparsing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../../libvlc/wav.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_input_item.h>
+#include <vlc_url.h>
+
+const char vlc_module_name[] = "test_preparse_light";
+
+#define RATE 8000
+#define SECONDS 2
+#define ITERATIONS 50
+
+static void write_be32(FILE *stream, uint32_t v)
+{
+    uint8_t b[4];
+
+    SetDWBE(b, v);
+    assert(fwrite(b, sizeof (b), 1, stream) == 1);
+}
+
+static void write_silence(FILE *stream, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+        assert(fputc(0, stream) != EOF);
+}
+
+/* Writes a mono 16-bits Sun audio file */
+static void write_au(const char *path)
+{
+    uint32_t size = SECONDS * RATE * 2;
+    FILE *stream = fopen(path, "wb");
+    assert(stream != NULL);
+
+    assert(fwrite(".snd", 4, 1, stream) == 1);
+    write_be32(stream, 24);
+    write_be32(stream, size);
+    write_be32(stream, 3); /* 16-bits linear PCM */
+    write_be32(stream, RATE);
+    write_be32(stream, 1);
+    write_silence(stream, size);
+    assert(fclose(stream) == 0);
+}
+
+struct result
+{
+    vlc_sem_t done;
+    int status;
+    vlc_tick_t duration;
+    int tracks;
+    int cat;
+    char *name;
+};
+
+static void on_preparse_ended(input_item_t *item,
+                              enum input_item_preparse_status status,
+                              void *data)
+{
+    VLC_UNUSED(item);
+    struct result *res = data;
+
+    res->status = status;
+    vlc_sem_post(&res->done);
+}
+
+static const input_preparser_callbacks_t cbs = {
+    .on_preparse_ended = on_preparse_ended,
+};
+
+static void preparse(libvlc_instance_t *vlc, const char *uri,
+                     struct result *res)
+{
+    input_item_t *item = input_item_New(uri, NULL);
+    assert(item != NULL);
+
+    vlc_sem_init(&res->done, 0);
+    assert(libvlc_MetadataRequest(vlc->p_libvlc_int, item,
+                                  META_REQUEST_OPTION_SCOPE_LOCAL, &cbs,
+                                  res, -1, NULL) == VLC_SUCCESS);
+    vlc_sem_wait(&res->done);
+
+    vlc_mutex_lock(&item->lock);
+    res->tracks = item->i_es;
+    res->cat = item->i_es > 0 ? item->es[0]->i_cat : UNKNOWN_ES;
+    vlc_mutex_unlock(&item->lock);
+
+    res->duration = input_item_GetDuration(item);
+    res->name = input_item_GetName(item);
+    input_item_Release(item);
+}
+
+/* Counts the messages of the input threads: the light path creates none */
+static void on_log(void *data, int level, const libvlc_log_t *ctx,
+                   const char *fmt, va_list args)
+{
+    atomic_uint *inputs = data;
+    const char *name, *header;
+    uintptr_t id;
+
+    VLC_UNUSED(level); VLC_UNUSED(fmt); VLC_UNUSED(args);
+    libvlc_log_get_object(ctx, &name, &header, &id);
+    if (name != NULL && strcmp(name, "input") == 0)
+        atomic_fetch_add_explicit(inputs, 1, memory_order_relaxed);
+}
+
+static atomic_uint inputs[2];
+
+static libvlc_instance_t *create_instance(bool light)
+{
+    const char *argv[] = {
+        "-v", "--ignore-config", "--no-metadata-network-access",
+        light ? "--preparse-light" : "--no-preparse-light",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+    libvlc_log_set(vlc, on_log, &inputs[light]);
+    return vlc;
+}
+
+/* Preparses a file with both paths, compares and benchmarks them */
+static void test_file(libvlc_instance_t *full, libvlc_instance_t *light,
+                      const char *path)
+{
+    char *uri = vlc_path2uri(path, NULL);
+    assert(uri != NULL);
+
+    struct result ref, res;
+    atomic_store(&inputs[0], 0);
+    atomic_store(&inputs[1], 0);
+    preparse(full, uri, &ref);
+    preparse(light, uri, &res);
+    /* The light path ran, rather than falling back to the input */
+    assert(atomic_load(&inputs[0]) > 0);
+    assert(atomic_load(&inputs[1]) == 0);
+
+    assert(res.status == ref.status);
+    assert(res.duration == ref.duration);
+    assert(res.tracks == ref.tracks);
+    assert(res.cat == ref.cat);
+    assert(strcmp(res.name, ref.name) == 0);
+    free(ref.name);
+    free(res.name);
+
+    vlc_tick_t elapsed[2];
+    libvlc_instance_t *instances[2] = { full, light };
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        vlc_tick_t start = vlc_tick_now();
+        for (unsigned j = 0; j < ITERATIONS; j++)
+        {
+            preparse(instances[i], uri, &res);
+            free(res.name);
+        }
+        elapsed[i] = vlc_tick_now() - start;
+        if (elapsed[i] <= 0)
+            elapsed[i] = 1;
+    }
+
+    test_log("%s: full %"PRId64" items/s, light %"PRId64" items/s\n",
+             strrchr(path, '/') + 1,
+             ITERATIONS * CLOCK_FREQ / elapsed[0],
+             ITERATIONS * CLOCK_FREQ / elapsed[1]);
+    free(uri);
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/vlc-preparse-XXXXXX";
+    char wav[sizeof (dir) + 16], au[sizeof (dir) + 16];
+
+    test_init();
+
+    assert(mkdtemp(dir) != NULL);
+    snprintf(wav, sizeof (wav), "%s/test.wav", dir);
+    snprintf(au, sizeof (au), "%s/test.au", dir);
+    test_write_wav(wav, 1, RATE, SECONDS, false);
+    write_au(au);
+
+    libvlc_instance_t *full = create_instance(false);
+    libvlc_instance_t *light = create_instance(true);
+
+    test_file(full, light, wav);
+    test_file(full, light, au);
+    test_file(full, light, SRCDIR"/samples/meta.mp3");
+    test_file(full, light, SRCDIR"/samples/empty.voc");
+    test_file(full, light, SRCDIR"/samples/image.jpg");
+
+    libvlc_release(light);
+    libvlc_release(full);
+
+    unlink(wav);
+    unlink(au);
+    rmdir(dir);
+    return 0;
+}